@@ -29,6 +29,9 @@
 #include <QXmlInputSource>
 #include <QFile>
 #include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
 
 #include <KProcess>
 #include <KProgressDialog>
@@ -97,11 +100,26 @@ bool AICommandManager::setupParser()
   parser->loadVars(KStandardDirs::locate("data", "ai/util/bot.xml"), true);
   parser->loadSubstitutions(KStandardDirs::locate("data", "ai/util/substitutions.xml"));
 
-  QString aimlDirString = KStandardDirs::locate("data", "ai/aimls/"+static_cast<AIConfiguration*>(config)->aimlSet()+'/');
+  QString aimlSet = static_cast<AIConfiguration*>(config)->aimlSet();
+  QString aimlDirString = KStandardDirs::locate("data", "ai/aimls/"+aimlSet+'/');
 
   QDir aimlDir(aimlDirString);
   QStringList aimls = aimlDir.entryList(QStringList() << "*.aiml", QDir::Files);
 
+  //parsing the aiml set takes much longer than mapping the compiled graph;
+  //the graph is rebuilt whenever one of the source files changes
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  foreach (const QString& aiml, aimls) {
+    QFileInfo info(aimlDir.filePath(aiml));
+    hash.addData(aiml.toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toTime_t()));
+  }
+  QByteArray stamp = hash.result();
+  QString compiledPath = KStandardDirs::locateLocal("data", "ai/compiled/"+aimlSet+".graph");
+  if (parser->loadCompiled(compiledPath, stamp))
+    return true;
+
   KProgressDialog *dlg = new KProgressDialog(0, i18n("Artificial Intelligence"), i18n("Loading artificial intelligence..."));
   dlg->progressBar()->setMaximum(aimls.count());
   dlg->show();
@@ -111,6 +129,9 @@ bool AICommandManager::setupParser()
     dlg->progressBar()->setValue(++i);
   }
   dlg->deleteLater();
+
+  if (!parser->saveCompiled(compiledPath, stamp))
+    kWarning() << "Failed to store compiled aiml set to " << compiledPath;
   return true;
 }
 
@@ -0,0 +1,463 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "aimlgraph.h"
+#include "aimlparser.h"
+
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+#include <QTextStream>
+#include <QtAlgorithms>
+#include <string.h>
+
+static const char graphMagic[8] = { 'S', 'I', 'M', 'O', 'N', 'A', 'I', 'G' };
+static const quint32 graphVersion = 1;
+static const quint32 graphByteOrder = 0x01020304;
+
+/*
+ * File layout (native byte order, everything 4 byte aligned):
+ *
+ * Header
+ * quint32 stringOffsets[stringCount+1]   in UTF-16 code units
+ * quint32 sortedWords[wordCount]         string ids of pattern words, sorted
+ * FlatNode nodes[nodeCount]              breadth first; node 0 is the root
+ * FlatLeaf leaves[leafCount]
+ * ushort strings[stringOffsets[stringCount]]
+ */
+struct AIMLGraph::Header {
+  char magic[8];
+  quint32 version;
+  quint32 byteOrder;
+  char stamp[16];
+  quint32 stringCount;
+  quint32 wordCount;
+  quint32 nodeCount;
+  quint32 leafCount;
+  quint32 empty;
+  quint32 star;
+  quint32 underscore;
+  quint32 reserved;
+};
+
+class AIMLStringTable
+{
+  public:
+    AIMLStringTable() { offsets << 0; }
+
+    quint32 intern(const QString& s) {
+      QHash<QString, quint32>::const_iterator i = ids.constFind(s);
+      if (i != ids.constEnd())
+        return *i;
+      quint32 id = offsets.count()-1;
+      ids.insert(s, id);
+      strings += s;
+      offsets << strings.length();
+      return id;
+    }
+
+    QHash<QString, quint32> ids;
+    QVector<quint32> offsets;
+    QString strings;
+};
+
+static bool isLessThanByString(const QPair<QString, quint32>& a, const QPair<QString, quint32>& b)
+{
+  return a.first < b.first;
+}
+
+const quint32 AIMLGraph::NoWord;
+
+AIMLGraph::AIMLGraph() : m_file(0)
+{
+  clear();
+}
+
+AIMLGraph::~AIMLGraph()
+{
+  delete m_file;
+}
+
+void AIMLGraph::clear()
+{
+  delete m_file;
+  m_file = 0;
+  m_data.clear();
+  m_base = 0;
+  m_size = 0;
+  m_stringCount = m_wordCount = m_nodeCount = m_leafCount = 0;
+  m_stringOffsets = 0;
+  m_strings = 0;
+  m_sortedWords = 0;
+  m_nodes = 0;
+  m_leaves = 0;
+  m_empty = m_star = m_underscore = NoWord;
+}
+
+void AIMLGraph::build(const Node& root)
+{
+  AIMLStringTable table;
+  QVector<FlatNode> nodes;
+  QVector<FlatLeaf> leaves;
+  QSet<quint32> words;
+
+  //breadth first so that the children of every node are consecutive
+  QList<const Node*> queue;
+  QList<quint32> parents;
+  queue << &root;
+  parents << NoWord;
+  for (int i=0; i < queue.count(); i++) {
+    const Node *n = queue[i];
+    FlatNode f;
+    f.word = table.intern(n->word);
+    f.parent = parents[i];
+    f.firstChild = queue.count();
+    f.childCount = n->children.count();
+    f.firstLeaf = leaves.count();
+    f.leafCount = n->leafs.count();
+    words << f.word;
+
+    foreach (const Node *child, n->children) {
+      queue << child;
+      parents << i;
+    }
+    foreach (const Leaf *leaf, n->leafs) {
+      FlatLeaf l;
+      l.node = i;
+      l.that = table.intern(leaf->that);
+      l.topic = table.intern(leaf->topic);
+      l.tmplate = table.intern(leaf->tmplate);
+      leaves << l;
+    }
+    nodes << f;
+  }
+
+  QList< QPair<QString, quint32> > sortedWords;
+  foreach (quint32 word, words)
+    sortedWords << qMakePair(table.strings.mid(table.offsets[word], table.offsets[word+1]-table.offsets[word]), word);
+  qSort(sortedWords.begin(), sortedWords.end(), isLessThanByString);
+
+  Header header;
+  memset(&header, 0, sizeof(Header));
+  memcpy(header.magic, graphMagic, sizeof(graphMagic));
+  header.version = graphVersion;
+  header.byteOrder = graphByteOrder;
+  header.empty = table.intern(QString(""));
+  header.star = table.intern("*");
+  header.underscore = table.intern("_");
+  header.stringCount = table.offsets.count()-1;
+  header.wordCount = sortedWords.count();
+  header.nodeCount = nodes.count();
+  header.leafCount = leaves.count();
+
+  QByteArray data;
+  data.reserve(sizeof(Header) + table.offsets.count()*sizeof(quint32) + sortedWords.count()*sizeof(quint32) +
+               nodes.count()*sizeof(FlatNode) + leaves.count()*sizeof(FlatLeaf) +
+               table.strings.length()*sizeof(ushort));
+  data.append((const char*) &header, sizeof(Header));
+  data.append((const char*) table.offsets.constData(), table.offsets.count()*sizeof(quint32));
+  for (int i=0; i < sortedWords.count(); i++)
+    data.append((const char*) &sortedWords[i].second, sizeof(quint32));
+  data.append((const char*) nodes.constData(), nodes.count()*sizeof(FlatNode));
+  data.append((const char*) leaves.constData(), leaves.count()*sizeof(FlatLeaf));
+  data.append((const char*) table.strings.constData(), table.strings.length()*sizeof(ushort));
+
+  clear();
+  m_data = data;
+  bool valid = attach((const uchar*) m_data.constData(), m_data.size());
+  Q_ASSERT(valid);
+  Q_UNUSED(valid);
+}
+
+bool AIMLGraph::attach(const uchar *data, qint64 size)
+{
+  if (size < (qint64) sizeof(Header))
+    return false;
+  Header header;
+  memcpy(&header, data, sizeof(Header));
+  if ((memcmp(header.magic, graphMagic, sizeof(graphMagic)) != 0) || (header.version != graphVersion) ||
+      (header.byteOrder != graphByteOrder))
+    return false;
+
+  qint64 tableSize = sizeof(Header) + ((qint64) header.stringCount + 1 + header.wordCount) * sizeof(quint32) +
+                     ((qint64) header.nodeCount) * sizeof(FlatNode) + ((qint64) header.leafCount) * sizeof(FlatLeaf);
+  if ((tableSize > size) || (header.nodeCount == 0))
+    return false;
+
+  const quint32 *offsets = (const quint32*) (data + sizeof(Header));
+  const quint32 *sortedWords = offsets + header.stringCount + 1;
+  const FlatNode *nodes = (const FlatNode*) (sortedWords + header.wordCount);
+  const FlatLeaf *leaves = (const FlatLeaf*) (nodes + header.nodeCount);
+  const ushort *strings = (const ushort*) (leaves + header.leafCount);
+
+  //validate everything once; matching relies on it
+  bool valid = (offsets[0] == 0) && (header.empty < header.stringCount) &&
+               (header.star < header.stringCount) && (header.underscore < header.stringCount);
+  for (quint32 i=0; valid && (i < header.stringCount); i++)
+    valid = (offsets[i] <= offsets[i+1]);
+  valid = valid && (tableSize + ((qint64) offsets[header.stringCount]) * sizeof(ushort) <= size);
+  for (quint32 i=0; valid && (i < header.wordCount); i++)
+    valid = (sortedWords[i] < header.stringCount);
+  for (quint32 i=0; valid && (i < header.nodeCount); i++) {
+    const FlatNode& n = nodes[i];
+    //children are always stored after their parent; no cycles
+    valid = (n.word < header.stringCount) && ((i == 0) ? (n.parent == NoWord) : (n.parent < i)) &&
+            ((n.childCount == 0) || ((n.firstChild > i) && ((qint64) n.firstChild + n.childCount <= header.nodeCount))) &&
+            ((qint64) n.firstLeaf + n.leafCount <= header.leafCount);
+  }
+  for (quint32 i=0; valid && (i < header.leafCount); i++)
+    valid = (leaves[i].node < header.nodeCount) && (leaves[i].that < header.stringCount) &&
+            (leaves[i].topic < header.stringCount) && (leaves[i].tmplate < header.stringCount);
+  if (!valid)
+    return false;
+
+  m_base = data;
+  m_size = size;
+  m_stringCount = header.stringCount;
+  m_stringOffsets = offsets;
+  m_strings = strings;
+  m_wordCount = header.wordCount;
+  m_sortedWords = sortedWords;
+  m_nodeCount = header.nodeCount;
+  m_nodes = nodes;
+  m_leafCount = header.leafCount;
+  m_leaves = leaves;
+  m_empty = header.empty;
+  m_star = header.star;
+  m_underscore = header.underscore;
+  return true;
+}
+
+bool AIMLGraph::save(const QString& path, const QByteArray& stamp) const
+{
+  if (!m_base)
+    return false;
+
+  Header header;
+  memcpy(&header, m_base, sizeof(Header));
+  memset(header.stamp, 0, sizeof(header.stamp));
+  memcpy(header.stamp, stamp.constData(), qMin(stamp.size(), (int) sizeof(header.stamp)));
+
+  //a mapped graph of this file might still be in use: replace it instead of writing into it
+  QString tempPath = path+".new";
+  QFile f(tempPath);
+  if (!f.open(QIODevice::WriteOnly))
+    return false;
+  f.write((const char*) &header, sizeof(Header));
+  f.write((const char*) m_base + sizeof(Header), m_size - sizeof(Header));
+  f.close();
+  if (f.error() != QFile::NoError) {
+    f.remove();
+    return false;
+  }
+  QFile::remove(path);
+  return QFile::rename(tempPath, path);
+}
+
+bool AIMLGraph::load(const QString& path, const QByteArray& stamp)
+{
+  QFile *f = new QFile(path);
+  uchar *data = 0;
+  qint64 size = f->size();
+  if (f->open(QIODevice::ReadOnly))
+    data = f->map(0, size);
+
+  QByteArray paddedStamp = stamp.left(sizeof(((Header*) 0)->stamp));
+  paddedStamp.append(QByteArray(sizeof(((Header*) 0)->stamp) - paddedStamp.size(), '\0'));
+
+  if (!data || (size < (qint64) sizeof(Header)) ||
+      (memcmp(((const Header*) data)->stamp, paddedStamp.constData(), paddedStamp.size()) != 0)) {
+    delete f;
+    return false;
+  }
+
+  //the current graph stays in place if the file is invalid
+  if (!attach(data, size)) {
+    delete f;
+    return false;
+  }
+  delete m_file;
+  m_file = f;
+  m_data.clear();
+  return true;
+}
+
+QString AIMLGraph::string(quint32 id) const
+{
+  return QString::fromRawData((const QChar*) (m_strings + m_stringOffsets[id]),
+                              m_stringOffsets[id+1] - m_stringOffsets[id]);
+}
+
+QString AIMLGraph::copy(quint32 id) const
+{
+  return QString((const QChar*) (m_strings + m_stringOffsets[id]), m_stringOffsets[id+1] - m_stringOffsets[id]);
+}
+
+static int compareRaw(const ushort *a, int aLength, const QString& b)
+{
+  const ushort *bData = b.utf16();
+  int length = qMin(aLength, b.length());
+  for (int i=0; i < length; i++)
+    if (a[i] != bData[i])
+      return (a[i] < bData[i]) ? -1 : 1;
+  return aLength - b.length();
+}
+
+quint32 AIMLGraph::wordId(const QString& word) const
+{
+  int low = 0;
+  int high = ((int) m_wordCount) - 1;
+  while (low <= high) {
+    int middle = (low + high) / 2;
+    quint32 id = m_sortedWords[middle];
+    int c = compareRaw(m_strings + m_stringOffsets[id], m_stringOffsets[id+1] - m_stringOffsets[id], word);
+    if (c == 0)
+      return id;
+    if (c < 0)
+      low = middle + 1;
+    else
+      high = middle - 1;
+  }
+  return NoWord;
+}
+
+bool AIMLGraph::match(const QVector<quint32>& input, const QString& that, const QString& topic,
+                      QStringList& capturedThatTexts, QStringList& capturedTopicTexts, quint32& leaf) const
+{
+  if (!m_nodeCount)
+    return false;
+  return matchNode(0, 0, input, that, topic, capturedThatTexts, capturedTopicTexts, leaf);
+}
+
+bool AIMLGraph::matchNode(quint32 node, int input, const QVector<quint32>& words, const QString& that,
+                          const QString& topic, QStringList& capturedThatTexts, QStringList& capturedTopicTexts,
+                          quint32& leaf) const
+{
+  if (input == words.count())
+    return false;
+
+  const FlatNode& n = m_nodes[node];
+  quint32 childEnd = n.firstChild + n.childCount;
+  if ((n.word == m_star) || (n.word == m_underscore)) {
+    //wildcards swallow at least one word
+    for (++input; input != words.count(); input++)
+      for (quint32 child = n.firstChild; child < childEnd; child++)
+        if (matchNode(child, input, words, that, topic, capturedThatTexts, capturedTopicTexts, leaf))
+          return true;
+  }
+  else {
+    if (n.word != m_empty) {
+      if (n.word != words[input])
+        return false;
+      ++input;
+    }
+    for (quint32 child = n.firstChild; child < childEnd; child++)
+      if (matchNode(child, input, words, that, topic, capturedThatTexts, capturedTopicTexts, leaf))
+        return true;
+  }
+
+  if (input == words.count()) {
+    quint32 leafEnd = n.firstLeaf + n.leafCount;
+    for (quint32 l = n.firstLeaf; l < leafEnd; l++) {
+      capturedThatTexts.clear();
+      capturedTopicTexts.clear();
+      QString leafThat = string(m_leaves[l].that);
+      QString leafTopic = string(m_leaves[l].topic);
+      if ( (!leafThat.isEmpty() && !exactMatch(leafThat, that, capturedThatTexts)) ||
+        (!leafTopic.isEmpty() && !exactMatch(leafTopic, topic, capturedTopicTexts)) )
+        continue;
+      leaf = l;
+      return true;
+    }
+  }
+  return false;
+}
+
+QString AIMLGraph::pattern(quint32 leaf) const
+{
+  QStringList words;
+  for (quint32 node = m_leaves[leaf].node; node != 0; node = m_nodes[node].parent)
+    words.prepend(string(m_nodes[node].word));
+  return words.join(" ");
+}
+
+QString AIMLGraph::that(quint32 leaf) const
+{
+  return copy(m_leaves[leaf].that);
+}
+
+QString AIMLGraph::topic(quint32 leaf) const
+{
+  return copy(m_leaves[leaf].topic);
+}
+
+QString AIMLGraph::templateXml(quint32 leaf) const
+{
+  return copy(m_leaves[leaf].tmplate);
+}
+
+void AIMLGraph::thaw(Node& root) const
+{
+  if (!m_nodeCount)
+    return;
+
+  QVector<Node*> created(m_nodeCount, 0);
+  created[0] = &root;
+  root.word = copy(m_nodes[0].word);
+  //parents are always stored before their children
+  for (quint32 i=0; i < m_nodeCount; i++) {
+    const FlatNode& f = m_nodes[i];
+    Node *n = created[i];
+    for (quint32 child = f.firstChild; child < f.firstChild + f.childCount; child++) {
+      Node *c = new Node;
+      c->word = copy(m_nodes[child].word);
+      c->parent = n;
+      n->children << c;
+      created[child] = c;
+    }
+    for (quint32 l = f.firstLeaf; l < f.firstLeaf + f.leafCount; l++) {
+      Leaf *leaf = new Leaf;
+      leaf->parent = n;
+      leaf->that = that(l);
+      leaf->topic = topic(l);
+      leaf->tmplate = templateXml(l);
+      n->leafs << leaf;
+    }
+  }
+}
+
+void AIMLGraph::debug(QTextStream* logStream) const
+{
+  if (m_nodeCount)
+    debugNode(logStream, 0, 0);
+}
+
+void AIMLGraph::debugNode(QTextStream* logStream, quint32 node, uint indent) const
+{
+  const FlatNode& n = m_nodes[node];
+  QString indentStr = QString().fill('\t', indent);
+  *logStream << indentStr << string(n.word) << " :\n";
+  for (quint32 child = n.firstChild; child < n.firstChild + n.childCount; child++)
+    debugNode(logStream, child, indent + 1);
+  indentStr = QString().fill('\t', indent + 1);
+  for (quint32 l = n.firstLeaf; l < n.firstLeaf + n.leafCount; l++)
+    *logStream << indentStr + "<topic-" + topic(l) + " that-" + that(l) + ">\n";
+}
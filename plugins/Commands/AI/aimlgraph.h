@@ -0,0 +1,136 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef SIMON_AIMLGRAPH_H_5D4338A6E8EB46019046E6E327B400EE
+#define SIMON_AIMLGRAPH_H_5D4338A6E8EB46019046E6E327B400EE
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QByteArray>
+
+class QFile;
+class QTextStream;
+struct Node;
+
+/**
+ * \class AIMLGraph
+ * \brief Flattened, serializable form of the AIML pattern tree
+ *
+ * All strings (pattern words, that / topic patterns and the templates)
+ * are stored once in a string table. Nodes and leafs are kept in
+ * contiguous arrays; The children of every node are stored next to each
+ * other.
+ *
+ * The in memory layout is identical to the file layout so a stored graph
+ * is memory mapped and used in place.
+ */
+class AIMLGraph
+{
+  public:
+    static const quint32 NoWord = 0xffffffff;
+
+    AIMLGraph();
+    ~AIMLGraph();
+
+    /**
+     * Replaces the graph with a flattened copy of the given tree
+     */
+    void build(const Node& root);
+
+    /**
+     * Recreates the pattern tree (e.g. to add more categories)
+     */
+    void thaw(Node& root) const;
+
+    /**
+     * \param stamp Identifies the sources of the graph (16 bytes)
+     */
+    bool save(const QString& path, const QByteArray& stamp) const;
+    bool load(const QString& path, const QByteArray& stamp);
+
+    bool isEmpty() const { return m_leafCount == 0; }
+    quint32 leafCount() const { return m_leafCount; }
+
+    /**
+     * \return The id of the given pattern word or NoWord if no pattern
+     *         contains it
+     */
+    quint32 wordId(const QString& word) const;
+
+    bool match(const QVector<quint32>& input, const QString& that, const QString& topic,
+               QStringList& capturedThatTexts, QStringList& capturedTopicTexts, quint32& leaf) const;
+
+    /**
+     * The returned strings stay valid when the graph is rebuilt or unloaded
+     */
+    QString pattern(quint32 leaf) const;
+    QString that(quint32 leaf) const;
+    QString topic(quint32 leaf) const;
+    QString templateXml(quint32 leaf) const;
+
+    void debug(QTextStream* logStream) const;
+
+  private:
+    struct Header;
+    struct FlatNode {
+      quint32 word;
+      quint32 parent;
+      quint32 firstChild;
+      quint32 childCount;
+      quint32 firstLeaf;
+      quint32 leafCount;
+    };
+    struct FlatLeaf {
+      quint32 node;
+      quint32 that;
+      quint32 topic;
+      quint32 tmplate;
+    };
+
+    //either m_data or the mapping of m_file
+    QByteArray m_data;
+    QFile *m_file;
+    const uchar *m_base;
+    qint64 m_size;
+
+    quint32 m_stringCount;
+    const quint32 *m_stringOffsets;
+    const ushort *m_strings;
+    quint32 m_wordCount;
+    const quint32 *m_sortedWords;
+    quint32 m_nodeCount;
+    const FlatNode *m_nodes;
+    quint32 m_leafCount;
+    const FlatLeaf *m_leaves;
+    quint32 m_empty, m_star, m_underscore;
+
+    void clear();
+    bool attach(const uchar *data, qint64 size);
+    //string() references the graph; copy() is independent of it
+    QString string(quint32 id) const;
+    QString copy(quint32 id) const;
+    bool matchNode(quint32 node, int input, const QVector<quint32>& words, const QString& that,
+                   const QString& topic, QStringList& capturedThatTexts, QStringList& capturedTopicTexts,
+                   quint32& leaf) const;
+    void debugNode(QTextStream* logStream, quint32 node, uint indent) const;
+};
+
+#endif
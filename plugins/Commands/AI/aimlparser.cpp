@@ -111,66 +111,25 @@ Node::Node()
 }
 
 
-bool Node::match(QStringList::const_iterator input, const QStringList &inputWords,
-const QString &currentThat, const QString &currentTopic, QStringList &capturedThatTexts,
-QStringList &capturedTopicTexts, Leaf *&leaf)
+Node::~Node()
 {
-  if (input == inputWords.end())
-    return false;
-
-  if ((word == "*") || (word == "_")) {
-    ++input;
-    for (;input != inputWords.end(); input++) {
-      foreach (Node *child, children) {
-        if (child->match(input, inputWords, currentThat, currentTopic, capturedThatTexts,
-          capturedTopicTexts, leaf))
-          return true;
-      }
-    }
-  }
-  else {
-    if (!word.isEmpty()) {
-      if (word != *input)
-        return false;
-      ++input;
-    }
-    foreach (Node *child, children) {
-      if (child->match(input, inputWords, currentThat, currentTopic, capturedThatTexts,
-        capturedTopicTexts, leaf))
-        return true;
-    }
-  }
-  if (input == inputWords.end()) {
-    foreach (leaf, leafs) {
-      capturedThatTexts.clear();
-      capturedTopicTexts.clear();
-      if ( (!leaf->that.isEmpty() && !exactMatch(leaf->that, currentThat, capturedThatTexts)) ||
-        (!leaf->topic.isEmpty() && !exactMatch(leaf->topic, currentTopic, capturedTopicTexts)) )
-        continue;
-      return true;
-    }
-  }
-
-  return false;
+  clear();
 }
 
 
-void Node::debug(QTextStream* logStream, uint indent)
+void Node::clear()
 {
-  QString indentStr = QString().fill('\t', indent);
-  *logStream << indentStr << word << " :\n";
-  foreach (Node *child, children)
-    child->debug(logStream, indent + 1);
-  indentStr = QString().fill('\t', indent + 1);
-  foreach (Leaf *leaf, leafs)
-    *logStream << indentStr + "<topic-" + leaf->topic + " that-" + leaf->that + ">\n";
+  qDeleteAll(children);
+  children.clear();
+  qDeleteAll(leafs);
+  leafs.clear();
 }
 
 
-void AIMLParser::runRegression()
+void AIMLParser::runRegression(const QString& directory)
 {
   QDomDocument doc;
-  QFile file( "utils/TestSuite.xml" );
+  QFile file( directory + "/TestSuite.xml" );
   if ( !file.open( QIODevice::ReadOnly ) )
     return;
   if ( !doc.setContent( &file ) ) {
@@ -182,7 +141,7 @@ void AIMLParser::runRegression()
 
   *logStream << "Regression running:\n";
 
-  loadAiml("utils/TestSuite.aiml");
+  loadAiml(directory + "/TestSuite.aiml");
 
   QDomElement docElem = doc.documentElement();
   QDomNodeList testCaseList = docElem.elementsByTagName ("TestCase");
@@ -212,7 +171,8 @@ void AIMLParser::runRegression()
 
 void AIMLParser::displayTree()
 {
-  root.debug(logStream);
+  compile();
+  graph.debug(logStream);
 }
 
 
@@ -229,7 +189,8 @@ void AIMLParser::normalizeString(QString &str)
 
 
 AIMLParser::AIMLParser(QTextStream* logStream_)
-: indent(0),
+: graphOutdated(false),
+indent(0),
 logStream(logStream_)
 {
   root.parent = 0;
@@ -259,13 +220,42 @@ bool AIMLParser::loadSubstitutions(const QString &filename)
   QDomNodeList subsList = docElem.elementsByTagName ("substitution");
   for (int i = 0; i < subsList.count(); i++) {
     QDomElement n = subsList.item(i).toElement();
-    subOld.append(QRegExp(n.namedItem("old").firstChild().nodeValue()));
+    QString old = n.namedItem("old").firstChild().nodeValue();
+    subOld.append(QRegExp(old));
+    subLiteral.append(substitutionLiteral(old));
     subNew.append(n.namedItem("new").firstChild().nodeValue());
   }
   return true;
 }
 
 
+//returns the text every match of the given substitution pattern contains
+//(or an empty string if the pattern is not a simple literal); Lets
+//getResponse() skip the replacement for the vast majority of substitutions
+QString AIMLParser::substitutionLiteral(const QString& pattern)
+{
+  QString literal;
+  for (int i = 0; i < pattern.length(); i++) {
+    QChar c = pattern.at(i);
+    if (c == '\\') {
+      if (++i == pattern.length())
+        return QString();
+      c = pattern.at(i);
+      if (c == 'b')
+        continue;
+      if (c.isLetterOrNumber())
+        return QString();
+      literal += c;
+    }
+    else if (QString(".*+?[](){}|^$").contains(c))
+      return QString();
+    else
+      literal += c;
+  }
+  return literal;
+}
+
+
 bool AIMLParser::loadVars(const QString &filename, const bool &bot)
 {
   QDomDocument doc;
@@ -351,6 +341,11 @@ bool AIMLParser::loadAiml(const QString &filename)
   }
   file.close();
 
+  //continue with the categories of a loaded graph
+  if (root.children.isEmpty() && root.leafs.isEmpty())
+    graph.thaw(root);
+  graphOutdated = true;
+
   QDomElement docElem = doc.documentElement();
   QDomNodeList categoryList = docElem.elementsByTagName ("category");
   for (int i = 0; i < categoryList.count(); i++) {
@@ -407,7 +402,9 @@ void AIMLParser::parseCategory(QDomNode* categoryNode)
     leaf->that = thatNode.firstChild().toText().nodeValue();
     normalizeString(leaf->that);
   }
-  leaf->tmplate = categoryNode->namedItem("template");
+  QTextStream tmplateStream(&leaf->tmplate);
+  categoryNode->namedItem("template").save(tmplateStream, -1);
+  tmplateStream.flush();
   QDomNode parentNode = categoryNode->parentNode();
   if (!parentNode.isNull() && (parentNode.nodeName() == "topic")) {
     leaf->topic = parentNode.toElement().attribute("name");
@@ -429,6 +426,56 @@ void AIMLParser::parseCategory(QDomNode* categoryNode)
 }
 
 
+void AIMLParser::compile()
+{
+  if (!graphOutdated)
+    return;
+  graph.build(root);
+  root.clear();
+  templateCache.clear();
+  graphOutdated = false;
+}
+
+
+bool AIMLParser::loadCompiled(const QString& path, const QByteArray& stamp)
+{
+  if (!graph.load(path, stamp))
+    return false;
+  root.clear();
+  templateCache.clear();
+  graphOutdated = false;
+  return true;
+}
+
+
+bool AIMLParser::saveCompiled(const QString& path, const QByteArray& stamp)
+{
+  compile();
+  return graph.save(path, stamp);
+}
+
+
+QDomNode AIMLParser::templateNode(quint32 leaf)
+{
+  QHash<quint32, QDomNode>::const_iterator i = templateCache.constFind(leaf);
+  if (i != templateCache.constEnd())
+    return *i;
+
+  QDomDocument doc;
+  QXmlInputSource src;
+  src.setData(graph.templateXml(leaf));
+  QXmlSimpleReader reader;
+  reader.setFeature("http://trolltech.com/xml/features/report-whitespace-only-CharData", true);
+  QDomNode tmplate;
+  if (doc.setContent(&src, &reader))
+    tmplate = doc.documentElement();
+  else
+    *logStream << "Error while parsing template of pattern " + graph.pattern(leaf) + '\n';
+  templateCache.insert(leaf, tmplate);
+  return tmplate;
+}
+
+
 //recursively replace all the values & return the QString result
 QString AIMLParser::resolveNode(QDomNode* node, const QStringList &capturedTexts,
 const QStringList &capturedThatTexts, const QStringList &capturedTopicTexts)
@@ -570,11 +617,13 @@ QString AIMLParser::getResponse(QString input, const bool &srai)
   QString indentSpace = QString().fill(' ', 2*indent);
   *logStream << (!srai ? "\n" : "") + indentSpace + (srai ? "::SRAI: " : "::User Input: ") +
     input + '\n';
+  //categories learned while answering are available from the next input on
+  if (!srai)
+    compile();
   //perform substitutions for input string
-  QList<QRegExp>::Iterator itOld = subOld.begin();
-  QStringList::Iterator itNew = subNew.begin();
-  for (; itOld != subOld.end(); ++itOld, ++itNew )
-    input.replace(*itOld, *itNew);
+  for (int i = 0; i < subOld.count(); i++)
+    if (subLiteral[i].isEmpty() || input.contains(subLiteral[i]))
+      input.replace(subOld[i], subNew[i]);
   if (!srai) {
     inputList.prepend(input);
     if (inputList.count() > MAX_LIST_LENGTH)
@@ -584,38 +633,40 @@ QString AIMLParser::getResponse(QString input, const bool &srai)
   QStringList capturedTexts, capturedThatTexts, capturedTopicTexts;
   QString curTopic = parameterValue["topic"];
   normalizeString(curTopic);
-  Leaf *leaf = 0;
+  QString currentThat = thatList.count() && thatList[0].count() ? thatList[0][0] : QString("");
+  static const QRegExp sentenceSeparator("[\\.\\?!;\\x061f]");
+  QVector<quint32> inputWordIds;
+  quint32 leaf = 0;
   QString result("");
-  QStringList sentences = input.split(QRegExp("[\\.\\?!;\\x061f]"));
+  QStringList sentences = input.split(sentenceSeparator);
   QStringList::Iterator sentence = sentences.begin();
   while (true) {
     //normalizeString(*sentence);
     *sentence = (*sentence).toLower();
-    QStringList inputWords = sentence->split(' ');
-    QStringList::ConstIterator it = inputWords.constBegin();
-    if (!root.match(it, inputWords, thatList.count() && thatList[0].count() ?
-      thatList[0][0] : QString(""), curTopic, capturedThatTexts, capturedTopicTexts, leaf))
+    const QStringList inputWords = sentence->split(' ');
+    inputWordIds.clear();
+    foreach (const QString& word, inputWords)
+      inputWordIds << graph.wordId(word);
+    if (!graph.match(inputWordIds, currentThat, curTopic, capturedThatTexts, capturedTopicTexts, leaf))
       return "Internal Error!";
-    Node *parentNode = leaf->parent;
-    QString matchedPattern = parentNode->word;
-    while (parentNode->parent->parent) {
-      parentNode = parentNode->parent;
-      matchedPattern = parentNode->word + ' ' + matchedPattern;
-    }
+    QString matchedPattern = graph.pattern(leaf);
     *logStream << indentSpace + "::Matched pattern: [" + matchedPattern + ']';
-    if (!leaf->that.isEmpty())
-      *logStream << " - Matched that: [" + leaf->that + ']';
-    if (!leaf->topic.isEmpty())
-      *logStream << " - Matched topic: [" + leaf->topic + ']';
+    QString leafThat = graph.that(leaf);
+    if (!leafThat.isEmpty())
+      *logStream << " - Matched that: [" + leafThat + ']';
+    QString leafTopic = graph.topic(leaf);
+    if (!leafTopic.isEmpty())
+      *logStream << " - Matched topic: [" + leafTopic + ']';
     *logStream << "\n";
     capturedTexts.clear();
     exactMatch(matchedPattern, *sentence, capturedTexts);
     //strip whitespaces from the beginning and the end of result
-    if (visitedNodeList.contains(&leaf->tmplate))
+    if (visitedLeafList.contains(leaf))
       *logStream << "Infinite loop detected!";    //check why... result += "ProgramQ: Infinite loop detected!";
     else {
-      visitedNodeList.append(&leaf->tmplate);
-      result += resolveNode(&leaf->tmplate, capturedTexts, capturedThatTexts, capturedTopicTexts).trimmed();
+      visitedLeafList.append(leaf);
+      QDomNode tmplate = templateNode(leaf);
+      result += resolveNode(&tmplate, capturedTexts, capturedThatTexts, capturedTopicTexts).trimmed();
     }
     sentence++;
     if (sentence != sentences.end())
@@ -626,21 +677,16 @@ QString AIMLParser::getResponse(QString input, const bool &srai)
   if (!srai) {
     QString tempResult = result.simplified();
     //get the sentences of the result split by: . ? ! ; and "arabic ?"
-    QStringList thatSentencesList = tempResult.split(QRegExp("[\\.\\?!;\\x061f]"));
+    QStringList thatSentencesList = tempResult.split(sentenceSeparator);
     QStringList inversedList;
     for (QStringList::Iterator it = thatSentencesList.begin(); it != thatSentencesList.end(); ++it) {
-      //perform substitutions for that string
-      itOld = subOld.begin();
-      itNew = subNew.begin();
-      for (; itOld != subOld.end(); ++itOld, ++itNew )
-        tempResult.replace(*itOld, *itNew);
       normalizeString(*it);
       inversedList.prepend(*it);
     }
     thatList.prepend(inversedList);
     if (thatList.count() > MAX_LIST_LENGTH)
       thatList.pop_back();
-    visitedNodeList.clear();
+    visitedLeafList.clear();
   }
   //debug
   *logStream << indentSpace + "::Result: " + result + '\n';
@@ -21,12 +21,16 @@
 #include <QMap>
 
 #include <QList>
+#include <QHash>
+#include <QVector>
 
 #include <QStringList>
 #include <QTextStream>
 #include <QRegExp>
 #include <QDomNode>
 
+#include "aimlgraph.h"
+
 #define MAX_LIST_LENGTH 50
 
 /**
@@ -38,24 +42,30 @@ struct Node;
 struct Leaf
 {
   Node *parent;
-  QDomNode tmplate;
+  //the template element as xml; parsed when it is first used
+  QString tmplate;
   QString topic;
   QString that;
   Leaf();
 };
 
+/**
+ * Pattern tree; Only used while loading categories. Matching is done on the
+ * AIMLGraph compiled from it.
+ */
 struct Node
 {
   Node *parent;
   QString word;
   Node();
+  ~Node();
   QList<Node*> children;
   QList<Leaf*> leafs;
-  void debug(QTextStream* logStream, uint indent = 0);
-  bool match(QStringList::const_iterator, const QStringList&,
-    const QString&, const QString&, QStringList &, QStringList &, Leaf *&);
+  void clear();
 };
 
+bool exactMatch(QString regExp, QString str, QStringList &capturedText);
+
 class AIMLParser
 {
   public:
@@ -65,25 +75,39 @@ class AIMLParser
     bool loadSubstitutions(const QString&);
     bool loadVars(const QString&, const bool&);
     bool saveVars(const QString &);
+    /**
+     * Replaces all loaded categories with the given precompiled graph
+     * \param stamp Has to match the stamp given to saveCompiled()
+     */
+    bool loadCompiled(const QString& path, const QByteArray& stamp);
+    bool saveCompiled(const QString& path, const QByteArray& stamp);
     QString getResponse(QString, const bool &srai = false);
     void displayTree();
-    void runRegression();
+    void runRegression(const QString& directory = "utils");
   private:
     QString resolveNode(QDomNode*, const QStringList & = QStringList(),
       const QStringList & = QStringList(), const QStringList & = QStringList());
     void parseCategory(QDomNode*);
     void normalizeString(QString &);
     QString executeCommand(const QString&);
+    void compile();
+    QDomNode templateNode(quint32 leaf);
+    static QString substitutionLiteral(const QString&);
   private:
     QMap<QString, QString> parameterValue;
     QMap<QString, QString> botVarValue;
     QList<QRegExp> subOld;
     QStringList subNew;
+    //text every match of the corresponding subOld contains; empty if unknown
+    QStringList subLiteral;
     QStringList inputList;
     QList<QStringList> thatList;
     Node root;
+    AIMLGraph graph;
+    bool graphOutdated;
+    QHash<quint32, QDomNode> templateCache;
     int indent;
     QTextStream *logStream;
-    QList<QDomNode*> visitedNodeList;
+    QList<quint32> visitedLeafList;
 };
 #endif
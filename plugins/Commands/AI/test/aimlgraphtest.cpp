@@ -0,0 +1,347 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "aimlparser.h"
+
+#include <QTest>
+#include <QDir>
+#include <QFile>
+#include <QTime>
+#include <QDebug>
+#include <QDomDocument>
+#include <cstdlib>
+
+static const QString aimlFile = KDESRCDIR "../aimls/German/German-standalone.aiml";
+static const QString substitutionsFile = KDESRCDIR "../substitutions.xml";
+
+/**
+ * The matcher that walked the pattern tree before it was compiled into
+ * AIMLGraph
+ */
+static bool treeMatch(const Node *node, QStringList::const_iterator input, const QStringList &inputWords,
+                      const QString &currentThat, const QString &currentTopic, QStringList &capturedThatTexts,
+                      QStringList &capturedTopicTexts, Leaf *&leaf)
+{
+  if (input == inputWords.end())
+    return false;
+
+  if ((node->word == "*") || (node->word == "_")) {
+    ++input;
+    for (;input != inputWords.end(); input++) {
+      foreach (Node *child, node->children) {
+        if (treeMatch(child, input, inputWords, currentThat, currentTopic, capturedThatTexts,
+          capturedTopicTexts, leaf))
+          return true;
+      }
+    }
+  }
+  else {
+    if (!node->word.isEmpty()) {
+      if (node->word != *input)
+        return false;
+      ++input;
+    }
+    foreach (Node *child, node->children) {
+      if (treeMatch(child, input, inputWords, currentThat, currentTopic, capturedThatTexts,
+        capturedTopicTexts, leaf))
+        return true;
+    }
+  }
+  if (input == inputWords.end()) {
+    foreach (leaf, node->leafs) {
+      capturedThatTexts.clear();
+      capturedTopicTexts.clear();
+      if ( (!leaf->that.isEmpty() && !exactMatch(leaf->that, currentThat, capturedThatTexts)) ||
+        (!leaf->topic.isEmpty() && !exactMatch(leaf->topic, currentTopic, capturedTopicTexts)) )
+        continue;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static QString treePattern(const Leaf *leaf)
+{
+  Node *parentNode = leaf->parent;
+  QString matchedPattern = parentNode->word;
+  while (parentNode->parent->parent) {
+    parentNode = parentNode->parent;
+    matchedPattern = parentNode->word + ' ' + matchedPattern;
+  }
+  return matchedPattern;
+}
+
+//an input the given pattern accepts
+static QString fillWildcards(const QString& pattern)
+{
+  QStringList words = pattern.split(' ');
+  for (int i=0; i < words.count(); i++)
+    if ((words[i] == "*") || (words[i] == "_"))
+      words[i] = "xyzzy plugh";
+  return words.join(" ");
+}
+
+class testAIMLGraph: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testCompiled();
+    void testRejected();
+    void testLearn();
+    void testMatches();
+    void benchmarkParse();
+    void benchmarkLoadCompiled();
+    void benchmarkResponse();
+    void benchmarkRegression();
+
+  public:
+    testAIMLGraph() : log(0) {}
+
+  private:
+    QFile logFile;
+    QTextStream *log;
+    QString graphPath;
+    QByteArray stamp;
+    QStringList inputs;
+
+    AIMLParser* createParser();
+    void compareResponses(AIMLParser *expected, AIMLParser *actual);
+};
+
+void testAIMLGraph::initTestCase()
+{
+  logFile.setFileName(QDir::temp().filePath("simonaimlgraphtest.log"));
+  QVERIFY(logFile.open(QIODevice::WriteOnly));
+  log = new QTextStream(&logFile);
+  graphPath = QDir::temp().filePath("simonaimlgraphtest.graph");
+  stamp = "0123456789abcdef";
+
+  inputs << "Hallo" << "Wie geht es dir?" << "Bist du bloed" << "Das weiss ich nicht." <<
+            "Ich bin maennlich" << "Kennst du dich mit Mathematik aus" << "Wie waere es mit einem Kaffee" <<
+            "Danke, Schaetzchen!" << "Was ist statisch? Und was ist dynamisch?" << "Weisst du was ein Chat ist" <<
+            "Das habe ich dich gerade gefragt :-)" << "xyzzy plugh" << "" << "Mein Freund";
+}
+
+void testAIMLGraph::cleanupTestCase()
+{
+  QFile::remove(graphPath);
+  delete log;
+  logFile.close();
+  logFile.remove();
+}
+
+AIMLParser* testAIMLGraph::createParser()
+{
+  AIMLParser *parser = new AIMLParser(log);
+  parser->loadSubstitutions(substitutionsFile);
+  return parser;
+}
+
+void testAIMLGraph::compareResponses(AIMLParser *expected, AIMLParser *actual)
+{
+  //<random> templates: both parsers have to see the same sequence
+  foreach (const QString& input, inputs) {
+    srand(42);
+    QString expectedResponse = expected->getResponse(input);
+    srand(42);
+    QCOMPARE(actual->getResponse(input), expectedResponse);
+    QVERIFY(expectedResponse != "Internal Error!");
+  }
+}
+
+void testAIMLGraph::testCompiled()
+{
+  AIMLParser *parsed = createParser();
+  QVERIFY(parsed->loadAiml(aimlFile));
+  QVERIFY(parsed->saveCompiled(graphPath, stamp));
+
+  AIMLParser *compiled = createParser();
+  QVERIFY(compiled->loadCompiled(graphPath, stamp));
+  compareResponses(parsed, compiled);
+
+  delete compiled;
+  delete parsed;
+}
+
+void testAIMLGraph::testRejected()
+{
+  AIMLParser *parser = createParser();
+  QVERIFY(!parser->loadCompiled(graphPath, "fedcba9876543210"));
+  QVERIFY(!parser->loadCompiled(QDir::temp().filePath("simonaimlgraphtest-missing.graph"), stamp));
+
+  QString corruptPath = QDir::temp().filePath("simonaimlgraphtest-corrupt.graph");
+  QFile::remove(corruptPath);
+  QVERIFY(QFile::copy(graphPath, corruptPath));
+  QFile corrupt(corruptPath);
+  QVERIFY(corrupt.open(QIODevice::ReadWrite));
+  QVERIFY(corrupt.resize(corrupt.size() / 2));
+  corrupt.close();
+  QVERIFY(!parser->loadCompiled(corruptPath, stamp));
+  QFile::remove(corruptPath);
+
+  delete parser;
+}
+
+void testAIMLGraph::testLearn()
+{
+  //categories added on top of a loaded graph
+  AIMLParser *parsed = createParser();
+  QVERIFY(parsed->loadAiml(aimlFile));
+  QVERIFY(parsed->loadAiml(aimlFile));
+
+  AIMLParser *compiled = createParser();
+  QVERIFY(compiled->loadCompiled(graphPath, stamp));
+  QVERIFY(compiled->loadAiml(aimlFile));
+  compareResponses(parsed, compiled);
+
+  delete compiled;
+  delete parsed;
+}
+
+/**
+ * Compares the matches of the compiled graph with the ones the old tree
+ * matcher finds; thaw() recreates the tree the parser had built.
+ */
+void testAIMLGraph::testMatches()
+{
+  QString matchesPath = QDir::temp().filePath("simonaimlgraphtest-matches.graph");
+  AIMLParser *parser = createParser();
+  QVERIFY(parser->loadAiml(aimlFile));
+  QVERIFY(parser->saveCompiled(matchesPath, stamp));
+  delete parser;
+
+  {
+    AIMLGraph graph;
+    QVERIFY(graph.load(matchesPath, stamp));
+    Node root;
+    root.parent = 0;
+    graph.thaw(root);
+
+    //the inputs of the other tests, every fifth category and all that patterns
+    QList< QPair<QString, QString> > cases;
+    foreach (const QString& input, inputs)
+      foreach (const QString& sentence, input.split(QRegExp("[\\.\\?!;]")))
+        cases << qMakePair(sentence.toLower().simplified(), QString());
+    for (quint32 l=0; l < graph.leafCount(); l++)
+      if ((l % 5 == 0) || !graph.that(l).isEmpty())
+        cases << qMakePair(fillWildcards(graph.pattern(l)), fillWildcards(graph.that(l)));
+
+    for (int i=0; i < cases.count(); i++) {
+      const QStringList words = cases[i].first.split(' ');
+      const QString& that = cases[i].second;
+
+      QVector<quint32> wordIds;
+      foreach (const QString& word, words)
+        wordIds << graph.wordId(word);
+      QStringList graphThatTexts, graphTopicTexts;
+      quint32 graphLeaf = 0;
+      bool graphMatched = graph.match(wordIds, that, QString(), graphThatTexts, graphTopicTexts, graphLeaf);
+
+      QStringList treeThatTexts, treeTopicTexts;
+      Leaf *treeLeaf = 0;
+      bool treeMatched = treeMatch(&root, words.constBegin(), words, that, QString(),
+                                   treeThatTexts, treeTopicTexts, treeLeaf);
+
+      QCOMPARE(graphMatched, treeMatched);
+      if (!treeMatched)
+        continue;
+      QCOMPARE(graph.pattern(graphLeaf), treePattern(treeLeaf));
+      QCOMPARE(graph.that(graphLeaf), treeLeaf->that);
+      QCOMPARE(graph.topic(graphLeaf), treeLeaf->topic);
+      QCOMPARE(graph.templateXml(graphLeaf), treeLeaf->tmplate);
+      QCOMPARE(graphThatTexts, treeThatTexts);
+      QCOMPARE(graphTopicTexts, treeTopicTexts);
+    }
+  }
+  QFile::remove(matchesPath);
+}
+
+void testAIMLGraph::benchmarkParse()
+{
+  QBENCHMARK {
+    AIMLParser *parser = createParser();
+    parser->loadAiml(aimlFile);
+    parser->getResponse("Hallo");
+    delete parser;
+  }
+}
+
+void testAIMLGraph::benchmarkLoadCompiled()
+{
+  QBENCHMARK {
+    AIMLParser *parser = createParser();
+    parser->loadCompiled(graphPath, stamp);
+    parser->getResponse("Hallo");
+    delete parser;
+  }
+}
+
+void testAIMLGraph::benchmarkResponse()
+{
+  AIMLParser *parser = createParser();
+  QVERIFY(parser->loadCompiled(graphPath, stamp));
+  QBENCHMARK {
+    foreach (const QString& input, inputs)
+      parser->getResponse(input);
+  }
+  delete parser;
+}
+
+/**
+ * Runs an AIML regression suite (TestSuite.aiml / TestSuite.xml as used by
+ * AIMLParser::runRegression()) on top of the German set and reports the
+ * throughput.
+ *
+ * Set SIMON_BENCHMARK_AIML_REGRESSION to the folder containing the suite to
+ * run it.
+ */
+void testAIMLGraph::benchmarkRegression()
+{
+  QString directory = QString::fromLocal8Bit(qgetenv("SIMON_BENCHMARK_AIML_REGRESSION"));
+  if (directory.isEmpty())
+    QSKIP("SIMON_BENCHMARK_AIML_REGRESSION not set", SkipSingle);
+
+  QFile suite(directory+"/TestSuite.xml");
+  QDomDocument doc;
+  QVERIFY(suite.open(QIODevice::ReadOnly));
+  QVERIFY(doc.setContent(&suite));
+  int testCases = doc.documentElement().elementsByTagName("TestCase").count();
+
+  AIMLParser *parser = createParser();
+  QVERIFY(parser->loadCompiled(graphPath, stamp));
+  int elapsed = 0;
+  QBENCHMARK_ONCE {
+    QTime timer;
+    timer.start();
+    parser->runRegression(directory);
+    elapsed = timer.elapsed();
+  }
+  delete parser;
+
+  qDebug() << testCases << "test cases in" << elapsed << "ms:"
+           << (testCases * 1000.0 / qMax(elapsed, 1)) << "test cases per second";
+}
+
+QTEST_MAIN(testAIMLGraph)
+
+#include "aimlgraphtest.moc"
@@ -25,6 +25,7 @@
 #include <QDBusVariant>
 #include <QDBusArgument>
 #include <QTimer>
+#include <QSet>
 #include <QVector>
 
 #include <KLocalizedString>
@@ -129,13 +130,11 @@ void ATSPICommandManager::schedulingTimeout()
 void ATSPICommandManager::setupLanguageModel(const QStringList& commands, bool reset)
 {
   m_shouldReset = false;
-  QStringList newCommands = commands;
-
-  QStringList commandsToRemove = m_lastCommands;
-  foreach (const QString& c, m_lastCommands) {
-    if (newCommands.removeAll(c) != 0)
-      commandsToRemove.removeAll(c);
-  }
+  QSet<QString> requestedCommands = commands.toSet();
+  QSet<QString> lastCommands = m_lastCommands.toSet();
+  QStringList newCommands = (requestedCommands - lastCommands).toList();
+  QStringList commandsToRemove = (lastCommands - requestedCommands).toList();
+  newCommands.sort();
 
   if (newCommands.isEmpty() && commandsToRemove.isEmpty())
     return;
@@ -19,11 +19,13 @@
 
 #include "atspiscanner.h"
 #include <QThread>
+#include <QTimer>
 #include <QMutexLocker>
 #include <KDebug>
 
 ATSPIScanner::ATSPIScanner() : m_abort(false),
-  m_thread(new QThread()), m_registry(0), m_cleanStringRegExp(QRegExp("[^\\w ]"))
+  m_thread(new QThread()), m_registry(0), m_cleanStringRegExp(QRegExp("[^\\w ]")),
+  m_commandsShownTimer(0), m_resetPending(false)
 {
   moveToThread(m_thread);
   connect(m_thread, SIGNAL(started()), this, SLOT(initialize()));
@@ -32,6 +34,11 @@ ATSPIScanner::ATSPIScanner() : m_abort(false),
 
 void ATSPIScanner::initialize()
 {
+  m_commandsShownTimer = new QTimer(this);
+  m_commandsShownTimer->setSingleShot(true);
+  m_commandsShownTimer->setInterval(0);
+  connect(m_commandsShownTimer, SIGNAL(timeout()), this, SLOT(emitCommandsShown()));
+
   m_registry = new QAccessibleClient::Registry(this);
   m_registry->applications(); // FIXME: KDE bug: 307264
 
@@ -63,7 +70,7 @@ void ATSPIScanner::clearATModel()
   m_modelMutex.lock();
   m_actions.clear();
   kDebug() << "Clearing tracked objects";
-  m_reverseActions.clear();
+  m_tree.clear();
   m_abort = false;
   m_modelMutex.unlock();
 }
@@ -78,91 +85,140 @@ QVector<QSharedPointer<QAction> > ATSPIScanner::getActions(const QString& trigge
   return object.actions();
 }
 
+QList<QAccessibleClient::AccessibleObject> ATSPIScanner::children(const QAccessibleClient::AccessibleObject &object, bool reset)
+{
+  if (!reset) {
+    QMutexLocker l(&m_modelMutex);
+    QHash<QAccessibleClient::AccessibleObject, MirroredObject>::const_iterator i = m_tree.constFind(object);
+    if (i != m_tree.constEnd())
+      return i->children;
+  }
+  return object.children(); //poll from dbus
+}
+
+/**
+ * Adds the given (visible) object to the mirror; Only queries the
+ * application for objects that aren't mirrored yet
+ */
+void ATSPIScanner::track(const QAccessibleClient::AccessibleObject &object, const QList<QAccessibleClient::AccessibleObject>& children)
+{
+  m_modelMutex.lock();
+  QHash<QAccessibleClient::AccessibleObject, MirroredObject>::iterator i = m_tree.find(object);
+  if (i != m_tree.end()) {
+    i->children = children;
+    m_modelMutex.unlock();
+    return;
+  }
+  m_modelMutex.unlock();
+
+  MirroredObject mirrored;
+  mirrored.children = children;
+  QString cleanName = cleanString(object.name());
+  if (!cleanName.isEmpty() && !object.actions().isEmpty()) {
+    kDebug() << "Triggerable: " << cleanName;
+    mirrored.name = cleanName;
+  }
+
+  QMutexLocker l(&m_modelMutex);
+  if (m_abort || m_tree.contains(object))
+    return;
+  m_tree.insert(object, mirrored);
+  if (!mirrored.name.isEmpty())
+    m_actions.insertMulti(mirrored.name, object);
+}
+
+/**
+ * Removes the given object and everything below it from the mirror
+ */
+void ATSPIScanner::untrack(const QAccessibleClient::AccessibleObject &object)
+{
+  QList<QAccessibleClient::AccessibleObject> objectsToRemove;
+  objectsToRemove << object;
+
+  QMutexLocker l(&m_modelMutex);
+  while (!objectsToRemove.isEmpty()) {
+    QHash<QAccessibleClient::AccessibleObject, MirroredObject>::iterator i = m_tree.find(objectsToRemove.takeFirst());
+    if (i == m_tree.end())
+      continue;
+    if (!i->name.isEmpty())
+      removeAction(i->name, i.key());
+    objectsToRemove << i->children;
+    m_tree.erase(i);
+  }
+}
+
 void ATSPIScanner::processTree(const QAccessibleClient::AccessibleObject &object, bool added, bool reset)
 {
-  kDebug() << "Entering processTree" << object << added << reset;
-  qDebug() << "Entering processTree" << object << "added=" << added << "reset=" << reset;
-  QStringList alreadyParsed;
+  kDebug() << "Entering processTree" << object.id() << added << reset;
+  if (!added) {
+    untrack(object);
+    scheduleCommandsShown(reset);
+    return;
+  }
+
+  QSet<QString> alreadyParsed;
   QList<QAccessibleClient::AccessibleObject> objectsToParse;
   objectsToParse.append(object);
 
-  // in case this is called from a recently hidden object, this objects visibility will be false
-  // but we still want to remove all visible children from the AT model. So force re-evaluation
-  // of the objects children
-  if (reset || !m_reverseActions.contains(object)) {
-    objectsToParse.append(object.children()); //poll from dbus
-  } else {
-    qDebug() << "Pulling direct children from cache...";
-    objectsToParse.append(m_reverseActions.value(object).second);
-  }
+  // the visibility of the object that triggered this might not be up to date yet;
+  // always evaluate its children
+  objectsToParse.append(children(object, reset));
 
   while (!objectsToParse.isEmpty()) {
-    const QAccessibleClient::AccessibleObject& o  = objectsToParse.takeFirst();
-    //kDebug() << "Object " << o.name() << " is visible: " << o.isVisible() << " id: " << o.id();
-    qDebug() << "Object " << o.name() << " is visible: " << o.isVisible() << " id: " << o.id() << " role: " << o.roleName();
+    if (m_abort)
+      return;
 
-    if (alreadyParsed.contains(o.id()))
+    const QAccessibleClient::AccessibleObject o = objectsToParse.takeFirst();
+    QString id = o.id();
+    if (alreadyParsed.contains(id))
       continue;
-    alreadyParsed << o.id();
+    alreadyParsed.insert(id);
 
-    if (added && !o.isVisible())
+    //only visible objects are mirrored; ask the application about the others
+    bool mirrored;
+    {
+      QMutexLocker l(&m_modelMutex);
+      mirrored = m_tree.contains(o);
+    }
+    if (!mirrored && !o.isVisible())
       continue;
 
-    QList<QAccessibleClient::AccessibleObject> children;
-    if (reset || !m_reverseActions.contains(o)) {
-      children = o.children(); //poll from dbus
-    } else {
-      qDebug() << "Pulling children from cache";
-      children = m_reverseActions.value(o).second;
-    }
-    qDebug() << children.count() << " children";
-
-    QString cleanName;
-    if (added) {
-      cleanName = cleanString(o.name());
-      if (!cleanName.isEmpty() && !o.actions().isEmpty()) {
-        kDebug() << "========== Triggerable: " << cleanName;
-
-        m_modelMutex.lock();
-        if (m_abort) {
-	  qDebug() << "Aborting";
-          m_modelMutex.unlock();
-          return;
-        }
-        if (added) {
-          if (!m_reverseActions.contains(o)) {
-	    kDebug() << "Tracking: " << cleanName << o.id();
-            m_actions.insertMulti(cleanName, o);
-            m_reverseActions.insert(o, qMakePair(cleanName, children));
-          }
-        }
-        m_modelMutex.unlock();
-      }
-    } else {
-      qDebug() << "Removing " << cleanName << o.isValid();
-      m_modelMutex.lock();
-      if (m_reverseActions.contains(o)) {
-	//get cleanName from cache
-        cleanName = m_reverseActions.value(o).first;
-        removeAction(cleanName, o);
-        m_reverseActions.remove(o);
-      }
-      m_modelMutex.unlock();
-    }
+    QList<QAccessibleClient::AccessibleObject> objectChildren = children(o, reset);
+    track(o, objectChildren);
 
     //add children to the list to parse
-    objectsToParse.append(children);
+    objectsToParse.append(objectChildren);
   }
 
-  QMutexLocker l(&m_modelMutex);
-  qDebug() << "processTree(): Emitting commandsShown()" << m_actions.keys();
-  kDebug() << "Emitting commands shown" << m_actions.keys();
-  emit commandsShown(m_actions.keys(), reset);
+  scheduleCommandsShown(reset);
+}
+
+void ATSPIScanner::scheduleCommandsShown(bool reset)
+{
+  m_resetPending |= reset;
+  m_commandsShownTimer->start();
+}
+
+void ATSPIScanner::emitCommandsShown()
+{
+  QStringList commands;
+  {
+    QMutexLocker l(&m_modelMutex);
+    commands = m_actions.uniqueKeys();
+  }
+  commands.sort();
+  if (!m_resetPending && (commands == m_lastCommands))
+    return;
+
+  kDebug() << "Emitting commands shown" << commands;
+  bool reset = m_resetPending;
+  m_resetPending = false;
+  m_lastCommands = commands;
+  emit commandsShown(commands, reset);
 }
 
 void ATSPIScanner::windowActivated(const QAccessibleClient::AccessibleObject& object)
 {
-  qDebug() << "Window activated: " << object.name() << object.childCount();
   clearATModel();
   kDebug() << "Window activated: " << object.name() << object.childCount();
 
@@ -172,25 +228,21 @@ void ATSPIScanner::windowActivated(const QAccessibleClient::AccessibleObject& ob
 
 void ATSPIScanner::added(const QAccessibleClient::AccessibleObject &object)
 {
-  kDebug() << "Object added: " << object.id() << object.roleName();
+  kDebug() << "Object added: " << object.id();
 }
 
 void ATSPIScanner::stateChanged (const QAccessibleClient::AccessibleObject &object, const QString& state, bool active)
 {
-  qDebug() << "State changed: " << object.id() << object.roleName() << state << active;
-  kDebug() << "State changed: " << object.id() << state << active;
   if (state != "showing")
     return;
+  kDebug() << "State changed: " << object.id() << state << active;
 
   if (!active) {
-    m_modelMutex.lock();
-    if (!m_reverseActions.contains(object)) {
-      kDebug() << "Untracked object changed: " << object.name() << object.id();
-      qDebug() << "Untracked object changed: " << object.name() << object.id();
-      m_modelMutex.unlock();
+    QMutexLocker l(&m_modelMutex);
+    if (!m_tree.contains(object)) {
+      kDebug() << "Untracked object changed: " << object.id();
       return;
     }
-    m_modelMutex.unlock();
   }
 
   processTree(object, active, false);
@@ -206,47 +258,95 @@ void ATSPIScanner::removeAction(const QString& name, const QAccessibleClient::Ac
 {
   kDebug() << "Removing action " << name << o.id();
   QHash<QString,QAccessibleClient::AccessibleObject>::iterator i = m_actions.find(name);
-  while (i != m_actions.end()) {
-    if (*i == o) {
-      m_actions.erase(i);
-      i = m_actions.find(name);
-    } else
+  while ((i != m_actions.end()) && (i.key() == name)) {
+    if (*i == o)
+      i = m_actions.erase(i);
+    else
       ++i;
   }
 }
 
 void ATSPIScanner::nameChanged(const QAccessibleClient::AccessibleObject& object)
 {
-  qDebug() << "nameChanged()";
-  QMutexLocker l(&m_modelMutex);
-  if (!m_reverseActions.contains(object)) {
-    //kDebug() << "Untracked object changed its name: " << object.name() << object.id();
-    qDebug() << "Untracked object changed its name: " << object.name() << object.id();
-    return;
+  QString oldName;
+  {
+    QMutexLocker l(&m_modelMutex);
+    QHash<QAccessibleClient::AccessibleObject, MirroredObject>::const_iterator i = m_tree.constFind(object);
+    if (i == m_tree.constEnd()) {
+      kDebug() << "Untracked object changed its name: " << object.id();
+      return;
+    }
+    oldName = i->name;
   }
 
   QString cleanName = cleanString(object.name());
-  qDebug() << "Name changed: " << cleanName;
-  //kDebug() << "Name changed: " << cleanName;
+  kDebug() << "Name changed: " << cleanName;
+  //objects that had no name might not have had their actions checked yet
+  if (!cleanName.isEmpty() && oldName.isEmpty() && object.actions().isEmpty())
+    cleanName.clear();
 
-  QPair<QString, QList<QAccessibleClient::AccessibleObject> > oldValue = m_reverseActions.value(object);
-  m_reverseActions.insert(object, qMakePair(cleanName, oldValue.second)); // replace
+  QMutexLocker l(&m_modelMutex);
+  QHash<QAccessibleClient::AccessibleObject, MirroredObject>::iterator i = m_tree.find(object);
+  if (i == m_tree.end() || (i->name == cleanName))
+    return;
 
-  QString oldName = oldValue.first;
-  removeAction(oldName, object);
-  m_actions.insert(cleanName, object);
+  if (!i->name.isEmpty())
+    removeAction(i->name, object);
+  i->name = cleanName;
+  if (!cleanName.isEmpty())
+    m_actions.insertMulti(cleanName, object);
+  l.unlock();
 
-  qDebug() << "nameChanged(): " << cleanName << " Emitting commandsShown()" << m_actions.keys();
-  emit commandsShown(m_actions.keys(), false);
+  scheduleCommandsShown(false);
 }
 
 void ATSPIScanner::childAdded(const QAccessibleClient::AccessibleObject &parent, int index)
 {
-  qDebug() << "Child added to " << parent.name();
+  {
+    QMutexLocker l(&m_modelMutex);
+    if (!m_tree.contains(parent))
+      return;
+  }
+  kDebug() << "Child added to " << parent.id() << index;
+
+  //the parent's list of children has to be refreshed anyway
+  QList<QAccessibleClient::AccessibleObject> parentChildren = parent.children();
+  {
+    QMutexLocker l(&m_modelMutex);
+    QHash<QAccessibleClient::AccessibleObject, MirroredObject>::iterator i = m_tree.find(parent);
+    if (i == m_tree.end())
+      return;
+    i->children = parentChildren;
+  }
+  if ((index >= 0) && (index < parentChildren.count()))
+    processTree(parentChildren.at(index), true, false);
 }
+
 void ATSPIScanner::childRemoved(const QAccessibleClient::AccessibleObject &parent, int index)
 {
-  qDebug() << "Child removed from " << parent.name();
+  QList<QAccessibleClient::AccessibleObject> removed;
+  bool outOfSync = false;
+  {
+    QMutexLocker l(&m_modelMutex);
+    QHash<QAccessibleClient::AccessibleObject, MirroredObject>::iterator i = m_tree.find(parent);
+    if (i == m_tree.end())
+      return;
+    kDebug() << "Child removed from " << parent.id() << index;
+    if ((index >= 0) && (index < i->children.count()))
+      removed << i->children.takeAt(index);
+    else
+      outOfSync = true;
+  }
+
+  if (outOfSync) {
+    //rebuild the parent from scratch
+    untrack(parent);
+    processTree(parent, true, false);
+    return;
+  }
+  foreach (const QAccessibleClient::AccessibleObject& o, removed)
+    untrack(o);
+  scheduleCommandsShown(false);
 }
 
 inline QString ATSPIScanner::cleanString(const QString& input)
@@ -256,4 +356,3 @@ inline QString ATSPIScanner::cleanString(const QString& input)
   out.remove('_');
   return out;
 }
-
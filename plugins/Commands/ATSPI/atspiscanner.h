@@ -24,11 +24,14 @@
 #include <qaccessibilityclient/registry.h>
 
 #include <QList>
+#include <QSet>
 #include <QMutex>
 #include <QRegExp>
 #include <QObject>
+#include <QStringList>
 
 class QThread;
+class QTimer;
 
 class ATSPIScanner : public QObject
 {
@@ -55,21 +58,38 @@ private slots:
   void childRemoved(const QAccessibleClient::AccessibleObject &parent, int index);
 
   void initialize();
+  void emitCommandsShown();
 
 private:
+  /**
+   * Local copy of a visible object; Avoids asking the application (over
+   * D-Bus) again on every update
+   */
+  struct MirroredObject {
+    QString name;                                            //!< trigger; empty if the object isn't triggerable
+    QList<QAccessibleClient::AccessibleObject> children;
+  };
+
   bool m_abort;
   QMutex m_modelMutex;
   QThread *m_thread;
   QAccessibleClient::Registry *m_registry;
   QRegExp m_cleanStringRegExp;
   QHash<QString /* name (trigger) */, QAccessibleClient::AccessibleObject /* object */> m_actions;
-  QHash<QAccessibleClient::AccessibleObject /* object */,
-        QPair<QString /* name (trigger) */, QList<QAccessibleClient::AccessibleObject> /* children */> > m_reverseActions;
 
-  //Additionally, store the original object hierarchy to avoid querying it on every update
+  /// Mirror of all visible objects of the active window
+  QHash<QAccessibleClient::AccessibleObject, MirroredObject> m_tree;
 
+  /// Coalesces the changes of one batch of events into one commandsShown()
+  QTimer *m_commandsShownTimer;
+  bool m_resetPending;
+  QStringList m_lastCommands;
 
   void processTree(const QAccessibleClient::AccessibleObject &object, bool added, bool reset);
+  QList<QAccessibleClient::AccessibleObject> children(const QAccessibleClient::AccessibleObject &object, bool reset);
+  void track(const QAccessibleClient::AccessibleObject &object, const QList<QAccessibleClient::AccessibleObject>& children);
+  void untrack(const QAccessibleClient::AccessibleObject &object);
+  void scheduleCommandsShown(bool reset);
   void removeAction(const QString& name, const QAccessibleClient::AccessibleObject& o);
 
   inline QString cleanString(const QString& input);
@@ -28,7 +28,7 @@
 #include <QMenuBar>
 #include <QDebug>
 
-AccessibleApp::AccessibleApp() : btn(0), msg(0)
+AccessibleApp::AccessibleApp() : btn(0), secondBtn(0), msg(0)
 {
   show();
   menuBar();
@@ -73,6 +73,18 @@ void AccessibleApp::showButton()
   btn->show();
 }
 
+void AccessibleApp::addButton()
+{
+  secondBtn = new QPushButton("Second Button", centralWidget());
+  secondBtn->move(0, btn->height());
+  secondBtn->show();
+}
+void AccessibleApp::removeButton()
+{
+  delete secondBtn;
+  secondBtn = 0;
+}
+
 void AccessibleApp::setupMenu()
 {
   QMenu *fileMenu = new QMenu("File", this);
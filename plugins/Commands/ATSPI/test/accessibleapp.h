@@ -34,6 +34,8 @@ public:
   void changeButtonText();
   void showButton();
   void hideButton();
+  void addButton();
+  void removeButton();
   void setupMenu();
   void setupBuddy();
   void setupDialog();
@@ -42,6 +44,7 @@ public:
 
 private:
   QPushButton *btn;
+  QPushButton *secondBtn;
   QMessageBox *msg;
   void setUI(QWidget *w);
 };
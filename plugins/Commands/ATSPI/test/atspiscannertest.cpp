@@ -35,6 +35,7 @@ class testATSPIScanner: public QObject
 private slots:
   void initTestCase();
   void testGeneral();
+  void testChildren();
   void testMenu();
   void testBuddy();
   void testDialog();
@@ -112,6 +113,19 @@ void testATSPIScanner::testGeneral()
   QCOMPARE(currentCommands(), QStringList());
 }
 
+void testATSPIScanner::testChildren()
+{
+  blockingInvoke(&AccessibleApp::setupSingleButton, 1);
+  QCOMPARE(currentCommands(), QStringList() << QLatin1String("Testbutton"));
+  blockingInvoke(&AccessibleApp::addButton, 1);
+  QCOMPARE(currentCommands(), QStringList() << QLatin1String("Second Button") << QLatin1String("Testbutton"));
+  blockingInvoke(&AccessibleApp::removeButton, 1);
+  QCOMPARE(currentCommands(), QStringList() << QLatin1String("Testbutton"));
+
+  blockingInvoke(&AccessibleApp::clear, 1);
+  QCOMPARE(currentCommands(), QStringList());
+}
+
 
 void testATSPIScanner::testMenu()
 {
@@ -98,7 +98,7 @@ void LanguageProfileView::createProfile()
 
   //prepare sphinx dict
   if (!ScenarioManager::getInstance()->getShadowVocabulary()->
-    exportToFile(KStandardDirs::locateLocal("tmp", "simon/sequitur/train.lex"), Vocabulary::SPHINX)) {
+    exportToFile(GraphemeToPhoneme::trainingLexiconPath(), Vocabulary::SPHINX)) {
     KMessageBox::sorry(this, i18n("Could not export current shadow dictionary to file for further processing."));
     return;
   }
@@ -36,6 +36,7 @@
  */
 BOMPDict::BOMPDict(QObject* parent): Dict(parent)
 {
+  pronunciationFormat = SegmentedSampa;
 }
 
 
@@ -84,7 +85,6 @@ void BOMPDict::load(QString path, QString encodingName)
   QString xspFertig;
   QString currentPhoneme;
   QString currentCategory;
-  QString currentFinalXsp;
   QString currentWord;
   while (!line.isNull()) {
     wordend = line.indexOf("\t");
@@ -96,7 +96,6 @@ void BOMPDict::load(QString path, QString encodingName)
     xsp.remove('\'');
     xsp.remove('|');
     xsp.remove(',');
-    currentFinalXsp = segmentSampa(adaptToSimonPhonemeSet(xsp));
 
     currentWord = line.left(wordend);
     currentCategory = line.mid(wordend,
@@ -112,18 +111,14 @@ void BOMPDict::load(QString path, QString encodingName)
 
     QString currentCategoryStr = currentCategories[0];
     currentCategoriesUnique << currentCategoryStr;
-    words << currentWord;
-    categories << currentCategoryStr;
-    pronunciations << currentFinalXsp;
+    addEntry(currentWord, xsp, currentCategoryStr);
 
     for (int k=1; k < currentCategories.count(); k++) {
       currentCategoryStr = currentCategories[k];
       if (!currentCategoriesUnique.contains(currentCategoryStr)) {
         currentCategoriesUnique << currentCategoryStr;
 
-        words << currentWord;
-        categories << currentCategoryStr;
-        pronunciations << currentFinalXsp;
+        addEntry(currentWord, xsp, currentCategoryStr);
       }
     }
 
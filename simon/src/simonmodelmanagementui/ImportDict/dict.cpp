@@ -18,15 +18,94 @@
  */
 
 #include "dict.h"
+#include <simonscenarios/word.h>
 #include <QFile>
+#include <QVector>
+#include <QPair>
+#include <QtConcurrentRun>
+#include <QtConcurrentMap>
 #include <KStandardDirs>
 #include <KDebug>
+#include <algorithm>
+#include <iterator>
+
+//entries handed to a worker at once
+static const int chunkSize = 4096;
+
+/**
+ * Prefix tree of the allowed phonemes; Finds the longest phoneme at a
+ * position of a pronunciation in a single pass.
+ */
+class Dict::PhonemeTrie
+{
+  private:
+    struct Node
+    {
+      Node() : terminal(false) {}
+      QHash<QChar, int> children;
+      bool terminal;
+    };
+    QVector<Node> nodes;
+
+  public:
+    PhonemeTrie() : nodes(1) {}
+
+    void insert(const QString& phoneme)
+    {
+      int node = 0;
+      for (int i=0; i < phoneme.count(); i++) {
+        int next = nodes[node].children.value(phoneme[i], -1);
+        if (next == -1) {
+          next = nodes.count();
+          nodes[node].children.insert(phoneme[i], next);
+          nodes.append(Node());
+        }
+        node = next;
+      }
+      nodes[node].terminal = true;
+    }
+
+    /**
+     * \return Length of the longest phoneme starting at the given position;
+     *         0 if there is none
+     */
+    int longestMatch(const QString& text, int position) const
+    {
+      int node = 0;
+      int longest = 0;
+      for (int i=position; i < text.count(); i++) {
+        node = nodes[node].children.value(text[i], -1);
+        if (node == -1)
+          break;
+        if (nodes[node].terminal)
+          longest = i - position + 1;
+      }
+      return longest;
+    }
+};
+
+typedef QPair< QList<Word*>, QList<Word*> > WordListPair;
+
+struct SortedMerger
+{
+  typedef QList<Word*> result_type;
+  QList<Word*> operator()(const WordListPair& lists) const {
+    QList<Word*> merged;
+    merged.reserve(lists.first.count() + lists.second.count());
+    std::merge(lists.first.begin(), lists.first.end(), lists.second.begin(), lists.second.end(),
+               std::back_inserter(merged), isWordLessThan);
+    return merged;
+  }
+};
+
 
 /**
  * \brief Constructor
  * \author Peter Grasch
  */
-Dict::Dict(QObject *parent) : QObject(parent)
+Dict::Dict(QObject *parent) : QObject(parent),
+  pronunciationFormat(SimonPhonemes),
+  allowedPhonemes(new PhonemeTrie)
 {
   buildAllowedPhonemes();
 }
@@ -283,76 +362,65 @@ void Dict::buildAllowedPhonemes()
   if (!phon.open(QIODevice::ReadOnly))
     return;
 
-  QStringList phonemes;
-  //sorting per phoneme length...
   while (!phon.atEnd()) {
-    phonemes << phon.readLine(50).trimmed();      //read phonemes linewise
+    QString phoneme = phon.readLine(50).trimmed(); //read phonemes linewise
+    if (!phoneme.isEmpty())
+      allowedPhonemes->insert(phoneme);
   }
   phon.close();
-
-  int max =0;
-  //find max
-  for (int i=0; i < phonemes.count(); i++) {
-    max = qMax(phonemes[i].count(), max);
-  }
-  int index;
-  while (max > 0) {
-    index=0;
-    while (index < phonemes.count()) {
-      if (phonemes[index].count() == max)
-        allowedPhonemes << phonemes.takeAt(index);
-      else index++;
-    }
-    --max;
-  }
 }
 
 
-QString Dict::adaptToSimonPhonemeSet(QString sampa)
+QString Dict::adaptToSimonPhonemeSet(const QString& sampa) const
 {
-  QString out = sampa.replace('6', "ah");
-  out = out.replace('2', "oeh");
-  out = out.replace('3', "three");
-  out = out.replace('%', "perc");
-  //out = out.remove('~');
-  //out = out.remove('<');
-  out = out.replace('~', "nas");
-  out = out.replace('<', "nsb");
-  out = out.replace('{', "ocurly");
-  out = out.replace('/', "ccurly");
-  out = out.remove('_');
-  out = out.remove('^');
-  //	out = out.remove('?');
-  out = out.replace('?', "gls");
-  out = out.replace('9', "oe");
+  //one pass; none of the replacements contains a character that is replaced itself
+  QString out;
+  out.reserve(sampa.count() + 8);
+  for (int i=0; i < sampa.count(); i++) {
+    switch (sampa[i].unicode()) {
+      case '6': out += QLatin1String("ah"); break;
+      case '2': out += QLatin1String("oeh"); break;
+      case '3': out += QLatin1String("three"); break;
+      case '%': out += QLatin1String("perc"); break;
+      case '~': out += QLatin1String("nas"); break;
+      case '<': out += QLatin1String("nsb"); break;
+      case '{': out += QLatin1String("ocurly"); break;
+      case '/': out += QLatin1String("ccurly"); break;
+      case '_':
+      case '^': break;
+      case '?': out += QLatin1String("gls"); break;
+      case '9': out += QLatin1String("oe"); break;
+      default: out += sampa[i];
+    }
+  }
   return out;
 }
 
 
-QString Dict::segmentSampa(const QString& sampa)
+/**
+ * \brief Splits the given sampa string into phonemes (separated by spaces)
+ *
+ * Always takes the longest allowed phoneme; Returns the input unchanged if
+ * it can not be split completely.
+ */
+QString Dict::segmentSampa(const QString& sampa) const
 {
-  QString filteredXsp = sampa;
-  //filter xsp through 'sampa sieve'
-  int phonemeIndex=0;
-  QString currentPhoneme = "";
-  QString xspFertig = "";
-
-  while ((!filteredXsp.isEmpty()) && (allowedPhonemes.count() > phonemeIndex)) {
-    currentPhoneme = allowedPhonemes[phonemeIndex++];
-    if (filteredXsp.indexOf(currentPhoneme)==0) {
-      xspFertig += ' '+currentPhoneme;
-                                                  //remove phoneme at start
-      filteredXsp.remove(0, currentPhoneme.count());
-      phonemeIndex=0;
-    }
-  }
+  QString segmented;
+  segmented.reserve(sampa.count() * 2);
 
-  if (filteredXsp.isEmpty()) {                    //found everything
-    return xspFertig.trimmed();
+  int position = 0;
+  while (position < sampa.count()) {
+    int length = allowedPhonemes->longestMatch(sampa, position);
+    if (length == 0) {
+      kDebug() << "Couldn't segment: " << sampa.mid(position) << sampa;
+      return sampa;
+    }
+    if (position > 0)
+      segmented += ' ';
+    segmented.append(sampa.midRef(position, length));
+    position += length;
   }
-
-  kDebug() << "Couldn't segment: " << filteredXsp << sampa;
-  return sampa;
+  return segmented;
 }
 
 
@@ -368,7 +436,7 @@ QString Dict::segmentSampa(const QString& sampa)
  * \return QString
  * The X-Sampa String
  */
-QString Dict::ipaToXSampa(QString ipa)
+QString Dict::ipaToXSampa(const QString& ipa) const
 {
   QString out;
   for (int i=0; i < ipa.count(); i++) {
@@ -380,15 +448,102 @@ QString Dict::ipaToXSampa(QString ipa)
 }
 
 
+QString Dict::processPronunciation(const QString& pronunciation) const
+{
+  switch (pronunciationFormat) {
+    case Sampa:
+      return adaptToSimonPhonemeSet(pronunciation);
+    case SegmentedSampa:
+      return segmentSampa(adaptToSimonPhonemeSet(pronunciation));
+    case IPA:
+      return adaptToSimonPhonemeSet(ipaToXSampa(pronunciation));
+    case SimonPhonemes:
+      break;
+  }
+  return pronunciation;
+}
+
+
+/**
+ * \brief Queues the given entry
+ *
+ * Full chunks are processed on the global thread pool.
+ */
+void Dict::addEntry(const QString& word, const QString& pronunciation, const QString& category)
+{
+  Entry entry;
+  entry.word = word;
+  entry.pronunciation = pronunciation;
+  entry.category = category;
+  currentChunk << entry;
+
+  if (currentChunk.count() == chunkSize)
+    flushChunk();
+}
+
+
+void Dict::flushChunk()
+{
+  if (currentChunk.isEmpty())
+    return;
+  processedChunks << QtConcurrent::run(this, &Dict::processChunk, currentChunk);
+  currentChunk.clear();
+}
+
+
+/**
+ * Runs on a worker thread; Must only read members that don't change
+ * while loading.
+ */
+QList<Word*> Dict::processChunk(const QList<Entry>& chunk) const
+{
+  QList<Word*> words;
+  words.reserve(chunk.count());
+  foreach (const Entry& entry, chunk)
+    words << new Word(entry.word, processPronunciation(entry.pronunciation), entry.category);
+  qSort(words.begin(), words.end(), isWordLessThan);
+  return words;
+}
+
+
+QList<Word*> Dict::takeWords()
+{
+  flushChunk();
+
+  QList< QList<Word*> > chunks;
+  for (int i=0; i < processedChunks.count(); i++)
+    chunks << processedChunks[i].result();
+  processedChunks.clear();
+
+  //merge neighbouring chunks in parallel until only one is left
+  while (chunks.count() > 1) {
+    QList<WordListPair> pairs;
+    for (int i=0; i+1 < chunks.count(); i += 2)
+      pairs << qMakePair(chunks[i], chunks[i+1]);
+    bool haveOdd = (chunks.count() % 2);
+    QList<Word*> odd;
+    if (haveOdd)
+      odd = chunks.last();
+
+    chunks = QtConcurrent::blockingMapped< QList< QList<Word*> > >(pairs, SortedMerger());
+    if (haveOdd)
+      chunks << odd;
+  }
+
+  if (chunks.isEmpty())
+    return QList<Word*>();
+  return chunks.first();
+}
+
+
 /**
  * \brief Destructor
  * \author Peter Grasch
  */
 Dict::~Dict()
 {
-  allowedPhonemes.clear();
-
-  words.clear();
-  pronunciations.clear();
-  categories.clear();
+  //the workers use our members; and nobody took their words
+  for (int i=0; i < processedChunks.count(); i++)
+    qDeleteAll(processedChunks[i].result());
+  delete allowedPhonemes;
 }
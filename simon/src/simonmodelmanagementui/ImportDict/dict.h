@@ -24,15 +24,22 @@
 #include <QString>
 #include <QStringList>
 #include <QHash>
+#include <QList>
+#include <QFuture>
+
+class Word;
 
 /**
   \class Dict
 
   \brief Provides some basic functions and members that make up a Dictionary
 
-  Provides functions to convert between IPA and XSP and holds some members like
-  the words, pronunciations and categories.
-  This are simple QStringLists because this is still _very_ low-level
+  Provides functions to convert between IPA and XSP and collects the entries
+  of the dictionary.
+
+  The parsers hand every entry to addEntry(); Entries are converted to the
+  simon phoneme set, turned into words and sorted in chunks on the global
+  thread pool while the parser carries on. takeWords() merges the chunks.
 
   The matrix from ipa to x-sampa was built with the matrix from theiling for reference.
   Thanks!
@@ -48,18 +55,45 @@ class Dict : public QObject
   void loaded();
   void progress(int prog);
   protected:
-    QHash<int, QString> translationLookup, modifiers;
-    QStringList allowedPhonemes;
+    /**
+     * How the pronunciations handed to addEntry() have to be converted
+     */
+    enum PronunciationFormat
+    {
+      SimonPhonemes=0,                            //!< used as is
+      Sampa=1,                                    //!< adapted to the simon phoneme set
+      SegmentedSampa=2,                           //!< adapted and split into phonemes
+      IPA=3                                       //!< translated to sampa and adapted
+    };
 
-    QStringList words;
-    QStringList pronunciations;
-    QStringList categories;
+    QHash<int, QString> translationLookup, modifiers;
+    PronunciationFormat pronunciationFormat;
 
     void buildAllowedPhonemes();
     void buildTranslationTables();
 
-    QString segmentSampa(const QString& sampa);
-    QString adaptToSimonPhonemeSet(QString sampa);
+    QString segmentSampa(const QString& sampa) const;
+    QString adaptToSimonPhonemeSet(const QString& sampa) const;
+
+    void addEntry(const QString& word, const QString& pronunciation, const QString& category);
+
+  private:
+    struct Entry
+    {
+      QString word;
+      QString pronunciation;
+      QString category;
+    };
+    class PhonemeTrie;
+
+    PhonemeTrie *allowedPhonemes;
+    QList<Entry> currentChunk;
+    QList< QFuture< QList<Word*> > > processedChunks;
+
+    void flushChunk();
+    QString processPronunciation(const QString& pronunciation) const;
+    QList<Word*> processChunk(const QList<Entry>& chunk) const;
+
   public:
 
     enum DictType
@@ -72,11 +106,14 @@ class Dict : public QObject
     };
 
     Dict(QObject *parent=0);
-    QString ipaToXSampa(QString ipa);
+    QString ipaToXSampa(const QString& ipa) const;
     virtual void load(QString path, QString encodingName) = 0;
-    QStringList getWords() const { return words; }
-    QStringList getPronuncations() const { return pronunciations; }
-    QStringList getCategories() const { return categories; }
+
+    /**
+     * Waits until all entries are processed and returns them as sorted list
+     * of words; The caller takes ownership of the words.
+     */
+    QList<Word*> takeWords();
     virtual ~Dict();
 
 };
@@ -25,6 +25,7 @@
 #include "plsdict.h"
 #include "juliusvocabulary.h"
 #include <QFile>
+#include <QElapsedTimer>
 #include <KDebug>
 #include <KLocalizedString>
 
@@ -74,6 +75,8 @@ void ImportDict::run()
   emit status(i18n("Opening Lexicon..."));
 
   emit progress(10, 1000);
+  QElapsedTimer timer;
+  timer.start();
   delete dict;
   wordList.clear();
   
@@ -103,35 +106,22 @@ void ImportDict::run()
 
   emit status(i18n("Processing Lexicon..."));
 
+  //the entries are processed in the background while the dict is parsed
   dict->load(pathToDict, encoding);
-  emit status(i18n("Creating List..."));
-  QStringList words = dict->getWords();
-  QStringList categories = dict->getCategories();
-  QStringList pronunciations = dict->getPronuncations();
+  emit status(i18n("Sorting Dictionary..."));
+  emit progress(800, 1000);
+  wordList = dict->takeWords();
   kDebug() << "Deleting dict!";
   delete dict;
   dict=0;
 
-  int wordCount = words.count();
-  for (int i=0; i<wordCount; i++) {
-    wordList.append( new Word(words.at(i),
-      pronunciations.at(i),
-      categories.at(i) ) );
-    if ((i%1000) == 0)
-      emit progress((int) ((((double) i)/((double)words.count())) *40+800), 1000);
-  }
-  words.clear();
-  pronunciations.clear();
-  categories.clear();
-
-  if (type != Dict::HTKLexicon) {
-    emit status(i18n("Sorting Dictionary..."));
-    qSort(wordList.begin(), wordList.end(), isWordLessThan);
-  }
   emit progress(1000, 1000);
   emit status(i18n("Storing Dictionary..."));
-  
-  Logger::log(i18np("%1 word from the lexicon \"%2\" imported", "%1 words from the lexicon \"%2\" imported", words.count(), pathToDict));
+
+  qint64 elapsed = qMax(timer.elapsed(), qint64(1));
+  Logger::log(i18np("%1 word from the lexicon \"%2\" imported", "%1 words from the lexicon \"%2\" imported", wordList.count(), pathToDict));
+  Logger::log(QString("Imported %1 entries in %2 ms (%3 entries per second)").arg(wordList.count())
+              .arg(elapsed).arg(qRound64(wordList.count() * 1000.0 / elapsed)));
 
   if (deleteFileWhenDone) {
     Logger::log(i18n("Deleting Input-File"));
@@ -29,6 +29,7 @@
 
 JuliusVocabulary::JuliusVocabulary(QObject* parent): Dict(parent)
 {
+  pronunciationFormat = Sampa;
 }
 
 
@@ -82,9 +83,7 @@ void JuliusVocabulary::load(QString path, QString encoding)
       if (word.isEmpty() || (word == "<s>") || (word == "</s>"))
         continue;
       xsp = line.mid(splitter).trimmed();
-      words << word;
-      categories << category;
-      pronunciations << adaptToSimonPhonemeSet(xsp);
+      addEntry(word, xsp, category);
     }
 
     if (maxProg != 0) {
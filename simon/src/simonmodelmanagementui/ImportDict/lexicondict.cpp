@@ -76,9 +76,7 @@ void LexiconDict::load(QString path, QString encoding)
 
     if (word.isEmpty())
       continue;
-    words << word;
-    categories << unknownStr;
-    pronunciations << line.mid(wordend+2).trimmed();
+    addEntry(word, line.mid(wordend+2).trimmed(), unknownStr);
 
     currentProg += line.length();
 
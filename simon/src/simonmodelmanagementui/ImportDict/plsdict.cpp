@@ -40,6 +40,7 @@ Dict(parent),
 reader(0),
 pos(0)
 {
+  pronunciationFormat = IPA;
   buildTranslationTables();
 }
 
@@ -143,16 +144,14 @@ bool PLSDict::endElement(const QString&, const QString&,
 const QString &qName)
 {
   if (qName == "phoneme") {
-    phonemeDefinitions << adaptToSimonPhonemeSet(ipaToXSampa(currentPhonemeDefinition.trimmed()));
+    phonemeDefinitions << currentPhonemeDefinition.trimmed();
     currentPhonemeDefinition.clear();
   } else
   if (qName == "lexeme") {
     foreach (const QString& w, currentWords) {
       // add the found words to the word
       foreach (const QString& phonemeDefinition, phonemeDefinitions) {
-        words << w.trimmed();
-        pronunciations << phonemeDefinition;
-        categories << currentCategory;
+        addEntry(w.trimmed(), phonemeDefinition, currentCategory);
       }
     }
     //cleanup
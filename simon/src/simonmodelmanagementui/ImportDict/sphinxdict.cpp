@@ -78,6 +78,8 @@ void SPHINXDict::load(QString path, QString encodingName)
   int wordend;
   line = dictStream->readLine(1000);
 
+  QString unknownStr = i18nc("Category name for words that are imported from a dictionary "
+				  "which does not provide category information", "Unknown");
   QRegExp duplicateIndex("\\(([0-9])*\\)$");
   QRegExp splitter("[ \\t]");
   while (!line.isNull()) {
@@ -85,10 +87,7 @@ void SPHINXDict::load(QString path, QString encodingName)
     QString word = line.left(wordend).remove(duplicateIndex);
 
     if (!word.isEmpty()) {
-      words << word;
-      categories << i18nc("Category name for words that are imported from a dictionary "
-				  "which does not provide category information", "Unknown");
-      pronunciations << line.mid(wordend+1).trimmed();
+      addEntry(word, line.mid(wordend+1).trimmed(), unknownStr);
     }
 
     if (maxProg != 0) {
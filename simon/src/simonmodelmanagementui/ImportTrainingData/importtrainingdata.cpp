@@ -32,6 +32,13 @@ ImportTrainingData::ImportTrainingData(QObject* parent) : QThread(parent),
   stopRequest(false)
 {
   connect(pp, SIGNAL(error(QString)), this, SIGNAL(error(QString)));
+  //emitted from the post-processing threads
+  connect(pp, SIGNAL(batchProgress(int)), this, SLOT(batchProgress(int)), Qt::DirectConnection);
+}
+
+void ImportTrainingData::batchProgress(int done)
+{
+  emit progress(prog + done);
 }
 
 
@@ -263,23 +270,20 @@ QStringList* ImportTrainingData::processSounds(QStringList dataFiles,
   QStringList *newFiles = new QStringList();
 
   for (int i=0; i < dataFiles.count(); i++) {
-    if (stopRequest) {
-      delete newFiles;
-      return 0;
-    }
-
     fInfo.setFile(dataFiles[i]);
     QString dateTime = QDate::currentDate().toString ( "yyyy-MM-dd" ) +'_'+QTime::currentTime().toString("hh-mm-ss");
     newFileName = destDir+QDir::separator()+fInfo.fileName().left(fInfo.fileName().lastIndexOf('.')).replace(' ', '_')+'_'+QString::number(i)+'_'+dateTime+".wav";
+    newFiles->append(newFileName);
+  }
 
-    if (!pp->process(dataFiles[i], newFileName, false /*do not delete input*/,
-    true /*silent*/)) {
+  if (stopRequest || !pp->processBatch(dataFiles, *newFiles, false /*do not delete input*/)) {
+    if (!stopRequest)
       emit error(i18n("Could not process sound files"));
-      return 0;
-    }
-    newFiles->append(newFileName);
-    emit progress(++prog);
+    delete newFiles;
+    return 0;
   }
+  prog += newFiles->count();
+  emit progress(prog);
   kDebug() << "Files processed" << newFiles->count();
 
   return newFiles;
@@ -288,7 +292,10 @@ QStringList* ImportTrainingData::processSounds(QStringList dataFiles,
 void ImportTrainingData::terminate()
 {
   stopRequest = true;
-  QThread::terminate();
+  pp->cancel();
+  //files that are already being processed still use the batch of this thread
+  if (!wait(5000))
+    QThread::terminate();
   wait();
 }
 
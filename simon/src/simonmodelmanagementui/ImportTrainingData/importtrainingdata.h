@@ -48,6 +48,9 @@ class ImportTrainingData : public QThread
 
     QStringList getAllowedFileTypes();
 
+  private slots:
+    void batchProgress(int done);
+
   public slots:
     void run();
 
@@ -117,6 +117,7 @@ currentlyReading(false)
 
   connect(socket, SIGNAL(disconnected()), this, SLOT(slotDisconnected()), Qt::QueuedConnection);
   connect(socket, SIGNAL(disconnected()), this, SIGNAL(disconnected()), Qt::QueuedConnection);
+  connect(socket, SIGNAL(bytesWritten(qint64)), this, SLOT(sendModelChunks()), Qt::QueuedConnection);
 
   connect(this, SIGNAL(simondSystemError(QString)), this, SLOT(disconnectFromServer()));
 
@@ -208,6 +209,7 @@ void RecognitionControl::streamStopped()
 
 bool RecognitionControl::startSimondStreamer()
 {
+  simondStreamer->setModelSampleRate(ModelManager::getInstance()->getActiveModelSampleRate());
   return simondStreamer->start();
 }
 
@@ -224,6 +226,7 @@ void RecognitionControl::slotDisconnected()
 
   m_loggedIn = false;
   recognitionReady=false;
+  clearModelTransfers();
   if (synchronisationOperation) {
     if (synchronisationOperation->isRunning())
       synchronisationOperation->canceled();
@@ -481,26 +484,120 @@ void RecognitionControl::login()
 }
 
 
-bool RecognitionControl::sendActiveModel()
+bool RecognitionControl::sendActiveModel(qint64 offset)
 {
   Model *model = ModelManager::getInstance()->createActiveContainer();
-  if (!model) {
+  if (!model || !sendModel(Simond::ActiveModel, ModelManager::getInstance()->getActiveContainerModifiedTime(),
+                           model, offset)) {
     emit synchronisationWarning(i18n("Could not create active model container"));
     sendRequest(Simond::ErrorRetrievingActiveModel);
     return false;
   }
+  return true;
+}
+
+
+/**
+ * Starts sending the given model container from offset on; Deletes the model
+ *
+ * The chunks are sent from sendModelChunks() one at a time so that neither the
+ * socket nor its buffer ever hold more than a chunk of the container.
+ */
+bool RecognitionControl::sendModel(qint32 request, const QDateTime& changedTime, Model *model, qint64 offset)
+{
+  ModelTransfer transfer;
+  transfer.request = request;
+  transfer.changedTime = changedTime;
+  transfer.sampleRate = model->sampleRate();
+  transfer.container = new QFile(model->containerPath());
+  transfer.offset = offset;
+  delete model;
+
+  if (!transfer.container->open(QIODevice::ReadOnly)) {
+    kWarning() << "Failed to open model container " << transfer.container->fileName();
+    delete transfer.container;
+    return false;
+  }
+  transfer.totalSize = transfer.container->size();
+  if (transfer.offset > transfer.totalSize)
+    transfer.offset = 0;
+
+  //a newer request for the same model replaces the running one
+  for (int i=0; i < modelTransfers.count(); i++) {
+    if (modelTransfers[i].request == request) {
+      delete modelTransfers[i].container;
+      modelTransfers.removeAt(i--);
+    }
+  }
+  modelTransfers << transfer;
+  sendModelChunks();
+  return true;
+}
+
+
+void RecognitionControl::sendModelChunks()
+{
+  //one chunk in flight at a time
+  while (!modelTransfers.isEmpty() && (socket->bytesToWrite() == 0)) {
+    ModelTransfer& transfer = modelTransfers.first();
+
+    QByteArray chunk;
+    if (transfer.offset < transfer.totalSize) {
+      chunk = PartialModel::readChunk(transfer.container, transfer.offset);
+      if (chunk.isEmpty()) {
+        kWarning() << "Failed to read model container " << transfer.container->fileName();
+        emit synchronisationWarning(i18n("Could not read model container"));
+        delete transfer.container;
+        modelTransfers.removeFirst();
+        continue;
+      }
+    }
+
+    QByteArray body;
+    QDataStream bodyStream(&body, QIODevice::WriteOnly);
+    bodyStream << transfer.changedTime
+      << transfer.sampleRate
+      << transfer.totalSize
+      << transfer.offset
+      << chunk;
+
+    send(transfer.request, body);
+    transfer.offset += chunk.size();
+
+    if (transfer.offset >= transfer.totalSize) {
+      delete transfer.container;
+      modelTransfers.removeFirst();
+    }
+  }
+}
+
 
+void RecognitionControl::clearModelTransfers()
+{
+  foreach (const ModelTransfer& transfer, modelTransfers)
+    delete transfer.container;
+  modelTransfers.clear();
+}
+
+
+void RecognitionControl::requestModel(qint32 request, qint64 offset)
+{
   QByteArray body;
   QDataStream bodyStream(&body, QIODevice::WriteOnly);
+  bodyStream << offset;
+  send(request, body, false);
+}
 
-  bodyStream << ModelManager::getInstance()->getActiveContainerModifiedTime()
-    << model->sampleRate()
-    << model->container();
 
-  send(Simond::ActiveModel, body);
-  
-  delete model;
-  return true;
+PartialModel::Status RecognitionControl::receiveModelChunk(PartialModel& part, qint32 resumeRequest,
+  const QDateTime& changedTime, qint64 totalSize, qint64 offset, const QByteArray& chunk)
+{
+  PartialModel::Status status = part.write(changedTime, totalSize, offset, chunk);
+
+  //the server is done but we are missing something; ask for the rest
+  if ((status == PartialModel::Incomplete) && (offset + chunk.size() >= totalSize))
+    requestModel(resumeRequest, part.resumeOffset(changedTime));
+  return status;
 }
 
 
@@ -539,28 +636,17 @@ void RecognitionControl::sendScenariosToDelete()
 }
 
 
-bool RecognitionControl::sendBaseModel()
+bool RecognitionControl::sendBaseModel(qint64 offset)
 {
   kDebug() << "Sending base model";
   Model *model = ModelManager::getInstance()->createBaseModelContainer();
-  if (!model) {
+  if (!model || !sendModel(Simond::BaseModel, ModelManager::getInstance()->getBaseModelDate(),
+                           model, offset)) {
     emit synchronisationWarning(i18n("Could not create base model container"));
     sendRequest(Simond::ErrorRetrievingBaseModel);
     return false;
   }
-
-  QByteArray body;
-  QDataStream bodyStream(&body, QIODevice::WriteOnly);
-
-  bodyStream << ModelManager::getInstance()->getBaseModelDate()
-    << model->baseModelType()
-    << model->container();
-
-  send(Simond::BaseModel, body);
-
-  delete model;
   return true;
-
 }
 
 void RecognitionControl::sendDeactivatedScenarioList()
@@ -874,28 +960,44 @@ void RecognitionControl::messageReceived()
 
         case Simond::GetActiveModel:
         {
-          advanceStream(sizeof(qint32));
+          checkIfMessageFinished(sizeof(qint64));
+          qint64 offset;
+          msg >> offset;
+          advanceStream(sizeof(qint32)+sizeof(qint64));
           checkIfSynchronisationIsAborting();
 
-          kDebug() << "Server requested active model";
-          sendActiveModel();
+          kDebug() << "Server requested active model from " << offset;
+          sendActiveModel(offset);
           break;
         }
 
         case Simond::ActiveModel:
         {
           parseLengthHeader();
-          kDebug() << "Server sent active model";
 
           qint32 sampleRate;
-          QByteArray container;
+          QByteArray chunk;
+          qint64 totalSize, offset;
 
           QDateTime changedTime;
           msg >> changedTime;
           msg >> sampleRate;
-          msg >> container;
-
-          storeActiveModel(changedTime, sampleRate, container);
+          msg >> totalSize;
+          msg >> offset;
+          msg >> chunk;
+          kDebug() << "Server sent active model: " << offset+chunk.size() << "of" << totalSize;
+
+          PartialModel part(ModelManager::getInstance()->activeContainerPath());
+          PartialModel::Status status = receiveModelChunk(part, Simond::GetActiveModel, changedTime,
+                                                          totalSize, offset, chunk);
+          if (status == PartialModel::Failed)
+            emit synchronisationError(i18nc("%1 is path", "Could not store the active model received from the server."
+              "\n\nPlease check the permissions on the model folder: %1",
+              KStandardDirs::locateLocal("appdata", "model")));
+          else if (status == PartialModel::Complete)
+            storeActiveModel(changedTime, sampleRate, part.path());
+          if (status != PartialModel::Incomplete)
+            part.discard();
 
           advanceStream(sizeof(qint32)+sizeof(qint64)+length);
           checkIfSynchronisationIsAborting();
@@ -924,26 +1026,41 @@ void RecognitionControl::messageReceived()
 
         case Simond::GetBaseModel:
         {
-          advanceStream(sizeof(qint32));
+          checkIfMessageFinished(sizeof(qint64));
+          qint64 offset;
+          msg >> offset;
+          advanceStream(sizeof(qint32)+sizeof(qint64));
           checkIfSynchronisationIsAborting();
-          sendBaseModel();
+          sendBaseModel(offset);
           break;
         }
         case Simond::BaseModel:
         {
-          kDebug() << "Server sent base model";
-
           parseLengthHeader();
 
-          int baseModelType;
+          qint32 baseModelType;
           QDateTime changedTime;
-          QByteArray container;
+          QByteArray chunk;
+          qint64 totalSize, offset;
 
           msg >> changedTime;
           msg >> baseModelType;
-          msg >> container;
-
-          storeBaseModel(changedTime, baseModelType, container);
+          msg >> totalSize;
+          msg >> offset;
+          msg >> chunk;
+          kDebug() << "Server sent base model: " << offset+chunk.size() << "of" << totalSize;
+
+          PartialModel part(ModelManager::getInstance()->baseModelContainerPath());
+          PartialModel::Status status = receiveModelChunk(part, Simond::GetBaseModel, changedTime,
+                                                          totalSize, offset, chunk);
+          if (status == PartialModel::Failed)
+            emit synchronisationError(i18nc("%1 is path", "Could not store the base model received from the server."
+              "\n\nPlease check the permissions on the model folder: %1",
+              KStandardDirs::locateLocal("appdata", "model")));
+          else if (status == PartialModel::Complete)
+            storeBaseModel(changedTime, baseModelType, part.path());
+          if (status != PartialModel::Incomplete)
+            part.discard();
 
           advanceStream(sizeof(qint32)+sizeof(qint64)+length);
 
@@ -1703,9 +1820,9 @@ void RecognitionControl::setBlockAutoStart(bool block)
   blockAutoStart = block;
 }
 
-bool RecognitionControl::storeBaseModel(const QDateTime& changedTime, int baseModelType, const QByteArray& container)
+bool RecognitionControl::storeBaseModel(const QDateTime& changedTime, int baseModelType, const QString& containerPath)
 {
-  bool succ = ModelManager::getInstance()->storeBaseModel(changedTime, baseModelType, container);
+  bool succ = ModelManager::getInstance()->storeBaseModel(changedTime, baseModelType, containerPath);
   if (!succ) {
     emit synchronisationError(i18nc("%1 is path", "Could not store the base model received from the server."
       "\n\nPlease check the permissions on the model folder: %1",
@@ -1739,9 +1856,9 @@ bool RecognitionControl::storeTraining(const QDateTime& changedTime, qint32 samp
 }
 
 
-bool RecognitionControl::storeActiveModel(const QDateTime& changedTime, qint32 sampleRate, const QByteArray& container)
+bool RecognitionControl::storeActiveModel(const QDateTime& changedTime, qint32 sampleRate, const QString& containerPath)
 {
-  bool succ = ModelManager::getInstance()->storeActiveModel(changedTime, sampleRate, container);
+  bool succ = ModelManager::getInstance()->storeActiveModel(changedTime, sampleRate, containerPath);
   if (!succ) {
     emit synchronisationError(i18nc("%1 is path", "Could not store the active model received from the server."
       "\n\nPlease check the permissions on the model folder: %1",
@@ -1777,6 +1894,7 @@ RecognitionControl::~RecognitionControl()
 
     localSimond->deleteLater();
   }
+  clearModelTransfers();
   socket->deleteLater();
   timeoutWatcher->deleteLater();
 }
@@ -23,18 +23,21 @@
 #include "recognitioncontrol_export.h"
 #include <simonrecognitionresult/recognitionresult.h>
 #include <simondstreamer/simonsender.h>
+#include <simonutils/partialmodel.h>
 #include <QStringList>
 #include <QMutex>
+#include <QDateTime>
 
 class ThreadedSSLSocket;
+class QFile;
 class QTimer;
 class QProcess;
 class Operation;
 
-const qint8 protocolVersion=5;
+const qint8 protocolVersion=6;
 
-class QDateTime;
 class SimondStreamer;
+class Model;
 
 /**
  *	@class RecognitionControl
@@ -108,13 +111,31 @@ class RECOGNITIONCONTROL_EXPORT RecognitionControl : public SimonSender
     
     void send(qint32 requestId, const QByteArray& data, bool includeLength=true);
 
+    //model containers being sent; the next chunk is written once the
+    //socket sent the previous one
+    struct ModelTransfer {
+      qint32 request;
+      QDateTime changedTime;
+      qint32 sampleRate;
+      QFile *container;
+      qint64 totalSize;
+      qint64 offset;
+    };
+    QList<ModelTransfer> modelTransfers;
+    void clearModelTransfers();
+
+    bool sendModel(qint32 request, const QDateTime& changedTime, Model *model, qint64 offset);
+    void requestModel(qint32 request, qint64 offset);
+    PartialModel::Status receiveModelChunk(PartialModel& part, qint32 resumeRequest,
+      const QDateTime& changedTime, qint64 totalSize, qint64 offset, const QByteArray& chunk);
+
     bool storeBaseModel(const QDateTime& changedTime, int baseModelType,
-      const QByteArray& container);
+      const QString& containerPath);
     bool storeLanguageDescription(const QDateTime& changedTime, QByteArray& shadowVocab,
       const QByteArray& languageProfile=QByteArray());
     bool storeTraining(const QDateTime& changedTime, qint32 sampleRate,
       const QByteArray& prompts);
-    bool storeActiveModel(const QDateTime& changedTime, qint32 sampleRate, const QByteArray& container);
+    bool storeActiveModel(const QDateTime& changedTime, qint32 sampleRate, const QString& containerPath);
     bool storeSample(const QString& name, const QByteArray& sample);
 
   signals:
@@ -170,12 +191,13 @@ class RECOGNITIONCONTROL_EXPORT RecognitionControl : public SimonSender
     void connectToNext();
     void timeoutReached();
     void messageReceived();
-    bool sendActiveModel();
+    bool sendActiveModel(qint64 offset=0);
+    void sendModelChunks();
     void sendActiveModelSampleRate();
 
     void sendScenariosToDelete();
 
-    bool sendBaseModel();
+    bool sendBaseModel(qint64 offset=0);
 
     void sendSelectedScenarioList();
 
@@ -30,6 +30,7 @@ SimonSSLSocket::SimonSSLSocket(ThreadedSSLSocket *socket, QObject* parent): QSsl
   
   connect(socket, SIGNAL(readyWrite()), this, SLOT(processBuffer()), Qt::QueuedConnection);
   connect(this, SIGNAL(readyRead()), this, SLOT(readFromSocket()), Qt::DirectConnection);
+  connect(this, SIGNAL(bytesWritten(qint64)), this, SLOT(written(qint64)), Qt::DirectConnection);
 }
 
 void SimonSSLSocket::connectToHostWrapper(const QString& hostName, quint16 port)
@@ -52,3 +53,8 @@ void SimonSSLSocket::readFromSocket()
   socket->readFromSocket();
 }
 
+void SimonSSLSocket::written(qint64 bytes)
+{
+  socket->written(bytes);
+}
+
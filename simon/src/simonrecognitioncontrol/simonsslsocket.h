@@ -35,6 +35,7 @@ public:
 private slots:
   void processBuffer();
   void readFromSocket();
+  void written(qint64 bytes);
   
 private slots:
   void connectToHostWrapper(const QString& hostName, quint16 port);
@@ -36,7 +36,8 @@ public:
 
 ThreadedSSLSocket::ThreadedSSLSocket(QObject* parent): QIODevice(parent),
     socketThread(new SocketThread(this)),
-    socket(new SimonSSLSocket(this))
+    socket(new SimonSSLSocket(this)),
+    pendingBytes(0)
 {
   open(QIODevice::ReadWrite); //krazy:exclude=syscalls
   
@@ -102,6 +103,7 @@ qint64 ThreadedSSLSocket::writeData(const char* data, qint64 len)
 {
   bytesToWriteLock.lock();
   qint64 out = writeBuffer.write(data, len);
+  pendingBytes += out;
   bytesToWriteLock.unlock();
   emit readyWrite();
   return out;
@@ -122,6 +124,20 @@ qint64 ThreadedSSLSocket::bytesAvailable() const
   return readBuffer.count();
 }
 
+qint64 ThreadedSSLSocket::bytesToWrite() const
+{
+  QMutexLocker l(&bytesToWriteLock);
+  return pendingBytes;
+}
+
+void ThreadedSSLSocket::written(qint64 bytes)
+{
+  bytesToWriteLock.lock();
+  pendingBytes = qMax(pendingBytes - bytes, (qint64) 0);
+  bytesToWriteLock.unlock();
+  emit bytesWritten(bytes);
+}
+
 //ssl socket wrappers
 QAbstractSocket::SocketState ThreadedSSLSocket::state() const
 {
@@ -133,10 +149,16 @@ void ThreadedSSLSocket::abort()
 }
 void ThreadedSSLSocket::connectToHost(const QString& hostName, quint16 port)
 {
+  bytesToWriteLock.lock();
+  pendingBytes = 0;
+  bytesToWriteLock.unlock();
   emit requestConnect(hostName, port);
 }
 void ThreadedSSLSocket::connectToHostEncrypted(const QString& hostName, quint16 port)
 {
+  bytesToWriteLock.lock();
+  pendingBytes = 0;
+  bytesToWriteLock.unlock();
   emit requestConnectEncrypted(hostName, port);
 }
 void ThreadedSSLSocket::setProtocol(QSsl::SslProtocol protocol)
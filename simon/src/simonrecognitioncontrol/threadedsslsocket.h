@@ -63,6 +63,7 @@ public:
   QAbstractSocket::SocketError error();
   void disconnectFromHost();
   qint64 bytesAvailable() const;
+  qint64 bytesToWrite() const;
   
   virtual void close();
   QString errorString() const;
@@ -70,6 +71,7 @@ public:
   
   bool processBuffer();
   void readFromSocket();
+  void written(qint64 bytes);
 
 protected:
   virtual qint64 readData(char* data, qint64 maxlen);
@@ -83,7 +85,9 @@ private:
   SocketThread  *socketThread;
   SimonSSLSocket *socket;
   
-  QMutex              bytesToWriteLock;
+  mutable QMutex      bytesToWriteLock;
+  //written by us but not yet by the socket
+  qint64             pendingBytes;
 //   QWaitCondition bytesToWriteCondition;
 };
 
@@ -31,7 +31,7 @@
 #include <simonscenarios/languagedescriptioncontainer.h>
 #include <simonscenarios/trainingcontainer.h>
 
-#include <simonwav/wav.h>
+#include <simonwav/wavfilewriter.h>
 
 #include <simoncontextadapter/contextadapter.h>
 
@@ -74,6 +74,7 @@ ClientSocket::ClientSocket(int socketDescriptor, DatabaseAccess* databaseAccess,
   this->setSocketDescriptor(socketDescriptor);
    connect(this, SIGNAL(readyRead()), this, SLOT(processRequest()));
   connect(this, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(slotSocketError()));
+  connect(this, SIGNAL(bytesWritten(qint64)), this, SLOT(sendModelChunks()));
 
   //TODO: Implement encryption
   if (false) {                                    //Settings::getB("Encryption"))
@@ -259,7 +260,8 @@ void ClientSocket::processRequest()
         kDebug() << "Base models: " << baseModelDate << localBaseModelDate;
         if (baseModelDate != localBaseModelDate) {
           if ((baseModelDate > localBaseModelDate) || !sendBaseModel())
-            sendCode(Simond::GetBaseModel);
+            requestModel(Simond::GetBaseModel,
+                         PartialModel(synchronisationManager->getBaseModelPath()).resumeOffset(baseModelDate));
         }
         //active model
         stream >> activeModelDate;
@@ -267,7 +269,8 @@ void ClientSocket::processRequest()
         kDebug() << "Active model date: " << activeModelDate << localActiveModelDate;
         if (activeModelDate != localActiveModelDate) {
           if (activeModelDate > localActiveModelDate || !sendActiveModel())
-            sendCode(Simond::GetActiveModel);
+            requestModel(Simond::GetActiveModel,
+                         PartialModel(synchronisationManager->getActiveModelPath()).resumeOffset(activeModelDate));
         }
         if (activeModelDate.isNull())
           sendCode(Simond::GetActiveModelSampleRate);
@@ -375,7 +378,10 @@ void ClientSocket::processRequest()
 
       case Simond::GetActiveModel:
       {
-        sendActiveModel();
+        WAITFORMESSAGEORRETURN(sizeof(qint64), stream, msg);
+        qint64 offset;
+        stream >> offset;
+        sendActiveModel(offset);
         break;
       }
 
@@ -383,8 +389,6 @@ void ClientSocket::processRequest()
       {
         Q_ASSERT(synchronisationManager);
 
-        kDebug() << "Received Active model";
-
         WAITFORMESSAGEORRETURN(sizeof(qint64), stream, msg);
 
         qint64 length;
@@ -392,15 +396,27 @@ void ClientSocket::processRequest()
         WAITFORMESSAGEORRETURN(length, stream, msg);
 
         qint32 sampleRate;
-        QByteArray container;
+        QByteArray chunk;
         QDateTime changedDate;
+        qint64 totalSize, offset;
         stream >> changedDate;
         stream >> sampleRate;
-        stream >> container;
+        stream >> totalSize;
+        stream >> offset;
+        stream >> chunk;
+
+        kDebug() << "Received active model: " << offset+chunk.size() << "of" << totalSize;
 
-        if (!synchronisationManager->storeActiveModel( changedDate, sampleRate, container)) {
+        PartialModel part(synchronisationManager->getActiveModelPath());
+        PartialModel::Status status = receiveModelChunk(part, Simond::GetActiveModel, changedDate,
+                                                        totalSize, offset, chunk);
+        if (status == PartialModel::Incomplete)
+          break;
+
+        if ((status == PartialModel::Failed) ||
+            !synchronisationManager->storeActiveModel(changedDate, sampleRate, part.path()))
           sendCode(Simond::ActiveModelStorageFailed);
-        }
+        part.discard();
         break;
       }
 
@@ -434,10 +450,18 @@ void ClientSocket::processRequest()
         kDebug() << "Client failed to retrieve base model!";
         break;
 
+      case Simond::GetBaseModel:
+      {
+        WAITFORMESSAGEORRETURN(sizeof(qint64), stream, msg);
+        qint64 offset;
+        stream >> offset;
+        sendBaseModel(offset);
+        break;
+      }
+
       case Simond::BaseModel:
       {
         Q_ASSERT(synchronisationManager);
-        kDebug() << "Received base model";
         WAITFORMESSAGEORRETURN(sizeof(qint64), stream, msg);
 
         qint64 length;
@@ -445,16 +469,28 @@ void ClientSocket::processRequest()
         WAITFORMESSAGEORRETURN(length, stream, msg);
 
         qint32 baseModelType;
-        QByteArray container;
+        QByteArray chunk;
         QDateTime changedDate;
+        qint64 totalSize, offset;
         stream >> changedDate;
         stream >> baseModelType;
-        stream >> container;
+        stream >> totalSize;
+        stream >> offset;
+        stream >> chunk;
+
+        kDebug() << "Received base model: " << offset+chunk.size() << "of" << totalSize;
+
+        PartialModel part(synchronisationManager->getBaseModelPath());
+        PartialModel::Status status = receiveModelChunk(part, Simond::GetBaseModel, changedDate,
+                                                        totalSize, offset, chunk);
+        if (status == PartialModel::Incomplete)
+          break;
 
         //if the new base model type is different from the old one, a new acoustic model should be compiled
-        if (!synchronisationManager->storeBaseModel(changedDate, baseModelType, container)) {
+        if ((status == PartialModel::Failed) ||
+            !synchronisationManager->storeBaseModel(changedDate, baseModelType, part.path()))
           sendCode(Simond::BaseModelStorageFailed);
-        }
+        part.discard();
         break;
       }
 
@@ -719,16 +755,22 @@ void ClientSocket::processRequest()
         kDebug() << "Starting sample " << id << channels << sampleRate;
 
         if (currentSamples.contains(id)) {
-          WAV* w = currentSamples.value(id);
+          //the client restarted the sample; what we have of it is incomplete
+          WavFileWriter* w = currentSamples.value(id);
+          w->abort();
           w->deleteLater();
           currentSamples.remove(id);
         }
 
-        WAV *currentSample = new WAV(KStandardDirs::locateLocal("appdata", "models/"+username+"/recognitionsamples/"+
+        WavFileWriter *currentSample = new WavFileWriter(KStandardDirs::locateLocal("appdata", "models/"+username+"/recognitionsamples/"+
           KDateTime::currentUtcDateTime().dateTime().toString("yyyy-MM-dd_hh-mm-ss-zzzz")+'.'+QString::number(id)+".wav"),
           channels, sampleRate);
+        if (!currentSample->open()) {
+          kWarning() << "Failed to create sample file: " << currentSample->getFilename();
+          delete currentSample;
+          break;
+        }
         currentSamples.insert(id, currentSample);
-        currentSample->beginAddSequence();
         break;
       }
       case Simond::RecognitionSampleData:
@@ -743,7 +785,7 @@ void ClientSocket::processRequest()
         qint8 id;
         stream >> id;
         stream >> sampleData;
-        WAV *w = currentSamples.value(id);
+        WavFileWriter *w = currentSamples.value(id);
         if (w)
           w->write(sampleData);
         else
@@ -756,10 +798,10 @@ void ClientSocket::processRequest()
         WAITFORMESSAGEORRETURN(sizeof(qint8), stream, msg);
         qint8 id;
         stream >> id;
-        WAV *w = currentSamples.value(id);
+        WavFileWriter *w = currentSamples.value(id);
         if (w) {
-          w->endAddSequence();
-          w->writeFile();
+          if (!w->finish())
+            kWarning() << "Failed to write sample file: " << w->getFilename();
 
           if (recognitionControl)
             recognitionControl->recognize(w->getFilename());
@@ -915,41 +957,126 @@ void ClientSocket::slotSocketError()
 }
 
 
-bool ClientSocket::sendActiveModel()
+bool ClientSocket::sendActiveModel(qint64 offset)
 {
   kDebug() << "Sending active model...";
   Q_ASSERT(synchronisationManager);
 
   Model *model = synchronisationManager->getActiveModel();
 
-  return sendModel(Simond::ActiveModel, synchronisationManager->getActiveModelDate(), model);
+  return sendModel(Simond::ActiveModel, synchronisationManager->getActiveModelDate(), model, offset);
 }
 
 
-bool ClientSocket::sendBaseModel()
+bool ClientSocket::sendBaseModel(qint64 offset)
 {
   kDebug() << "Sending base model...";
   Q_ASSERT(synchronisationManager);
 
   Model *model = synchronisationManager->getBaseModel();
-  return sendModel(Simond::BaseModel, synchronisationManager->getBaseModelDate(), model);
+  return sendModel(Simond::BaseModel, synchronisationManager->getBaseModelDate(), model, offset);
 }
 
 
-bool ClientSocket::sendModel(Simond::Request request, const QDateTime& changedTime, Model *model)
+/**
+ * Starts sending the given model container from offset on; Takes ownership
+ * of the model.
+ *
+ * The chunks are sent from sendModelChunks() as the socket drains, so other
+ * clients are served in the meantime.
+ */
+bool ClientSocket::sendModel(Simond::Request request, const QDateTime& changedTime, Model *model, qint64 offset)
 {
   if (!model) return false;
 
+  ModelTransfer transfer;
+  transfer.request = request;
+  transfer.changedTime = changedTime;
+  transfer.sampleRate = model->sampleRate();
+  transfer.container = new QFile(model->containerPath());
+  transfer.offset = offset;
+  delete model;
+
+  //the size is taken from the opened file; a container that is replaced
+  //later on is only picked up by the next transfer
+  if (!transfer.container->open(QIODevice::ReadOnly)) {
+    kWarning() << "Failed to open model container " << transfer.container->fileName();
+    delete transfer.container;
+    return false;
+  }
+  transfer.totalSize = transfer.container->size();
+  if (transfer.offset > transfer.totalSize)
+    transfer.offset = 0;
+
+  //a newer request for the same model replaces the running one
+  for (int i=0; i < modelTransfers.count(); i++) {
+    if (modelTransfers[i].request == request) {
+      delete modelTransfers[i].container;
+      modelTransfers.removeAt(i--);
+    }
+  }
+  modelTransfers << transfer;
+  sendModelChunks();
+  return true;
+}
+
+
+void ClientSocket::sendModelChunks()
+{
+  //don't queue up the whole model in the socket
+  while (!modelTransfers.isEmpty() && (bytesToWrite() < 4 * PartialModel::chunkSize)) {
+    ModelTransfer& transfer = modelTransfers.first();
+
+    QByteArray chunk;
+    if (transfer.offset < transfer.totalSize) {
+      chunk = PartialModel::readChunk(transfer.container, transfer.offset);
+      if (chunk.isEmpty()) {
+        //the client asks for the rest once it gets a final chunk; it won't get one
+        kWarning() << "Failed to read model container " << transfer.container->fileName();
+        delete transfer.container;
+        modelTransfers.removeFirst();
+        continue;
+      }
+    }
+
+    QByteArray body;
+    QDataStream bodyStream(&body, QIODevice::WriteOnly);
+    bodyStream << transfer.changedTime
+      << transfer.sampleRate
+      << transfer.totalSize
+      << transfer.offset
+      << chunk;
+
+    send(transfer.request, body);
+    transfer.offset += chunk.size();
+
+    if (transfer.offset >= transfer.totalSize) {
+      delete transfer.container;
+      modelTransfers.removeFirst();
+    }
+  }
+}
+
+
+void ClientSocket::requestModel(Simond::Request request, qint64 offset)
+{
   QByteArray body;
   QDataStream bodyStream(&body, QIODevice::WriteOnly);
-  bodyStream << changedTime
-    << model->sampleRate()
-    << model->container();
+  bodyStream << offset;
+  send(request, body, false);
+}
 
-  send(request, body);
 
-  delete model;
-  return true;
+PartialModel::Status ClientSocket::receiveModelChunk(PartialModel& part, Simond::Request resumeRequest,
+                                                     const QDateTime& changedDate, qint64 totalSize,
+                                                     qint64 offset, const QByteArray& chunk)
+{
+  PartialModel::Status status = part.write(changedDate, totalSize, offset, chunk);
+
+  //the sender is done but we are missing something; ask for the rest
+  if ((status == PartialModel::Incomplete) && (offset + chunk.size() >= totalSize))
+    requestModel(resumeRequest, part.resumeOffset(changedDate));
+  return status;
 }
 
 void ClientSocket::synchronisationDone()
@@ -1149,7 +1276,13 @@ ClientSocket::~ClientSocket()
   if (contextAdapter)
       contextAdapter->deleteLater();
 
+  //samples that were never finished are incomplete
+  foreach (WavFileWriter *w, currentSamples)
+    w->abort();
   qDeleteAll(currentSamples);
+
+  foreach (const ModelTransfer& transfer, modelTransfers)
+    delete transfer.container;
 }
 
 void ClientSocket::sendModelCompilationLog()
@@ -23,14 +23,17 @@
 #include "recognitioncontrol.h"
 #include <simonddatabaseaccess/databaseaccess.h>
 #include <simonprotocol/simonprotocol.h>
+#include <simonutils/partialmodel.h>
 #include <QSslSocket>
 #include <QList>
 #include <QHash>
 #include <QMutex>
 #include <QString>
+#include <QDateTime>
+#include <QFile>
 
 class RecognitionControlFactory;
-const qint8 protocolVersion=5;
+const qint8 protocolVersion=6;
 
 class DatabaseAccess;
 class RecognitionControl;
@@ -39,7 +42,7 @@ class ModelCompilationManager;
 class ModelCompilationAdapter;
 class ContextAdapter;
 class Model;
-class WAV;
+class WavFileWriter;
 class QHostAddress;
 
 class ClientSocket : public QSslSocket
@@ -60,7 +63,20 @@ class ClientSocket : public QSslSocket
     SynchronisationManager *synchronisationManager;
     ContextAdapter *contextAdapter;
 
-    QHash<qint8, WAV *> currentSamples;
+    QHash<qint8, WavFileWriter *> currentSamples;
+
+    //model containers being sent; the next chunk is queued whenever the
+    //socket drained below the low water mark. The container stays open so
+    //that a model replaced in the meantime doesn't end up spliced into it
+    struct ModelTransfer {
+      Simond::Request request;
+      QDateTime changedTime;
+      qint32 sampleRate;
+      QFile *container;
+      qint64 totalSize;
+      qint64 offset;
+    };
+    QList<ModelTransfer> modelTransfers;
     QMutex sendingMutex;
     QMutex recognitionInitializationMutex;
 
@@ -68,6 +84,11 @@ class ClientSocket : public QSslSocket
     void send(qint32 requestId, const QByteArray& data, bool includeLength=true);
     void sendCode(Simond::Request code);
 
+    void requestModel(Simond::Request request, qint64 offset);
+    PartialModel::Status receiveModelChunk(PartialModel& part, Simond::Request resumeRequest,
+                                           const QDateTime& changedDate, qint64 totalSize,
+                                           qint64 offset, const QByteArray& chunk);
+
   public slots:
     void sendRecognitionResult(const QString& fileName, const RecognitionResultList& recognitionResults);
 
@@ -80,9 +101,10 @@ class ClientSocket : public QSslSocket
     void processRequest();
     void slotSocketError();
 
-    bool sendModel(Simond::Request request, const QDateTime& changedTime, Model *m);
-    bool sendActiveModel();
-    bool sendBaseModel();
+    bool sendModel(Simond::Request request, const QDateTime& changedTime, Model *m, qint64 offset=0);
+    void sendModelChunks();
+    bool sendActiveModel(qint64 offset=0);
+    bool sendBaseModel(qint64 offset=0);
 
     void recognitionReady();
     void recognitionError(const QString& error, const QByteArray& log);
@@ -52,43 +52,37 @@
 #include <KTar>
 #include <locale.h>
 
-JuliusControl::JuliusControl(const QString& username, QObject* parent) : RecognitionControl(username, RecognitionControl::HTK, parent)
+JuliusControl::JuliusControl(const QString& username, ModelRegistry *modelRegistry, QObject* parent) :
+  RecognitionControl(username, RecognitionControl::HTK, modelRegistry, parent)
 {
-  recog = new JuliusRecognizer();
+  recog = createRecognizer();
 }
 
-bool JuliusControl::initializeRecognition(const QString& modelPath)
+Recognizer* JuliusControl::createRecognizer()
 {
-  if (modelPath != m_lastModel) { //already initialized / tried to initialize with this exact model
-  
-    kDebug() << "Initializing for model: " << modelPath << " old model path: " << m_lastModel;
-    m_lastModel = modelPath;
-    uninitialize();
-    m_startRequests = 0;
-
-    QString path = KStandardDirs::locateLocal("tmp", "/simond/"+username+"/julius/");
-    if (QFile::exists(path+"hmmdefs") && !QFile::remove(path+"hmmdefs")) return false;
-    if (QFile::exists(path+"tiedlist") && !QFile::remove(path+"tiedlist")) return false;
-    if (QFile::exists(path+"model.dfa") && !QFile::remove(path+"model.dfa")) return false;
-    if (QFile::exists(path+"model.dict") && !QFile::remove(path+"model.dict")) return false;
-    if (QFile::exists(path+"julius.jconf") && !QFile::remove(path+"julius.jconf")) return false;
-
-    if (!FileUtils::unpackAll(modelPath, path))//, (QStringList() << "hmmdefs" << "tiedlist" << "macros" << "stats")
-      return false;
-  }
+  return new JuliusRecognizer();
+}
 
-  kDebug() << "Emitting recognition ready";
-  emit recognitionReady();
-  return true;
+bool JuliusControl::prepareModel(ModelFiles& model)
+{
+  QString path = model.workingDir;
+  if (QFile::exists(path+"model.dfa") && !QFile::remove(path+"model.dfa")) return false;
+  if (QFile::exists(path+"model.dict") && !QFile::remove(path+"model.dict")) return false;
+  if (QFile::exists(path+"julius.jconf") && !QFile::remove(path+"julius.jconf")) return false;
+
+  //the acoustic model is the same for every user of a base model
+  if (!acquireAcousticModel(model, QStringList() << "hmmdefs" << "tiedlist"))
+    return false;
+  return FileUtils::unpack(model.path, path, QStringList() << "model.dfa" << "model.dict" << "julius.jconf");
 }
 
-RecognitionConfiguration* JuliusControl::setupConfig()
+RecognitionConfiguration* JuliusControl::setupConfig(const ModelFiles& model)
 {
-  QByteArray dirPath = KStandardDirs::locateLocal("tmp", "/simond/"+username+"/julius/").toUtf8();
+  QByteArray dirPath = model.workingDir.toUtf8();
   QByteArray jConfPath = dirPath+"julius.jconf";
   QByteArray gram = dirPath+"model";
-  QByteArray tiedList = dirPath+"tiedlist";
-  QByteArray hmmDefs = dirPath+"hmmdefs";
+  QByteArray tiedList = (model.acousticModelPath+"tiedlist").toUtf8();
+  QByteArray hmmDefs = (model.acousticModelPath+"hmmdefs").toUtf8();
 
   return new JuliusRecognitionConfiguration(jConfPath, gram, hmmDefs, tiedList);
 }
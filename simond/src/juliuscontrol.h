@@ -56,15 +56,15 @@ class JuliusControl : public RecognitionControl
 Q_OBJECT
 
 public:
-  explicit JuliusControl(const QString& username, QObject *parent=0);
-
-  bool initializeRecognition(const QString& modelPath);
+  explicit JuliusControl(const QString& username, ModelRegistry *modelRegistry, QObject *parent=0);
 
   ~JuliusControl();
 
 protected:
+  bool prepareModel(ModelFiles& model);
+  Recognizer* createRecognizer();
 
-  RecognitionConfiguration* setupConfig();
+  RecognitionConfiguration* setupConfig(const ModelFiles& model);
   void emitError(const QString& error);
 
 private:
@@ -0,0 +1,157 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "modelregistry.h"
+#include <simonutils/modelcontainer.h>
+#include <simonutils/fileutils.h>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QUuid>
+#include <QCryptographicHash>
+#include <KStandardDirs>
+#include <KDebug>
+
+/**
+ * Hashes everything written to the file
+ */
+class HashingFile : public QFile
+{
+public:
+  HashingFile(const QString& path, QCryptographicHash *hash) : QFile(path), m_hash(hash) {}
+
+protected:
+  qint64 writeData(const char *data, qint64 len)
+  {
+    qint64 written = QFile::writeData(data, len);
+    if (written > 0)
+      m_hash->addData(data, (int) written);
+    return written;
+  }
+
+private:
+  QCryptographicHash *m_hash;
+};
+
+ModelRegistry::ModelRegistry() :
+  m_root(KStandardDirs::locateLocal("tmp", "simond/shared/"))
+{
+}
+
+QString ModelRegistry::containerKey(const QString& containerPath, const QStringList& sortedFiles)
+{
+  QFileInfo info(containerPath);
+  return info.absoluteFilePath()+'\n'+QString::number(info.size())+'\n'+
+         info.lastModified().toString(Qt::ISODate)+'\n'+sortedFiles.join("\n");
+}
+
+QString ModelRegistry::acquire(const QString& containerPath, const QStringList& files)
+{
+  QStringList sortedFiles = files;
+  sortedFiles.sort();
+  QString unpackedKey = containerKey(containerPath, sortedFiles);
+
+  {
+    QMutexLocker l(&m_modelsLock);
+    QHash<QString, QString>::const_iterator known = m_containers.constFind(unpackedKey);
+    if (known != m_containers.constEnd()) {
+      QHash<QString, SharedModel>::iterator model = m_models.find(*known);
+      if (model != m_models.end()) {
+        kDebug() << "Sharing acoustic model " << *known << " without unpacking";
+        ++model->references;
+        return model->path;
+      }
+    }
+  }
+
+  ModelContainer container(containerPath);
+  if (!container.open(QIODevice::ReadOnly))
+    return QString();
+
+  //unpack to a private folder while hashing the files
+  QString staging = m_root+"staging-"+QUuid::createUuid().toString()+'/';
+  if (!QDir().mkpath(staging))
+    return QString();
+
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  foreach (const QString& file, sortedFiles) {
+    hash.addData(file.toUtf8());
+    HashingFile f(staging+file, &hash);
+    if (!f.open(QIODevice::WriteOnly) || !container.copyTo(file, &f)) {
+      kWarning() << "Failed to unpack " << file << " of " << containerPath;
+      f.close();
+      FileUtils::removeDirRecursive(staging);
+      return QString();
+    }
+  }
+  QString key = hash.result().toHex();
+
+  QMutexLocker l(&m_modelsLock);
+  m_containers.insert(unpackedKey, key);
+  QHash<QString, SharedModel>::iterator model = m_models.find(key);
+  if (model != m_models.end()) {
+    kDebug() << "Sharing acoustic model " << key;
+    FileUtils::removeDirRecursive(staging);
+    ++model->references;
+    return model->path;
+  }
+
+  //content addressed: A folder left over from an earlier run is just as good
+  QString path = m_root+key+'/';
+  if (QFile::exists(path))
+    FileUtils::removeDirRecursive(staging);
+  else if (!QDir().rename(staging, path)) {
+    FileUtils::removeDirRecursive(staging);
+    return QString();
+  }
+
+  kDebug() << "Registered acoustic model " << key;
+  SharedModel shared;
+  shared.path = path;
+  shared.references = 1;
+  m_models.insert(key, shared);
+  return path;
+}
+
+void ModelRegistry::release(const QString& path)
+{
+  QMutexLocker l(&m_modelsLock);
+  for (QHash<QString, SharedModel>::iterator i = m_models.begin(); i != m_models.end(); ++i) {
+    if (i->path != path)
+      continue;
+
+    if (--i->references == 0) {
+      kDebug() << "Dropping acoustic model " << i.key();
+      FileUtils::removeDirRecursive(path);
+      for (QHash<QString, QString>::iterator c = m_containers.begin(); c != m_containers.end();)
+        c = (*c == i.key()) ? m_containers.erase(c) : c + 1;
+      m_models.erase(i);
+    }
+    return;
+  }
+}
+
+ModelRegistry::~ModelRegistry()
+{
+  foreach (const SharedModel& model, m_models)
+    FileUtils::removeDirRecursive(model.path);
+}
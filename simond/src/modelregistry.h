@@ -0,0 +1,72 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef SIMON_MODELREGISTRY_H_935402259DD947DE83F5BFC5A2357838
+#define SIMON_MODELREGISTRY_H_935402259DD947DE83F5BFC5A2357838
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMutex>
+
+/**
+ * \class ModelRegistry
+ * \brief Acoustic models shared by all recognition controls
+ *
+ * Every acoustic model is unpacked once per content (SHA1 over the names
+ * and contents of its files) into a read only folder. Containers that were
+ * seen before (same path, size and modification date) are not unpacked
+ * again. Recognition controls of different users (or isolated controls of
+ * the same user) that use the same acoustic model reference the same files;
+ * Decoders that map their model files into memory share those pages.
+ *
+ * Thread safe: Models are also prepared for recognizers that are set up in
+ * the background.
+ */
+class ModelRegistry
+{
+public:
+  ModelRegistry();
+  ~ModelRegistry();
+
+  /**
+   * Provides the given files of the model container.
+   * \return The folder containing the files or a null string on error;
+   *         Release it when it's no longer used.
+   */
+  QString acquire(const QString& containerPath, const QStringList& files);
+  void release(const QString& path);
+
+private:
+  struct SharedModel {
+    QString path;
+    int references;
+  };
+
+  QString m_root;
+  QMutex m_modelsLock;
+  QHash<QString, SharedModel> m_models;
+  //container (path, size, date and requested files) -> content hash
+  QHash<QString, QString> m_containers;
+
+  static QString containerKey(const QString& containerPath, const QStringList& sortedFiles);
+};
+
+#endif
@@ -19,15 +19,23 @@
  */
 
 #include "recognitioncontrol.h"
+#include "modelregistry.h"
 #include <KDateTime>
 #include <KDebug>
 #include <KLocalizedString>
+#include <KStandardDirs>
 
 #include <simonrecognizer/recognitionconfiguration.h>
+#include <simonlogging/logger.h>
 
-RecognitionControl::RecognitionControl(const QString& user_name, RecognitionControl::BackendType type, QObject* parent) : QThread(parent),
+#include <QtConcurrentRun>
+
+RecognitionControl::RecognitionControl(const QString& user_name, RecognitionControl::BackendType type, ModelRegistry *modelRegistry, QObject* parent) : QThread(parent),
   m_refCounter(0),
   m_type(type),
+  m_modelRegistry(modelRegistry),
+  m_standby(0),
+  m_batchReported(0),
   username(user_name),
   m_startRequests(0),
   m_initialized(false),
@@ -35,6 +43,142 @@ RecognitionControl::RecognitionControl(const QString& user_name, RecognitionCont
   shouldBeRunning(false),
   recog(0)
 {
+  m_model.workingDir = workingDir("a");
+}
+
+QString RecognitionControl::workingDir(const QString& slot) const
+{
+  return KStandardDirs::locateLocal("tmp", "/simond/"+username+'/'+
+                                    ((m_type == HTK) ? "julius" : "sphinx")+'/'+slot+'/');
+}
+
+bool RecognitionControl::initializeRecognition(const QString& modelPath)
+{
+  QMutexLocker l(&m_standbyLock);
+  if (modelPath != m_lastModel) { //already initialized / tried to initialize with this exact model
+    kDebug() << "Initializing for model: " << modelPath << " old model path: " << m_lastModel;
+    m_lastModel = modelPath;
+
+    if (shouldBeRunning && m_initialized) {
+      //the running recognizer keeps going until the new one is ready (see run())
+      kDebug() << "Preparing recognizer in the background";
+      m_pendingModel = modelPath;
+      m_swapTimer.start();
+      return true;
+    }
+    l.unlock();
+
+    uninitialize();
+    m_startRequests = 0;
+
+    m_model.path = modelPath;
+    if (!prepareModel(m_model)) {
+      emitError(i18n("Failed to prepare the model \"%1\"", modelPath));
+      return false;
+    }
+  }
+
+  kDebug() << "Emitting recognition ready";
+  emit recognitionReady();
+  return true;
+}
+
+bool RecognitionControl::initializeStandby()
+{
+  if (!prepareModel(m_standbyModel)) {
+    m_standbyError = i18n("Failed to prepare the model \"%1\"", m_standbyModel.path);
+    return false;
+  }
+
+  RecognitionConfiguration *cfg = setupConfig(m_standbyModel);
+  bool success = m_standby->init(cfg);
+  delete cfg;
+  if (!success)
+    m_standbyError = m_standby->getLastError();
+  return success;
+}
+
+void RecognitionControl::startStandby()
+{
+  QMutexLocker l(&m_standbyLock);
+  if (m_pendingModel.isNull() || m_standby)
+    return;
+
+  //the standby gets the working folder the running recognizer doesn't use;
+  //wait until the one retired before is done with it
+  foreach (const QFuture<void>& retiring, m_retiring.futures())
+    if (!retiring.isFinished())
+      return;
+  m_retiring.clearFutures();
+
+  m_standbyModel = ModelFiles();
+  m_standbyModel.path = m_pendingModel;
+  m_standbyModel.workingDir = workingDir((m_model.workingDir == workingDir("a")) ? "b" : "a");
+  m_standby = createRecognizer();
+  m_standbyInitialization = QtConcurrent::run(this, &RecognitionControl::initializeStandby);
+  m_pendingModel = QString();
+}
+
+bool RecognitionControl::swapStandby()
+{
+  QMutexLocker l(&m_standbyLock);
+  if (!m_standby || !m_standbyInitialization.isFinished())
+    return false;
+
+  if (m_standbyInitialization.result()) {
+    //the old recognizer might take a while to shut down (julius waits for its process)
+    m_retiring.addFuture(QtConcurrent::run(this, &RecognitionControl::retireRecognizer,
+                                           recog, m_model.acousticModelPath));
+    recog = m_standby;
+    m_model = m_standbyModel;
+    QMetaObject::invokeMethod(this, "standbySwapped", Qt::QueuedConnection, Q_ARG(int, m_swapTimer.elapsed()));
+  } else {
+    emit recognitionWarning(i18n("Failed to switch to the new model; Keeping the previous one.\n\n%1", m_standbyError));
+    delete m_standby;
+    releaseAcousticModel(m_standbyModel);
+    //unless an even newer model is waiting, the next request for the failed one should try again
+    if (m_pendingModel.isNull())
+      m_lastModel = m_model.path;
+  }
+  m_standby = 0;
+  return true;
+}
+
+/**
+ * Called in the thread of the recognition control once the recognizer for the
+ * new model took over
+ */
+void RecognitionControl::standbySwapped(int latency)
+{
+  Logger::log(i18n("Switched recognition of \"%1\" to the new model %2 ms after it changed", username, latency),
+              Logger::Info, "simond");
+
+  //as after any initialization, clients start over with the new model
+  m_startRequests = 0;
+  kDebug() << "Emitting recognition ready";
+  emit recognitionReady();
+}
+
+void RecognitionControl::discardStandby()
+{
+  QMutexLocker l(&m_standbyLock);
+  m_pendingModel = QString();
+  if (m_standby) {
+    m_standbyInitialization.waitForFinished();
+    delete m_standby;
+    m_standby = 0;
+    releaseAcousticModel(m_standbyModel);
+  }
+  m_retiring.waitForFinished();
+  m_retiring.clearFutures();
+}
+
+void RecognitionControl::retireRecognizer(Recognizer *recognizer, const QString& acousticModelPath)
+{
+  recognizer->uninitialize();
+  delete recognizer;
+  if (!acousticModelPath.isNull())
+    m_modelRegistry->release(acousticModelPath);
 }
 
 bool RecognitionControl::isEmpty() const
@@ -60,6 +204,7 @@ bool RecognitionControl::recognitionRunning()
 
 QByteArray RecognitionControl::getBuildLog()
 {
+  QMutexLocker l(&m_standbyLock);
   return "<html><head /><body><p>"+recog->getLog().replace('\n', "<br />")+"</p></body></html>";
 }
 
@@ -89,7 +234,7 @@ void RecognitionControl::run()
 {
   Q_ASSERT(recog);
 
-  RecognitionConfiguration *cfg = setupConfig();
+  RecognitionConfiguration *cfg = setupConfig(m_model);
   bool success = recog->init(cfg);
   delete cfg;
   if (!success) {
@@ -101,20 +246,38 @@ void RecognitionControl::run()
 
   while (shouldBeRunning)
   {
+    startStandby();
+
     if (!queueLock.tryLock(500)) continue;
-    QString file;
-    if (!toRecognize.isEmpty())
-      file = toRecognize.dequeue();
+    //hand everything that queued up to the recognizer in one batch
+    QStringList files;
+    while (!toRecognize.isEmpty())
+      files << toRecognize.dequeue();
     queueLock.unlock();
-    if (file.isNull()) {
-      QThread::msleep(100);
+    if (files.isEmpty()) {
+      //swap only once the old recognizer drained everything that was queued for it
+      if (!swapStandby())
+        QThread::msleep(100);
     } else {
-      emit recognitionResult(file, recog->recognize(file));
-      emit recognitionDone(file);
+      m_batchReported = 0;
+      recog->recognizeBatch(files, this);
+      //aborted or failed: the client still waits for every file
+      for (int i = m_batchReported; i < files.count(); ++i) {
+        emit recognitionResult(files[i], RecognitionResultList());
+        emit recognitionDone(files[i]);
+      }
     }
   }
 }
 
+bool RecognitionControl::batchResult(int index, const QString& file, const QList<RecognitionResult>& results)
+{
+  m_batchReported = index + 1;
+  emit recognitionResult(file, results);
+  emit recognitionDone(file);
+  return shouldBeRunning;
+}
+
 bool RecognitionControl::startRecognitionInternal()
 {
   shouldBeRunning=true;
@@ -128,7 +291,10 @@ bool RecognitionControl::stopInternal()
 {
   shouldBeRunning=false;
 
-  if (!isRunning()) return true;
+  if (!isRunning()) {
+    discardStandby();
+    return true;
+  }
 
   if (!wait(1000)) {
     while (isRunning()) {
@@ -137,6 +303,7 @@ bool RecognitionControl::stopInternal()
       wait(500);
     }
   }
+  discardStandby();
   m_lastModel = QString();
 
   return true;
@@ -153,12 +320,31 @@ void RecognitionControl::uninitialize()
 {
   kDebug() << "Uninitializing recognition control";
   shouldBeRunning = false;
+  m_standbyLock.lock();
   recog->uninitialize();
+  m_standbyLock.unlock();
   stopInternal();
+  releaseAcousticModel(m_model);
 
   m_initialized=false;
 }
 
+bool RecognitionControl::acquireAcousticModel(ModelFiles& model, const QStringList& files)
+{
+  QString path = m_modelRegistry->acquire(model.path, files);
+  releaseAcousticModel(model);
+  model.acousticModelPath = path;
+  return !path.isNull();
+}
+
+void RecognitionControl::releaseAcousticModel(ModelFiles& model)
+{
+  if (model.acousticModelPath.isNull())
+    return;
+  m_modelRegistry->release(model.acousticModelPath);
+  model.acousticModelPath = QString();
+}
+
 bool RecognitionControl::stop()
 {
   kDebug() << "Stopping recognition" << m_startRequests;
@@ -31,6 +31,12 @@
 #include <QMetaType>
 #include <QMutex>
 #include <QQueue>
+#include <QStringList>
+#include <QFuture>
+#include <QFutureSynchronizer>
+#include <QTime>
+
+class ModelRegistry;
 
 /*!
  * \class RecognitionControl
@@ -41,7 +47,7 @@
  *  \date 15.08.2012
  *  \author Vladislav Sitalo
  */
-class RecognitionControl : public QThread
+class RecognitionControl : public QThread, public RecognitionResultCallback
 {
   Q_OBJECT
 
@@ -62,9 +68,16 @@ class RecognitionControl : public QThread
       HTK = 1,
       SPHINX = 2
     };
-    explicit RecognitionControl(const QString& username, BackendType type, QObject *parent=0);
-
-    virtual bool initializeRecognition(const QString& modelPath)=0;
+    explicit RecognitionControl(const QString& username, BackendType type, ModelRegistry *modelRegistry, QObject *parent=0);
+
+    /**
+     * Switches to the given model. If recognition is running, the new
+     * recognizer is set up in the background and replaces the current one
+     * once it is ready; Recognition continues with the old model until then.
+     *
+     * recognitionReady() is emitted once the given model is in use.
+     */
+    virtual bool initializeRecognition(const QString& modelPath);
     virtual bool isInitialized() { return m_initialized; }
 
     virtual bool startRecognition();
@@ -78,6 +91,8 @@ class RecognitionControl : public QThread
      */
     virtual void recognize(const QString& fileName);
 
+    bool batchResult(int index, const QString& file, const QList<RecognitionResult>& results);
+
     bool recognitionRunning();
 
     void pop();
@@ -89,12 +104,48 @@ class RecognitionControl : public QThread
 
     ~RecognitionControl();
 
+  protected:
+    /**
+     * The files a recognizer is set up from; The running recognizer and the
+     * one prepared in the background each have their own working folder.
+     */
+    struct ModelFiles {
+      QString path;
+      QString workingDir;
+      QString acousticModelPath;
+      QString name;
+    };
+
   private:
     int m_refCounter;
     BackendType m_type;
+    ModelRegistry *m_modelRegistry;
+
+    //guards recog, m_model and m_lastModel against the background swap
+    QMutex m_standbyLock;
+    QString m_pendingModel;
+    Recognizer *m_standby;
+    ModelFiles m_standbyModel;
+    QFuture<bool> m_standbyInitialization;
+    QString m_standbyError;
+    QTime m_swapTimer;
+    QFutureSynchronizer<void> m_retiring;
+
+    int m_batchReported;
+
+    QString workingDir(const QString& slot) const;
+    bool initializeStandby();
+    void startStandby();
+    bool swapStandby();
+    void discardStandby();
+    void retireRecognizer(Recognizer *recognizer, const QString& acousticModelPath);
+
+  private slots:
+    void standbySwapped(int latency);
 
   protected:
     QString m_lastModel;
+    ModelFiles m_model;
 
   protected:
     QString username;
@@ -115,9 +166,23 @@ class RecognitionControl : public QThread
     virtual void uninitialize();
     virtual bool startRecognitionInternal();
 
+    /**
+     * Points model.acousticModelPath to the shared copy of the given files
+     * of the model container.
+     */
+    bool acquireAcousticModel(ModelFiles& model, const QStringList& files);
+    void releaseAcousticModel(ModelFiles& model);
+
     void run();
 
-    virtual RecognitionConfiguration* setupConfig()=0;
+    /**
+     * Provides the files of model.path in model.workingDir for
+     * setupConfig(); Called from a background thread when swapping models
+     * during recognition, so it must only touch the given model.
+     */
+    virtual bool prepareModel(ModelFiles& model)=0;
+    virtual Recognizer* createRecognizer()=0;
+    virtual RecognitionConfiguration* setupConfig(const ModelFiles& model)=0;
     virtual void emitError(const QString& error)=0;
 
     Recognizer *recog;
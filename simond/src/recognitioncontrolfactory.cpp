@@ -56,13 +56,13 @@ RecognitionControl* RecognitionControlFactory::recognitionControl(const QString&
     if(type == RecognitionControl::SPHINX)
     {
       #ifdef BACKEND_TYPE_BOTH
-        r = new SphinxControl(user);
+        r = new SphinxControl(user, &m_modelRegistry);
       #else
         return 0;
       #endif
     }
     else if(type == RecognitionControl::HTK)
-      r = new JuliusControl(user);
+      r = new JuliusControl(user, &m_modelRegistry);
     else
       return 0;
 
@@ -25,6 +25,7 @@
 #include <QHash>
 #include <QString>
 #include "recognitioncontrol.h"
+#include "modelregistry.h"
 
 class ModelIdentifier {
 public:
@@ -47,6 +48,7 @@ public:
 private:
   QMultiHash<ModelIdentifier, RecognitionControl*> m_recognitionControls;
   bool m_isolatedMode;
+  ModelRegistry m_modelRegistry;
 };
 
 uint qHash(const ModelIdentifier& identifier);
@@ -18,7 +18,8 @@
  */
 
 #include "sphinxcontrol.h"
-#include <simonscenarios/modelmetadata.h>
+#include <simonscenarios/model.h>
+#include <simonutils/modelcontainer.h>
 #include <simonutils/fileutils.h>
 #include <simonrecognizer/sphinxrecognitionconfiguration.h>
 #include <simonrecognizer/sphinxrecognizer.h>
@@ -29,62 +30,58 @@
 #include <KLocalizedString>
 
 
-SphinxControl::SphinxControl(const QString& username, QObject* parent) : RecognitionControl(username, RecognitionControl::SPHINX, parent)
+SphinxControl::SphinxControl(const QString& username, ModelRegistry *modelRegistry, QObject* parent) :
+  RecognitionControl(username, RecognitionControl::SPHINX, modelRegistry, parent)
 {
-  recog = new SphinxRecognizer();
+  recog = createRecognizer();
 }
 
-bool SphinxControl::initializeRecognition(const QString &modelPath)
+Recognizer* SphinxControl::createRecognizer()
 {
-  kDebug() << "Initializing to " << modelPath << m_lastModel;
-  if (modelPath != m_lastModel) { //already initialized / tried to initialize with this exact model
-    m_lastModel = modelPath;
-    kDebug() << "Initializing";
-    uninitialize();
-    m_startRequests = 0;
+  return new SphinxRecognizer();
+}
 
-    QString path = KStandardDirs::locateLocal("tmp", "/simond/"+username+"/sphinx/");
-    if(!QDir(path).entryInfoList(QDir::NoDotAndDotDot | QDir::System | QDir::Hidden  | QDir::AllDirs | QDir::Files, QDir::DirsFirst).isEmpty())
-    {
-      kDebug() << "Removing old data from working dir";
-      FileUtils::removeDirRecursive(path);
-      path = KStandardDirs::locateLocal("tmp", "/simond/"+username+"/sphinx/");
-    }
+bool SphinxControl::prepareModel(ModelFiles& model)
+{
+  QString path = model.workingDir;
+  if(!QDir(path).entryInfoList(QDir::NoDotAndDotDot | QDir::System | QDir::Hidden  | QDir::AllDirs | QDir::Files, QDir::DirsFirst).isEmpty())
+  {
+    kDebug() << "Removing old data from working dir";
+    FileUtils::removeDirRecursive(path);
+    QDir().mkpath(path);
+  }
 
-    kDebug() << "Unpacking model to working dir";
-    if (!FileUtils::unpackAll(modelPath, path))
-    {
-      return false;
-    }
+  QDateTime creationDate;
+  QString type;
+  if (!Model::parseContainer(model.path, creationDate, model.name, type))
+  {
+    kWarning() << "Failed to read metadata from " << model.path;
+    return false;
+  }
 
-    QFile metadataFile(path+QLatin1String("metadata.xml"));
-    if(!metadataFile.open(QIODevice::ReadOnly))
-    {
-      emit recognitionError(i18n("Failed to read metadata from \"%1\"", path+QLatin1String("metadata.xml")),
-                            getBuildLog());
-      return NULL;
-    }
-    ModelMetadata metadata;
-    QDomDocument DomDocument;
-    DomDocument.setContent(&metadataFile);
-    metadata.deserializeXml(DomDocument.documentElement());
+  QStringList languageModel;
+  languageModel << model.name+QLatin1String(".jsgf") << model.name+QLatin1String(".dic");
 
-    metadataFile.close();
+  ModelContainer container(model.path);
+  if (!container.open(QIODevice::ReadOnly))
+    return false;
+  QStringList acousticModel = container.entries();
+  container.close();
+  acousticModel.removeAll(QLatin1String("metadata.xml"));
+  foreach (const QString& file, languageModel)
+    acousticModel.removeAll(file);
 
-    modelName = metadata.name();
-  }
-  kDebug() << "Emitting recognition ready";
-  emit recognitionReady();
-  return true;
+  kDebug() << "Unpacking model to working dir";
+  return acquireAcousticModel(model, acousticModel) && FileUtils::unpack(model.path, path, languageModel);
 }
 
-RecognitionConfiguration *SphinxControl::setupConfig()
+RecognitionConfiguration *SphinxControl::setupConfig(const ModelFiles& model)
 {
   kDebug() << "Setting config up";
-  QString dirPath = KStandardDirs::locateLocal("tmp", "/simond/"+username+"/sphinx/");
+  QString dirPath = model.workingDir;
 
-  return new SphinxRecognitionConfiguration(dirPath, dirPath+modelName+QLatin1String(".jsgf"),
-                                            dirPath+modelName+QLatin1String(".dic"), DEFAULT_SAMPRATE);
+  return new SphinxRecognitionConfiguration(model.acousticModelPath, dirPath+model.name+QLatin1String(".jsgf"),
+                                            dirPath+model.name+QLatin1String(".dic"), DEFAULT_SAMPRATE);
 }
 
 void SphinxControl::emitError(const QString &error)
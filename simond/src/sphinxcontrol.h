@@ -27,14 +27,13 @@ class SphinxControl : public RecognitionControl
 {
 Q_OBJECT
 public:
-  SphinxControl(const QString &username, QObject *parent = 0);
-
-  bool initializeRecognition(const QString& modelPath);
+  SphinxControl(const QString &username, ModelRegistry *modelRegistry, QObject *parent = 0);
 
 protected:
-  RecognitionConfiguration* setupConfig();
+  bool prepareModel(ModelFiles& model);
+  Recognizer* createRecognizer();
+  RecognitionConfiguration* setupConfig(const ModelFiles& model);
   void emitError(const QString& error);
-  QString modelName;
 };
 
 #endif // SPHINXCONTROL_H
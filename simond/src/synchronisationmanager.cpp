@@ -144,14 +144,19 @@ Model* SynchronisationManager::getActiveModel()
   sampleRate = cGroup.readEntry("SampleRate").toInt(&ok);
   if (!ok) return 0;
 
-  QFile containerFile(dirPath+"active.sbm");
-
-  if (!containerFile.open(QIODevice::ReadOnly)) {
+  QString containerPath = getActiveModelPath();
+  if (!QFile::exists(containerPath)) {
     kDebug() << "Failed to gather active model";
     return 0;
   }
 
-  return new Model(sampleRate, containerFile.readAll());
+  return new Model(sampleRate, containerPath);
+}
+
+
+QString SynchronisationManager::getActiveModelPath()
+{
+  return KStandardDirs::locateLocal("appdata", "models/"+username+"/active/active.sbm");
 }
 
 
@@ -165,18 +170,17 @@ QDateTime SynchronisationManager::getActiveModelDate()
 }
 
 
-bool SynchronisationManager::storeActiveModel(const QDateTime& changedDate, qint32 sampleRate, const QByteArray& container)
+bool SynchronisationManager::storeActiveModel(const QDateTime& changedDate, qint32 sampleRate, const QString& containerPath)
 {
   if (username.isEmpty()) return false;
 
   QString dirPath = KStandardDirs::locateLocal("appdata", "models/"+username+"/active/");
-  QFile containerFile(dirPath+"active.sbm");
-
-  if (!containerFile.open(QIODevice::WriteOnly))
-    return false;
-
-  containerFile.write(container);
-  containerFile.close();
+  QString activePath = getActiveModelPath();
+  if (containerPath != activePath) {
+    QFile::remove(activePath);
+    if (!QFile::rename(containerPath, activePath))
+      return false;
+  }
 
   KConfig config( dirPath+"activerc", KConfig::SimpleConfig );
   KConfigGroup cGroup(&config, "");
@@ -229,14 +233,13 @@ Model* SynchronisationManager::getBaseModel()
   qint32 baseModelType = cGroup.readEntry("BaseModelType").toInt(&ok);
   if (!ok) return 0;
 
-  QFile containerFile(getBaseModelPath());
-
-  if (!containerFile.open(QIODevice::ReadOnly)) {
+  QString containerPath = getBaseModelPath();
+  if (!QFile::exists(containerPath)) {
     kDebug() << "Failed to gather base model";
     return 0;
   }
 
-  return new Model(baseModelType, containerFile.readAll());
+  return new Model(baseModelType, containerPath);
 }
 
 
@@ -269,18 +272,17 @@ int SynchronisationManager::getBaseModelType()
 
 
 bool SynchronisationManager::storeBaseModel(const QDateTime& changedDate, int modelType,
-                                            const QByteArray& container)
+                                            const QString& containerPath)
 {
   if (username.isEmpty()) return false;
 
   QString dirPath = KStandardDirs::locateLocal("appdata", "models/"+username+"/active/");
-  QFile containerFile(dirPath+"base.sbm");
-
-  if (!containerFile.open(QIODevice::WriteOnly))
-    return false;
-
-  containerFile.write(container);
-  containerFile.close();
+  QString basePath = getBaseModelPath();
+  if (containerPath != basePath) {
+    QFile::remove(basePath);
+    if (!QFile::rename(containerPath, basePath))
+      return false;
+  }
 
   KConfig config( dirPath+"activerc", KConfig::SimpleConfig );
   KConfigGroup cGroup(&config, "");
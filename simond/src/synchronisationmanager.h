@@ -61,16 +61,17 @@ class SynchronisationManager : public QObject
     QMap<QDateTime, QString> getModels();
 
     Model* getActiveModel();
+    QString getActiveModelPath();
     bool hasActiveModel();
     QDateTime getActiveModelDate();
     void setActiveModelSampleRate(int activeModelSampleRate);
-    bool storeActiveModel(const QDateTime& changedDate, qint32 sampleRate, const QByteArray& container);
+    bool storeActiveModel(const QDateTime& changedDate, qint32 sampleRate, const QString& containerPath);
 
     QDateTime getBaseModelDate();
     Model* getBaseModel();
     QString getBaseModelPath();
     int getBaseModelType();
-    bool storeBaseModel(const QDateTime& changedDate, int baseModelType, const QByteArray& container);
+    bool storeBaseModel(const QDateTime& changedDate, int baseModelType, const QString& containerPath);
 
     QDateTime getModelSrcDate();
     QDateTime getCompileModelSrcDate();
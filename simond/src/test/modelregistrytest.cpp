@@ -0,0 +1,160 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "../modelregistry.h"
+#include <simonutils/fileutils.h>
+
+#include <QTest>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <qtest_kde.h>
+
+/**
+ * Two users with the same acoustic model in their (otherwise different)
+ * model containers
+ */
+class testModelRegistry: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void init();
+    void cleanup();
+    void testShared();
+    void testReferences();
+    void testChangedContainer();
+    void testMissingFile();
+
+  private:
+    QString firstUser;
+    QString secondUser;
+    QStringList files;
+
+    static bool pack(const QString& path, const QByteArray& hmmdefs, const QByteArray& dict);
+    static QByteArray readFile(const QString& path);
+};
+
+bool testModelRegistry::pack(const QString& path, const QByteArray& hmmdefs, const QByteArray& dict)
+{
+  QHash<QString, QByteArray> entries;
+  entries.insert("hmmdefs", hmmdefs);
+  entries.insert("tiedlist", "a\nb\n");
+  entries.insert("model.dict", dict);
+  QFile::remove(path);
+  return FileUtils::pack(path, entries, QHash<QString, QString>());
+}
+
+QByteArray testModelRegistry::readFile(const QString& path)
+{
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly))
+    return QByteArray();
+  return f.readAll();
+}
+
+void testModelRegistry::init()
+{
+  firstUser = QDir::temp().filePath("simond_modelregistrytest_first.sbm");
+  secondUser = QDir::temp().filePath("simond_modelregistrytest_second.sbm");
+  files = QStringList() << "tiedlist" << "hmmdefs";
+  QVERIFY(pack(firstUser, "~h \"a\"\n", "first\n"));
+  QVERIFY(pack(secondUser, "~h \"a\"\n", "second\n"));
+}
+
+void testModelRegistry::cleanup()
+{
+  QFile::remove(firstUser);
+  QFile::remove(secondUser);
+}
+
+void testModelRegistry::testShared()
+{
+  ModelRegistry registry;
+  QString first = registry.acquire(firstUser, files);
+  QVERIFY(!first.isNull());
+  QCOMPARE(readFile(first+"hmmdefs"), QByteArray("~h \"a\"\n"));
+  QCOMPARE(readFile(first+"tiedlist"), QByteArray("a\nb\n"));
+  //only what was asked for
+  QVERIFY(!QFile::exists(first+"model.dict"));
+
+  QCOMPARE(registry.acquire(secondUser, files), first);
+  //the order of the files doesn't matter
+  QCOMPARE(registry.acquire(secondUser, QStringList() << "hmmdefs" << "tiedlist"), first);
+
+  //a different acoustic model
+  QVERIFY(pack(secondUser, "~h \"other\"\n", "second\n"));
+  QString second = registry.acquire(secondUser, files);
+  QVERIFY(!second.isNull());
+  QVERIFY(second != first);
+  QCOMPARE(readFile(second+"hmmdefs"), QByteArray("~h \"other\"\n"));
+  QCOMPARE(readFile(first+"hmmdefs"), QByteArray("~h \"a\"\n"));
+}
+
+void testModelRegistry::testReferences()
+{
+  ModelRegistry registry;
+  QString path = registry.acquire(firstUser, files);
+  QCOMPARE(registry.acquire(secondUser, files), path);
+
+  //the files stay as long as one of the users needs them
+  registry.release(path);
+  QVERIFY(QFile::exists(path+"hmmdefs"));
+  registry.release(path);
+  QVERIFY(!QFile::exists(path));
+
+  //unknown paths are ignored
+  registry.release(path);
+
+  //set up again once needed again
+  QCOMPARE(registry.acquire(secondUser, files), path);
+  QVERIFY(QFile::exists(path+"hmmdefs"));
+  registry.release(path);
+  QVERIFY(!QFile::exists(path));
+}
+
+void testModelRegistry::testChangedContainer()
+{
+  ModelRegistry registry;
+  QString path = registry.acquire(firstUser, files);
+  QCOMPARE(registry.acquire(firstUser, files), path);
+
+  //the container is unpacked again once it changed
+  QVERIFY(pack(firstUser, "~h \"changed\"\n", "first\n"));
+  QString changed = registry.acquire(firstUser, files);
+  QVERIFY(changed != path);
+  QCOMPARE(readFile(changed+"hmmdefs"), QByteArray("~h \"changed\"\n"));
+
+  registry.release(path);
+  registry.release(path);
+  QVERIFY(!QFile::exists(path));
+  registry.release(changed);
+  QVERIFY(!QFile::exists(changed));
+}
+
+void testModelRegistry::testMissingFile()
+{
+  ModelRegistry registry;
+  QVERIFY(registry.acquire(firstUser, QStringList() << "hmmdefs" << "missing").isNull());
+  QVERIFY(registry.acquire(QDir::temp().filePath("simond_modelregistrytest_none.sbm"), files).isNull());
+}
+
+QTEST_KDEMAIN(testModelRegistry, NoGUI)
+
+#include "modelregistrytest.moc"
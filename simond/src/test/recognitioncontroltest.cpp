@@ -0,0 +1,207 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "../recognitioncontrol.h"
+#include <simonrecognizer/recognitionconfiguration.h>
+
+#include <QTest>
+#include <QStringList>
+#include <qtest_kde.h>
+
+/**
+ * Configuration only carrying the name of the model it was set up for
+ */
+class StubConfiguration : public RecognitionConfiguration
+{
+  public:
+    explicit StubConfiguration(const QString& model) : m_model(model) {}
+    QStringList toArgs() { return QStringList() << m_model; }
+    QString model() const { return m_model; }
+
+  private:
+    QString m_model;
+};
+
+/**
+ * Recognizes every sample as the name of its model; Models called
+ * "unusable" can't be loaded
+ */
+class StubRecognizer : public Recognizer
+{
+  public:
+    bool init(RecognitionConfiguration* config) {
+      m_model = static_cast<StubConfiguration*>(config)->model();
+      if (m_model == "unusable") {
+        m_lastError = "Unusable model";
+        return false;
+      }
+      return true;
+    }
+    QList<RecognitionResult> recognize(const QString& file) {
+      Q_UNUSED(file);
+      return QList<RecognitionResult>() << RecognitionResult(m_model, QString(), QString(), QList<float>());
+    }
+    bool uninitialize() { return true; }
+
+  private:
+    QString m_model;
+};
+
+class StubControl : public RecognitionControl
+{
+  public:
+    explicit StubControl(const QString& username) : RecognitionControl(username, SPHINX, 0) {
+      recog = createRecognizer();
+    }
+    QString error;
+
+  protected:
+    bool prepareModel(ModelFiles& model) { Q_UNUSED(model); return true; }
+    Recognizer* createRecognizer() { return new StubRecognizer; }
+    RecognitionConfiguration* setupConfig(const ModelFiles& model) { return new StubConfiguration(model.path); }
+    void emitError(const QString& error) { this->error = error; }
+};
+
+/**
+ * Switches the model of a running recognition control and checks that
+ * recognition continues without interruption.
+ */
+class testRecognitionControl: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void initTestCase();
+    void testSwap();
+    void testFailedSwap();
+
+  public slots:
+    void recognitionResult(const QString& fileName, const RecognitionResultList& recognitionResults);
+    void recognitionReady();
+    void recognitionWarning(const QString& warning);
+
+  private:
+    QStringList results;
+    int readyCount;
+    QStringList warnings;
+
+    void start(StubControl& control, const QString& model);
+    QString recognize(StubControl& control);
+};
+
+void testRecognitionControl::initTestCase()
+{
+  qRegisterMetaType<RecognitionResultList>("RecognitionResultList");
+}
+
+void testRecognitionControl::recognitionResult(const QString& fileName, const RecognitionResultList& recognitionResults)
+{
+  Q_UNUSED(fileName);
+  results << (recognitionResults.isEmpty() ? QString() : recognitionResults.first().sentence());
+}
+
+void testRecognitionControl::recognitionReady()
+{
+  ++readyCount;
+}
+
+void testRecognitionControl::recognitionWarning(const QString& warning)
+{
+  warnings << warning;
+}
+
+void testRecognitionControl::start(StubControl& control, const QString& model)
+{
+  results.clear();
+  readyCount = 0;
+  warnings.clear();
+  connect(&control, SIGNAL(recognitionResult(QString,RecognitionResultList)),
+          this, SLOT(recognitionResult(QString,RecognitionResultList)));
+  connect(&control, SIGNAL(recognitionReady()), this, SLOT(recognitionReady()));
+  connect(&control, SIGNAL(recognitionWarning(QString)), this, SLOT(recognitionWarning(QString)));
+
+  QVERIFY(control.initializeRecognition(model));
+  QCOMPARE(readyCount, 1);
+  QVERIFY(control.startRecognition());
+  for (int i=0; (i < 100) && !control.isInitialized(); i++)
+    QTest::qWait(50);
+  QVERIFY(control.isInitialized());
+}
+
+/**
+ * \return The sentence the running recognizer reports for the next sample
+ */
+QString testRecognitionControl::recognize(StubControl& control)
+{
+  int count = results.count();
+  control.recognize("sample.wav");
+  for (int i=0; (i < 100) && (results.count() == count); i++)
+    QTest::qWait(50);
+  return (results.count() > count) ? results.last() : QString();
+}
+
+void testRecognitionControl::testSwap()
+{
+  StubControl control("testRecognitionControlSwap");
+  start(control, "first");
+  QCOMPARE(recognize(control), QString("first"));
+
+  //the old recognizer keeps going until the new one took over
+  QVERIFY(control.initializeRecognition("second"));
+  QCOMPARE(readyCount, 1);
+  for (int i=0; (i < 100) && (readyCount == 1); i++)
+    QTest::qWait(50);
+  QCOMPARE(readyCount, 2);
+  QCOMPARE(recognize(control), QString("second"));
+  QVERIFY(warnings.isEmpty());
+  QVERIFY(control.error.isEmpty());
+
+  //the model that is running already is not set up again
+  QVERIFY(control.initializeRecognition("second"));
+  QCOMPARE(readyCount, 3);
+  QCOMPARE(recognize(control), QString("second"));
+
+  QVERIFY(control.stop());
+}
+
+void testRecognitionControl::testFailedSwap()
+{
+  StubControl control("testRecognitionControlFailedSwap");
+  start(control, "first");
+
+  QVERIFY(control.initializeRecognition("unusable"));
+  for (int i=0; (i < 100) && warnings.isEmpty(); i++)
+    QTest::qWait(50);
+  QCOMPARE(warnings.count(), 1);
+  QCOMPARE(readyCount, 1);
+  QCOMPARE(recognize(control), QString("first"));
+
+  //asking for the failed model again tries again
+  QVERIFY(control.initializeRecognition("unusable"));
+  for (int i=0; (i < 100) && (warnings.count() == 1); i++)
+    QTest::qWait(50);
+  QCOMPARE(warnings.count(), 2);
+  QCOMPARE(recognize(control), QString("first"));
+
+  QVERIFY(control.stop());
+}
+
+QTEST_KDEMAIN(testRecognitionControl, NoGUI)
+
+#include "recognitioncontroltest.moc"
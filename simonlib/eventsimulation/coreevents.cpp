@@ -20,9 +20,11 @@
 #include "coreevents.h"
 #include "pressmode.h"
 #include <QKeySequence>
+#include <QString>
 
 CoreEvents::CoreEvents()
-: shiftSet(false),
+: keyDelay(5),
+shiftSet(false),
 altgrSet(false),
 altSet(false),
 superSet(false),
@@ -51,6 +53,53 @@ void CoreEvents::sendKey(unsigned int key /*unicode representation*/, EventSimul
 }
 
 
+/**
+ * \brief Types the given text
+ *
+ * Dead keys are resolved up front and the whole text is handed to the
+ * backend at once (see \ref sendKeysPrivate()).
+ *
+ * \author Peter Grasch
+ * @param text The text to type
+ */
+void CoreEvents::sendText(const QString& text)
+{
+  //held modifiers change the meaning of every key; type them one by one
+  if (shiftSet || altgrSet || altSet || superSet || strgSet || optionSet) {
+    for (int i=0; i < text.size(); i++)
+      sendKey(text.at(i).unicode(), (EventSimulation::PressMode)
+          (EventSimulation::Press|EventSimulation::Release));
+    return;
+  }
+
+  QList<unsigned int> keys;
+  for (int i=0; i < text.size(); i++) {
+    unsigned int key = text.at(i).unicode();
+    DeadKey* d = deadKeys.value(key);
+    if (d) {
+      keys << d->deadKey();
+      key = d->baseKey();
+    }
+    keys << key;
+  }
+  sendKeysPrivate(keys);
+}
+
+
+/**
+ * \brief Presses and releases the given keys in order
+ *
+ * Backends that can simulate a whole burst of key events at once should
+ * override this.
+ */
+void CoreEvents::sendKeysPrivate(const QList<unsigned int>& keys)
+{
+  foreach (unsigned int key, keys)
+    sendKeyPrivate(key, (EventSimulation::PressMode)
+        (EventSimulation::Press|EventSimulation::Release));
+}
+
+
 void CoreEvents::unsetUnneededModifiers()
 {
   if (shiftOnce) {
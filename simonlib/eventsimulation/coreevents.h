@@ -22,6 +22,7 @@
 #define SIMON_COREEVENTS_H_5AB1C794A9624F49802445C0C89AB826
 
 #include <QHash>
+#include <QList>
 #include "clickmode.h"
 #include "pressmode.h"
 
@@ -61,16 +62,25 @@ class CoreEvents
     virtual void dragAndDrop(int xStart, int yStart, int x, int y)=0;
 
     void sendKey(unsigned int key /*unicode representation*/, EventSimulation::PressMode mode);
+    void sendText(const QString& text);
 
     void unsetUnneededModifiers();
     void sendShortcut(const QKeySequence& shortcut, EventSimulation::PressMode mode);
 
     void setModifierKey(int virtualKey, bool once=false);
     void unsetModifier(int virtualKey);
+
+    /**
+     * \brief Delay in ms the backend waits between two simulated key events
+     */
+    void setKeyDelay(int delay) { keyDelay = delay; }
     virtual ~CoreEvents();
 
   protected:
     QHash<unsigned int /*unicode char*/, DeadKey*> deadKeys;
+    int keyDelay;
+
+    virtual void sendKeysPrivate(const QList<unsigned int>& keys /*unicode representation*/);
 
   private:
     bool shiftSet, altgrSet, altSet, superSet, strgSet, optionSet;
@@ -90,9 +90,7 @@ void EventHandler::dragAndDrop(int xStart, int yStart, int x, int y)
 /**
  * @brief Sends a word to the underlying Core Eventhandlers
  *
- * Splits up the word in characters and sends every single one
- * separate by using sendKey()
- *
+ * The whole word is typed in one go (see CoreEvents::sendText())
  * @param QString word
  * The word to send
  *
@@ -100,9 +98,9 @@ void EventHandler::dragAndDrop(int xStart, int yStart, int x, int y)
  */
 void EventHandler::sendWord(const QString& word) const
 {
-  for (int i=0; i < word.size();i++) {
-    sendKey(word.at(i));
-  }
+  if (!coreEvents) return;
+
+  coreEvents->sendText(word);
 }
 
 
@@ -150,6 +148,14 @@ void EventHandler::unsetModifier(int virtualKey) const
 }
 
 
+void EventHandler::setKeyDelay(int delay) const
+{
+  if (!coreEvents) return;
+
+  coreEvents->setKeyDelay(delay);
+}
+
+
 EventHandler::~EventHandler()
 {
   delete coreEvents;
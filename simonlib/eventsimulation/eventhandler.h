@@ -62,5 +62,12 @@ class EVENTSIMULATION_EXPORT EventHandler
 
     void setModifier(int virtualKey, bool once=false) const;
     void unsetModifier(int virtualKey) const;
+
+    /**
+     * \brief Sets the delay (in ms) between two simulated key events
+     *
+     * Lower values type faster but some applications might drop keys.
+     */
+    void setKeyDelay(int delay) const;
 };
 #endif
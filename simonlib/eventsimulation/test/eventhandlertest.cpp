@@ -24,6 +24,7 @@
 #include <QDebug>
 #include <QMouseEvent>
 #include <QLineEdit>
+#include <QTime>
 
 #include <KPushButton>
 #include <KCmdLineArgs>
@@ -38,6 +39,7 @@ class eventHandlerTest: public QObject
     void testClick();
     void testDragAndDrop();
     void testSendWord();
+    void testSendWordThroughput();
     void testSendShortcut();
     
   private:
@@ -239,6 +241,36 @@ void eventHandlerTest::testSendWord()
   delete leTest;
 }
 
+void eventHandlerTest::testSendWordThroughput()
+{
+  QLineEdit *leTest = new QLineEdit();
+  leTest->show();
+  leTest->raise();
+  QTest::qWait(300);
+
+  QString sentence = "The Quick brown Fox jumps over the lazy Dog, (again) & again! ";
+  QString text;
+  for (int i=0; i < 8; i++)
+    text += sentence;
+
+  QList<int> delays;
+  delays << 5 << 0;
+  foreach (int delay, delays) {
+    EventHandler::getInstance()->setKeyDelay(delay);
+    leTest->clear();
+    QTime timer;
+    timer.start();
+    EventHandler::getInstance()->sendWord(text);
+    while ((leTest->text().size() < text.size()) && (timer.elapsed() < 30000))
+      QTest::qWait(10);
+    int elapsed = timer.elapsed();
+    QCOMPARE(leTest->text(), text);
+    qDebug() << "Delay" << delay << "ms:" << text.size() << "characters in" << elapsed << "ms";
+  }
+  EventHandler::getInstance()->setKeyDelay(5);
+  delete leTest;
+}
+
 QTEST_APPLESS_MAIN(eventHandlerTest)
 
 #include "eventhandlertest.moc"
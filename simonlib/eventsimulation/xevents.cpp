@@ -50,7 +50,13 @@ void XEvents::dragAndDrop (int xStart, int yStart, int x, int y)
 
 void XEvents::sendKeyPrivate (unsigned int key, EventSimulation::PressMode mode)
 {
-  d->sendKeyPrivate (key, mode);
+  d->sendKeyPrivate (key, mode, keyDelay);
+  unsetUnneededModifiers();
+}
+
+void XEvents::sendKeysPrivate (const QList<unsigned int>& keys)
+{
+  d->sendKeys (keys, keyDelay);
   unsetUnneededModifiers();
 }
 
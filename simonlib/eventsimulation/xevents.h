@@ -44,6 +44,7 @@ class XEvents : public PCEvents
     void setModifierKeyPrivate (int virtualKey);
     void unsetModifierKeyPrivate (int virtualKey);
     void sendKeyPrivate (unsigned int key, EventSimulation::PressMode mode);
+    void sendKeysPrivate (const QList<unsigned int>& keys);
 
   public:
     void click (int x, int y, EventSimulation::ClickMode clickMode);
@@ -30,7 +30,9 @@
 
 // #include "../Logging/logger.h"
 
-XEventsPrivate::XEventsPrivate(const char* displayName)
+XEventsPrivate::XEventsPrivate(const char* displayName) : keymapValid(false),
+  shiftCode(0),
+  altGrCode(0)
 {
   display = openDisplay(displayName);
 }
@@ -131,7 +133,7 @@ void XEventsPrivate::dragAndDrop(int xStart, int yStart, int x, int y)
  * \author Peter Grasch
  * @param key The key to send
  */
-void XEventsPrivate::sendKeyPrivate(unsigned int key /*unicode*/, EventSimulation::PressMode mode)
+void XEventsPrivate::sendKeyPrivate(unsigned int key /*unicode*/, EventSimulation::PressMode mode, int delay)
 {
   if (!display) return;
   KeyCode keyCode;
@@ -140,6 +142,201 @@ void XEventsPrivate::sendKeyPrivate(unsigned int key /*unicode*/, EventSimulatio
   //takes effect before calling XKeysymToKeycode
   XFlush(display);
 
+  key = keySymForKey(key);
+
+  keyCode = XKeysymToKeycode(display, key);
+
+  if (keyCode) {
+    int syms;
+    KeySym *keyToSendShifted=XGetKeyboardMapping(display, keyCode, 1, &syms);
+    if (!keyToSendShifted) return;
+    KeySym shiftSym = keyToSendShifted[1];        //XKeycodeToKeysym(display, keyCode, 1);
+    KeySym altGrSym = 0;
+    KeySym altGrShiftSym = 0;
+    if (syms >= 4)
+      altGrSym = keyToSendShifted[4];
+    if (syms >= 5)
+      altGrShiftSym = keyToSendShifted[5];
+
+    XFree(keyToSendShifted);
+
+    if (mode & EventSimulation::Press)
+    {
+      if (((shiftSym == key) || (altGrShiftSym == key)) && (key < 0xff08))
+        setModifierKey(Qt::SHIFT);
+      if (((key==altGrSym) || (altGrShiftSym == key)) && (key < 0xff08))
+        setModifierKey(Qt::Key_AltGr);
+    }
+
+    pressKeyCode(keyCode, mode, delay);
+
+    if (mode & EventSimulation::Release)
+    {
+      if (((shiftSym == key) || (altGrShiftSym == key)) && (key < 0xff08))
+        unsetModifier(Qt::SHIFT);
+      if (((key==altGrSym) || (altGrShiftSym == key)) && (key < 0xff08))
+        unsetModifier(Qt::Key_AltGr);
+    }
+  }
+  else {
+    QKeySequence k(key);                          //do some magic
+    QString shortcut = k.toString();              //somthing like "Ctrl+L"
+    QStringList keys = shortcut.split('+');
+    QList<KeyCode> shortcutCodes;
+
+    foreach (const QString& keyStr, keys) {
+      shortcutCodes << XKeysymToKeycode(display, XStringToKeysym(keyStr.toUtf8().constData()));
+    }
+
+    if (mode & EventSimulation::Press)
+    {
+      foreach (const KeyCode& shortcutCode, shortcutCodes)
+        XTestFakeKeyEvent(display, shortcutCode, True, delay);
+    }
+
+    if (mode & EventSimulation::Release)
+    {
+      foreach (const KeyCode& shortcutCode, shortcutCodes)
+        XTestFakeKeyEvent(display, shortcutCode, False, delay);
+    }
+
+    XFlush ( display );
+  }
+}
+
+
+void XEventsPrivate::pressKeyCode(const KeyCode& code, EventSimulation::PressMode mode, int delay)
+{
+  if (mode & EventSimulation::Press)
+    XTestFakeKeyEvent(display, code, True, delay);
+  if (mode & EventSimulation::Release)
+    XTestFakeKeyEvent(display, code, False, delay);
+  XFlush ( display );
+}
+
+
+/**
+ * \brief Types the given keys (unicode) as one burst of events
+ *
+ * Keys that can't be found in the keyboard mapping are handed to
+ * \ref sendKeyPrivate() individually.
+ *
+ * @param keys The keys to press and release
+ * @param delay Delay between two key events in ms
+ */
+void XEventsPrivate::sendKeys(const QList<unsigned int>& keys, int delay)
+{
+  if (!display) return;
+
+  updateKeymap();
+
+  int modifiers = 0;
+  foreach (unsigned int key, keys) {
+    KeyStroke stroke;
+    if (!lookupKey(key, stroke)) {
+      switchModifiers(modifiers, 0, delay);
+      modifiers = 0;
+      sendKeyPrivate(key, (EventSimulation::PressMode)
+          (EventSimulation::Press|EventSimulation::Release), delay);
+      continue;
+    }
+
+    switchModifiers(modifiers, stroke.modifiers, delay);
+    modifiers = stroke.modifiers;
+    XTestFakeKeyEvent(display, stroke.code, True, delay);
+    XTestFakeKeyEvent(display, stroke.code, False, delay);
+  }
+  switchModifiers(modifiers, 0, delay);
+
+  XFlush ( display );
+}
+
+
+/**
+ * \brief Presses / releases shift and AltGr so that only the wanted ones are held
+ */
+void XEventsPrivate::switchModifiers(int current, int wanted, int delay)
+{
+  if ((current & ShiftModifier) != (wanted & ShiftModifier))
+    XTestFakeKeyEvent(display, shiftCode, (wanted & ShiftModifier) ? True : False, delay);
+  if ((current & AltGrModifier) != (wanted & AltGrModifier))
+    XTestFakeKeyEvent(display, altGrCode, (wanted & AltGrModifier) ? True : False, delay);
+}
+
+
+/**
+ * \brief Looks up the key code and modifiers needed to type the given key
+ * \return False if the key isn't on the current keyboard layout
+ */
+bool XEventsPrivate::lookupKey(unsigned int key, KeyStroke& stroke)
+{
+  KeySym sym = keySymForKey(key);
+  QHash<KeySym, KeyStroke>::const_iterator i = keymap.constFind(sym);
+  //keysyms of unicode characters outside of latin 1
+  if ((i == keymap.constEnd()) && (sym == key) && (key > 0xff))
+    i = keymap.constFind(0x01000000 | key);
+  if (i == keymap.constEnd())
+    return false;
+
+  stroke = *i;
+  //function keys are not affected by modifiers
+  if ((sym >= 0xff08) && (sym <= 0xffff))
+    stroke.modifiers = 0;
+  return (!(stroke.modifiers & ShiftModifier) || shiftCode) &&
+         (!(stroke.modifiers & AltGrModifier) || altGrCode);
+}
+
+
+/**
+ * \brief Rebuilds the keysym table if the keyboard mapping changed
+ */
+void XEventsPrivate::updateKeymap()
+{
+  XEvent event;
+  while (XCheckTypedEvent(display, MappingNotify, &event)) {
+    XRefreshKeyboardMapping(&event.xmapping);
+    keymapValid = false;
+  }
+  if (keymapValid) return;
+
+  keymap.clear();
+  int minCode, maxCode, symsPerCode;
+  XDisplayKeycodes(display, &minCode, &maxCode);
+  KeySym *syms = XGetKeyboardMapping(display, minCode, maxCode - minCode + 1, &symsPerCode);
+  if (!syms) return;
+
+  //columns of the mapping in order of preference
+  const int columns[] = { 0, 1, 4, 5 };
+  const int modifiers[] = { 0, ShiftModifier, AltGrModifier, ShiftModifier|AltGrModifier };
+  for (int level=0; (level < 4) && (columns[level] < symsPerCode); level++) {
+    for (int code=minCode; code <= maxCode; code++) {
+      KeySym *codeSyms = syms + (code - minCode) * symsPerCode;
+      KeySym sym = codeSyms[columns[level]];
+      if ((level == 1) && (sym == NoSymbol)) {
+        //one letter per key: shift selects the upper case version
+        KeySym lower, upper;
+        XConvertCase(codeSyms[0], &lower, &upper);
+        if (upper != lower)
+          sym = upper;
+      }
+      if ((sym != NoSymbol) && !keymap.contains(sym))
+        keymap.insert(sym, KeyStroke((KeyCode) code, modifiers[level]));
+    }
+  }
+  XFree(syms);
+
+  shiftCode = XKeysymToKeycode(display, XK_Shift_L);
+  altGrCode = XKeysymToKeycode(display, XK_ISO_Level3_Shift);
+  keymapValid = true;
+  kDebug() << "Keyboard mapping has " << keymap.count() << " symbols";
+}
+
+
+/**
+ * \brief Translates the unicode / Qt key to the X11 key symbol
+ */
+KeySym XEventsPrivate::keySymForKey(unsigned int key)
+{
   switch (key) {
     case 9:
       key = XK_Tab;
@@ -382,75 +579,7 @@ void XEventsPrivate::sendKeyPrivate(unsigned int key /*unicode*/, EventSimulatio
       key = XK_Greek_omega;
       break;
   }
-
-  keyCode = XKeysymToKeycode(display, key);
-
-  if (keyCode) {
-    int syms;
-    KeySym *keyToSendShifted=XGetKeyboardMapping(display, keyCode, 1, &syms);
-    if (!keyToSendShifted) return;
-    KeySym shiftSym = keyToSendShifted[1];        //XKeycodeToKeysym(display, keyCode, 1);
-    KeySym altGrSym = 0;
-    KeySym altGrShiftSym = 0;
-    if (syms >= 4)
-      altGrSym = keyToSendShifted[4];
-    if (syms >= 5)
-      altGrShiftSym = keyToSendShifted[5];
-
-    XFree(keyToSendShifted);
-
-    if (mode & EventSimulation::Press)
-    {
-      if (((shiftSym == key) || (altGrShiftSym == key)) && (key < 0xff08))
-        setModifierKey(Qt::SHIFT);
-      if (((key==altGrSym) || (altGrShiftSym == key)) && (key < 0xff08))
-        setModifierKey(Qt::Key_AltGr);
-    }
-
-    pressKeyCode(keyCode, mode);
-
-    if (mode & EventSimulation::Release)
-    {
-      if (((shiftSym == key) || (altGrShiftSym == key)) && (key < 0xff08))
-        unsetModifier(Qt::SHIFT);
-      if (((key==altGrSym) || (altGrShiftSym == key)) && (key < 0xff08))
-        unsetModifier(Qt::Key_AltGr);
-    }
-  }
-  else {
-    QKeySequence k(key);                          //do some magic
-    QString shortcut = k.toString();              //somthing like "Ctrl+L"
-    QStringList keys = shortcut.split('+');
-    QList<KeyCode> shortcutCodes;
-
-    foreach (const QString& keyStr, keys) {
-      shortcutCodes << XKeysymToKeycode(display, XStringToKeysym(keyStr.toUtf8().constData()));
-    }
-
-    if (mode & EventSimulation::Press)
-    {
-      foreach (const KeyCode& shortcutCode, shortcutCodes)
-        XTestFakeKeyEvent(display, shortcutCode, True, 15);
-    }
-
-    if (mode & EventSimulation::Release)
-    {
-      foreach (const KeyCode& shortcutCode, shortcutCodes)
-        XTestFakeKeyEvent(display, shortcutCode, False, 15);
-    }
-
-    XFlush ( display );
-  }
-}
-
-
-void XEventsPrivate::pressKeyCode(const KeyCode& code, EventSimulation::PressMode mode)
-{
-  if (mode & EventSimulation::Press)
-    XTestFakeKeyEvent(display, code, True, 15);
-  if (mode & EventSimulation::Release)
-    XTestFakeKeyEvent(display, code, False, 15);
-  XFlush ( display );
+  return key;
 }
 
 
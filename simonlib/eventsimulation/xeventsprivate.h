@@ -22,6 +22,8 @@
 
 #include "clickmode.h"
 #include "pressmode.h"
+#include <QHash>
+#include <QList>
 #include <X11/Xlib.h>
 #include <X11/keysym.h>
 #include <X11/XF86keysym.h>
@@ -41,13 +43,37 @@
 class XEventsPrivate
 {
   private:
+    enum KeyModifier
+    {
+      ShiftModifier=1,
+      AltGrModifier=2
+    };
+
+    struct KeyStroke
+    {
+      KeyCode code;
+      int modifiers;                              //!< KeyModifier flags
+      KeyStroke(KeyCode code_=0, int modifiers_=0) : code(code_), modifiers(modifiers_) {}
+    };
+
     Display *display;                             //!< The opened Display
 
-    void pressKeyCode (const KeyCode& code, EventSimulation::PressMode mode);
+    /// Cheapest way to type every keysym of the current keyboard mapping
+    QHash<KeySym, KeyStroke> keymap;
+    bool keymapValid;
+    KeyCode shiftCode;
+    KeyCode altGrCode;
+
+    void pressKeyCode (const KeyCode& code, EventSimulation::PressMode mode, int delay);
+    void updateKeymap();
+    bool lookupKey (unsigned int key, KeyStroke& stroke);
+    void switchModifiers (int current, int wanted, int delay);
+    static KeySym keySymForKey (unsigned int key);
   public:
     void click (int x, int y, EventSimulation::ClickMode clickMode);
     void dragAndDrop (int xStart, int yStart, int x, int y);
-    void sendKeyPrivate (unsigned int key, EventSimulation::PressMode mode);
+    void sendKeyPrivate (unsigned int key, EventSimulation::PressMode mode, int delay);
+    void sendKeys (const QList<unsigned int>& keys, int delay);
 
     void setModifierKey (int virtualKey);
 
@@ -34,7 +34,6 @@
 #include <KDebug>
 #include <KAboutData>
 #include <KDateTime>
-#include <KTar>
 #include <KConfigGroup>
 #include <KComponentData>
 
@@ -267,8 +266,7 @@ void ContextAdapter::adaptAndBuild ( const Situation& situation, CachedModel* mo
   ContextAdapter::BackendType bType = ContextAdapter::Null;
 
   if (m_currentSource->baseModelType() != 2 /* no base model */) {
-    KTar tar(m_currentSource->baseModelPath(), "application/x-gzip");
-    if (!Model::parseContainer(tar, creationDate, name, type)) {
+    if (!Model::parseContainer(m_currentSource->baseModelPath(), creationDate, name, type)) {
       emit error(i18n("Base model is corrupt."));
       slotModelCompilationAborted(ModelCompilation::InsufficientInput);
     } else {
@@ -45,6 +45,12 @@ class SIMONDIALOGENGINE_EXPORT BoundValue
     virtual QVariant getValue()=0;
     virtual QString getValueDescription()=0;
 
+    /**
+     * Values that might change on every access (live data, scripts) are
+     * never remembered by \ref DialogBoundValues
+     */
+    virtual bool isVolatile() { return false; }
+
     static BoundValue* createInstance(const QDomElement& elem);
 
     virtual QString getTypeName()=0;
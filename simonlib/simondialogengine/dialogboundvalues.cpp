@@ -20,22 +20,37 @@
 #include "dialogboundvalues.h"
 #include "boundvalue.h"
 #include "argumentboundvalue.h"
+#include "scriptboundvalue.h"
 #include <QDomDocument>
+#include <QScriptEngine>
 #include <KLocalizedString>
 #include <KDebug>
 
-DialogBoundValues::DialogBoundValues()
+DialogBoundValues::DialogBoundValues() : scriptEngine(0)
 {
 }
 
 DialogBoundValues::~DialogBoundValues()
 {
   qDeleteAll(boundValues);
+  delete scriptEngine;
+}
+
+void DialogBoundValues::adopt(BoundValue *value)
+{
+  ScriptBoundValue *s = dynamic_cast<ScriptBoundValue*>(value);
+  if (s)
+  {
+    if (!scriptEngine)
+      scriptEngine = new QScriptEngine;
+    s->setEngine(scriptEngine);
+  }
 }
 
 bool DialogBoundValues::deSerialize(const QDomElement& elem)
 {
   boundValues.clear();
+  valueCache.clear();
  
   QDomElement valueElem = elem.firstChildElement("boundValue");
   while (!valueElem.isNull())
@@ -44,6 +59,7 @@ bool DialogBoundValues::deSerialize(const QDomElement& elem)
 
     if (value)
     {
+      adopt(value);
       boundValues << value;
     }
     else 
@@ -162,6 +178,8 @@ bool DialogBoundValues::addBoundValue(BoundValue *value)
 {
   if (!value) return false;
 
+  adopt(value);
+  valueCache.remove(value->getName());
   beginInsertRows(QModelIndex(), boundValues.count(), boundValues.count());
   boundValues << value;
   endInsertRows();
@@ -175,6 +193,7 @@ bool DialogBoundValues::removeBoundValue(BoundValue *value)
       beginRemoveRows(QModelIndex(), i, i);
       boundValues.removeAt(i);
       endRemoveRows();
+      valueCache.remove(value->getName());
       delete value;
       return true;
     }
@@ -184,9 +203,18 @@ bool DialogBoundValues::removeBoundValue(BoundValue *value)
 
 QVariant DialogBoundValues::getBoundValue(const QString& name)
 {
+  QHash<QString, QVariant>::const_iterator cached = valueCache.constFind(name);
+  if (cached != valueCache.constEnd())
+    return *cached;
+
   foreach (BoundValue *value, boundValues)
     if (value->getName() == name)
-      return value->getValue();
+    {
+      QVariant v = value->getValue();
+      if (!value->isVolatile())
+        valueCache.insert(name, v);
+      return v;
+    }
 
   return QVariant();
 }
@@ -195,6 +223,7 @@ QVariant DialogBoundValues::getBoundValue(const QString& name)
 
 void DialogBoundValues::setArguments(const QStringList& arguments)
 {
+  valueCache.clear();
   foreach (BoundValue* b, boundValues)
   {
     ArgumentBoundValue *a = dynamic_cast<ArgumentBoundValue*>(b);
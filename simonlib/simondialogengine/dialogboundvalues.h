@@ -23,17 +23,28 @@
 
 #include "simondialogengine_export.h"
 #include <QList>
+#include <QHash>
 #include <QString>
+#include <QVariant>
 #include <QDomElement>
 #include <QAbstractItemModel>
 
 class BoundValue;
+class QScriptEngine;
 
 class SIMONDIALOGENGINE_EXPORT DialogBoundValues : public QAbstractItemModel
 {
   private:
     QList<BoundValue*> boundValues;
 
+    /// Shared by all script values of this dialog
+    QScriptEngine *scriptEngine;
+
+    /// Values of non volatile bound values; Cleared when the arguments change
+    QHash<QString, QVariant> valueCache;
+
+    void adopt(BoundValue *value);
+
   public:
     DialogBoundValues();
     Qt::ItemFlags flags(const QModelIndex &index) const;
@@ -39,103 +39,210 @@ void DialogTextParser::setArguments(const QStringList& arguments)
 }
 
 
-bool DialogTextParser::parseTemplates(QString& data)
+/**
+ * A dialog text split into literal text and template markers
+ * ({{x}}, {{elsex}}, {{endx}}); Text tokens are further split into
+ * literals and bound values ($x$)
+ */
+class DialogTextParser::CompiledText
 {
-  QString outData;
+  public:
+    enum TokenType
+    {
+      Text,
+      Open,
+      Else,
+      End
+    };
 
-  //find {{x}}
-  //"{{bla}}gu{{endbla}}dudu"
-  
-  int startPos=-1;
-  int oldStartPos=0;
-  int endPos=data.count();
-  QString condition;
+    struct Part
+    {
+      bool variable;
+      QString text;                               //!< Literal or name of the bound value
+    };
 
-  QStringList activeLimitingConditions;
-  QStringList activeMetConditions;
+    struct Token
+    {
+      TokenType type;
+      QString value;                              //!< Text or name of the condition
+      QList<Part> parts;
+    };
 
-  forever
-  {
-    oldStartPos = startPos;
-    startPos = data.indexOf("{{", oldStartPos+1);
+    QList<Token> tokens;
 
-    //output
-    //only output if every condition is met
-    if (activeLimitingConditions.isEmpty())
+    /// False if a marker isn't closed
+    bool valid;
+
+    /// False if a bound value spans multiple text tokens; These are resolved on the whole output
+    bool splitValues;
+
+    CompiledText() : valid(true), splitValues(true) {}
+
+    void addText(const QString& text)
     {
-      if (startPos == -1) 
-      {
-        if (oldStartPos == -1)
-          outData += data.mid(oldStartPos);
-        else
-          outData += data.mid(oldStartPos+4+condition.count());
+      if (text.isEmpty())
+        return;
 
-        break;
-      } else {
-        if (oldStartPos == -1)
-          outData += data.mid(0, startPos);
-        else
-          outData += data.mid(oldStartPos+4+condition.count(), startPos-oldStartPos-4-condition.count());
+      Token token;
+      token.type = Text;
+      token.value = text;
+
+      QStringList pieces = text.split('$');
+      if (pieces.count() % 2 == 0)
+        splitValues = false;
+      for (int i=0; i < pieces.count(); i++)
+      {
+        if (!(i % 2) && pieces[i].isEmpty())
+          continue;
+        Part part;
+        part.variable = (i % 2);
+        part.text = pieces[i];
+        token.parts << part;
       }
-    } else {
-      if (startPos == -1)
+      tokens << token;
+    }
+
+    void addMarker(const QString& condition)
+    {
+      Token token;
+      if (condition.startsWith(QLatin1String("end")))
       {
-        kWarning() << "Syntax error: Unclosed conditions: " << activeLimitingConditions;
-        return false;
+        token.type = End;
+        token.value = condition.mid(3);
+      } else if (condition.startsWith(QLatin1String("else")))
+      {
+        token.type = Else;
+        token.value = condition.mid(4);
+      } else {
+        token.type = Open;
+        token.value = condition;
       }
+      tokens << token;
+    }
+};
+
+DialogTextParser::CompiledText* DialogTextParser::compile(const QString& data)
+{
+  //find {{x}}
+  //"{{bla}}gu{{endbla}}dudu"
+  CompiledText *text = new CompiledText;
+
+  int pos = 0;
+  forever
+  {
+    int startPos = data.indexOf("{{", pos);
+    if (startPos == -1)
+    {
+      text->addText(data.mid(pos));
+      break;
     }
-    //endoutput
+    text->addText(data.mid(pos, startPos-pos));
 
-    endPos = data.indexOf("}}", (startPos == -1) ? 0 : startPos);
+    int endPos = data.indexOf("}}", startPos);
     if (endPos == -1)
     {
       kWarning() << "Syntax error: Condition not closed (missing }}) at position " << startPos;
-      return false;
+      text->valid = false;
+      break;
     }
 
-    condition = data.mid(startPos+2, endPos-startPos-2);
-    kDebug() << "Found condition: " << condition;
+    text->addMarker(data.mid(startPos+2, endPos-startPos-2));
+    pos = endPos+2;
+  }
+
+  return text;
+}
+
+bool DialogTextParser::evaluate(const CompiledText *text, QString& data)
+{
+  if (!text->valid)
+    return false;
+
+  QStringList activeLimitingConditions;
+  QStringList activeMetConditions;
+  QList<const CompiledText::Token*> output;
 
-    if (!condition.startsWith(QLatin1String("end")))
+  for (QList<CompiledText::Token>::const_iterator i = text->tokens.constBegin();
+       i != text->tokens.constEnd(); ++i)
+  {
+    const QString& condition = i->value;
+    switch (i->type)
     {
-      if (condition.startsWith(QLatin1String("else")))
-      {
-        QString baseCondition = condition.mid(4);
-        kDebug() << "Parsing else for " << baseCondition;
-        bool wasActive = (activeLimitingConditions.removeAll(baseCondition) != 0);
-        if (wasActive) activeMetConditions << baseCondition;
+      case CompiledText::Text:
+        //only output if every condition is met
+        if (activeLimitingConditions.isEmpty())
+          output << &(*i);
+        break;
+      case CompiledText::Open:
+        //condition only relevant if it is NOT enabled in the template options
+        if (!m_templateOptions->isEnabled(condition))
+          activeLimitingConditions << condition;
+        else
+          activeMetConditions << condition;
+        break;
+      case CompiledText::Else:
+        if (activeLimitingConditions.removeAll(condition) != 0)
+          activeMetConditions << condition;
         else {
-          if (activeMetConditions.removeAll(baseCondition) == 0)
+          if (activeMetConditions.removeAll(condition) == 0)
           {
-            kWarning() << "Else for unopened condition: " << baseCondition;
+            kWarning() << "Else for unopened condition: " << condition;
             return false;
           }
-          activeLimitingConditions << baseCondition;
+          activeLimitingConditions << condition;
         }
-      } else {
-        //condition only relevant if it is NOT enabled in the template options
-        if (!m_templateOptions->isEnabled(condition))
+        break;
+      case CompiledText::End:
+        if ((activeLimitingConditions.removeAll(condition) == 0) &&
+            (activeMetConditions.removeAll(condition) == 0))
         {
-          kDebug() << "Is not enabled: " << condition;
-          activeLimitingConditions << condition;
-        } else {
-          kDebug() << "Is enabled: " << condition;
-          activeMetConditions << condition;
+          kWarning() << "Closed unopened condition " << condition;
+          return false;
         }
+        break;
+    }
+  }
+
+  if (!activeLimitingConditions.isEmpty())
+  {
+    kWarning() << "Syntax error: Unclosed conditions: " << activeLimitingConditions;
+    return false;
+  }
+
+  if (!text->splitValues)
+  {
+    data.clear();
+    foreach (const CompiledText::Token* token, output)
+      data += token->value;
+    return parseBoundValues(data);
+  }
+
+  QString outData;
+  foreach (const CompiledText::Token* token, output)
+  {
+    foreach (const CompiledText::Part& part, token->parts)
+    {
+      if (!part.variable)
+      {
+        outData += part.text;
+        continue;
       }
-    } else {
-      QString baseCondition = condition.mid(3);
-      if ((activeLimitingConditions.removeAll(baseCondition) == 0) &&
-          (activeMetConditions.removeAll(baseCondition) == 0))
+
+      QVariant value = m_boundValues->getBoundValue(part.text);
+      if (value.isNull())
       {
-        kWarning() << "Closed unopened condition " << baseCondition << " at position " << startPos;
+        kWarning() << "Variable not bound: " << part.text;
+        //like parseBoundValues(): leave the text with only the templates applied
+        data.clear();
+        foreach (const CompiledText::Token* t, output)
+          data += t->value;
         return false;
       }
+      outData += value.toString();
     }
   }
 
   data = outData;
-
   return true;
 }
 
@@ -177,18 +284,19 @@ bool DialogTextParser::parseBoundValues(QString& data)
 
 bool DialogTextParser::parse(QString& data)
 {
-  kDebug() << "Parsing: " << data;
-  bool ok = parseTemplates(data);
-
-  if (!ok) return false;
-
-  ok = parseBoundValues(data);
+  CompiledText *text = m_compiledTexts.value(data);
+  if (!text)
+  {
+    text = compile(data);
+    m_compiledTexts.insert(data, text);
+  }
 
-  return ok;
+  return evaluate(text, data);
 }
 
 DialogTextParser::~DialogTextParser()
 {
+  qDeleteAll(m_compiledTexts);
 }
 
 
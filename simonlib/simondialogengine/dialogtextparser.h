@@ -21,6 +21,8 @@
 #define SIMON_DIALOGTEXTPARSER_H_7A7B9100FF5245329569C1B540119C37
 
 #include <QList>
+#include <QHash>
+#include <QString>
 #include "simondialogengine_export.h"
 
 class DialogDataProvider;
@@ -31,10 +33,16 @@ class QStringList;
 class SIMONDIALOGENGINE_EXPORT DialogTextParser
 {
   private:
+    class CompiledText;
+
     DialogTemplateOptions *m_templateOptions;
     DialogBoundValues *m_boundValues;
 
-    bool parseTemplates(QString& data);
+    /// Texts are tokenized once and then only evaluated
+    QHash<QString, CompiledText*> m_compiledTexts;
+
+    CompiledText* compile(const QString& data);
+    bool evaluate(const CompiledText *text, QString& data);
     bool parseBoundValues(QString& data);
 
   public:
@@ -58,6 +58,7 @@ class SIMONDIALOGENGINE_EXPORT PlasmaBoundValue : public BoundValue
     QString getKey() { return m_key; }
 
     QVariant getValue();
+    bool isVolatile() { return true; }
     QString getValueDescription();
 
     bool serializePrivate(QDomDocument *doc, QDomElement& elem, int& id);
@@ -27,15 +27,29 @@
 
 #include <KLocalizedString>
 
-ScriptBoundValue::ScriptBoundValue(const QString& name) : BoundValue(name)
+ScriptBoundValue::ScriptBoundValue(const QString& name) : BoundValue(name),
+  m_engine(0), m_ownEngine(0)
 {
 }
 
 ScriptBoundValue::ScriptBoundValue(const QString& name, const QString& script) :
-  BoundValue(name), m_script(script)
+  BoundValue(name), m_script(script), m_program(script),
+  m_engine(0), m_ownEngine(0)
 {
 }
 
+ScriptBoundValue::~ScriptBoundValue()
+{
+  delete m_ownEngine;
+}
+
+void ScriptBoundValue::setEngine(QScriptEngine *engine)
+{
+  m_engine = engine;
+  delete m_ownEngine;
+  m_ownEngine = 0;
+}
+
 QString ScriptBoundValue::getTypeName()
 {
   return i18nc("Typename of script bound values", "Script");
@@ -43,8 +57,14 @@ QString ScriptBoundValue::getTypeName()
 
 QVariant ScriptBoundValue::getValue()
 {
-  QScriptEngine engine;
-  QScriptValue result = engine.evaluate(m_script);
+  if (!m_engine)
+    m_engine = m_ownEngine = new QScriptEngine;
+
+  //own scope so the variables of one script don't leak into the others
+  m_engine->pushContext();
+  QScriptValue result = m_engine->evaluate(m_program);
+  m_engine->popContext();
+  m_engine->clearExceptions();
   return result.toVariant();
 }
 
@@ -60,6 +80,7 @@ bool ScriptBoundValue::deSerialize(const QDomElement& elem)
   if (scriptElem.isNull()) return false;
 
   m_script = scriptElem.text();
+  m_program = QScriptProgram(m_script);
   return true;
 }
 
@@ -24,11 +24,17 @@
 #include "simondialogengine_export.h"
 #include <QVariant>
 #include <QString>
+#include <QScriptProgram>
+
+class QScriptEngine;
 
 class SIMONDIALOGENGINE_EXPORT ScriptBoundValue : public BoundValue
 {
   private:
     QString m_script;
+    QScriptProgram m_program;
+    QScriptEngine *m_engine;
+    QScriptEngine *m_ownEngine;
 
   protected:
     bool deSerialize(const QDomElement& elem);
@@ -36,11 +42,19 @@ class SIMONDIALOGENGINE_EXPORT ScriptBoundValue : public BoundValue
   public:
     ScriptBoundValue(const QString& name);
     ScriptBoundValue(const QString& name, const QString& script);
+    ~ScriptBoundValue();
+
+    /**
+     * Evaluate in the given (shared) engine instead of an own one; The
+     * engine has to outlive this value
+     */
+    void setEngine(QScriptEngine *engine);
 
     QString getTypeName();
 
     QString getScript() { return m_script; }
     QVariant getValue();
+    bool isVolatile() { return true; }
     QString getValueDescription();
 
     bool serializePrivate(QDomDocument *doc, QDomElement& elem, int& id);
@@ -22,9 +22,12 @@
 #include <QDomDocument>
 #include <QDomElement>
 #include <QByteArray>
+#include <QStringList>
 
 #include "../dialogboundvalues.h"
 #include "../staticboundvalue.h"
+#include "../argumentboundvalue.h"
+#include "../scriptboundvalue.h"
 
 class testDialogBoundValues: public QObject
 {
@@ -34,6 +37,8 @@ class testDialogBoundValues: public QObject
     void testAdd();
     void testGet();
     void testRemove();
+    void testArguments();
+    void testScripts();
 
   private:
     DialogBoundValues *values;
@@ -110,6 +115,40 @@ void testDialogBoundValues::testRemove()
   }
 }
 
+void testDialogBoundValues::testArguments()
+{
+  ArgumentBoundValue *argument = new ArgumentBoundValue("argument", 2);
+  QVERIFY(values->addBoundValue(argument));
+
+  values->setArguments(QStringList() << "first" << "second");
+  QCOMPARE(values->getBoundValue("argument"), QVariant("second"));
+  QCOMPARE(values->getBoundValue("argument"), QVariant("second"));
+
+  //remembered values have to follow the arguments
+  values->setArguments(QStringList() << "first" << "other");
+  QCOMPARE(values->getBoundValue("argument"), QVariant("other"));
+
+  QVERIFY(values->removeBoundValue(argument));
+}
+
+void testDialogBoundValues::testScripts()
+{
+  ScriptBoundValue *first = new ScriptBoundValue("first", "var a = 2; a*5");
+  ScriptBoundValue *second = new ScriptBoundValue("second", "typeof a");
+  QVERIFY(values->addBoundValue(first));
+  QVERIFY(values->addBoundValue(second));
+
+  for (int i=0; i < 2; i++)
+  {
+    QCOMPARE(values->getBoundValue("first"), QVariant(10));
+    //scripts share the engine but not their variables
+    QCOMPARE(values->getBoundValue("second"), QVariant("undefined"));
+  }
+
+  QVERIFY(values->removeBoundValue(first));
+  QVERIFY(values->removeBoundValue(second));
+}
+
  
 QTEST_MAIN(testDialogBoundValues)
 
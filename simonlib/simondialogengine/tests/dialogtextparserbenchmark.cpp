@@ -0,0 +1,127 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include <QTest>
+#include <QDomDocument>
+#include <QDomElement>
+#include <QByteArray>
+#include <QStringList>
+
+#include "../dialogtemplateoptions.h"
+#include "../dialogtextparser.h"
+#include "../dialogboundvalues.h"
+
+/**
+ * Rendering cost of a typical dialog turn: templates, static, argument
+ * and script bound values
+ */
+class benchmarkDialogTextParser: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkTemplates();
+    void benchmarkBoundValues();
+    void benchmarkScript();
+
+  private:
+    DialogTemplateOptions *options;
+    DialogBoundValues *values;
+    DialogTextParser *textParser;
+
+    void render(const QString& source, const QString& expected);
+};
+
+void benchmarkDialogTextParser::initTestCase()
+{
+  QDomDocument doc;
+  doc.setContent(
+      QByteArray(
+    "<options>"
+     "<option value=\"0\" name=\"formal\"/>"
+     "<option value=\"1\" name=\"nice\"/>"
+    "</options>"
+     ));
+  options = DialogTemplateOptions::createInstance(doc.documentElement());
+  QVERIFY(options);
+
+  doc.setContent(
+      QByteArray(
+    "<boundValues>"
+     "<boundValue type=\"1\">"
+      "<name>name</name>"
+      "<value content=\"Peter\"/>"
+     "</boundValue>"
+     "<boundValue type=\"2\">"
+      "<name>sum</name>"
+      "<script>var s = 0; for (var i=1; i &lt;= 10; i++) s += i; s</script>"
+     "</boundValue>"
+     "<boundValue type=\"4\">"
+      "<name>item</name>"
+      "<argumentId>1</argumentId>"
+     "</boundValue>"
+    "</boundValues>"
+     ));
+  values = DialogBoundValues::createInstance(doc.documentElement());
+  QVERIFY(values);
+
+  textParser = new DialogTextParser(options, values);
+  textParser->setArguments(QStringList() << "coffee");
+}
+
+void benchmarkDialogTextParser::cleanupTestCase()
+{
+  delete textParser;
+  delete values;
+  delete options;
+}
+
+void benchmarkDialogTextParser::render(const QString& source, const QString& expected)
+{
+  QString out;
+  QBENCHMARK {
+    out = source;
+    QVERIFY(textParser->parse(out));
+  }
+  QCOMPARE(out, expected);
+}
+
+void benchmarkDialogTextParser::benchmarkTemplates()
+{
+  render("{{formal}}Good morning{{elseformal}}Hi{{nice}}, nice to see you{{elsenice}}.{{endnice}}{{endformal}} "
+         "What can I do for you?",
+         "Hi, nice to see you What can I do for you?");
+}
+
+void benchmarkDialogTextParser::benchmarkBoundValues()
+{
+  render("{{nice}}Hello $name$! {{endnice}}Do you want some $item$?{{formal}} Sir.{{endformal}}",
+         "Hello Peter! Do you want some coffee?");
+}
+
+void benchmarkDialogTextParser::benchmarkScript()
+{
+  render("The sum is $sum$.", "The sum is 55.");
+}
+
+QTEST_MAIN(benchmarkDialogTextParser)
+
+#include "dialogtextparserbenchmark.moc"
@@ -35,6 +35,7 @@ class testDialogTextParser: public QObject
     void testParse();
     void testParse_data();
     void testText();
+    void testReparse();
 
   private:
     DialogTemplateOptions *options;
@@ -128,6 +129,28 @@ void testDialogTextParser::testText()
   QCOMPARE(test->parse(), QString("<html><head /><body><p>$unbound$</p></body></html>"));
 }
 
+void testDialogTextParser::testReparse()
+{
+  //compiled texts have to follow changed options
+  QString source = "{{nice}}nice $time${{elsenice}}not nice{{endnice}}";
+  for (int i=0; i < 2; i++)
+  {
+    QString out = source;
+    QVERIFY(textParser->parse(out));
+    QCOMPARE(out, QString("nice Test"));
+  }
+  options->addOption("nice", false);
+  QString out = source;
+  QVERIFY(textParser->parse(out));
+  QCOMPARE(out, QString("not nice"));
+  options->addOption("nice", true);
+
+  //bound values spanning template markers
+  out = "$ti{{nice}}{{endnice}}me$";
+  QVERIFY(textParser->parse(out));
+  QCOMPARE(out, QString("Test"));
+}
+
  
 QTEST_MAIN(testDialogTextParser)
 
@@ -102,7 +102,13 @@ bool TTSDialogView::synthesizeState(const DialogState& state)
   }
   kDebug() << "Saying text: " << text;
 
-  return say(text);
+  if (!say(text))
+    return false;
+
+  //said again on invalid input
+  if (m_dialog->getRepeatOnInvalidInput() && !optionsRepeat.trimmed().isEmpty())
+    SimonTTS::prefetch(QStringList() << optionsRepeat);
+  return true;
 }
 
 bool TTSDialogView::present(const DialogState& state)
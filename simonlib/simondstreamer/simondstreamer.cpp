@@ -30,7 +30,8 @@
  */
 SimondStreamer::SimondStreamer(SimonSender *s, QObject *parent) :
 QObject(parent),
-m_sender(s)
+m_sender(s),
+m_modelSampleRate(0)
 {
   initializeDevices();
   connect(SoundServer::getInstance(), SIGNAL(devicesChanged()), this, SLOT(initializeDevices()));
@@ -49,7 +50,13 @@ void SimondStreamer::initializeDevices()
   QList<SimonSound::DeviceConfiguration> devices = SoundServer::getRecognitionInputDevices();
   kDebug() << "Initializing " << devices.count() << " streaming devices...";
   qint8 i=0;
-  foreach (const SimonSound::DeviceConfiguration& dev, devices) {
+  foreach (SimonSound::DeviceConfiguration dev, devices) {
+    if (m_modelSampleRate && (dev.targetSampleRate() != m_modelSampleRate)) {
+      kDebug() << "Streaming " << dev.name() << " at the sample rate of the model: " << m_modelSampleRate;
+      dev = SimonSound::DeviceConfiguration(dev.name(), dev.channels(), dev.sampleRate(),
+                                            dev.sampleRate() != m_modelSampleRate, m_modelSampleRate,
+                                            dev.conditions(), dev.defaultSampleGroup());
+    }
     SimondStreamerClient *streamer = new SimondStreamerClient(i++, m_sender, dev, this);
 
     connect(streamer, SIGNAL(started()), this, SIGNAL(started()));
@@ -63,6 +70,15 @@ void SimondStreamer::initializeDevices()
 }
 
 
+void SimondStreamer::setModelSampleRate(int sampleRate)
+{
+  if (sampleRate == m_modelSampleRate)
+    return;
+  m_modelSampleRate = sampleRate;
+  initializeDevices();
+}
+
+
 bool SimondStreamer::isRunning()
 {
   foreach (SimondStreamerClient *c, clients)
@@ -38,6 +38,7 @@ class SIMONDSTREAMER_EXPORT SimondStreamer : public QObject
 
   private:
     SimonSender *m_sender;
+    int m_modelSampleRate;
     QList<SimondStreamerClient*> clients;
 
   private slots:
@@ -48,6 +49,13 @@ class SIMONDSTREAMER_EXPORT SimondStreamer : public QObject
     bool stop();
     bool start();
     bool isRunning();
+
+    /**
+     * Streams at the sample rate of the active model, regardless of the
+     * configured resampling; 0 to use the device configuration as is.
+     */
+    void setModelSampleRate(int sampleRate);
+
     virtual ~SimondStreamer();
 
 };
@@ -130,8 +130,7 @@ void SimondStreamerClient::processPrivate(const QByteArray& data, qint64 current
   if (!shouldStream(oldState)) { // start sample 
     kDebug() << "Starting sample";
     sender->startSampleToRecognize(id, m_deviceConfiguration.channels(),
-      m_deviceConfiguration.resample() ? m_deviceConfiguration.resampleSampleRate() : 
-      m_deviceConfiguration.sampleRate());
+      m_deviceConfiguration.targetSampleRate());
   }
   
   sender->sendSampleToRecognize(id, data);
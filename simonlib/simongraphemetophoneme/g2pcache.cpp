@@ -0,0 +1,85 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "g2pcache.h"
+
+#include <QFile>
+#include <QDir>
+#include <KDebug>
+
+G2PCache::G2PCache(const QString& directory) : m_directory(directory)
+{
+}
+
+void G2PCache::load(const QString& modelVersion)
+{
+  m_path = QDir(m_directory).filePath(modelVersion);
+  m_pronunciations.clear();
+  m_added.clear();
+
+  QFile f(m_path);
+  if (!f.open(QIODevice::ReadOnly))
+    return;
+
+  while (!f.atEnd()) {
+    QString line = QString::fromUtf8(f.readLine());
+    line.chop(1); // newline
+    int splitter = line.indexOf('\t');
+    if (splitter == -1)
+      continue;
+    m_pronunciations.insert(line.left(splitter), line.mid(splitter+1));
+  }
+}
+
+void G2PCache::insert(const QString& word, const QString& pronunciation)
+{
+  m_pronunciations.insert(word, pronunciation);
+  m_added.insert(word, pronunciation);
+}
+
+bool G2PCache::save()
+{
+  if (m_added.isEmpty())
+    return true;
+
+  if (!QDir().mkpath(m_directory))
+    return false;
+
+  QFile f(m_path);
+  if (!f.open(QIODevice::WriteOnly|QIODevice::Append))
+    return false;
+
+  QByteArray data;
+  for (QHash<QString, QString>::const_iterator i = m_added.constBegin(); i != m_added.constEnd(); ++i)
+    data += i.key().toUtf8() + '\t' + i.value().toUtf8() + '\n';
+
+  if (f.write(data) != data.size())
+    return false;
+  f.close();
+  m_added.clear();
+
+  //drop the caches of models that weren't used in a while
+  QDir directory(m_directory);
+  QStringList caches = directory.entryList(QDir::Files, QDir::Time);
+  for (int i = maxModels; i < caches.count(); i++) {
+    kDebug() << "Removing pronunciation cache of model " << caches[i];
+    directory.remove(caches[i]);
+  }
+  return true;
+}
@@ -0,0 +1,56 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SIMON_G2PCACHE_H_798E684F1A264B668BD730B1004ED38F
+#define SIMON_G2PCACHE_H_798E684F1A264B668BD730B1004ED38F
+
+#include "simongraphemetophoneme_export.h"
+#include <QString>
+#include <QHash>
+
+/**
+ * \class G2PCache
+ * \brief Persistent store of generated pronunciations
+ *
+ * Every model version gets its own file in the cache folder, so switching
+ * between language profiles keeps the pronunciations of each. Only the
+ * maxModels files that were extended most recently are kept.
+ */
+class SIMONGRAPHEMETOPHONEME_EXPORT G2PCache
+{
+public:
+  static const int maxModels = 5;
+
+  explicit G2PCache(const QString& directory);
+
+  void load(const QString& modelVersion);
+  bool save();
+
+  bool contains(const QString& word) const { return m_pronunciations.contains(word); }
+  QString pronunciation(const QString& word) const { return m_pronunciations.value(word); }
+  void insert(const QString& word, const QString& pronunciation);
+
+private:
+  QString m_directory;
+  QString m_path;
+  QHash<QString, QString> m_pronunciations;
+  QHash<QString, QString> m_added;
+};
+
+#endif
@@ -0,0 +1,405 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "g2pmodel.h"
+
+#include <QFile>
+#include <QVector>
+#include <QBitArray>
+#include <QSet>
+#include <QCryptographicHash>
+#include <QtConcurrentMap>
+
+#include <KLocalizedString>
+#include <KDebug>
+
+#include <math.h>
+
+static const char modelHeader[] = "SIMONG2P 1";
+static const int maxContext = 3;
+//every level extends the previous one by one grapheme
+static const int contextWidths[][2] = { {0,0}, {0,1}, {1,1}, {1,2}, {2,2}, {2,3}, {3,3} };
+static const int levelCount = sizeof(contextWidths) / sizeof(contextWidths[0]);
+static const double impossible = -1e300;
+static const QChar padding('#');
+
+struct G2PModel::Aligner
+{
+  typedef void result_type;
+  const G2PModel *model;
+  Aligner(const G2PModel *m) : model(m) {}
+  void operator()(G2PModel::Entry& entry) const { model->alignEntry(entry); }
+};
+
+struct G2PModel::Estimator
+{
+  typedef G2PModel::ChunkCounts result_type;
+  const G2PModel *model;
+  Estimator(const G2PModel *m) : model(m) {}
+  G2PModel::ChunkCounts operator()(const G2PModel::Entry& entry) const { return model->estimate(entry); }
+};
+
+static void mergeCounts(QHash<QChar, QHash<QString, double> >& result,
+                        const QHash<QChar, QHash<QString, double> >& counts)
+{
+  for (QHash<QChar, QHash<QString, double> >::const_iterator g = counts.constBegin();
+       g != counts.constEnd(); ++g) {
+    QHash<QString, double>& target = result[g.key()];
+    for (QHash<QString, double>::const_iterator c = g->constBegin(); c != g->constEnd(); ++c)
+      target[c.key()] += c.value();
+  }
+}
+
+static double logAdd(double a, double b)
+{
+  if (a == impossible) return b;
+  if (b == impossible) return a;
+  double m = qMax(a, b);
+  return m + log(exp(a - m) + exp(b - m));
+}
+
+G2PModel::G2PModel()
+{
+}
+
+bool G2PModel::loadLexicon(const QString& path)
+{
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly)) {
+    m_lastError = i18nc("%1 is path", "Could not open training lexicon at \"%1\"", path);
+    return false;
+  }
+
+  m_lexicon.clear();
+  m_emission.clear();
+  while (!f.atEnd()) {
+    QString line = QString::fromUtf8(f.readLine()).trimmed();
+    int splitter = line.indexOf('\t');
+    if (splitter == -1)
+      splitter = line.indexOf(' ');
+    if (splitter == -1)
+      continue;
+
+    Entry entry;
+    entry.graphemes = line.left(splitter).toUpper();
+    entry.phonemes = line.mid(splitter+1).split(' ', QString::SkipEmptyParts);
+    if (entry.graphemes.isEmpty() || entry.phonemes.isEmpty())
+      continue;
+    m_lexicon << entry;
+  }
+
+  if (m_lexicon.isEmpty()) {
+    m_lastError = i18n("The training lexicon is empty");
+    return false;
+  }
+  return true;
+}
+
+double G2PModel::emission(const QChar& grapheme, const QString& chunk, int length) const
+{
+  //before the first pass every grapheme prefers a single phoneme
+  if (m_emission.isEmpty())
+    return log((length == 1) ? 0.6 : 0.2);
+
+  QHash<QChar, QHash<QString, double> >::const_iterator g = m_emission.constFind(grapheme);
+  if (g == m_emission.constEnd())
+    return log(1e-6);
+  return g->value(chunk, log(1e-6));
+}
+
+void G2PModel::alignEntry(Entry& entry) const
+{
+  const int n = entry.graphemes.count();
+  const int m = entry.phonemes.count();
+  entry.chunkLengths.clear();
+  if (m > 2 * n)
+    return; // not alignable with at most two phonemes per grapheme
+
+  const int stride = m + 1;
+  QVector<double> score((n + 1) * stride, impossible);
+  QVector<char> back((n + 1) * stride, 0);
+  score[0] = 0;
+
+  for (int i = 1; i <= n; ++i) {
+    const QChar g = entry.graphemes[i - 1];
+    for (int j = 0; j <= m; ++j) {
+      for (int length = 0; (length <= 2) && (length <= j); ++length) {
+        double previous = score[(i - 1) * stride + j - length];
+        if (previous == impossible)
+          continue;
+        QString chunk = QStringList(entry.phonemes.mid(j - length, length)).join(" ");
+        double s = previous + emission(g, chunk, length);
+        if (s > score[i * stride + j]) {
+          score[i * stride + j] = s;
+          back[i * stride + j] = length;
+        }
+      }
+    }
+  }
+
+  if (score[n * stride + m] == impossible)
+    return;
+
+  int j = m;
+  for (int i = n; i > 0; --i) {
+    int length = back[i * stride + j];
+    entry.chunkLengths.prepend(length);
+    j -= length;
+  }
+}
+
+G2PModel::ChunkCounts G2PModel::estimate(const Entry& entry) const
+{
+  ChunkCounts counts;
+  const int n = entry.graphemes.count();
+  const int m = entry.phonemes.count();
+  if (m > 2 * n)
+    return counts;
+
+  //forward / backward log probabilities over the (grapheme, phoneme) lattice
+  const int stride = m + 1;
+  QVector<double> forward((n + 1) * stride, impossible);
+  QVector<double> backward((n + 1) * stride, impossible);
+  forward[0] = 0;
+  backward[n * stride + m] = 0;
+
+  for (int i = 1; i <= n; ++i)
+    for (int j = 0; j <= m; ++j)
+      for (int length = 0; (length <= 2) && (length <= j); ++length) {
+        double previous = forward[(i - 1) * stride + j - length];
+        if (previous == impossible)
+          continue;
+        QString chunk = QStringList(entry.phonemes.mid(j - length, length)).join(" ");
+        forward[i * stride + j] = logAdd(forward[i * stride + j],
+                                         previous + emission(entry.graphemes[i - 1], chunk, length));
+      }
+
+  for (int i = n - 1; i >= 0; --i)
+    for (int j = 0; j <= m; ++j)
+      for (int length = 0; (length <= 2) && (j + length <= m); ++length) {
+        double next = backward[(i + 1) * stride + j + length];
+        if (next == impossible)
+          continue;
+        QString chunk = QStringList(entry.phonemes.mid(j, length)).join(" ");
+        backward[i * stride + j] = logAdd(backward[i * stride + j],
+                                          next + emission(entry.graphemes[i], chunk, length));
+      }
+
+  double total = forward[n * stride + m];
+  if (total == impossible)
+    return counts;
+
+  for (int i = 1; i <= n; ++i)
+    for (int j = 0; j <= m; ++j)
+      for (int length = 0; (length <= 2) && (length <= j); ++length) {
+        double previous = forward[(i - 1) * stride + j - length];
+        double next = backward[i * stride + j];
+        if ((previous == impossible) || (next == impossible))
+          continue;
+        QString chunk = QStringList(entry.phonemes.mid(j - length, length)).join(" ");
+        counts[entry.graphemes[i - 1]][chunk] +=
+          exp(previous + emission(entry.graphemes[i - 1], chunk, length) + next - total);
+      }
+  return counts;
+}
+
+void G2PModel::align()
+{
+  ChunkCounts counts = QtConcurrent::blockingMappedReduced<ChunkCounts>(m_lexicon,
+                                   Estimator(this), mergeCounts, QtConcurrent::UnorderedReduce);
+
+  m_emission.clear();
+  for (ChunkCounts::const_iterator g = counts.constBegin(); g != counts.constEnd(); ++g) {
+    double total = 0;
+    foreach (double count, *g)
+      total += count;
+    QHash<QString, double>& probabilities = m_emission[g.key()];
+    for (QHash<QString, double>::const_iterator c = g->constBegin(); c != g->constEnd(); ++c)
+      probabilities.insert(c.key(), log(c.value() / total));
+  }
+}
+
+QString G2PModel::context(const QString& padded, int position, int level)
+{
+  int left = contextWidths[level][0];
+  int right = contextWidths[level][1];
+  return padded.mid(maxContext + position - left, left + 1 + right);
+}
+
+void G2PModel::buildRules()
+{
+  QtConcurrent::blockingMap(m_lexicon, Aligner(this));
+
+  //flatten the aligned lexicon to one token per grapheme
+  QStringList padded;
+  QVector<int> tokenEntry;
+  QVector<int> tokenPosition;
+  QStringList tokenChunk;
+  QString pad(maxContext, padding);
+  for (int e = 0; e < m_lexicon.count(); ++e) {
+    const Entry& entry = m_lexicon[e];
+    padded << pad + entry.graphemes + pad;
+    int position = 0;
+    for (int i = 0; i < entry.chunkLengths.count(); ++i) {
+      int length = entry.chunkLengths[i];
+      tokenEntry << e;
+      tokenPosition << i;
+      tokenChunk << QStringList(entry.phonemes.mid(position, length)).join(" ");
+      position += length;
+    }
+  }
+
+  const int tokens = tokenChunk.count();
+  QVector<QString> decision(tokens);
+  QBitArray settled(tokens);
+
+  m_rules.clear();
+  for (int level = 0; level < levelCount; ++level) {
+    QHash<QString, QHash<QString, int> > counts;
+    for (int t = 0; t < tokens; ++t)
+      if (!settled[t])
+        ++counts[context(padded[tokenEntry[t]], tokenPosition[t], level)][tokenChunk[t]];
+
+    QHash<QString, QString> best;
+    QSet<QString> unambiguous;
+    for (QHash<QString, QHash<QString, int> >::const_iterator c = counts.constBegin();
+         c != counts.constEnd(); ++c) {
+      int bestCount = -1;
+      QString bestChunk;
+      for (QHash<QString, int>::const_iterator i = c->constBegin(); i != c->constEnd(); ++i)
+        if (i.value() > bestCount) {
+          bestCount = i.value();
+          bestChunk = i.key();
+        }
+      best.insert(c.key(), bestChunk);
+      if (c->count() == 1)
+        unambiguous.insert(c.key());
+    }
+
+    QHash<QString, QString> rules;
+    for (int t = 0; t < tokens; ++t) {
+      if (settled[t])
+        continue;
+      QString key = context(padded[tokenEntry[t]], tokenPosition[t], level);
+      const QString& chunk = best[key];
+      if ((level == 0) || (chunk != decision[t]))
+        rules.insert(key, chunk);
+      decision[t] = chunk;
+      //wider contexts of an unambiguous one can not change its decision
+      if (unambiguous.contains(key))
+        settled.setBit(t);
+    }
+    kDebug() << "G2P context level " << level << ": " << rules.count() << " rules";
+    m_rules << rules;
+  }
+
+  m_lexicon.clear();
+  m_emission.clear();
+}
+
+bool G2PModel::save(const QString& path)
+{
+  QByteArray data = QByteArray(modelHeader) + '\n' + QByteArray::number(m_rules.count()) + '\n';
+  for (int level = 0; level < m_rules.count(); ++level)
+    for (QHash<QString, QString>::const_iterator i = m_rules[level].constBegin();
+         i != m_rules[level].constEnd(); ++i)
+      data += QByteArray::number(level) + '\t' + i.key().toUtf8() + '\t' + i.value().toUtf8() + '\n';
+
+  QFile f(path);
+  if (!f.open(QIODevice::WriteOnly) || (f.write(data) != data.size())) {
+    m_lastError = i18nc("%1 is path", "Could not write model to \"%1\"", path);
+    return false;
+  }
+  m_version = QString::fromAscii(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex());
+  return true;
+}
+
+bool G2PModel::isNativeModel(const QString& path)
+{
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly))
+    return false;
+  return f.readLine().trimmed() == modelHeader;
+}
+
+bool G2PModel::load(const QString& path)
+{
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly)) {
+    m_lastError = i18nc("%1 is path", "Could not open model at \"%1\"", path);
+    return false;
+  }
+  QByteArray data = f.readAll();
+  QList<QByteArray> lines = data.split('\n');
+  if ((lines.count() < 2) || (lines[0] != modelHeader)) {
+    m_lastError = i18nc("%1 is path", "\"%1\" is not a valid grapheme to phoneme model", path);
+    return false;
+  }
+
+  m_rules.clear();
+  int levels = lines[1].toInt();
+  for (int level = 0; level < levels; ++level)
+    m_rules << QHash<QString, QString>();
+
+  for (int i = 2; i < lines.count(); ++i) {
+    if (lines[i].isEmpty())
+      continue;
+    QList<QByteArray> fields = lines[i].split('\t');
+    int level = fields[0].toInt();
+    if ((fields.count() != 3) || (level < 0) || (level >= levels)) {
+      m_lastError = i18nc("%1 is path", "\"%1\" is not a valid grapheme to phoneme model", path);
+      m_rules.clear();
+      return false;
+    }
+    m_rules[level].insert(QString::fromUtf8(fields[1]), QString::fromUtf8(fields[2]));
+  }
+  m_version = QString::fromAscii(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex());
+  return true;
+}
+
+bool G2PModel::transcribe(const QString& word, QString& pronunciation, QString *error) const
+{
+  QString graphemes = word.toUpper();
+  QString pad(maxContext, padding);
+  QString padded = pad + graphemes + pad;
+  QStringList phonemes;
+
+  for (int i = 0; i < graphemes.count(); ++i) {
+    //deeper levels only hold contexts that changed the decision
+    bool found = false;
+    QString chunk;
+    for (int level = 0; level < m_rules.count(); ++level) {
+      QHash<QString, QString>::const_iterator rule = m_rules[level].constFind(context(padded, i, level));
+      if (rule != m_rules[level].constEnd()) {
+        chunk = *rule;
+        found = true;
+      }
+    }
+    if (!found) {
+      pronunciation.clear();
+      if (error)
+        *error = i18nc("%1 is a letter", "Unknown grapheme: %1", graphemes.at(i));
+      return false;
+    }
+    if (!chunk.isEmpty())
+      phonemes << chunk;
+  }
+  pronunciation = phonemes.join(" ");
+  return true;
+}
@@ -0,0 +1,111 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SIMON_G2PMODEL_H_9FF3CFDC189440C998D92BE1E0D3B99C
+#define SIMON_G2PMODEL_H_9FF3CFDC189440C998D92BE1E0D3B99C
+
+#include "simongraphemetophoneme_export.h"
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+
+/**
+ * \class G2PModel
+ * \brief Native grapheme to phoneme model
+ *
+ * Training aligns every grapheme of the lexicon to zero, one or two
+ * phonemes (EM over all possible joint sequences). The best alignment of
+ * the corpus is then compressed into a chain of increasingly wide
+ * grapheme contexts; a context is only stored when it changes the
+ * decision of its parent.
+ *
+ * Transcription looks up the widest matching context for every grapheme.
+ * A trained model is read only and can be shared between threads.
+ */
+class SIMONGRAPHEMETOPHONEME_EXPORT G2PModel
+{
+public:
+  G2PModel();
+
+  /**
+   * Reads a lexicon in the sphinx dictionary format (word, tab, space
+   * separated phonemes) as training data.
+   */
+  bool loadLexicon(const QString& path);
+
+  /**
+   * One EM pass over the lexicon re-estimating the grapheme to phoneme
+   * chunk probabilities.
+   */
+  void align();
+
+  /**
+   * Aligns the lexicon with the current probabilities, builds the context
+   * rules from it and releases the training data.
+   */
+  void buildRules();
+
+  bool save(const QString& path);
+  bool load(const QString& path);
+
+  /**
+   * \return True if the given file is a model in this format (and not, for
+   *         example, a sequitur model)
+   */
+  static bool isNativeModel(const QString& path);
+
+  /**
+   * Identifies the model contents; Changes whenever the model is retrained.
+   */
+  QString version() const { return m_version; }
+
+  /**
+   * \param pronunciation Set to the pronunciation or emptied on failure
+   * \param error Optional; Set to the reason if the word can't be transcribed
+   */
+  bool transcribe(const QString& word, QString& pronunciation, QString *error=0) const;
+
+  QString lastError() const { return m_lastError; }
+
+private:
+  struct Entry {
+    QString graphemes;
+    QStringList phonemes;
+    QList<int> chunkLengths;
+  };
+  typedef QHash<QChar, QHash<QString, double> > ChunkCounts;
+  struct Aligner;
+  struct Estimator;
+  friend struct Aligner;
+  friend struct Estimator;
+
+  QList<Entry> m_lexicon;
+  QHash<QChar, QHash<QString, double> > m_emission;
+  QList< QHash<QString, QString> > m_rules;
+  QString m_version;
+  QString m_lastError;
+
+  void alignEntry(Entry& entry) const;
+  ChunkCounts estimate(const Entry& entry) const;
+  double emission(const QChar& grapheme, const QString& chunk, int length) const;
+  static QString context(const QString& padded, int position, int level);
+};
+
+#endif
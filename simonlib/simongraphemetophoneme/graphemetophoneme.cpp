@@ -18,17 +18,47 @@
  */
 
 #include "graphemetophoneme.h"
+#include "g2pmodel.h"
+#include "g2pcache.h"
 #include <KProcess>
 #include <KStandardDirs>
 #include <KDebug>
 #include <KLocalizedString>
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QtConcurrentRun>
+#include <QtConcurrentMap>
+
+struct Transcriber
+{
+  typedef TranscriptionResult result_type;
+  const G2PModel *model;
+  Transcriber(const G2PModel *m) : model(m) {}
+  TranscriptionResult operator()(const QString& word) const {
+    QString pronunciation, error;
+    if (!model->transcribe(word, pronunciation, &error))
+      return TranscriptionResult(false, error);
+    return TranscriptionResult(true, pronunciation);
+  }
+};
+
+//the model used for transcription is kept around as long as it doesn't change on disk
+static QMutex sharedModelLock;
+static G2PModel *sharedModel = 0;
+static QString sharedModelPath;
+static QDateTime sharedModelModified;
 
 GraphemeToPhoneme::GraphemeToPhoneme(QObject *parent) : QObject(parent),
-	sequitur(new KProcess(this)),
+	model(0),
+	trainer(new QFutureWatcher<bool>(this)),
+	aborting(false),
 	m_state(GraphemeToPhoneme::Idle)
 {
-  connect(sequitur, SIGNAL(finished(int)), this, SLOT(nextStep(int)));
+  connect(trainer, SIGNAL(finished()), this, SLOT(nextStep()));
 }
 
 bool GraphemeToPhoneme::findSequitur(QString& out)
@@ -45,76 +75,101 @@ bool GraphemeToPhoneme::findSequitur(QString& out)
   return true;
 }
 
+QString GraphemeToPhoneme::trainingLexiconPath()
+{
+  return KStandardDirs::locateLocal("tmp", "simon/g2p/train.lex");
+}
+
 bool GraphemeToPhoneme::createProfile()
 {
-  if (!findSequitur(sequiturExe)) {
-    emit failed();
+  if (m_state != Idle && m_state != Finished) {
+    error = i18n("A model is already being created.");
     return false;
   }
-  
-  sequitur->setWorkingDirectory(KStandardDirs::locateLocal("tmp", "simon/sequitur/"));
-  sequitur->setOutputChannelMode(KProcess::OnlyStderrChannel);
- 
+
+  delete model;
+  model = new G2PModel;
+  aborting = false;
+  m_state = Idle;
   nextStep();
   return true;
 }
 
-void GraphemeToPhoneme::nextStep(int finish)
+void GraphemeToPhoneme::nextStep()
 {
-  if (finish != 0) {
-    //error handling
-    error = i18nc("%1 is error message", "An unexpected error occurred when creating the model with sequitur:\n\n%1", QString::fromUtf8(sequitur->readAllStandardError()));
-    
-    sequitur->terminate(); //if we are not yet done, abort
-    m_state = Idle;
-    kDebug() << "Error: " << error;
-    
-    emit failed();
-    return;
+  if (m_state != Idle) {
+    if (aborting || !trainer->result()) {
+      if (!aborting) {
+        error = i18nc("%1 is error message", "An unexpected error occurred when creating the model:\n\n%1", model->lastError());
+        kDebug() << "Error: " << error;
+      }
+      m_state = Idle;
+      emit failed();
+      return;
+    }
   }
   
   switch(m_state) {
     case Idle:
-      sequitur->setProgram(sequiturExe, QStringList() << "--train" << "train.lex" << "--devel" << "5%" << "--write-model" << "model1");
       m_state = Initial;
       emit state(i18n("Creating initial model..."), 3, 100);
       break;
     case Initial:
-      sequitur->setProgram(sequiturExe, QStringList() << "--model" << "model1" << "--ramp-up" << "--train" << "train.lex" << "--devel" << "5%" << "--write-model" << "model2");
       m_state = RampUp1;
       emit state(i18n("Improving model (1/4)..."), 7, 100);
       break;
     case RampUp1:
-      sequitur->setProgram(sequiturExe, QStringList() << "--model" << "model2" << "--ramp-up" << "--train" << "train.lex" << "--devel" << "5%" << "--write-model" << "model3");
       m_state = RampUp2;
       emit state(i18n("Improving model (2/4)..."), 15, 100);
       break;
     case RampUp2:
-      sequitur->setProgram(sequiturExe, QStringList() << "--model" << "model3" << "--ramp-up" << "--train" << "train.lex" << "--devel" << "5%" << "--write-model" << "model4");
       m_state = RampUp3;
       emit state(i18n("Improving model (3/4)..."), 32, 100);
       break;
     case RampUp3:
-      sequitur->setProgram(sequiturExe, QStringList() << "--model" << "model4" << "--ramp-up" << "--train" << "train.lex" << "--devel" << "5%" << "--write-model" << "model5");
       m_state = RampUp4;
       emit state(i18n("Improving model (4/4)..."), 58, 100);
       break;
     case RampUp4: {
+      m_state = Finished;
       emit state(i18n("Finished."), 100,100);
-      emit success(KStandardDirs::locateLocal("tmp", "simon/sequitur/model5"));
-      break;
+      emit success(KStandardDirs::locateLocal("tmp", "simon/g2p/model"));
+      return;
     }
     default:
       kDebug() << "Not implemented";
       return;
   };
 
-   sequitur->start();
+  trainer->setFuture(QtConcurrent::run(this, &GraphemeToPhoneme::trainStep));
+}
+
+bool GraphemeToPhoneme::trainStep()
+{
+  switch (m_state) {
+    case Initial:
+      if (!model->loadLexicon(trainingLexiconPath()))
+        return false;
+      model->align();
+      return true;
+    case RampUp1:
+    case RampUp2:
+    case RampUp3:
+      model->align();
+      return true;
+    case RampUp4:
+      model->align();
+      model->buildRules();
+      return model->save(KStandardDirs::locateLocal("tmp", "simon/g2p/model"));
+    default:
+      return false;
+  }
 }
 
 void GraphemeToPhoneme::abort()
 {
-  sequitur->terminate();
+  //the running step can not be interrupted; nextStep() will stop afterwards
+  aborting = true;
 }
 
 GraphemeToPhoneme::GraphemeToPhonemeState GraphemeToPhoneme::getState()
@@ -127,7 +182,66 @@ QString GraphemeToPhoneme::getError()
   return error;
 }
 
+GraphemeToPhoneme::~GraphemeToPhoneme()
+{
+  aborting = true;
+  trainer->waitForFinished();
+  delete model;
+}
+
 QHash< QString, TranscriptionResult > GraphemeToPhoneme::transcribe(const QStringList& words, const QString& pathToModel)
+{
+  if (!G2PModel::isNativeModel(pathToModel))
+    return transcribeSequitur(words, pathToModel);
+
+  kDebug() << "Transcribing: " << words;
+  QHash<QString, TranscriptionResult> transcribed;
+
+  QMutexLocker l(&sharedModelLock);
+  QDateTime modified = QFileInfo(pathToModel).lastModified();
+  if (!sharedModel || (sharedModelPath != pathToModel) || (sharedModelModified != modified)) {
+    delete sharedModel;
+    sharedModel = new G2PModel;
+    if (!sharedModel->load(pathToModel)) {
+      kWarning() << sharedModel->lastError();
+      delete sharedModel;
+      sharedModel = 0;
+      return transcribed;
+    }
+    sharedModelPath = pathToModel;
+    sharedModelModified = modified;
+  }
+
+  G2PCache cache(KStandardDirs::locateLocal("appdata", "model/g2pcache/"));
+  cache.load(sharedModel->version());
+
+  QStringList toTranscribe;
+  QSet<QString> queued;
+  foreach (const QString& word, words) {
+    QString w = word.toUpper();
+    if (transcribed.contains(w) || queued.contains(w))
+      continue;
+    if (cache.contains(w))
+      transcribed.insert(w, TranscriptionResult(true, cache.pronunciation(w)));
+    else {
+      toTranscribe << w;
+      queued.insert(w);
+    }
+  }
+
+  QList<TranscriptionResult> results = QtConcurrent::blockingMapped<QList<TranscriptionResult> >(toTranscribe, Transcriber(sharedModel));
+  for (int i=0; i < toTranscribe.count(); i++) {
+    transcribed.insert(toTranscribe[i], results[i]);
+    if (results[i].getSuccess())
+      cache.insert(toTranscribe[i], results[i].getData());
+  }
+  if (!cache.save())
+    kWarning() << "Failed to store pronunciation cache";
+
+  return transcribed;
+}
+
+QHash< QString, TranscriptionResult > GraphemeToPhoneme::transcribeSequitur(const QStringList& words, const QString& pathToModel)
 {
   kDebug() << "Transcribing: " << words;
   QHash<QString, TranscriptionResult> transcribed;
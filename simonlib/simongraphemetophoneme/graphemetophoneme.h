@@ -24,8 +24,9 @@
 #include "simongraphemetophoneme_export.h"
 #include <QObject>
 #include <QHash>
+#include <QFutureWatcher>
 
-class KProcess;
+class G2PModel;
 
 class SIMONGRAPHEMETOPHONEME_EXPORT GraphemeToPhoneme : public QObject
 {
@@ -48,20 +49,30 @@ public:
   };
   
 private:
-  KProcess *sequitur;
-  QString sequiturExe;
+  G2PModel *model;
+  QFutureWatcher<bool> *trainer;
+  bool aborting;
   QString error;
   
   GraphemeToPhonemeState m_state;
   
+  bool trainStep();
+  static QHash<QString, TranscriptionResult> transcribeSequitur(const QStringList& words, const QString& pathToModel);
   
 private slots:
-  void nextStep(int finish=0);
+  void nextStep();
   
 public:
   GraphemeToPhoneme(QObject *parent=0);
+  ~GraphemeToPhoneme();
 
+  /**
+   * Trains a new model from the lexicon at trainingLexiconPath() in the
+   * background; Emits success() with the path of the model when done.
+   */
   bool createProfile();
+
+  static QString trainingLexiconPath();
   
   /**
    * \return True if sequitur was found
@@ -69,6 +80,11 @@ public:
    */
   static bool findSequitur(QString& out);
   
+  /**
+   * Transcribes the given words in parallel; Generated pronunciations are
+   * cached per model version. Failed results hold the error message.
+   * Models of older versions are still supported through sequitur.
+   */
   static QHash<QString, TranscriptionResult> transcribe(const QStringList& words, const QString& pathToModel);
   
   void abort();
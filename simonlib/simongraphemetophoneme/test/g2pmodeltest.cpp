@@ -0,0 +1,171 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "../g2pmodel.h"
+#include "../g2pcache.h"
+
+#include <QTest>
+#include <QFile>
+#include <QDir>
+#include <QHash>
+
+class testG2PModel: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testTraining();
+    void testSaveLoad();
+    void testUnknownGrapheme();
+    void testCache();
+
+  private:
+    QHash<QString, QString> lexicon;
+    QString lexiconPath;
+    QString modelPath;
+    QString cachePath;
+    G2PModel model;
+
+    void removeCache();
+};
+
+void testG2PModel::removeCache()
+{
+  QDir cache(cachePath);
+  foreach (const QString& file, cache.entryList(QDir::Files))
+    cache.remove(file);
+  QDir::temp().rmdir("simon_g2ptest_cache");
+}
+
+void testG2PModel::initTestCase()
+{
+  lexicon.insert("CAT", "k a t");
+  lexicon.insert("HAT", "h a t");
+  lexicon.insert("HATS", "h a t s");
+  lexicon.insert("CHAT", "tS a t");
+  lexicon.insert("THAT", "D a t");
+  lexicon.insert("TAX", "t a k s");
+  lexicon.insert("SAT", "s a t");
+  lexicon.insert("SHOT", "S O t");
+
+  lexiconPath = QDir::temp().filePath("simon_g2ptest_train.lex");
+  modelPath = QDir::temp().filePath("simon_g2ptest_model");
+  cachePath = QDir::temp().filePath("simon_g2ptest_cache");
+  removeCache();
+
+  QFile f(lexiconPath);
+  QVERIFY(f.open(QIODevice::WriteOnly));
+  for (QHash<QString, QString>::const_iterator i = lexicon.constBegin(); i != lexicon.constEnd(); ++i)
+    f.write(i.key().toLower().toUtf8() + '\t' + i.value().toUtf8() + '\n');
+  f.close();
+
+  QVERIFY(model.loadLexicon(lexiconPath));
+  for (int i = 0; i < 5; ++i)
+    model.align();
+  model.buildRules();
+}
+
+void testG2PModel::cleanupTestCase()
+{
+  QFile::remove(lexiconPath);
+  QFile::remove(modelPath);
+  removeCache();
+}
+
+void testG2PModel::testTraining()
+{
+  for (QHash<QString, QString>::const_iterator i = lexicon.constBegin(); i != lexicon.constEnd(); ++i) {
+    QString pronunciation;
+    QVERIFY(model.transcribe(i.key(), pronunciation));
+    QCOMPARE(pronunciation, i.value());
+  }
+}
+
+void testG2PModel::testSaveLoad()
+{
+  QVERIFY(model.save(modelPath));
+  QVERIFY(G2PModel::isNativeModel(modelPath));
+  QVERIFY(!G2PModel::isNativeModel(lexiconPath));
+
+  G2PModel loaded;
+  QVERIFY(loaded.load(modelPath));
+  QCOMPARE(loaded.version(), model.version());
+
+  for (QHash<QString, QString>::const_iterator i = lexicon.constBegin(); i != lexicon.constEnd(); ++i) {
+    QString pronunciation;
+    QVERIFY(loaded.transcribe(i.key(), pronunciation));
+    QCOMPARE(pronunciation, i.value());
+  }
+}
+
+void testG2PModel::testUnknownGrapheme()
+{
+  QString pronunciation("stale"), error;
+  QVERIFY(!model.transcribe("QUIZ", pronunciation, &error));
+  QVERIFY(pronunciation.isEmpty());
+  QVERIFY(error.contains("Q"));
+  QVERIFY(!model.transcribe("QUIZ", pronunciation));
+}
+
+void testG2PModel::testCache()
+{
+  G2PCache cache(cachePath);
+  cache.load("1");
+  QVERIFY(!cache.contains("CAT"));
+  cache.insert("CAT", "k a t");
+  QVERIFY(cache.save());
+
+  G2PCache reloaded(cachePath);
+  reloaded.load("1");
+  QCOMPARE(reloaded.pronunciation("CAT"), QString("k a t"));
+  reloaded.insert("HAT", "h a t");
+  QVERIFY(reloaded.save());
+
+  G2PCache appended(cachePath);
+  appended.load("1");
+  QCOMPARE(appended.pronunciation("CAT"), QString("k a t"));
+  QCOMPARE(appended.pronunciation("HAT"), QString("h a t"));
+
+  //every model has its own entries
+  G2PCache other(cachePath);
+  other.load("2");
+  QVERIFY(!other.contains("CAT"));
+  other.insert("CAT", "k { t");
+  QVERIFY(other.save());
+
+  G2PCache switchedBack(cachePath);
+  switchedBack.load("1");
+  QCOMPARE(switchedBack.pronunciation("CAT"), QString("k a t"));
+  switchedBack.load("2");
+  QCOMPARE(switchedBack.pronunciation("CAT"), QString("k { t"));
+
+  //only the most recently used models are kept
+  for (int i = 0; i < G2PCache::maxModels; i++) {
+    G2PCache filler(cachePath);
+    filler.load(QString("filler%1").arg(i));
+    filler.insert("CAT", "k a t");
+    QVERIFY(filler.save());
+  }
+  QCOMPARE(QDir(cachePath).entryList(QDir::Files).count(), (int) G2PCache::maxModels);
+}
+
+QTEST_MAIN(testG2PModel)
+
+#include "g2pmodeltest.moc"
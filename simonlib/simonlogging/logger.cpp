@@ -27,73 +27,357 @@
 #include <QDebug>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QWaitCondition>
+#include <QThread>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QCoreApplication>
 #include <KDebug>
 
-QTextStream * Logger::logFile = 0;
-QFile * Logger::logF = 0;
+struct LogRecord
+{
+  //position (see below) the slot is ready for: a writer of the record at
+  //position p waits for p, the reader for p+1
+  QAtomicInt sequence;
+  qint64 time;
+  Logger::LogType type;
+  const char *component;
+  QString message;
+};
+
+//records not yet written; a bounded queue for many producers and one
+//consumer (the writer, under its write lock)
+static const int ringSize = 4096;
+static LogRecord ring[ringSize];
+static QAtomicInt enqueuePosition;
+static unsigned dequeuePosition = 0;
+static QAtomicInt pendingCount;
+
+class LogWriter;
+static QAtomicPointer<LogWriter> writer;
+static QAtomicInt closed;
+
+static QMutex settingsLock;
+static Logger::Format logFormat = Logger::Text;
+static qint64 maximumFileSize = 10*1024*1024;
+static QString logDirectory;
+
+//the writer wakes up at least this often (ms) or once this many records are queued
+static const unsigned long flushInterval = 500;
+static const int batchSize = 256;
+
+class LogWriter : public QThread
+{
+  public:
+    LogWriter() : m_stop(1) {}
+
+    bool isStopped() const { return m_stop; }
+    void resume();
+    void stop();
+    void wake() { m_wake.wakeOne(); }
+    void writePending();
+    void reset();
+
+  protected:
+    void run();
+
+  private:
+    QMutex m_waitLock;
+    QWaitCondition m_wake;
+    QAtomicInt m_stop;
+
+    QMutex m_writeLock;
+    QDate m_date;
+    QString m_path;
+    QFile m_file;
+    QTextStream m_stream;
+
+    void open(const QDate& date);
+    void rotate();
+    void purge(const QString& directory, const QDate& date);
+};
+
 QMutex * Logger::lock = new QMutex;
 
-QTextStream* Logger::init()
+void LogWriter::resume()
+{
+  m_stop = 0;
+  start(QThread::LowPriority);
+}
+
+void LogWriter::run()
+{
+  m_waitLock.lock();
+  while (!m_stop) {
+    m_wake.wait(&m_waitLock, flushInterval);
+    m_waitLock.unlock();
+    writePending();
+    m_waitLock.lock();
+  }
+  m_waitLock.unlock();
+  writePending();
+}
+
+void LogWriter::stop()
+{
+  m_waitLock.lock();
+  m_stop = 1;
+  m_wake.wakeOne();
+  m_waitLock.unlock();
+  wait();
+  reset();
+}
+
+void LogWriter::reset()
+{
+  QMutexLocker l(&m_writeLock);
+  m_stream.flush();
+  m_stream.setDevice(0);
+  m_file.close();
+  m_date = QDate();
+}
+
+void LogWriter::purge(const QString& directory, const QDate& date)
 {
   //remove logs older than 2 months
-  QDate currentDate = QDate::currentDate();
-  QDate purgeToDate = currentDate.addMonths(-2);
-  
-  QString protocolDir = KStandardDirs::locateLocal("appdata", "logs/");
-  QStringList files = QDir(protocolDir).entryList(QStringList() << "*.log", QDir::NoDotAndDotDot|QDir::Files);
+  QDate purgeToDate = date.addMonths(-2);
+
+  QStringList files = QDir(directory).entryList(QStringList() << "protocol-*.log", QDir::NoDotAndDotDot|QDir::Files);
   foreach (const QString& file, files)
   {
-    QString dateStr = file;
-    dateStr.remove("protocol-").remove(".log");
-    QDate logDate = QDate::fromString(dateStr, Qt::ISODate);
-    if (logDate < purgeToDate)
+    //protocol-<date>.log or protocol-<date>.<n>.log
+    QDate logDate = QDate::fromString(file.mid(QString("protocol-").length(), 10), Qt::ISODate);
+    if (logDate.isValid() && (logDate < purgeToDate))
     {
-      QString logPath = protocolDir+QDir::separator()+file;
+      QString logPath = directory+QDir::separator()+file;
       if (!QFile::remove(logPath))
 	kWarning() << "Couldn't remove old log at " << logPath;
     }
   }
-  
-  QString path = KStandardDirs::locateLocal("appdata", QString("logs/protocol-%1.log").arg(currentDate.toString(Qt::ISODate)));
+}
+
+void LogWriter::open(const QDate& date)
+{
+  m_stream.setDevice(0);
+  m_file.close();
+  m_date = date;
+
+  QString directory;
+  {
+    QMutexLocker l(&settingsLock);
+    directory = logDirectory;
+  }
+  purge(directory, date);
+
+  m_path = directory+QDir::separator()+QString("protocol-%1.log").arg(date.toString(Qt::ISODate));
+  m_file.setFileName(m_path);
+  if (!m_file.open(QIODevice::WriteOnly|QIODevice::Append)) {
+    kWarning() << "Couldn't open log at " << m_path;
+    return;
+  }
+  m_stream.setDevice(&m_file);
+}
+
+void LogWriter::rotate()
+{
+  m_stream.setDevice(0);
+  m_file.close();
+
+  QString base = m_path.left(m_path.length() - QString(".log").length());
+  int i = 1;
+  while (QFile::exists(QString("%1.%2.log").arg(base).arg(i)))
+    ++i;
+  if (!QFile::rename(m_path, QString("%1.%2.log").arg(base).arg(i)))
+    kWarning() << "Couldn't rotate log at " << m_path;
+  open(m_date);
+}
+
+static QString jsonEscape(const QString& string)
+{
+  QString escaped;
+  escaped.reserve(string.length() + 2);
+  for (int i = 0; i < string.length(); i++) {
+    ushort c = string.at(i).unicode();
+    switch (c) {
+      case '"': escaped += "\\\""; break;
+      case '\\': escaped += "\\\\"; break;
+      case '\n': escaped += "\\n"; break;
+      case '\r': escaped += "\\r"; break;
+      case '\t': escaped += "\\t"; break;
+      default:
+        if (c < 0x20)
+          escaped += QString("\\u%1").arg(c, 4, 16, QChar('0'));
+        else
+          escaped += string.at(i);
+    }
+  }
+  return escaped;
+}
+
+void LogWriter::writePending()
+{
+  QMutexLocker l(&m_writeLock);
+  LogRecord *record = &ring[dequeuePosition % ringSize];
+  if (unsigned(record->sequence.fetchAndAddAcquire(0)) != dequeuePosition + 1)
+    return;
+
+  Logger::Format format;
+  qint64 maximumSize;
+  {
+    QMutexLocker settings(&settingsLock);
+    format = logFormat;
+    maximumSize = maximumFileSize;
+  }
 
-  Logger::logF = new QFile(path);
-  if (!Logger::logF->open(QIODevice::WriteOnly|QIODevice::Append)) return 0;
-  Logger::logFile = new QTextStream(Logger::logF);
+  int count = 0;
+  for (; unsigned(record->sequence.fetchAndAddAcquire(0)) == dequeuePosition + 1; record = &ring[dequeuePosition % ringSize]) {
+    QDateTime time = QDateTime::fromMSecsSinceEpoch(record->time);
+    if (time.date() != m_date)
+      open(time.date());
 
-  return logFile;
+    if (m_file.isOpen()) {
+      if (format == Logger::Json) {
+        const char *level = (record->type == Logger::Error) ? "error" :
+                            (record->type == Logger::Warning) ? "warning" : "info";
+        m_stream << "{\"time\":\"" << time.toString("yyyy-MM-ddThh:mm:ss.zzz") << "\",\"level\":\"" << level << '"';
+        if (record->component)
+          m_stream << ",\"component\":\"" << jsonEscape(QString::fromUtf8(record->component)) << '"';
+        m_stream << ",\"message\":\"" << jsonEscape(record->message) << "\"}\n";
+      } else {
+        const char *tag = (record->type == Logger::Error) ? "[ERR] " :
+                          (record->type == Logger::Warning) ? "[WRN] " : "[INF] ";
+        m_stream << time.toString("[yyyy/MM/dd hh:mm:ss] ") << tag;
+        if (record->component)
+          m_stream << '[' << record->component << "] ";
+        m_stream << record->message << '\n';
+      }
+    }
+    record->message = QString();
+    //hand the slot to the producer of the next round
+    record->sequence.fetchAndStoreRelease(int(dequeuePosition + ringSize));
+    ++dequeuePosition;
+    ++count;
+  }
+  pendingCount.fetchAndAddRelaxed(-count);
+
+  //one write for the whole batch
+  m_stream.flush();
+  if (maximumSize && m_file.isOpen() && (m_file.size() > maximumSize))
+    rotate();
 }
 
 
-void Logger::log(QString message, Logger::LogType type)
+LogWriter* Logger::startWriter()
 {
   QMutexLocker l(lock);
-  if (!logFile) logFile = Logger::init();
+  LogWriter *w = writer;
+  if (!w) {
+    {
+      QMutexLocker settings(&settingsLock);
+      if (logDirectory.isEmpty())
+        logDirectory = KStandardDirs::locateLocal("appdata", "logs/");
+    }
+    for (int i = 0; i < ringSize; i++)
+      ring[i].sequence = i;
+    w = new LogWriter;
+    writer.fetchAndStoreRelease(w);
+    //write out everything that is still queued on shutdown
+    qAddPostRoutine(Logger::close);
+  }
+  if (w->isStopped())
+    w->resume();
+  return w;
+}
+
+
+bool Logger::init()
+{
+  closed = 0;
+  return startWriter();
+}
+
+
+void Logger::log(QString message, Logger::LogType type, const char *component)
+{
+  if (closed)
+    return;
+
+  LogWriter *w = writer;
+  if (!w || w->isStopped())
+    w = startWriter();
+
+  //claim the next free slot; if the ring is full, let the writer catch up
+  LogRecord *record;
+  unsigned position = unsigned(int(enqueuePosition));
+  forever {
+    record = &ring[position % ringSize];
+    int distance = int(unsigned(record->sequence.fetchAndAddAcquire(0)) - position);
+    if (distance == 0) {
+      if (enqueuePosition.testAndSetRelaxed(int(position), int(position + 1)))
+        break;
+    } else if (distance < 0) {
+      //closed while we were waiting; nobody is going to make room anymore
+      if (closed || w->isStopped())
+        return;
+      w->wake();
+      QThread::yieldCurrentThread();
+    }
+    position = unsigned(int(enqueuePosition));
+  }
+
+  record->time = QDateTime::currentMSecsSinceEpoch();
+  record->type = type;
+  record->component = component;
+  record->message = message;
+  record->sequence.fetchAndStoreRelease(int(position + 1));
+
+  //errors are written right away
+  if ((pendingCount.fetchAndAddRelaxed(1) >= batchSize) || (type == Logger::Error))
+    w->wake();
+}
+
+
+void Logger::setFormat(Logger::Format format)
+{
+  QMutexLocker l(&settingsLock);
+  logFormat = format;
+}
+
+
+void Logger::setMaximumFileSize(qint64 size)
+{
+  QMutexLocker l(&settingsLock);
+  maximumFileSize = size;
+}
+
 
-  QString tag;
-  switch (type)
+void Logger::setDirectory(const QString& path)
+{
   {
-    case Logger::Info:
-      tag = "[INF] ";
-      break;
-    case Logger::Warning:
-      tag = "[WRN] ";
-      break;
-    case Logger::Error:
-      tag = "[ERR] ";
-      break;
+    QMutexLocker l(&settingsLock);
+    logDirectory = path;
   }
-  *(Logger::logFile) << QDateTime::currentDateTime().toString("[yyyy/MM/dd hh:mm:ss] ") << tag << message << endl;
+  QMutexLocker l(lock);
+  LogWriter *w = writer;
+  if (w)
+    w->reset();
 }
 
 
-void Logger::close()
+void Logger::flush()
 {
   QMutexLocker l(lock);
-  (Logger::logFile)->flush();
-  delete (Logger::logFile);
-  if (Logger::logF)
-    Logger::logF->deleteLater();
+  LogWriter *w = writer;
+  if (w)
+    w->writePending();
+}
+
 
-  Logger::logFile = 0;
-  Logger::logF = 0;
+void Logger::close()
+{
+  QMutexLocker l(lock);
+  closed = 1;
+  LogWriter *w = writer;
+  if (w)
+    w->stop();
 }
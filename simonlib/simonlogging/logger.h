@@ -26,18 +26,20 @@
  \class Logger
  \author Peter Grasch
  \brief Logs messages to the logfile with static functions
+
+ Messages are queued without locking in a preallocated ring and written
+ in batches by a background thread. The log is rotated daily and whenever
+ it exceeds the maximum file size.
 */
 
-class QTextStream;
-class QFile;
 class QMutex;
+class LogWriter;
 
 class SIMONLOGGING_EXPORT Logger
 {
   private:
-    static QTextStream *logFile;
-    static QFile *logF;
     static QMutex *lock;
+    static LogWriter* startWriter();
 
   public:
     enum LogType {
@@ -45,26 +47,55 @@ class SIMONLOGGING_EXPORT Logger
       Warning=2,
       Error=4
     };
+    enum Format {
+      Text=1,
+      Json=2
+    };
+
     /**
-     * \brief Initialises the file handle and the stream
+     * \brief Starts the writer (logging starts it implicitly until close())
      * \author Peter Grasch
-     * @param path
-     * The path to the file - will be created if it doesn't exist
      * @return
      * success
      */
-    static QTextStream* init();
+    static bool init();
 
     /**
      * \brief Logs the given string to the file (adds a timecode)
      * \author Peter Grasch
      * @param message
      * The message to log
+     * @param component
+     * Optional tag of the logging component; Has to be a string literal
+     */
+    static void log(QString message, LogType type=Info, const char *component=0);
+
+    /**
+     * \brief Format of records written from now on
+     */
+    static void setFormat(Format format);
+
+    /**
+     * \brief Size after which the current log is moved aside (0 disables this)
+     */
+    static void setMaximumFileSize(qint64 size);
+
+    /**
+     * \brief Folder of the logs; Defaults to the logs folder of the application
+     */
+    static void setDirectory(const QString& path);
+
+    /**
+     * \brief Writes all queued messages before returning
      */
-    static void log(QString message, LogType type=Info);
+    static void flush();
 
     /**
      *        \brief Closes and flushes the buffer
+     *
+     *        Messages logged afterwards are dropped until init() is called
+     *        again; This keeps logging during shutdown from restarting the
+     *        writer.
      *        \author Peter Grasch
      */
     static void close();
@@ -0,0 +1,186 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "../logger.h"
+
+#include <QTest>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <QTextStream>
+#include <QDebug>
+
+class LoggingThread : public QThread
+{
+  public:
+    LoggingThread(int id, int count) : m_id(id), m_count(count) {}
+
+  protected:
+    void run() {
+      for (int i = 0; i < m_count; i++)
+        Logger::log(QString("%1 %2").arg(m_id).arg(i), Logger::Info, "test");
+    }
+
+  private:
+    int m_id;
+    int m_count;
+};
+
+class testLogger: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void init();
+    void cleanup();
+    void testConcurrent();
+    void testFormat();
+    void testRotation();
+    void testClosed();
+    void benchmarkLog();
+
+  private:
+    QDir directory;
+
+    QStringList readLines();
+};
+
+void testLogger::init()
+{
+  directory = QDir::temp();
+  directory.mkdir("simonloggertest");
+  QVERIFY(directory.cd("simonloggertest"));
+  foreach (const QString& file, directory.entryList(QDir::Files))
+    directory.remove(file);
+
+  Logger::setDirectory(directory.absolutePath());
+  Logger::setFormat(Logger::Text);
+  Logger::setMaximumFileSize(0);
+  QVERIFY(Logger::init());
+}
+
+void testLogger::cleanup()
+{
+  Logger::close();
+  foreach (const QString& file, directory.entryList(QDir::Files))
+    directory.remove(file);
+  QDir::temp().rmdir("simonloggertest");
+}
+
+QStringList testLogger::readLines()
+{
+  Logger::flush();
+  QStringList lines;
+  foreach (const QString& file, directory.entryList(QStringList() << "*.log", QDir::Files, QDir::Name)) {
+    QFile f(directory.filePath(file));
+    if (!f.open(QIODevice::ReadOnly))
+      continue;
+    QTextStream ts(&f);
+    while (!ts.atEnd())
+      lines << ts.readLine();
+  }
+  return lines;
+}
+
+void testLogger::testConcurrent()
+{
+  const int threadCount = 4;
+  const int count = 5000;
+  QList<LoggingThread*> threads;
+  for (int i = 0; i < threadCount; i++)
+    threads << new LoggingThread(i, count);
+  foreach (LoggingThread *t, threads)
+    t->start();
+  foreach (LoggingThread *t, threads)
+    t->wait();
+  qDeleteAll(threads);
+
+  QStringList lines = readLines();
+  QCOMPARE(lines.count(), threadCount * count);
+
+  //every message exactly once and in order per thread
+  QVector<int> next(threadCount, 0);
+  foreach (const QString& line, lines) {
+    QStringList fields = line.section("[test] ", 1).split(' ');
+    QCOMPARE(fields.count(), 2);
+    int id = fields[0].toInt();
+    QCOMPARE(fields[1].toInt(), next[id]++);
+  }
+}
+
+void testLogger::testFormat()
+{
+  Logger::log("plain");
+  Logger::log("with \"quotes\"", Logger::Error, "component");
+  QStringList lines = readLines();
+  QCOMPARE(lines.count(), 2);
+  QVERIFY(lines[0].endsWith("] [INF] plain"));
+  QVERIFY(lines[1].endsWith("] [ERR] [component] with \"quotes\""));
+
+  Logger::setFormat(Logger::Json);
+  Logger::log("line\nbreak", Logger::Warning, "json");
+  lines = readLines();
+  QCOMPARE(lines.count(), 3);
+  QVERIFY(lines[2].startsWith("{\"time\":\""));
+  QVERIFY(lines[2].endsWith("\",\"level\":\"warning\",\"component\":\"json\",\"message\":\"line\\nbreak\"}"));
+}
+
+void testLogger::testRotation()
+{
+  const qint64 maximumSize = 16*1024;
+  Logger::setMaximumFileSize(maximumSize);
+  for (int i = 0; i < 5000; i++) {
+    Logger::log(QString("message %1").arg(i));
+    if (i % 100 == 0)
+      Logger::flush();
+  }
+  QCOMPARE(readLines().count(), 5000);
+
+  QStringList files = directory.entryList(QStringList() << "*.log", QDir::Files);
+  QVERIFY(files.count() > 5);
+  foreach (const QString& file, files)
+    QVERIFY(QFileInfo(directory.filePath(file)).size() < 2 * maximumSize);
+}
+
+void testLogger::testClosed()
+{
+  Logger::log("before");
+  Logger::close();
+  Logger::log("after");
+  QStringList lines = readLines();
+  QCOMPARE(lines.count(), 1);
+  QVERIFY(lines[0].endsWith("] [INF] before"));
+
+  QVERIFY(Logger::init());
+  Logger::log("again");
+  QCOMPARE(readLines().count(), 2);
+}
+
+void testLogger::benchmarkLog()
+{
+  QString message("The quick brown fox jumps over the lazy dog");
+  QBENCHMARK {
+    Logger::log(message, Logger::Info, "benchmark");
+  }
+}
+
+QTEST_MAIN(testLogger)
+
+#include "loggertest.moc"
@@ -323,23 +323,23 @@ bool ModelTest::recognize(const QStringList& fileNames, RecognitionConfiguration
     return false;
   }
 
-  foreach (const QString& file, fileNames) {
-    if (!keepGoing)
-      break;
-    
-    QList<RecognitionResult> recognitionResults = recog->recognize(file);
-    
-    if (recognitionResults.isEmpty())
-      searchFailed(file);
-    else
-      recognized(file, recognitionResults);
-  }
+  recog->recognizeBatch(fileNames, this);
   
   recog->uninitialize();
 
   return keepGoing;
 }
 
+bool ModelTest::batchResult(int index, const QString& file, const QList<RecognitionResult>& results)
+{
+  Q_UNUSED(index);
+  if (results.isEmpty())
+    searchFailed(file);
+  else
+    recognized(file, results);
+  return keepGoing;
+}
+
 
 void ModelTest::searchFailed(const QString& fileName)
 {
@@ -23,6 +23,7 @@
 
 #include <simonrecognitionresult/recognitionresult.h>
 #include <simonrecognizer/recognitionconfiguration.h>
+#include <simonrecognizer/recognizer.h>
 #include "simonmodeltest_export.h"
 #include <QThread>
 #include <QProcess>
@@ -33,9 +34,8 @@ class TestResult;
 class TestResultLeaf;
 class TestResultModel;
 class FileResultModel;
-class Recognizer;
 
-class MODELTEST_EXPORT ModelTest : public QThread
+class MODELTEST_EXPORT ModelTest : public QThread, public RecognitionResultCallback
 {
   Q_OBJECT
 signals:
@@ -68,6 +68,7 @@ public:
 
   void recognized(const QString& file, RecognitionResultList);
   void searchFailed(const QString& file);
+  bool batchResult(int index, const QString& file, const QList<RecognitionResult>& results);
 
   FileResultModel* recognizerResultsModel();
   TestResultModel* wordResultsModel();
@@ -26,6 +26,10 @@
  *
  * length is ONLY ommitted if it would be 0 (i.e. no data after the type) or if the length of the packet is not
  * variable
+ *
+ * Model containers are transferred as a series of BaseModel / ActiveModel chunks in ascending order. The
+ * receiver requests the rest of an interrupted transfer with GetBaseModel / GetActiveModel and the offset
+ * it has received so far.
  */
 namespace Simond
 {
@@ -43,16 +47,16 @@ namespace Simond
     AbortSynchronisation=2004,
     AbortSynchronisationFailed=2005,
 
-    GetBaseModel=2013,
+    GetBaseModel=2013,                            /* qint64 offset */
     ErrorRetrievingBaseModel=2014,
-    BaseModel=2015,
+    BaseModel=2015,                               /* qint64 length, QDateTime modifiedDate, qint32 baseModelType, qint64 totalSize, qint64 offset, QByteArray chunk */
     BaseModelStorageFailed=2016,
 
-    GetActiveModel=2023,
+    GetActiveModel=2023,                          /* qint64 offset */
     ErrorRetrievingActiveModel=2024,
     GetActiveModelSampleRate=2025,
-    ActiveModelSampleRate=2026,                   /* QDateTime modifiedDat, qint32 samplerate, QByteArray hmmDefs, QByteArray tiedlist, QByteArray dict, QByteArray dfa */
-    ActiveModel=2027,                             /* QDateTime modifiedDat, qint32 samplerate, QByteArray hmmDefs, QByteArray tiedlist, QByteArray dict, QByteArray dfa */
+    ActiveModelSampleRate=2026,                   /* qint32 samplerate */
+    ActiveModel=2027,                             /* qint64 length, QDateTime modifiedDate, qint32 samplerate, qint64 totalSize, qint64 offset, QByteArray chunk */
     ActiveModelStorageFailed=2029,
 
     GetLanguageDescription=2053,
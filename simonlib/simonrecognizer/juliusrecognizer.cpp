@@ -75,6 +75,7 @@ bool JuliusRecognizer::startProcess()
     return true;
   }
 
+  m_pendingOutput.clear();
   m_juliusProcess->start();
   int deferredCount = 0;
   while (!m_juliusProcess->waitForStarted(500)) {
@@ -102,8 +103,25 @@ bool JuliusRecognizer::startProcess()
 }
 
 
+bool JuliusRecognizer::takeTillPrompt(QByteArray *data)
+{
+  static const QByteArray prompt("enter filename->");
+  int promptIndex = m_pendingOutput.indexOf(prompt);
+  if (promptIndex == -1)
+    return false;
+
+  promptIndex += prompt.count();
+  if (data) *data += m_pendingOutput.left(promptIndex);
+  m_pendingOutput.remove(0, promptIndex);
+  return true;
+}
+
 bool JuliusRecognizer::blockTillPrompt(QByteArray *data)
 {
+  //a pipelined batch might have already delivered the next prompt
+  if (takeTillPrompt(data))
+    return true;
+
   //wait until julius is ready
   QByteArray currentData;
   initializationLock.lock();
@@ -116,11 +134,9 @@ bool JuliusRecognizer::blockTillPrompt(QByteArray *data)
   {
     currentData = readData();
     initializationLock.unlock();
-    if (data) *data += currentData;
-    if (currentData.contains("enter filename->")) {
-      initializationLock.unlock();
+    m_pendingOutput += currentData;
+    if (takeTillPrompt(data))
       return true;
-    }
 
     if (currentData.isEmpty())
       ++deferredCount;
@@ -200,7 +216,14 @@ QList< RecognitionResult > JuliusRecognizer::recognize(const QString& file)
     return recognitionResults;
   }
   
-  QStringList results = QString::fromUtf8(result).split("\nsentence");
+  return parseResults(result);
+}
+
+QList< RecognitionResult > JuliusRecognizer::parseResults(const QByteArray& output)
+{
+  QList<RecognitionResult> recognitionResults;
+
+  QStringList results = QString::fromUtf8(output).split("\nsentence");
   results.takeFirst(); // remove preamble
   
   foreach (const QString& r, results)
@@ -242,6 +265,61 @@ QList< RecognitionResult > JuliusRecognizer::recognize(const QString& file)
   return recognitionResults;
 }
 
+bool JuliusRecognizer::recognizeBatch(const QStringList& files, RecognitionResultCallback *callback)
+{
+  //julius reads one file name per prompt from stdin; queuing a window of
+  //names at once lets it decode back to back instead of waiting for us to
+  //parse every result. The window bounds what has to be drained on abort.
+  static const int pipelineDepth = 16;
+
+  kDebug() << "Recognizing batch of " << files.count() << " files";
+  QMutexLocker l(&recognitionLock);
+
+  if (m_juliusProcess->state() == QProcess::NotRunning)
+  {
+    kDebug() << "Recognition requested even though julius was not running. Restarting";
+    if (!startProcess())
+      return false;
+  }
+
+  int queued = 0;
+  bool keepGoing = true;
+  for (int i=0; i < files.count(); ++i) {
+    if (keepGoing) {
+      QByteArray names;
+      for (; (queued < files.count()) && (queued < i + pipelineDepth); ++queued)
+        names += files[queued].toUtf8()+'\n';
+      if (!names.isEmpty())
+        m_juliusProcess->write(names);
+    }
+    if (i == queued)
+      break; // aborted and drained
+
+    QByteArray result;
+    QList<RecognitionResult> recognitionResults;
+    if (blockTillPrompt(&result))
+      recognitionResults = parseResults(result);
+    else {
+      m_lastError = i18n("Julius did not process the sample correctly");
+      //the rest of the window is still queued in julius; stop it so the
+      //next request (which restarts it) doesn't get those results
+      initializationLock.lock();
+      if (m_juliusProcess && !isBeingKilled) {
+        m_juliusProcess->kill();
+        m_juliusProcess->waitForFinished();
+      }
+      m_pendingOutput.clear();
+      initializationLock.unlock();
+      return false;
+    }
+
+    if (keepGoing)
+      keepGoing = callback->batchResult(i, files[i], recognitionResults);
+  }
+
+  return keepGoing;
+}
+
 bool JuliusRecognizer::uninitialize()
 {
   if (!m_juliusProcess) return true; // already uninitialized
@@ -250,6 +328,7 @@ bool JuliusRecognizer::uninitialize()
   isBeingKilled = true;
   initializationLock.lock();
   log.clear();
+  m_pendingOutput.clear();
 
   if (m_juliusProcess->state() != QProcess::NotRunning)
   {
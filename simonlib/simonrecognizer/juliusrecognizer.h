@@ -37,9 +37,12 @@ private:
   bool isBeingKilled;
   QMutex recognitionLock;
   QMutex initializationLock;
+  QByteArray m_pendingOutput;
   
 private:
+  bool takeTillPrompt(QByteArray *data);
   bool blockTillPrompt(QByteArray *data=0);
+  QList<RecognitionResult> parseResults(const QByteArray& output);
   QByteArray readData();
   bool startProcess();
   
@@ -47,6 +50,8 @@ public:
   JuliusRecognizer();
   bool init(RecognitionConfiguration* config);
   QList<RecognitionResult> recognize(const QString& file);
+  bool recognizeBatch(const QStringList& files, RecognitionResultCallback *callback);
+  using Recognizer::recognizeBatch;
   bool uninitialize();
   
   virtual ~JuliusRecognizer();
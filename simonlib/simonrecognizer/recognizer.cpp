@@ -0,0 +1,55 @@
+/*
+ *   Copyright (C) 2012 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "recognizer.h"
+
+#include <QFile>
+#include <QUuid>
+
+#include <KDE/KLocalizedString>
+#include <KDE/KStandardDirs>
+
+bool Recognizer::recognizeBatch(const QStringList& files, RecognitionResultCallback *callback)
+{
+  for (int i=0; i < files.count(); ++i)
+    if (!callback->batchResult(i, files[i], recognize(files[i])))
+      return false;
+  return true;
+}
+
+bool Recognizer::recognizeBatch(const QList<QByteArray>& buffers, RecognitionResultCallback *callback)
+{
+  QString prefix = KStandardDirs::locateLocal("tmp", QLatin1String("simon/recognizer/")+
+                                              QUuid::createUuid().toString());
+  bool success = true;
+  for (int i=0; success && (i < buffers.count()); ++i) {
+    QString path = prefix+'_'+QString::number(i)+".wav";
+    QFile f(path);
+    QList<RecognitionResult> results;
+    if (!f.open(QIODevice::WriteOnly) || (f.write(buffers[i]) != buffers[i].size()))
+      m_lastError = i18n("Failed to write temporary file \"%1\"", path);
+    else {
+      f.close();
+      results = recognize(path);
+    }
+    f.remove();
+    success = callback->batchResult(i, QString(), results);
+  }
+  return success;
+}
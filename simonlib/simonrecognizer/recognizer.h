@@ -25,8 +25,32 @@
 #include <simonrecognitionresult/recognitionresult.h>
 #include "simonrecognizer_export.h"
 
+#include <QStringList>
+#include <QByteArray>
+
 class RecognitionConfiguration;
 
+/*!
+ *  \class RecognitionResultCallback
+ *  \brief Receives the results of a batch recognition one input at a time.
+ *
+ *  Results are delivered in the order of the inputs from the thread that
+ *  called Recognizer::recognizeBatch(). An empty result list means that
+ *  the search failed for this input.
+ */
+class SIMONRECOGNIZER_EXPORT RecognitionResultCallback
+{
+public:
+  /*!
+   * \param index Position of the input in the batch
+   * \param file Input file name; Empty for in-memory buffers
+   * \return false to abort the remaining batch
+   */
+  virtual bool batchResult(int index, const QString& file, const QList<RecognitionResult>& results)=0;
+
+  virtual ~RecognitionResultCallback() {}
+};
+
 /*!
  *  \class Recognizer
  *  \brief The Recognizer class initialize recognition with given configuration
@@ -47,6 +71,24 @@ public:
   virtual bool init(RecognitionConfiguration* config)=0;
   virtual QList<RecognitionResult> recognize(const QString& file)=0;
   virtual bool uninitialize()=0;
+
+  /*!
+   * \brief Recognizes all given files and streams the results to \p callback.
+   *
+   * The default implementation calls recognize() for every file; backends
+   * override this to pipeline I/O and decoding.
+   * \return false if the batch was aborted by the callback or the backend
+   *         failed (see getLastError()); The remaining files are not reported
+   */
+  virtual bool recognizeBatch(const QStringList& files, RecognitionResultCallback *callback);
+
+  /*!
+   * \brief Recognizes in-memory WAV files (16 bit mono PCM at the model sample rate).
+   *
+   * The default implementation spools every buffer to a temporary file
+   * and calls recognize() on it; The callback gets a null file name.
+   */
+  virtual bool recognizeBatch(const QList<QByteArray>& buffers, RecognitionResultCallback *callback);
   
   QString getLastError() { return m_lastError; }
   
@@ -47,6 +47,10 @@ cmd_ln_t* SphinxRecognitionConfiguration::getSphinxConfig()
                                "-jsgf", grammar.data(),
                                "-dict", dict.data(),
                                "-samprate", samprate.data(),
+                               //acoustic models are shared by all decoders of simond
+                               "-mmap", "yes",
+                               //lattice for the n-best list and word posteriors
+                               "-bestpath", m_Lattice ? "yes" : "no",
                                NULL);
   return config;
 }
@@ -29,11 +29,17 @@
 class SIMONRECOGNIZER_EXPORT SphinxRecognitionConfiguration : public RecognitionConfiguration
 {
 public:
-  SphinxRecognitionConfiguration(const QString &modelDir, const QString &grammar, const QString &dictionary, const int &samprate):
+  /**
+   * \param lattice Search the lattice for the best path; Needed for the
+   *        n-best list and word posteriors
+   */
+  SphinxRecognitionConfiguration(const QString &modelDir, const QString &grammar, const QString &dictionary, const int &samprate,
+                                 bool lattice=true):
     m_ModelDir(modelDir),
     m_Grammar(grammar),
     m_Dictionary(dictionary),
-    m_Samprate(samprate){}
+    m_Samprate(samprate),
+    m_Lattice(lattice){}
 
   QString getModelDir() { return m_ModelDir; }
   QString getGrammar() { return m_Grammar; }
@@ -49,6 +55,7 @@ private:
   QString m_Grammar; //-jsgf
   QString m_Dictionary; //-dict
   int m_Samprate; //-samprate
+  bool m_Lattice; //-bestpath
 };
 
 #endif // SPHINXRECOGNITIONCONFIGURATION_H
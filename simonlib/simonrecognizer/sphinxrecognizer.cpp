@@ -26,13 +26,18 @@
 
 #include <QUuid>
 #include <QFile>
+#include <QSet>
+#include <QFuture>
+#include <QtConcurrentRun>
 #include <KDebug>
 #include <KDE/KLocalizedString>
 #include <KDE/KStandardDirs>
 
 SphinxRecognizer::SphinxRecognizer():
     logPath(KStandardDirs::locateLocal("tmp", QLatin1String("pocketsphinx_log_")+QUuid::createUuid().toString())),
-    decoder(0)
+    decoder(0),
+    m_maxHypotheses(defaultMaxHypotheses),
+    m_wordPosteriors(true)
 {
 }
 
@@ -108,50 +113,227 @@ QList<RecognitionResult> SphinxRecognizer::recognize(const QString &file)
 #else
       ps_decode_raw(decoder, toRecognize, -1);
 #endif
+  fclose(toRecognize);
   if(rv < 0)
   {
     m_lastError = i18n("Failed to decode \"%1\"", file);
     return recognitionResults;
   }
 
-  kDebug()<<"Recognition checkpoint";
+  return hypothesis(file);
+}
+
+static bool isFiller(const QString& word)
+{
+  return word.startsWith('<') || word.startsWith('[') || word.startsWith(QLatin1String("++"));
+}
+
+static QString baseWord(const QString& word)
+{
+  //alternative pronunciations are suffixed with their number: "word(2)"
+  int alternative = word.lastIndexOf('(');
+  if ((alternative > 0) && word.endsWith(')'))
+    return word.left(alternative);
+  return word;
+}
+
+QHash<QPair<QString, int>, float> SphinxRecognizer::wordPosteriors()
+{
+  QHash<QPair<QString, int>, float> posteriors;
+
+  ps_lattice_t *dag = ps_get_lattice(decoder);
+  if (!dag)
+    return posteriors;
+
+  float32 ascale = cmd_ln_float32_r(ps_get_config(decoder), "-ascale");
+  ps_lattice_posterior(dag, 0, 1.0f / ascale);
+  logmath_t *lmath = ps_lattice_get_logmath(dag);
 
-  int score;
-  char const *hyp;
+  for (ps_latnode_iter_t *i = ps_latnode_iter(dag); i; i = ps_latnode_iter_next(i)) {
+    ps_latnode_t *node = ps_latnode_iter_node(i);
+    ps_latlink_t *bestLink;
+    int16 firstEnd, lastEnd;
+    int startFrame = ps_latnode_times(node, &firstEnd, &lastEnd);
+    float posterior = (float) logmath_exp(lmath, ps_latnode_prob(dag, node, &bestLink));
+
+    //the same word can end in several nodes starting in the same frame
+    QPair<QString, int> key(QString::fromUtf8(ps_latnode_word(dag, node)), startFrame);
+    if (posterior > posteriors.value(key))
+      posteriors.insert(key, posterior);
+  }
+  return posteriors;
+}
+
+QString SphinxRecognizer::pronunciation(const QString& word)
+{
 #ifdef POCKETSPHINX_HAS_UTTID_APIS
-  char const *uttid;
-  hyp = ps_get_hyp(decoder, &score, &uttid);
+  //pocketsphinx 0.8 has no public dictionary lookup; results carry no phonemes there
+  Q_UNUSED(word);
+  return QString();
 #else
-  hyp = ps_get_hyp(decoder, &score);
+  QByteArray wordByte = word.toUtf8();
+  char *phones = ps_lookup_word(decoder, wordByte.constData());
+  if (!phones)
+    return QString();
+  QString pronunciation = QString::fromUtf8(phones);
+  ckd_free(phones);
+  return pronunciation;
 #endif
-  if(!hyp)
+}
+
+RecognitionResult SphinxRecognizer::alignment(ps_seg_t *seg, const QHash<QPair<QString, int>, float>& posteriors)
+{
+  QStringList words;
+  QStringList sampa;
+  QStringList sampaRaw;
+  QList<float> confidenceScores;
+
+  sampa << QLatin1String("sil");
+  for (; seg; seg = ps_seg_next(seg)) {
+    QString word = QString::fromUtf8(ps_seg_word(seg));
+    int startFrame, endFrame;
+    ps_seg_frames(seg, &startFrame, &endFrame);
+
+    QString phones = pronunciation(word);
+    sampaRaw << phones;
+    if (isFiller(word))
+      continue;
+
+    words << baseWord(word);
+    sampa << phones;
+    confidenceScores << posteriors.value(qMakePair(word, startFrame));
+  }
+  sampa << QLatin1String("sil");
+
+  return RecognitionResult(words.join(" "), sampa.join(" | "), sampaRaw.join(" | "), confidenceScores);
+}
+
+QList<RecognitionResult> SphinxRecognizer::hypothesis(const QString& name)
+{
+  QList<RecognitionResult> recognitionResults;
+
+#ifdef POCKETSPHINX_HAS_UTTID_APIS
+  int32 score;
+  ps_seg_t *best = ps_seg_iter(decoder, &score);
+#else
+  ps_seg_t *best = ps_seg_iter(decoder);
+#endif
+  if(!best)
   {
-    m_lastError = i18n("Cannot get hypothesis for \"%1\"", file);
+    m_lastError = i18n("Cannot get hypothesis for \"%1\"", name);
     return recognitionResults;
   }
 
-  fclose(toRecognize);
+  //word posteriors of the lattice are shared by all hypotheses
+  QHash<QPair<QString, int>, float> posteriors;
+  if (m_wordPosteriors)
+    posteriors = wordPosteriors();
+  recognitionResults << alignment(best, posteriors);
+  kDebug() << "Got hypothesis: " << recognitionResults.first().sentence();
+
+  //alternatives that only differ in fillers or pronunciation variants are skipped
+  QSet<QString> sentences;
+  sentences << recognitionResults.first().sentence();
 
-  QString sentence = QString::fromUtf8(hyp);
-  QString sampa;
-  int wordsCount = sentence.split(" ", QString::SkipEmptyParts).count();
+  //setting up the n-best search builds the lattice
+  ps_nbest_t *nbest = 0;
+  if (m_maxHypotheses > 1)
+#ifdef POCKETSPHINX_HAS_UTTID_APIS
+    nbest = ps_nbest(decoder, 0, -1, 0, 0);
+#else
+    nbest = ps_nbest(decoder);
+#endif
+  while (nbest && (recognitionResults.count() < m_maxHypotheses) && (nbest = ps_nbest_next(nbest))) {
+#ifdef POCKETSPHINX_HAS_UTTID_APIS
+    RecognitionResult alternative = alignment(ps_nbest_seg(nbest, &score), posteriors);
+#else
+    RecognitionResult alternative = alignment(ps_nbest_seg(nbest), posteriors);
+#endif
+    if (alternative.sentence().isEmpty() || sentences.contains(alternative.sentence()))
+      continue;
+    sentences << alternative.sentence();
+    recognitionResults << alternative;
+  }
+  if (nbest)
+    ps_nbest_free(nbest);
+
+  return recognitionResults;
+}
+
+static QByteArray readSample(const QString& path)
+{
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly))
+    return QByteArray();
+  return f.readAll();
+}
 
-  QList<float> tlist;
+QList<RecognitionResult> SphinxRecognizer::decode(const QByteArray& data, const QString& name)
+{
+  QList<RecognitionResult> recognitionResults;
+
+  //skip the RIFF header to hand pocketsphinx only the PCM payload
+  int offset = 0;
+  if (data.startsWith("RIFF")) {
+    int dataChunk = data.indexOf("data", 12);
+    if (dataChunk != -1)
+      offset = dataChunk + 8;
+  }
+  size_t samples = (data.size() - offset) / sizeof(int16);
 
-  for(int i(0); i < wordsCount; i++)
+  QByteArray uttName = name.toUtf8();
+  int rv =
+#ifdef POCKETSPHINX_HAS_UTTID_APIS
+      ps_start_utt(decoder, uttName.constData());
+#else
+      ps_start_utt(decoder);
+#endif
+  if (rv >= 0)
+    rv = ps_process_raw(decoder, reinterpret_cast<const int16*>(data.constData() + offset),
+                        samples, false, true);
+  if (rv >= 0)
+    rv = ps_end_utt(decoder);
+  if (rv < 0)
   {
-    tlist.append(0.99);
-    sampa.append("FIXME |");
+    m_lastError = i18n("Failed to decode \"%1\"", name);
+    return recognitionResults;
   }
 
-  RecognitionResult res = RecognitionResult(sentence, sampa /*"FIXME"*/, sampa /*"FIXME"*/, tlist);
+  return hypothesis(name);
+}
 
-  recognitionResults.append(res); //TODO: Find how to get SAMPA, using sphinx..
-  recognitionResults.append(res); //WARNING: some magic
+bool SphinxRecognizer::recognizeBatch(const QStringList& files, RecognitionResultCallback *callback)
+{
+  //read the next sample while the decoder works on the current one
+  QFuture<QByteArray> next;
+  if (!files.isEmpty())
+    next = QtConcurrent::run(readSample, files.first());
 
-  kDebug()<<"Got hypothesis: " <<QString::fromUtf8(hyp);
+  for (int i=0; i < files.count(); ++i) {
+    QByteArray data = next.result();
+    if (i+1 < files.count())
+      next = QtConcurrent::run(readSample, files[i+1]);
 
-  return recognitionResults;
+    QList<RecognitionResult> recognitionResults;
+    if (data.isEmpty())
+      m_lastError = i18n("Failed to open \"%1\"", files[i]);
+    else
+      recognitionResults = decode(data, files[i]);
+
+    if (!callback->batchResult(i, files[i], recognitionResults)) {
+      next.waitForFinished();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SphinxRecognizer::recognizeBatch(const QList<QByteArray>& buffers, RecognitionResultCallback *callback)
+{
+  for (int i=0; i < buffers.count(); ++i)
+    if (!callback->batchResult(i, QString(), decode(buffers[i], QString::number(i))))
+      return false;
+  return true;
 }
 
 bool SphinxRecognizer::uninitialize()
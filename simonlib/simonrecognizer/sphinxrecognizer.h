@@ -24,21 +24,48 @@
 #include "simonrecognizer_export.h"
 
 #include <QString>
+#include <QHash>
+#include <QPair>
 #include <pocketsphinx/pocketsphinx.h>
 #include <sphinxbase/err.h>
+#include <sphinxbase/ckd_alloc.h>
 
 class SIMONRECOGNIZER_EXPORT SphinxRecognizer : public Recognizer
 {
 private:
   QString logPath;
   ps_decoder_t *decoder;
+  int m_maxHypotheses;
+  bool m_wordPosteriors;
+
+  QHash<QPair<QString, int>, float> wordPosteriors();
+  QString pronunciation(const QString& word);
+  RecognitionResult alignment(ps_seg_t *seg, const QHash<QPair<QString, int>, float>& posteriors);
+  QList<RecognitionResult> hypothesis(const QString& name);
+  QList<RecognitionResult> decode(const QByteArray& data, const QString& name);
 
 public:
+  static const int defaultMaxHypotheses = 5;
+
   SphinxRecognizer();
   virtual ~SphinxRecognizer();
 
+  /**
+   * Number of alternative results (including the best one) read from the
+   * N-best list of the lattice; Every word carries its posterior probability
+   * as confidence score.
+   */
+  void setMaxHypotheses(int maxHypotheses) { m_maxHypotheses = maxHypotheses; }
+
+  /**
+   * Without word posteriors, the confidence scores of all words are 0
+   */
+  void setWordPosteriors(bool wordPosteriors) { m_wordPosteriors = wordPosteriors; }
+
   bool init(RecognitionConfiguration* config);
   QList<RecognitionResult> recognize(const QString& file);
+  bool recognizeBatch(const QStringList& files, RecognitionResultCallback *callback);
+  bool recognizeBatch(const QList<QByteArray>& buffers, RecognitionResultCallback *callback);
   virtual QByteArray getLog();
   bool uninitialize();
 
@@ -0,0 +1,185 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "../recognizer.h"
+#include "../juliusrecognizer.h"
+#include "../juliusstaticrecognitionconfiguration.h"
+#ifdef BACKEND_TYPE_BOTH
+#include "../sphinxrecognizer.h"
+#include "../sphinxrecognitionconfiguration.h"
+#endif
+
+#include <QTest>
+#include <QDir>
+#include <QTime>
+#include <QHash>
+#include <QDebug>
+
+/**
+ * Compares per utterance overhead of Recognizer::recognize() against
+ * Recognizer::recognizeBatch() for every backend that has a model.
+ *
+ * Julius: Set SIMON_BENCHMARK_MODEL to a folder containing julius.jconf,
+ * model.dfa, model.dict, hmmdefs, tiedlist and a samples/ folder with
+ * 16 kHz wav files.
+ *
+ * Pocketsphinx (if built): Set SIMON_BENCHMARK_SPHINX_MODEL to a folder
+ * containing the acoustic model, model.jsgf, model.dic and a samples/
+ * folder with 16 kHz wav files.
+ */
+class recognizerBenchmark: public QObject, public RecognitionResultCallback
+{
+  Q_OBJECT
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkSingle_data();
+    void benchmarkSingle();
+    void benchmarkBatch_data();
+    void benchmarkBatch();
+
+  public:
+    recognizerBenchmark() : resultCount(0) {}
+    bool batchResult(int index, const QString& file, const QList<RecognitionResult>& results);
+
+  private:
+    QHash<QString, Recognizer*> recognizers;
+    QHash<QString, QStringList> samples;
+    int resultCount;
+
+    static QStringList findSamples(const QDir& model);
+    void backends();
+    void report(const QString& backend, const char* mode, int elapsed);
+};
+
+bool recognizerBenchmark::batchResult(int index, const QString& file, const QList<RecognitionResult>& results)
+{
+  Q_UNUSED(index);
+  Q_UNUSED(file);
+  Q_UNUSED(results);
+  ++resultCount;
+  return true;
+}
+
+QStringList recognizerBenchmark::findSamples(const QDir& model)
+{
+  QStringList found;
+  QDir sampleDir(model.filePath("samples"));
+  foreach (const QString& sample, sampleDir.entryList(QStringList() << "*.wav", QDir::Files))
+    found << sampleDir.absoluteFilePath(sample);
+  return found;
+}
+
+void recognizerBenchmark::initTestCase()
+{
+  QString juliusPath = QString::fromLocal8Bit(qgetenv("SIMON_BENCHMARK_MODEL"));
+  if (!juliusPath.isEmpty()) {
+    QDir model(juliusPath);
+    samples.insert("julius", findSamples(model));
+    QVERIFY(!samples.value("julius").isEmpty());
+
+    JuliusStaticRecognitionConfiguration cfg(model.filePath("julius.jconf"), model.filePath("model.dfa"),
+                                             model.filePath("model.dict"), model.filePath("hmmdefs"),
+                                             model.filePath("tiedlist"), "16000");
+    Recognizer *recognizer = new JuliusRecognizer;
+    recognizers.insert("julius", recognizer);
+    QVERIFY(recognizer->init(&cfg));
+  }
+
+#ifdef BACKEND_TYPE_BOTH
+  QString sphinxPath = QString::fromLocal8Bit(qgetenv("SIMON_BENCHMARK_SPHINX_MODEL"));
+  if (!sphinxPath.isEmpty()) {
+    QDir model(sphinxPath);
+    samples.insert("pocketsphinx", findSamples(model));
+    QVERIFY(!samples.value("pocketsphinx").isEmpty());
+
+    SphinxRecognitionConfiguration cfg(model.absolutePath(), model.filePath("model.jsgf"),
+                                       model.filePath("model.dic"), 16000);
+    Recognizer *recognizer = new SphinxRecognizer;
+    recognizers.insert("pocketsphinx", recognizer);
+    QVERIFY(recognizer->init(&cfg));
+  }
+#endif
+
+  if (recognizers.isEmpty())
+    QSKIP("Neither SIMON_BENCHMARK_MODEL nor SIMON_BENCHMARK_SPHINX_MODEL set", SkipAll);
+}
+
+void recognizerBenchmark::cleanupTestCase()
+{
+  qDeleteAll(recognizers);
+  recognizers.clear();
+}
+
+void recognizerBenchmark::backends()
+{
+  QTest::addColumn<QString>("backend");
+  foreach (const QString& backend, recognizers.keys())
+    QTest::newRow(backend.toLatin1().constData()) << backend;
+}
+
+void recognizerBenchmark::report(const QString& backend, const char* mode, int elapsed)
+{
+  int count = samples.value(backend).count();
+  qDebug() << backend << mode << ":" << count << "utterances in" << elapsed << "ms,"
+           << (double(elapsed) / count) << "ms per utterance";
+}
+
+void recognizerBenchmark::benchmarkSingle_data()
+{
+  backends();
+}
+
+void recognizerBenchmark::benchmarkSingle()
+{
+  QFETCH(QString, backend);
+  Recognizer *recognizer = recognizers.value(backend);
+
+  QTime timer;
+  timer.start();
+  QBENCHMARK_ONCE {
+    foreach (const QString& sample, samples.value(backend))
+      recognizer->recognize(sample);
+  }
+  report(backend, "recognize()", timer.elapsed());
+}
+
+void recognizerBenchmark::benchmarkBatch_data()
+{
+  backends();
+}
+
+void recognizerBenchmark::benchmarkBatch()
+{
+  QFETCH(QString, backend);
+  Recognizer *recognizer = recognizers.value(backend);
+
+  resultCount = 0;
+  QTime timer;
+  timer.start();
+  QBENCHMARK_ONCE {
+    QVERIFY(recognizer->recognizeBatch(samples.value(backend), this));
+  }
+  report(backend, "recognizeBatch()", timer.elapsed());
+  QCOMPARE(resultCount, samples.value(backend).count());
+}
+
+QTEST_MAIN(recognizerBenchmark)
+
+#include "recognizerbenchmark.moc"
@@ -0,0 +1,140 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "../sphinxrecognizer.h"
+#include "../sphinxrecognitionconfiguration.h"
+
+#include <QTest>
+#include <QDir>
+#include <QTime>
+#include <QDebug>
+
+/**
+ * Measures the cost of the lattice search and word posteriors on top of
+ * plain decoding, and of the N-best list on top of that.
+ *
+ * Needs a sphinx model; Set SIMON_BENCHMARK_SPHINX_MODEL to a folder
+ * containing the acoustic model, model.jsgf, model.dic and a samples/
+ * folder with 16 kHz wav files.
+ */
+class sphinxBenchmark: public QObject, public RecognitionResultCallback
+{
+  Q_OBJECT
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkBaseline();
+    void benchmarkBest();
+    void benchmarkNBest();
+
+  public:
+    sphinxBenchmark() : recognizer(0), baselineRecognizer(0), resultCount(0), hypothesisCount(0) {}
+    bool batchResult(int index, const QString& file, const QList<RecognitionResult>& results);
+
+  private:
+    SphinxRecognizer *recognizer;
+    SphinxRecognizer *baselineRecognizer;
+    QStringList samples;
+    int resultCount;
+    int hypothesisCount;
+
+    void run(SphinxRecognizer *recognizer, const char* mode);
+};
+
+bool sphinxBenchmark::batchResult(int index, const QString& file, const QList<RecognitionResult>& results)
+{
+  Q_UNUSED(index);
+  Q_UNUSED(file);
+  ++resultCount;
+  hypothesisCount += results.count();
+  foreach (const RecognitionResult& result, results)
+    if (result.confidenceScores().count() != result.words().count())
+      return false;
+  return true;
+}
+
+void sphinxBenchmark::initTestCase()
+{
+  QString modelPath = QString::fromLocal8Bit(qgetenv("SIMON_BENCHMARK_SPHINX_MODEL"));
+  if (modelPath.isEmpty())
+    QSKIP("SIMON_BENCHMARK_SPHINX_MODEL not set", SkipAll);
+
+  QDir model(modelPath);
+  QDir sampleDir(model.filePath("samples"));
+  foreach (const QString& sample, sampleDir.entryList(QStringList() << "*.wav", QDir::Files))
+    samples << sampleDir.absoluteFilePath(sample);
+  QVERIFY(!samples.isEmpty());
+
+  SphinxRecognitionConfiguration cfg(model.absolutePath(), model.filePath("model.jsgf"),
+                                     model.filePath("model.dic"), 16000);
+  recognizer = new SphinxRecognizer;
+  QVERIFY(recognizer->init(&cfg));
+
+  SphinxRecognitionConfiguration baselineCfg(model.absolutePath(), model.filePath("model.jsgf"),
+                                             model.filePath("model.dic"), 16000, false);
+  baselineRecognizer = new SphinxRecognizer;
+  baselineRecognizer->setMaxHypotheses(1);
+  baselineRecognizer->setWordPosteriors(false);
+  QVERIFY(baselineRecognizer->init(&baselineCfg));
+}
+
+void sphinxBenchmark::cleanupTestCase()
+{
+  delete recognizer;
+  delete baselineRecognizer;
+}
+
+void sphinxBenchmark::run(SphinxRecognizer *recognizer, const char* mode)
+{
+  resultCount = 0;
+  hypothesisCount = 0;
+  QTime timer;
+  timer.start();
+  QBENCHMARK_ONCE {
+    QVERIFY(recognizer->recognizeBatch(samples, this));
+  }
+  int elapsed = timer.elapsed();
+  QCOMPARE(resultCount, samples.count());
+
+  qDebug() << mode << ":" << samples.count() << "utterances in" << elapsed << "ms,"
+           << (double(elapsed) / samples.count()) << "ms per utterance,"
+           << (double(hypothesisCount) / samples.count()) << "hypotheses per utterance";
+}
+
+void sphinxBenchmark::benchmarkBaseline()
+{
+  run(baselineRecognizer, "best hypothesis without lattice");
+}
+
+void sphinxBenchmark::benchmarkBest()
+{
+  recognizer->setMaxHypotheses(1);
+  run(recognizer, "best hypothesis with posteriors");
+}
+
+void sphinxBenchmark::benchmarkNBest()
+{
+  recognizer->setMaxHypotheses(SphinxRecognizer::defaultMaxHypotheses);
+  run(recognizer, "n-best with posteriors");
+}
+
+QTEST_MAIN(sphinxBenchmark)
+
+#include "sphinxbenchmark.moc"
@@ -338,26 +338,39 @@ bool ActionCollection::moveActionDown(Action *action)
 }
 
 
+/**
+ * \brief Rebuilds the trigger index if actions or their triggers changed
+ */
+void ActionCollection::updateTriggerIndex()
+{
+  QStringList triggers;
+  foreach (Action *a, m_actions)
+    triggers << a->trigger();
+  if ((m_actions == m_indexedActions) && m_triggerIndex.isValid(triggers))
+    return;
+
+  m_indexedActions = m_actions;
+  m_triggerIndex.build(triggers);
+}
+
 bool ActionCollection::processResult(RecognitionResult recognitionResult)
 {
-  int i=0;
-  bool commandFound=false;
+  updateTriggerIndex();
+
   QString currentTrigger;
-  QString realCommand;
 
-  while ((i<m_actions.count()) && (!commandFound)) {
-    currentTrigger = m_actions[i]->trigger();
+  foreach (int i, m_triggerIndex.candidates(recognitionResult.sentence())) {
+    currentTrigger = m_triggerIndex.trigger(i);
     RecognitionResult tempResult = recognitionResult;
     if (tempResult.matchesTrigger(currentTrigger)) {
       tempResult.removeTrigger(currentTrigger);
 
-      if(m_actions.at(i)->manager()->processResult(tempResult))
-        commandFound=true;
+      if(m_indexedActions.at(i)->manager()->processResult(tempResult))
+        return true;
     }
-    i++;
   }
 
-  return commandFound;
+  return false;
 }
 
 
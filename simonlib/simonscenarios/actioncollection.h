@@ -22,9 +22,11 @@
 
 #include <QString>
 #include <QList>
+#include <QHash>
 #include "actionmodel.h"
 #include "command.h"
 #include "commandlistelements.h"
+#include "triggerindex.h"
 #include <simonscenariobase/scenarioobject.h>
 #include <simonrecognitionresult/recognitionresult.h>
 #include <simonscenarios/commandlistelements.h>
@@ -86,5 +88,11 @@ class MODELMANAGEMENT_EXPORT ActionCollection : public ScenarioObject, public Ac
     QHash<CommandListElements::Element, VoiceInterfaceCommand*> listInterfaceCommands;
     bool m_autorunActive;
     QString m_autorunCommand, m_autorunType;
+
+    /// Actions the trigger index was built from
+    QList<Action*> m_indexedActions;
+    TriggerIndex m_triggerIndex;
+
+    void updateTriggerIndex();
 };
 #endif
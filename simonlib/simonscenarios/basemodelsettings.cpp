@@ -27,7 +27,6 @@
 #include <QMenu>
 #include <QPointer>
 #include <knewstuff3/downloaddialog.h>
-#include <KTar>
 #include <KMessageBox>
 #include <KFileDialog>
 
@@ -77,8 +76,7 @@ QString BaseModelSettings::baseModelDescription(const QString& path, QString* na
   QString lName;
   QDateTime lDateTime;
   QString type;
-  KTar tar(path, "application/x-gzip");
-  Model::parseContainer(tar, lDateTime, lName, type);
+  Model::parseContainer(path, lDateTime, lName, type);
   if (name)
     *name = lName;
   if (dateTime)
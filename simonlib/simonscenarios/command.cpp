@@ -25,6 +25,44 @@
 #include <KDebug>
 #include <KLocalizedString>
 #include <qvarlengtharray.h>
+#include "commandmanager.h"
+
+/**
+ * \brief Splits the scheme at its argument placeholders (%1, %2, ...)
+ *
+ * Equivalent to scheme.split(QRegExp("%\\d+")) without compiling a regular
+ * expression for every command.
+ */
+static QStringList splitScheme(const QString& scheme)
+{
+  QStringList parts;
+  QString current;
+  const int length = scheme.length();
+  for (int i=0; i < length; i++) {
+    if ((scheme[i] == '%') && (i+1 < length) && scheme[i+1].isDigit()) {
+      parts << current;
+      current.clear();
+      i++;
+      while ((i+1 < length) && scheme[i+1].isDigit())
+        i++;
+    } else
+      current += scheme[i];
+  }
+  parts << current;
+  return parts;
+}
+
+/**
+ * \brief Returns true if the given scheme contains argument placeholders
+ */
+bool Command::hasArguments(const QString& scheme)
+{
+  const int length = scheme.length();
+  for (int i=0; i+1 < length; i++)
+    if ((scheme[i] == '%') && scheme[i+1].isDigit())
+      return true;
+  return false;
+}
 
 
 /**
@@ -44,7 +82,7 @@ bool Command::parseArguments(const QString& input, const QString& scheme, QStrin
 {
   kDebug() << "Command trigger: " << scheme << " provided trigger: " << input;
   arguments.clear();
-  QStringList splitList = scheme.split(QRegExp("%\\d+"));
+  QStringList splitList = splitScheme(scheme);
   kDebug() << "Split list: " << splitList;
   QString callTrigger = input;
   for (int i=0; i < splitList.count()-1; i++)
@@ -59,9 +97,11 @@ bool Command::parseArguments(const QString& input, const QString& scheme, QStrin
     callTrigger.remove(0, partLength);
     
     int nextIndex;
-    if (!isString)
-      nextIndex = callTrigger.indexOf(QRegExp("( |$)"));
-    else {
+    if (!isString) {
+      nextIndex = callTrigger.indexOf(' ');
+      if (nextIndex == -1)
+        nextIndex = callTrigger.length();
+    } else {
       QString nextString = splitList[i+1];
       if ((i == splitList.count()-2) && nextString.isEmpty()) // last run
         nextIndex = callTrigger.length();
@@ -97,7 +137,7 @@ bool Command::matches(int commandManagerState, const QString& trigger)
   if (!boundStates.contains(commandManagerState))
     return false;
 
-  if (!triggerName.contains(QRegExp("%?%\\d+")))
+  if (!hasArguments(triggerName))
     return (trigger.compare(this->triggerName, Qt::CaseInsensitive) == 0);
   
   bool succ = Command::parseArguments(trigger, getTrigger(), m_currentParameters);
@@ -254,10 +294,20 @@ bool Command::deSerialize(const QDomElement& elem)
   
   switchToState = newStateElem.text().toInt();
   announce = (announceElem.text().toInt() == 1);
+  indexChanged();
 
   return deSerializePrivate(elem);
 }
 
+/**
+ * \brief Tells the parent that its compiled trigger index is out of date
+ */
+void Command::indexChanged()
+{
+  if (m_parent)
+    m_parent->invalidateCommandIndex();
+}
+
 /**
  * \brief Accesser method for @sa m_currentParameters
  * \return The parameters of the last matches() call
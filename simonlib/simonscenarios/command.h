@@ -121,6 +121,8 @@ class MODELMANAGEMENT_EXPORT  Command
     /// Parameters of the last triggering
     QStringList m_currentParameters;
 
+    void indexChanged();
+
   protected:
     /// \brief The command is bound to this state.
     /// \sa matches()
@@ -130,13 +132,13 @@ class MODELMANAGEMENT_EXPORT  Command
     int switchToState;
 
     /// Empty private constructor
-    Command() { hidden = false; }
+    Command() : hidden(false), m_parent(0) {}
 
     /**
      * \brief Setter method for triggerName
      * \param trigger The new triggerName
      */
-    void setTriggerName(const QString& trigger) { triggerName = trigger; }
+    void setTriggerName(const QString& trigger) { triggerName = trigger; indexChanged(); }
 
     /**
      * \brief Setter method for iconSrc
@@ -276,6 +278,7 @@ class MODELMANAGEMENT_EXPORT  Command
       description(description_),
       announce(announce_),
       hidden(false),
+      m_parent(0),
       boundStates(QList<int>() << boundState_),
       switchToState(newState_)
     {}
@@ -300,6 +303,7 @@ class MODELMANAGEMENT_EXPORT  Command
       description(description_),
       announce(announce_),
       hidden(false),
+      m_parent(0),
       boundStates(boundStates_),
       switchToState(newState_)
     {Q_ASSERT(boundStates.count());}
@@ -323,6 +327,7 @@ class MODELMANAGEMENT_EXPORT  Command
     void setBoundState(int state) { 
       boundStates.clear();
       boundStates << state;
+      indexChanged();
     }
     
     /**
@@ -331,6 +336,7 @@ class MODELMANAGEMENT_EXPORT  Command
      */
     void setBoundState(QList<int> states) { 
       boundStates = states;
+      indexChanged();
     }
 
     /**
@@ -426,6 +432,8 @@ class MODELMANAGEMENT_EXPORT  Command
     virtual ~Command() {}
     
     static bool parseArguments(const QString& input, const QString& scheme, QStringList& arguments);
+
+    static bool hasArguments(const QString& scheme);
 };
 
 /**
@@ -0,0 +1,84 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "commandindex.h"
+
+#include <QSet>
+
+CommandIndex::CommandIndex() : m_valid(false)
+{
+}
+
+void CommandIndex::build(const CommandList& commands)
+{
+  m_commands = commands;
+  m_literals.clear();
+  m_patterns.clear();
+
+  for (int i=0; i < commands.count(); i++) {
+    Command *c = commands[i];
+    QString trigger = c->getTrigger();
+    if (!Command::hasArguments(trigger)) {
+      QString key = trigger.toCaseFolded();
+      foreach (int state, c->getBoundStates().toSet())
+        m_literals[state][key] << i;
+    } else {
+      Pattern pattern;
+      pattern.position = i;
+      //the literal part up to the first argument has to match exactly
+      int prefixLength = 0;
+      while ((prefixLength+1 < trigger.length()) &&
+             !((trigger[prefixLength] == '%') && trigger[prefixLength+1].isDigit()))
+        prefixLength++;
+      pattern.prefix = trigger.left(prefixLength);
+      if (pattern.prefix.endsWith('%'))
+        pattern.prefix.chop(1);
+      foreach (int state, c->getBoundStates().toSet())
+        m_patterns[state] << pattern;
+    }
+  }
+  m_valid = true;
+}
+
+CommandList CommandIndex::candidates(int state, const QString& trigger) const
+{
+  CommandList out;
+
+  QList<int> literals;
+  QHash<int, QHash<QString, QList<int> > >::const_iterator stateLiterals = m_literals.constFind(state);
+  if (stateLiterals != m_literals.constEnd())
+    literals = stateLiterals->value(trigger.toCaseFolded());
+
+  QList<int> patterns;
+  QHash<int, QList<Pattern> >::const_iterator statePatterns = m_patterns.constFind(state);
+  if (statePatterns != m_patterns.constEnd())
+    foreach (const Pattern& pattern, *statePatterns)
+      if (trigger.startsWith(pattern.prefix))
+        patterns << pattern.position;
+
+  //both lists are ordered by position; merge them to keep the command order
+  int l = 0, p = 0;
+  while ((l < literals.count()) || (p < patterns.count())) {
+    if ((p == patterns.count()) || ((l < literals.count()) && (literals[l] < patterns[p])))
+      out << m_commands[literals[l++]];
+    else
+      out << m_commands[patterns[p++]];
+  }
+  return out;
+}
@@ -0,0 +1,71 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SIMON_COMMANDINDEX_H_B3CDC3EE12BE49C183A8E9794ED07498
+#define SIMON_COMMANDINDEX_H_B3CDC3EE12BE49C183A8E9794ED07498
+
+#include "simonmodelmanagement_export.h"
+#include "command.h"
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+/**
+ * \class CommandIndex
+ * \brief Compiled lookup of the commands that could match a recognized sentence
+ *
+ * Commands without arguments are bucketed by state and case folded trigger.
+ * Commands with arguments are bucketed by state and pre-filtered by the
+ * literal text in front of their first argument.
+ *
+ * The returned candidates keep the order of the command list so that the
+ * first command accepting the sentence is the same one a linear search
+ * would have found. Candidates still have to be confirmed with
+ * Command::matches().
+ */
+class MODELMANAGEMENT_EXPORT CommandIndex
+{
+  public:
+    CommandIndex();
+
+    void build(const CommandList& commands);
+
+    /**
+     * \return True if the index was built from this exact list and none of
+     *         its commands changed since
+     */
+    bool isValid(const CommandList& commands) const { return m_valid && (m_commands == commands); }
+    void invalidate() { m_valid = false; }
+
+    CommandList candidates(int state, const QString& trigger) const;
+
+  private:
+    struct Pattern {
+      int position;
+      QString prefix;
+    };
+
+    bool m_valid;
+    CommandList m_commands;
+    QHash<int, QHash<QString, QList<int> > > m_literals;
+    QHash<int, QList<Pattern> > m_patterns;
+};
+
+#endif
@@ -22,6 +22,7 @@
 #include "voiceinterfacecommandtemplate.h"
 #include "createvoiceinterfacecommandwidget.h"
 #include "commandconfiguration.h"
+#include "commandindex.h"
 #include <KLocalizedString>
 #include <KDebug>
 #include <simonscenarios/scenario.h>
@@ -86,7 +87,12 @@ const KIcon CommandManager::icon() const
  */
 bool CommandManager::trigger(const QString& triggerName, bool silent)
 {
-  foreach (Command* c, commands) {
+  if (!m_commandIndex)
+    m_commandIndex = new CommandIndex;
+  if (!m_commandIndex->isValid(commands))
+    m_commandIndex->build(commands);
+
+  foreach (Command* c, m_commandIndex->candidates(m_currentState, triggerName)) {
     if (c->matches(m_currentState, triggerName))
     {
       kDebug() << "Matches: " << c->getTrigger();
@@ -99,6 +105,19 @@ bool CommandManager::trigger(const QString& triggerName, bool silent)
 }
 
 
+/**
+ * \brief Marks the compiled trigger index as outdated
+ *
+ * Commands call this when their trigger or bound states change. Changes to
+ * the #commands list itself are detected automatically.
+ */
+void CommandManager::invalidateCommandIndex()
+{
+  if (m_commandIndex)
+    m_commandIndex->invalidate();
+}
+
+
 /**
  * \brief Directly executes the given command
  *
@@ -951,6 +970,7 @@ void CommandManager::switchToState(int newState)
 CommandManager::~CommandManager()
 { 
   qDeleteAll(commands);
+  delete m_commandIndex;
 
   if (config)
     config->deleteLater();
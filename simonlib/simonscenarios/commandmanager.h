@@ -88,6 +88,7 @@ class Scenario;
 class VoiceInterfaceCommand;
 class VoiceInterfaceCommandTemplate;
 class ActionCollection;
+class CommandIndex;
 
 /**
  *	@class CommandManager
@@ -148,6 +149,13 @@ class MODELMANAGEMENT_EXPORT CommandManager : public QAbstractItemModel, public
      */
     CommandList commands;
 
+    /**
+     * \brief Compiled trigger lookup over #commands used by trigger()
+     *
+     * Rebuilt lazily whenever #commands or one of its commands changed.
+     */
+    CommandIndex *m_commandIndex;
+
     /**
      * \brief Plugin source id
      *
@@ -365,6 +373,7 @@ class MODELMANAGEMENT_EXPORT CommandManager : public QAbstractItemModel, public
     virtual QDomElement serializeCommands(QDomDocument *doc);
 
     virtual bool trigger(const QString& triggerName, bool silent);
+    void invalidateCommandIndex();
     virtual bool triggerCommand(Command *command, bool silent);
 
     virtual bool installInterfaceCommand(QObject* object, const QString& slot,
@@ -448,7 +457,7 @@ class MODELMANAGEMENT_EXPORT CommandManager : public QAbstractItemModel, public
      */
     CommandManager(Scenario *parentScenario, const QVariantList& args) : QAbstractItemModel((QObject*) parentScenario),
     ScenarioObject(parentScenario),
-    m_currentState(SimonCommand::DefaultState), config(0) {
+    m_currentState(SimonCommand::DefaultState), m_commandIndex(0), config(0) {
       Q_UNUSED(args);
     }
 
@@ -22,7 +22,7 @@
 #include <QDomDocument>
 #include <QDomElement>
 #include <QFile>
-#include <KTar>
+#include <simonutils/modelcontainer.h>
 #include <KStandardDirs>
 #include <KMessageBox>
 #include <KLocalizedString>
@@ -98,14 +98,14 @@ QString CreateBaseModel::buildModel()
   doc.appendChild(rootElem);
   
   QString dest = KStandardDirs::locateLocal("tmp", "basemodel.sbm");
-  KTar archive(dest, "application/x-gzip");
+  ModelContainer archive(dest);
   if (!archive.open(QIODevice::WriteOnly)) {
     KMessageBox::sorry(this, i18nc("%1 is path", "Failed to create temporary archive at %1", dest));
     return QString();
   }
   
   QByteArray metadata = doc.toByteArray();
-  archive.writeFile("metadata.xml", "nobody", "nobody", metadata.constData(), metadata.length());
+  archive.writeFile("metadata.xml", metadata);
   
 
   if(ui.twModelType->currentIndex() == 0)
@@ -18,19 +18,24 @@
  */
 
 #include "model.h"
-#include <QBuffer>
-#include <QFile>
+#include <simonutils/modelcontainer.h>
+#include <QFileInfo>
 #include <QDomDocument>
 #include <QDomElement>
-#include <KFilterDev>
-#include <KTar>
 #include <KDebug>
 
-Model::Model(qint32 data, const QByteArray& container) :
-m_data(data), m_container(container), m_containerParsed(false)
+Model::Model(qint32 data, const QString& containerPath) :
+m_data(data), m_containerPath(containerPath), m_containerParsed(false)
 {
 }
 
+qint64 Model::containerSize()
+{
+  if (m_containerPath.isEmpty())
+    return 0;
+  return QFileInfo(m_containerPath).size();
+}
+
 QDateTime Model::modelCreationDate()
 {
   if (!m_containerParsed) parseContainer();
@@ -43,50 +48,35 @@ QString Model::modelName()
   return m_modelName;
 }
 
-bool Model::parseContainer ( KTar& archive, QDateTime& creationDate, QString& name, QString& type )
+bool Model::parseContainer ( const QString& path, QDateTime& creationDate, QString& name, QString& type )
 {
+  ModelContainer archive(path);
   if (archive.open(QIODevice::ReadOnly)) {
-    const KArchiveDirectory *d = archive.directory();
-    if (d) {
-      const KArchiveFile *entry = dynamic_cast<const KArchiveFile*>(d->entry("metadata.xml"));
-      if (entry) {
-        QDomDocument doc;
-        doc.setContent(entry->data());
-        QDomElement rootElem = doc.documentElement();
-        QDomElement nameElem = rootElem.firstChildElement("name");
-        QDomElement typeElem = rootElem.firstChildElement("type");
-        QDomElement dateElem = rootElem.firstChildElement("creationDate");
-        if (!nameElem.isNull() && !dateElem.isNull()) {
-          creationDate = QDateTime::fromString(dateElem.text(), Qt::ISODate);
-          name = nameElem.text();
-          type = typeElem.text();
-          return true;
-        }
-        else kDebug() << "Elements 0";
+    if (archive.contains("metadata.xml")) {
+      QDomDocument doc;
+      doc.setContent(archive.data("metadata.xml"));
+      QDomElement rootElem = doc.documentElement();
+      QDomElement nameElem = rootElem.firstChildElement("name");
+      QDomElement typeElem = rootElem.firstChildElement("type");
+      QDomElement dateElem = rootElem.firstChildElement("creationDate");
+      if (!nameElem.isNull() && !dateElem.isNull()) {
+        creationDate = QDateTime::fromString(dateElem.text(), Qt::ISODate);
+        name = nameElem.text();
+        type = typeElem.text();
+        return true;
       }
-        else kDebug() << "Entry invalid";
+      else kDebug() << "Elements 0";
     }
-        else kDebug() << "Directory invalid";
+    else kDebug() << "Entry invalid";
   }
-        else kDebug() << "Couldn't open tar";
-        
+  else kDebug() << "Couldn't open container";
+
   return false;
 }
 
 void Model::parseContainer()
 {
-  if (!m_container.isNull()) {
-    QBuffer model(&m_container);
-    model.open(QIODevice::ReadOnly);
-    QIODevice *filter = KFilterDev::device(&model, "application/x-gzip", false /* will be deleted when unwinding stack */);
-    filter->open(QIODevice::ReadOnly);
-    QByteArray uncompressed = filter->readAll();
-    delete filter; //KTar doesn't work with KFilterDev for some reason...
-    
-    QBuffer uncompressedModel(&uncompressed);
-    uncompressedModel.open(QIODevice::ReadOnly);
-    KTar archive(&uncompressedModel);
-    parseContainer(archive, m_modelCreationDate, m_modelName, m_type);
-  }
+  if (!m_containerPath.isEmpty())
+    parseContainer(m_containerPath, m_modelCreationDate, m_modelName, m_type);
   m_containerParsed = true;
 }
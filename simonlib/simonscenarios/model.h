@@ -26,13 +26,11 @@
 #include <QStringList>
 #include <QDateTime>
 
-class KTar;
-
 class MODELMANAGEMENT_EXPORT Model
 {
   private:
     qint32 m_data;
-    QByteArray m_container;
+    QString m_containerPath;
     
     //parsed form container
     bool m_containerParsed;
@@ -43,13 +41,22 @@ class MODELMANAGEMENT_EXPORT Model
     void parseContainer();
 
   public:
-    Model(qint32 data, const QByteArray& container);
+    /**
+     * \param containerPath Path of the model container; Empty if there is
+     *        none (e.g. no base model)
+     */
+    Model(qint32 data, const QString& containerPath);
 
     qint32 sampleRate() { return m_data; }
     qint32 baseModelType() { return m_data; }
-    QByteArray container() { return m_container; }
+    QString containerPath() { return m_containerPath; }
+    qint64 containerSize();
     
-    static bool parseContainer(KTar& archive, QDateTime& creationDate, QString& name, QString& type);
+    /**
+     * Reads the metadata of the container at the given path; Only the
+     * metadata itself is decompressed.
+     */
+    static bool parseContainer(const QString& path, QDateTime& creationDate, QString& name, QString& type);
     
     QDateTime modelCreationDate();
     QString modelName();
@@ -28,6 +28,7 @@
 #include <simonscenarios/shadowvocabulary.h>
 
 #include <simonscenarios/scenariomanager.h>
+#include <simonutils/modelcontainer.h>
 
 #include <QFile>
 #include <QFileInfo>
@@ -39,7 +40,6 @@
 #include <KDateTime>
 #include <KFilterBase>
 #include <KFilterDev>
-#include <KTar>
 
 ModelManager* ModelManager::instance = 0;
 
@@ -65,8 +65,7 @@ modelChangedFlag(false)
   // read active model and build blacklistedTranscriptions
   QString activePath = KStandardDirs::locate("appdata", "model/active.sbm");
   if (QFile::exists(activePath)) {
-    KTar tar(activePath, "application/x-gzip");
-    ModelMetadata *data = metaData(tar);
+    ModelMetadata *data = metaData(activePath);
     if (data) {
       updateBlacklistedTranscriptions(data);
       delete data;
@@ -111,12 +110,16 @@ Model* ModelManager::createActiveContainer()
 {
   qint32 modelSampleRate=SpeechModelManagementConfiguration::modelSampleRate();
 
-  QFile activeContainer(KStandardDirs::locate("appdata", "model/active.sbm"));
-
-  if (!activeContainer.open(QIODevice::ReadOnly))
+  QString path = activeContainerPath();
+  if (!QFile::exists(path))
     return 0;
 
-  return new Model(modelSampleRate, activeContainer.readAll());
+  return new Model(modelSampleRate, path);
+}
+
+QString ModelManager::activeContainerPath()
+{
+  return KStandardDirs::locateLocal("appdata", "model/active.sbm");
 }
 
 
@@ -125,14 +128,18 @@ Model* ModelManager::createBaseModelContainer()
   qint32 modelType = baseModelType();
 
   if (modelType == 2)
-    return new Model(modelType, QByteArray());
+    return new Model(modelType, QString());
 
-  QFile baseContainer(KStandardDirs::locate("appdata", "model/basemodel.sbm"));
-
-  if (!baseContainer.open(QIODevice::ReadOnly))
+  QString path = baseModelContainerPath();
+  if (!QFile::exists(path))
     return 0;
 
-  return new Model(modelType, baseContainer.readAll());
+  return new Model(modelType, path);
+}
+
+QString ModelManager::baseModelContainerPath()
+{
+  return KStandardDirs::locateLocal("appdata", "model/basemodel.sbm");
 }
 
 
@@ -160,7 +167,7 @@ QDateTime ModelManager::getBaseModelDate()
 }
 
 
-bool ModelManager::storeBaseModel(const QDateTime& changedTime, int baseModelType, const QByteArray& container)
+bool ModelManager::storeBaseModel(const QDateTime& changedTime, int baseModelType, const QString& containerPath)
 {
   KConfig config( KStandardDirs::locateLocal("appdata", "model/modelsrcrc"), KConfig::SimpleConfig );
   KConfigGroup cGroup(&config, "");
@@ -170,19 +177,20 @@ bool ModelManager::storeBaseModel(const QDateTime& changedTime, int baseModelTyp
 
   QString repoPath = KStandardDirs::locateLocal("appdata", "model/base/srv" + changedTime.toString(Qt::ISODate) + ".sbm");
   //store both as selected base model and in the local repository
-  foreach (const QString& path, QStringList() << KStandardDirs::locateLocal("appdata", "model/basemodel.sbm")
-                                                    << repoPath) {
-    QFile containerFile(path);
-    if (!containerFile.open(QIODevice::WriteOnly))
+  QString basePath = baseModelContainerPath();
+  QFile::remove(repoPath);
+  if (!QFile::copy(containerPath, repoPath))
+    return false;
+  if (containerPath != basePath) {
+    QFile::remove(basePath);
+    if (!QFile::rename(containerPath, basePath))
       return false;
-    containerFile.write(container);
-    containerFile.close();
   }
   setBaseModel(repoPath, baseModelType);
 
   QDateTime creationDate;
   QString name;
-  ModelMetadata *data = metaDataFromBuffer(container);
+  ModelMetadata *data = metaData(basePath);
   if (data) {
     name = data->name();
     creationDate = data->dateTime();
@@ -226,17 +234,13 @@ void ModelManager::setLanguageProfileName(const QString& name)
   SpeechModelManagementConfiguration::self()->writeConfig();
 }
 
-ModelMetadata* ModelManager::metaData(KTar& tar)
+ModelMetadata* ModelManager::metaData(const QString& containerPath)
 {
-  if (!tar.open(QIODevice::ReadOnly)) return 0;
-  const KArchiveDirectory *d = tar.directory();
-  if (!d) return 0;
-
-  const KArchiveFile *entry = dynamic_cast<const KArchiveFile*>(d->entry("metadata.xml"));
-  if (!entry) return 0;
+  ModelContainer container(containerPath);
+  if (!container.open(QIODevice::ReadOnly) || !container.contains("metadata.xml")) return 0;
 
   QDomDocument doc;
-  doc.setContent(entry->data());
+  doc.setContent(container.data("metadata.xml"));
 
   return new ModelMetadata(doc.documentElement());
 }
@@ -248,7 +252,7 @@ bool ModelManager::updateBlacklistedTranscriptions(ModelMetadata* data)
   return true;
 }
 
-bool ModelManager::storeActiveModel(const QDateTime& changedTime, qint32 sampleRate, const QByteArray& container)
+bool ModelManager::storeActiveModel(const QDateTime& changedTime, qint32 sampleRate, const QString& containerPath)
 {
   KConfig config( KStandardDirs::locateLocal("appdata", "model/activemodelrc"), KConfig::SimpleConfig );
   KConfigGroup cGroup(&config, "");
@@ -257,18 +261,17 @@ bool ModelManager::storeActiveModel(const QDateTime& changedTime, qint32 sampleR
 
   SpeechModelManagementConfiguration::setModelSampleRate(sampleRate);
 
-  QFile containerFile(KStandardDirs::locateLocal("appdata", "model/active.sbm"));
-
-  if (!containerFile.open(QIODevice::WriteOnly))
-    return false;
-
-  containerFile.write(container);
-  containerFile.close();
+  QString activePath = activeContainerPath();
+  if (containerPath != activePath) {
+    QFile::remove(activePath);
+    if (!QFile::rename(containerPath, activePath))
+      return false;
+  }
 
   bool success = false;
   QDateTime creationDate;
   QString name;
-  ModelMetadata *data = metaDataFromBuffer(container);
+  ModelMetadata *data = metaData(activePath);
   if (data) {
     success = updateBlacklistedTranscriptions(data);
     creationDate = data->dateTime();
@@ -279,44 +282,6 @@ bool ModelManager::storeActiveModel(const QDateTime& changedTime, qint32 sampleR
   return success;
 }
 
-ModelMetadata* ModelManager::metaDataFromBuffer(const QByteArray& input)
-{
-  ModelMetadata *data = 0;
-  KTar *tar = archiveFromBuffer(input);
-  if (tar) {
-    data = metaData(*tar);
-    QIODevice *d = tar->device();
-    delete tar;
-    delete d;
-  }
-  return data;
-}
-
-/**
- * \warning The caller has to delete the archive's underlying device
- */
-KTar* ModelManager::archiveFromBuffer(const QByteArray& input)
-{
-  // safely remove the const qualifier as the buffer is only opened read-only
-  QBuffer buffer(const_cast<QByteArray*>(&input));
-  if (!buffer.open(QIODevice::ReadOnly))
-    return 0;
-  QIODevice *uncompressed = KFilterDev::device(&buffer, "application/x-gzip", false);
-  if (!uncompressed || !uncompressed->open(QIODevice::ReadOnly))
-    return 0;
-
-  //seeking doesn't work properly in kfilterdevs, which trips up KTar. Instead, decompress
-  //completely before passing it on to KTar
-  QBuffer *uncompressedBuffer = new QBuffer;
-  if (!uncompressedBuffer->open(QIODevice::ReadWrite))
-    return 0;
-  uncompressedBuffer->write(uncompressed->readAll());
-  uncompressedBuffer->seek(0);
-  delete uncompressed;
-
-  return new KTar(uncompressedBuffer);
-}
-
 QByteArray ModelManager::getSample(const QString& sampleName)
 {
   QString dirPath = QDir::toNativeSeparators(
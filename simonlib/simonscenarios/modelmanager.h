@@ -25,7 +25,6 @@
 #include <QDateTime>
 #include <QStringList>
 
-class KTar;
 class Model;
 class WordListContainer;
 class GrammarContainer;
@@ -54,9 +53,7 @@ class MODELMANAGEMENT_EXPORT ModelManager : public QObject
     bool hasLanguageDescription();
     bool hasActiveContainer();
 
-    KTar* archiveFromBuffer(const QByteArray& input);
-    ModelMetadata* metaData(KTar& tar);
-    ModelMetadata* metaDataFromBuffer(const QByteArray& input);
+    ModelMetadata* metaData(const QString& containerPath);
     bool updateBlacklistedTranscriptions(ModelMetadata* data);
 
   public slots:
@@ -70,9 +67,13 @@ class MODELMANAGEMENT_EXPORT ModelManager : public QObject
     void commitGroup(bool silent=false);
 
     Model* createBaseModelContainer();
+    QString baseModelContainerPath();
     QDateTime getBaseModelDate();
+    /**
+     * Takes over the given, completely received container
+     */
     bool storeBaseModel(const QDateTime& changedTime, int baseModelType,
-      const QByteArray& container);
+      const QString& containerPath);
 
     LanguageDescriptionContainer* getLanguageDescriptionContainer();
     QDateTime getLanguageDescriptionModifiedTime();
@@ -84,9 +85,13 @@ class MODELMANAGEMENT_EXPORT ModelManager : public QObject
     bool storeTraining(const QDateTime& changedTime, qint32 sampleRate, const QByteArray& prompts);
 
     Model* createActiveContainer();
+    QString activeContainerPath();
     qint32 getActiveModelSampleRate();
     QDateTime getActiveContainerModifiedTime();
-    bool storeActiveModel(const QDateTime& changedTime, qint32 sampleRate, const QByteArray& container);
+    /**
+     * Takes over the given, completely received container
+     */
+    bool storeActiveModel(const QDateTime& changedTime, qint32 sampleRate, const QString& containerPath);
 
     void buildSampleList(QStringList& available, QStringList& missing);
     QByteArray getSample(const QString& sampleName);
@@ -40,12 +40,50 @@ void PromptsTable::updateModel()
   if (m_model) m_model->reset();
 }
 
+void PromptsTable::indexPrompt(const QString& sample, const QString& prompt)
+{
+  foreach (const QString& word, prompt.split(' ', QString::SkipEmptyParts)) {
+    ++m_wordCounts[word];
+    m_samplesByWord[word].insert(sample);
+  }
+}
+
+void PromptsTable::unindexPrompt(const QString& sample, const QString& prompt)
+{
+  foreach (const QString& word, prompt.split(' ', QString::SkipEmptyParts)) {
+    QHash<QString,int>::iterator count = m_wordCounts.find(word);
+    if (count == m_wordCounts.end())
+      continue;
+    if (--count.value() == 0) {
+      m_wordCounts.erase(count);
+      m_samplesByWord.remove(word);
+    } else
+      m_samplesByWord[word].remove(sample);
+  }
+}
+
+void PromptsTable::clearIndex()
+{
+  m_wordCounts.clear();
+  m_samplesByWord.clear();
+}
+
+QStringList PromptsTable::untrainedWords(const QStringList& words) const
+{
+  QStringList untrained;
+  foreach (const QString& word, words)
+    if (!m_wordCounts.contains(word))
+      untrained << word;
+  return untrained;
+}
+
 bool PromptsTable::init(const QString& path)
 {
   QFile *prompts = new QFile ( path );
   m_samples.clear();
   m_wordBySample.clear();
   m_groupBySample.clear();
+  clearIndex();
   if ( prompts->exists() ) {
     prompts->open ( QFile::ReadOnly );
     if ( !prompts->isReadable() ) return false;
@@ -78,6 +116,7 @@ bool PromptsTable::init(const QString& path)
       m_samples << label;
       m_wordBySample.insert (label, prompt);
       m_groupBySample.insert(label, group);
+      indexPrompt(label, prompt);
     }
 
     prompts->close();
@@ -114,6 +153,7 @@ bool PromptsTable::deletePrompt(QString key)
   found &= m_groupBySample.contains(key);
   found &= m_wordBySample.contains(key);
 
+  unindexPrompt(key, m_wordBySample.value(key));
   m_groupBySample.remove (key);
   m_wordBySample.remove (key);
   m_samples.removeAll(key);
@@ -130,16 +170,9 @@ bool PromptsTable::deleteWord(Word *w)
 {
   QString wordToDelete = w->getLexiconWord();
 
-  QStringList sampleFileNames = keys();
   bool succ = true;
-  foreach(const QString& sample, sampleFileNames)
-  {
-    QStringList promptWords = m_wordBySample.value(sample).split(' ');
-    if (promptWords.contains(wordToDelete))
-    {
-      if (!deletePrompt(sample)) succ = false;
-    }
-  }
+  foreach(const QString& sample, samplesContaining(wordToDelete))
+    if (!deletePrompt(sample)) succ = false;
   return succ;
 }
 
@@ -153,19 +186,28 @@ bool PromptsTable::deleteWord(const QString & word)
 
 void PromptsTable::insert(const QString &sample, const QString &sampleGroup, const QString &word)
 {
-  m_samples << sample;
+  if (m_wordBySample.contains(sample))
+    unindexPrompt(sample, m_wordBySample.value(sample));
+  else
+    m_samples << sample;
   m_wordBySample.insert(sample, word);
+  indexPrompt(sample, word);
   m_groupBySample.insert(sample, sampleGroup);
   updateModel();
 }
 
 bool PromptsTable::merge(const PromptsTable& other)
 {
-  foreach (const QString& sample, other.m_samples)
-    if (!m_samples.contains(sample))
+  foreach (const QString& sample, other.m_samples) {
+    if (m_wordBySample.contains(sample))
+      unindexPrompt(sample, m_wordBySample.value(sample));
+    else
       m_samples << sample;
-  m_wordBySample.unite(other.m_wordBySample);
-  m_groupBySample.unite(other.m_groupBySample);
+    QString prompt = other.m_wordBySample.value(sample);
+    m_wordBySample.insert(sample, prompt);
+    m_groupBySample.insert(sample, other.m_groupBySample.value(sample));
+    indexPrompt(sample, prompt);
+  }
   updateModel();
   return true;
 }
@@ -183,6 +225,7 @@ bool PromptsTable::clear()
   m_samples.clear();
   m_wordBySample.clear();
   m_groupBySample.clear();
+  clearIndex();
   updateModel();
 
   return true;
@@ -190,11 +233,12 @@ bool PromptsTable::clear()
 
 bool PromptsTable::contains(const QString &key)
 {
-  return m_samples.contains(key);
+  return m_wordBySample.contains(key);
 }
 
 int PromptsTable::remove(const QString &key)
 {
+  unindexPrompt(key, m_wordBySample.value(key));
   m_samples.removeAll(key);
   m_wordBySample.remove(key);
   int removed = m_groupBySample.remove(key);
@@ -26,6 +26,7 @@
  */
 
 #include <QHash>
+#include <QSet>
 #include <QStringList>
 #include "simonmodelmanagement_export.h"
 #include "promptstablemodel.h"
@@ -34,6 +35,8 @@
  *	@class PromptsTable
  *	@brief The PromptsTable class provides a convenient container for prompts file data.
  *
+ *	The words of all prompts are indexed (word to occurrences and samples)
+ *	and the index is kept up to date by every change of the table.
  *
  *	\sa TrainingManager
  *
@@ -70,6 +73,13 @@ public:
   QStringList sampleGroups() const { return m_groupBySample.values(); }
   QString sample(int idx) const { return m_samples[idx]; }
 
+  /// Occurrences of the word in all prompts
+  int wordCount(const QString& word) const { return m_wordCounts.value(word); }
+  /// Samples whose prompt contains the word
+  QSet<QString> samplesContaining(const QString& word) const { return m_samplesByWord.value(word); }
+  /// The given words that do not occur in any prompt
+  QStringList untrainedWords(const QStringList& words) const;
+
   PromptsTableModel* getModel();
 
 private:
@@ -77,9 +87,15 @@ private:
   QHash<QString,QString> m_wordBySample;
   QHash<QString,QString> m_groupBySample;
 
+  QHash<QString,int> m_wordCounts;
+  QHash<QString,QSet<QString> > m_samplesByWord;
+
   PromptsTableModel *m_model;
 
   void updateModel();
+  void indexPrompt(const QString& sample, const QString& prompt);
+  void unindexPrompt(const QString& sample, const QString& prompt);
+  void clearIndex();
 };
 
 #endif // PROMPTSTABLE_H
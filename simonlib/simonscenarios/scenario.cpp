@@ -36,6 +36,8 @@
 #include <QDomElement>
 #include <QFile>
 #include <QFileInfo>
+#include <QMutexLocker>
+#include <QThread>
 #include <KDebug>
 #include <KDateTime>
 #include <KConfigGroup>
@@ -53,7 +55,8 @@ m_texts(0),
 m_grammar(0),
 m_actionCollection(0),
 m_compoundCondition(0),
-m_parentScenario(0)
+m_parentScenario(0),
+m_pendingSectionsLock(QMutex::Recursive)
 {
 }
 
@@ -70,28 +73,58 @@ m_parentScenario(0)
  */
 bool Scenario::init(QString path)
 {
+  if (!setupPathToParse(path)) return false;
+
+  ScenarioSections sections;
+  if (!sections.read(path)) return false;
+
+  return init(sections);
+}
+
+
+bool Scenario::init(const ScenarioSections& sections)
+{
+  if (!sections.isValid()) return false;
+
+  QString path = sections.path();
   startGroup(); //ensure we have completely initialized the scenario before saving it
-  QDomDocument *doc=0;
-  bool deleteDoc;
-  if (!setupToParse(path, doc, deleteDoc)) return false;
 
-  if (!skim(path, doc)) return false;
+  QDomDocument *doc = sections.document(QStringList() << "simonCompatibility" << "authors" <<
+                                        "license" << "licence" << "childscenarioids" <<
+                                        "actions" << "compoundcondition");
+  if (!doc) return false;
 
-  //  Language model
-  //************************************************/
-  if (!readLanguageModel(path, doc)) return false;
+  if (!skim(path, doc)) {
+    delete doc;
+    return false;
+  }
 
-  //  Actions
+  //  Language model, Trainingstexts
   //************************************************/
-  if (!readActions(path, doc)) return false;
+  m_pendingSections = sections;
+  foreach (const QString& section, QStringList() << "simonCompatibility" << "authors" << "license" <<
+                                   "licence" << "childscenarioids" << "actions" << "compoundcondition")
+    m_pendingSections.remove(section);
 
-  //  Trainingstexts
+  //without a vocabulary, loading fails right away as it always did
+  if (!m_pendingSections.contains("vocabulary") && !readLanguageModel(path, doc)) {
+    delete doc;
+    return false;
+  }
+
+  //  Actions
   //************************************************/
-  if (!readTrainingsTexts(path, doc)) return false;
+  if (!readActions(path, doc)) {
+    delete doc;
+    return false;
+  }
 
   //  CompoundCondition
   //************************************************/
-  if (!readCompoundCondition(path, doc)) return false;
+  if (!readCompoundCondition(path, doc)) {
+    delete doc;
+    return false;
+  }
 
   delete doc;
   commitGroup();
@@ -99,6 +132,111 @@ bool Scenario::init(QString path)
 }
 
 
+QString Scenario::sourcePath()
+{
+  QString path;
+  setupPathToParse(path);
+  return path;
+}
+
+
+void Scenario::loadPendingLanguageModel()
+{
+  QMutexLocker l(&m_pendingSectionsLock);
+  if (!m_pendingSections.contains("vocabulary"))
+    return;
+
+  QDomDocument *doc = m_pendingSections.document(QStringList() << "vocabulary" << "grammar");
+  if (!doc || !readLanguageModel(m_pendingSections.path(), doc)) {
+    kWarning() << "Language model of scenario" << m_scenarioId << "could not be loaded";
+    //the vocabulary might have been read before the grammar failed
+    delete m_vocabulary;
+    m_vocabulary = 0;
+    delete m_grammar;
+    m_grammar = 0;
+    QDomDocument empty("scenario");
+    QDomElement rootElem = empty.createElement("scenario");
+    rootElem.appendChild(Vocabulary::createEmpty(&empty));
+    rootElem.appendChild(Grammar::createEmpty(&empty));
+    empty.appendChild(rootElem);
+    readLanguageModel(m_pendingSections.path(), &empty);
+  }
+  delete doc;
+  adoptPendingObject(m_vocabulary);
+  adoptPendingObject(m_grammar);
+}
+
+
+void Scenario::loadPendingTexts()
+{
+  QMutexLocker l(&m_pendingSectionsLock);
+  if (!m_pendingSections.contains("trainingtexts"))
+    return;
+
+  QDomDocument *doc = m_pendingSections.document(QStringList() << "trainingtexts");
+  if (!doc || !readTrainingsTexts(m_pendingSections.path(), doc)) {
+    kWarning() << "Training texts of scenario" << m_scenarioId << "could not be loaded";
+    QDomDocument empty("scenario");
+    QDomElement rootElem = empty.createElement("scenario");
+    rootElem.appendChild(TrainingTextCollection::createEmpty(&empty));
+    empty.appendChild(rootElem);
+    readTrainingsTexts(m_pendingSections.path(), &empty);
+  }
+  delete doc;
+  adoptPendingObject(m_texts);
+}
+
+
+/**
+ * Lazily loaded models are created by whichever thread asks for them
+ * first; they belong to the thread of the scenario
+ */
+void Scenario::adoptPendingObject(QObject *object)
+{
+  if (object && (object->thread() != thread()))
+    object->moveToThread(thread());
+}
+
+
+/**
+ * Copies a not yet materialized section into the given document
+ */
+QDomElement Scenario::pendingSection(QDomDocument& doc, const QString& section)
+{
+  QMutexLocker l(&m_pendingSectionsLock);
+  if (!m_pendingSections.contains(section))
+    return QDomElement();
+
+  QDomDocument *sectionDoc = m_pendingSections.document(QStringList() << section);
+  if (!sectionDoc)
+    return QDomElement();
+  QDomElement elem = doc.importNode(sectionDoc->documentElement().firstChildElement(section), true).toElement();
+  delete sectionDoc;
+  return elem;
+}
+
+
+ActiveVocabulary* Scenario::vocabulary()
+{
+  loadPendingLanguageModel();
+  return m_vocabulary;
+}
+
+
+Grammar* Scenario::grammar()
+{
+  loadPendingLanguageModel();
+  return m_grammar;
+}
+
+
+TrainingTextCollection* Scenario::texts()
+{
+  loadPendingTexts();
+  return m_texts;
+}
+
+
 bool Scenario::create(const QString& name, const QString& iconSrc, int version, VersionNumber* simonMinVersion,
 VersionNumber* simonMaxVersion, const QString& license, QList<Author*> authors)
 {
@@ -365,6 +503,8 @@ bool Scenario::skim(QString path, QDomDocument* doc, bool deleteDoc)
 bool Scenario::readLanguageModel(QString path, QDomDocument* doc, bool deleteDoc)
 {
   if (!setupToParse(path, doc, deleteDoc)) return false;
+  m_pendingSections.remove("vocabulary");
+  m_pendingSections.remove("grammar");
 
   QDomElement docElem = doc->documentElement();
 
@@ -418,6 +558,7 @@ bool Scenario::readActions(QString path, QDomDocument* doc, bool deleteDoc)
 bool Scenario::readTrainingsTexts(QString path, QDomDocument* doc, bool deleteDoc)
 {
   if (!setupToParse(path, doc, deleteDoc)) return false;
+  m_pendingSections.remove("trainingtexts");
 
   QDomElement docElem = doc->documentElement();
 
@@ -695,17 +836,17 @@ QDomElement Scenario::serialize(QDomDocument doc, bool full)
 
   //  Vocab
   //************************************************/
-  if (!m_vocabulary)
-    rootElem.appendChild(Vocabulary::createEmpty(&doc));
-  else
-    rootElem.appendChild(m_vocabulary->serialize(&doc));
+  QDomElement vocabElem = pendingSection(doc, "vocabulary");
+  QDomElement grammarElem = pendingSection(doc, "grammar");
+  if (vocabElem.isNull() || grammarElem.isNull()) {
+    vocabElem = vocabulary() ? vocabulary()->serialize(&doc) : Vocabulary::createEmpty(&doc);
+    grammarElem = grammar() ? grammar()->serialize(&doc) : Grammar::createEmpty(&doc);
+  }
+  rootElem.appendChild(vocabElem);
 
   //  Grammar
   //************************************************/
-  if (!m_grammar)
-    rootElem.appendChild(Grammar::createEmpty(&doc));
-  else
-    rootElem.appendChild(m_grammar->serialize(&doc));
+  rootElem.appendChild(grammarElem);
 
   //  Actions
   //************************************************/
@@ -716,10 +857,10 @@ QDomElement Scenario::serialize(QDomDocument doc, bool full)
 
   //  Trainingstexts
   //************************************************/
-  if (!m_texts)
-    rootElem.appendChild(TrainingTextCollection::createEmpty(&doc));
-  else
-    rootElem.appendChild(m_texts->serialize(&doc));
+  QDomElement textsElem = pendingSection(doc, "trainingtexts");
+  if (textsElem.isNull())
+    textsElem = texts() ? texts()->serialize(&doc) : TrainingTextCollection::createEmpty(&doc);
+  rootElem.appendChild(textsElem);
 
   //  CompoundCondition
   //************************************************/
@@ -775,25 +916,25 @@ QString Scenario::serialize(bool full)
 
 bool Scenario::addWords(QList<Word*> w)
 {
-  return (m_vocabulary->addWords(w));
+  return (vocabulary()->addWords(w));
 }
 
 
 bool Scenario::addWord(Word* w)
 {
-  return (m_vocabulary->addWord(w));
+  return (vocabulary()->addWord(w));
 }
 
 
 bool Scenario::removeWord(Word* w)
 {
-  return (m_vocabulary->removeWord(w));
+  return (vocabulary()->removeWord(w));
 }
 
 
 bool Scenario::addStructures(const QStringList& newStructures)
 {
-  return m_grammar->addStructures(newStructures);
+  return grammar()->addStructures(newStructures);
 }
 
 
@@ -802,10 +943,10 @@ QStringList Scenario::getCategories(SpeechModel::ModelElements elements)
   QStringList categories;
 
   if (elements & SpeechModel::ScenarioVocabulary)
-    categories = m_vocabulary->getCategories();
+    categories = vocabulary()->getCategories();
 
   if (elements & SpeechModel::ScenarioGrammar) {
-    QStringList grammarCategories = m_grammar->getCategories();
+    QStringList grammarCategories = grammar()->getCategories();
     foreach (const QString& category, grammarCategories)
       if (!categories.contains(category))
       categories << category;
@@ -821,14 +962,14 @@ bool Scenario::renameCategory(const QString& category, const QString& newName, S
   bool scenarioChanged = false;
 
   if (affect & SpeechModel::ScenarioVocabulary) {
-    if (m_vocabulary->renameCategory(category, newName))
+    if (vocabulary()->renameCategory(category, newName))
       scenarioChanged=true;
     else
       success=false;
   }
 
   if (affect & SpeechModel::ScenarioGrammar) {
-    if (m_grammar->renameCategory(category, newName))
+    if (grammar()->renameCategory(category, newName))
       scenarioChanged=true;
     else
       success=false;
@@ -842,13 +983,13 @@ bool Scenario::renameCategory(const QString& category, const QString& newName, S
 
 QList<Word*> Scenario::findWords(const QString& name, Vocabulary::MatchType type)
 {
-  return m_vocabulary->findWords(name, type);
+  return vocabulary()->findWords(name, type);
 }
 
 
 QList<Word*> Scenario::findWordsByCategory(const QString& name)
 {
-  return m_vocabulary->findWordsByCategory(name);
+  return vocabulary()->findWordsByCategory(name);
 }
 
 
@@ -876,7 +1017,7 @@ const QString& toDemonstrateCategory)
       }
     }
 
-    QString randomWord = m_vocabulary->getRandomWord(categoryNow);
+    QString randomWord = vocabulary()->getRandomWord(categoryNow);
     if (randomWord.isNull()) {
       if (!toDemonstrate.isNull() && (categoryNow == toDemonstrateCategory)) {
         actualSentence.append(toDemonstrate);
@@ -898,7 +1039,7 @@ QStringList Scenario::getExampleSentences(const QString& name, const QString& ca
   int failedCounter = 0;
 
   for (int i=0; i < count; i++) {
-    QString categorySentence = m_grammar->getExampleSentence(category);
+    QString categorySentence = grammar()->getExampleSentence(category);
     if (categorySentence.isNull()) {
       //no sentence found
       return out;
@@ -923,7 +1064,7 @@ QStringList Scenario::getExampleSentences(const QString& name, const QString& ca
 
 QStringList Scenario::getAllPossibleSentences()
 {
-  QStringList categorySentences = m_grammar->getStructures();
+  QStringList categorySentences = grammar()->getStructures();
 
   QStringList allSentences;
 
@@ -951,7 +1092,7 @@ QStringList Scenario::getAllPossibleSentencesOfStructure(const QString& structur
   QList< QList<Word*> > sentenceMatrix;
 
   foreach (const QString& element, structureElements)
-    sentenceMatrix.append(m_vocabulary->findWordsByCategory(element));
+    sentenceMatrix.append(vocabulary()->findWordsByCategory(element));
 
   //sentences: ( (Window, Test), (Next, Previous) )
 
@@ -987,31 +1128,31 @@ QStringList Scenario::getValidSentences(QList< QList<Word*> > sentenceMatrix, in
 
 QString Scenario::getRandomWord(const QString& category)
 {
-  return m_vocabulary->getRandomWord(category);
+  return vocabulary()->getRandomWord(category);
 }
 
 
 bool Scenario::containsWord(const QString& word)
 {
-  return (m_vocabulary->containsWord(word));
+  return (vocabulary()->containsWord(word));
 }
 
 
 bool Scenario::containsWord(const QString& word, const QString& category, const QString& pronunciation)
 {
-  return (m_vocabulary->containsWord(word, category, pronunciation));
+  return (vocabulary()->containsWord(word, category, pronunciation));
 }
 
 
 bool Scenario::removeText(TrainingText* text)
 {
-  return m_texts->removeText(text);
+  return texts()->removeText(text);
 }
 
 
 bool Scenario::addTrainingText(TrainingText* text)
 {
-  return m_texts->addTrainingText(text);
+  return texts()->addTrainingText(text);
 }
 
 
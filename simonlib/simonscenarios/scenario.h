@@ -25,10 +25,12 @@
 #include <QDateTime>
 #include <QDomDocument>
 #include <QHash>
+#include <QMutex>
 #include <KIcon>
 #include "speechmodel.h"
 #include "vocabulary.h"
 #include "scenariomanager.h"
+#include "scenariosections.h"
 #include <simonrecognitionresult/recognitionresult.h>
 #include "simonmodelmanagement_export.h"
 #include <simoncontextdetection/compoundcondition.h>
@@ -76,6 +78,16 @@ class MODELMANAGEMENT_EXPORT Scenario : public QObject
     QList<Scenario*> m_childScenarios;
     Scenario* m_parentScenario;
 
+    //sections of the scenario file that are only parsed on first use; the
+    //lock serializes the first call of the getters and the objects created
+    //there are moved to the thread of the scenario
+    ScenarioSections m_pendingSections;
+    QMutex m_pendingSectionsLock;
+    void loadPendingLanguageModel();
+    void loadPendingTexts();
+    void adoptPendingObject(QObject *object);
+    QDomElement pendingSection(QDomDocument& doc, const QString& section);
+
     QStringList getValidSentences(QList< QList<Word*> > sentenceMatrix, int* alreadyFoundExamples=0);
 
     bool setupPathToParse(QString& path);
@@ -134,6 +146,19 @@ class MODELMANAGEMENT_EXPORT Scenario : public QObject
     bool readCompoundCondition(QString path=QString(), QDomDocument* doc=0, bool deleteDoc=false);
     bool readChildScenarioIds(QString path=QString(), QDomDocument* doc=0, bool deleteDoc=false);
     bool init(QString path=QString());
+
+    /**
+     * Initializes the scenario from an already read scenario file.
+     *
+     * Vocabulary, grammar and training texts are only parsed on first
+     * access.
+     */
+    bool init(const ScenarioSections& sections);
+
+    /**
+     * \return The file this scenario will be loaded from
+     */
+    QString sourcePath();
     bool create(const QString& name, const QString& iconSrc, int version, VersionNumber* simonMinVersion,
       VersionNumber* simonMaxVersion, const QString& license, QList<Author*> authors);
     bool update(const QString& name, const QString& iconSrc, int version, VersionNumber* simonMinVersion,
@@ -146,9 +171,9 @@ class MODELMANAGEMENT_EXPORT Scenario : public QObject
     void setParentScenario(Scenario* parent);
     void setChildScenarioIds(QStringList ids);
 
-    ActiveVocabulary* vocabulary() { return m_vocabulary; }
-    Grammar* grammar() { return m_grammar; }
-    TrainingTextCollection* texts() { return m_texts; }
+    ActiveVocabulary* vocabulary();
+    Grammar* grammar();
+    TrainingTextCollection* texts();
     ActionCollection* actionCollection() { return m_actionCollection; }
     CompoundCondition* compoundCondition() {return m_compoundCondition;}
 
@@ -32,6 +32,7 @@
 #include <simonscenariobase/versionnumber.h>
 
 #include <QFileInfo>
+#include <QtConcurrentMap>
 #include <QCoreApplication>
 #include <QDBusConnection>
 
@@ -115,7 +116,7 @@ QHash<QString,QString> ScenarioManager::transcribe(QStringList words)
       if (i.value().getSuccess())
         out.insert(i.key(), i.value().getData());
       else
-        kWarning() << i.key() << "could not be transcribed";
+        kWarning() << i.key() << "could not be transcribed:" << i.value().getData();
     }
   }
   kDebug() << out;
@@ -252,6 +253,13 @@ Scenario* ScenarioManager::getScenario(const QString& id)
 }
 
 
+static ScenarioSections readScenarioSections(const QString& path)
+{
+  ScenarioSections sections;
+  sections.read(path);
+  return sections;
+}
+
 bool ScenarioManager::setupScenarios(bool forceChange)
 {
   bool success = true;
@@ -299,15 +307,26 @@ bool ScenarioManager::setupScenarios(bool forceChange)
 
   kDebug() << "Loading scenarios: " << scenarioIds;
 
+  QList<Scenario*> toLoad;
+  QStringList paths;
   foreach (const QString& id, scenarioIds) {
     Scenario *s = new Scenario(id, QString(), this);
-    kDebug() << "Initializing scenario" << id;
+    toLoad << s;
+    paths << s->sourcePath();
+  }
+
+  //reading the scenario files does not depend on any shared state
+  QList<ScenarioSections> sections = QtConcurrent::blockingMapped(paths, readScenarioSections);
+
+  for (int i=0; i < toLoad.count(); i++) {
+    Scenario *s = toLoad[i];
+    kDebug() << "Initializing scenario" << s->id();
 
-    if (setupScenario(s))
+    if (setupScenario(s, &sections[i]))
       scenarios << s;
     else {
       success = false;
-      kDebug() << "Could not initialize scenario: " << id;
+      kDebug() << "Could not initialize scenario: " << s->id();
     }
   }
 
@@ -346,9 +365,9 @@ void ScenarioManager::setPluginFont(const QFont& font)
 }
 
 
-bool ScenarioManager::setupScenario(Scenario *s)
+bool ScenarioManager::setupScenario(Scenario *s, const ScenarioSections *sections)
 {
-  if (!s->init()) {
+  if (!(sections ? s->init(*sections) : s->init())) {
     kDebug() << "Could not init scenario";
     return false;
   }
@@ -40,6 +40,7 @@
 
 class Word;
 class Scenario;
+class ScenarioSections;
 class ScenarioDisplay;
 class ShadowVocabulary;
 class Command;
@@ -65,7 +66,7 @@ class MODELMANAGEMENT_EXPORT ScenarioManager : public QObject
     bool m_baseModelDirty;
     bool m_scenariosDirty;
     bool m_shadowVocabularyDirty;
-    bool setupScenario(Scenario *s);
+    bool setupScenario(Scenario *s, const ScenarioSections *sections=0);
 
     ShadowVocabulary *shadowVocab;
     Scenario *currentScenario;
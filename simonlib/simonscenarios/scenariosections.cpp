@@ -0,0 +1,122 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "scenariosections.h"
+
+#include <QFile>
+#include <QTextCodec>
+#include <QXmlStreamReader>
+#include <QDomDocument>
+#include <KDebug>
+
+ScenarioSections::ScenarioSections() : m_valid(false)
+{
+}
+
+bool ScenarioSections::read(const QString& path)
+{
+  m_valid = false;
+  m_path = path;
+  m_rootTag.clear();
+  m_sections.clear();
+
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly))
+    return false;
+  QByteArray data = f.readAll();
+  f.close();
+
+  //decode once ourselves so that the reader offsets index into this string
+  QTextCodec *codec = 0;
+  int declarationEnd = data.startsWith("<?xml") ? data.indexOf("?>") : -1;
+  int encoding = (declarationEnd != -1) ? data.left(declarationEnd).indexOf("encoding=") : -1;
+  if (encoding != -1) {
+    char quote = data[encoding+9];
+    int encodingEnd = data.indexOf(quote, encoding+10);
+    codec = QTextCodec::codecForName(data.mid(encoding+10, encodingEnd-encoding-10));
+  }
+  QString content = codec ? codec->toUnicode(data) : QString::fromUtf8(data);
+  data.clear();
+
+  QXmlStreamReader reader(content);
+  int depth = 0;
+  while (!reader.atEnd()) {
+    switch (reader.readNext()) {
+      case QXmlStreamReader::StartElement:
+      {
+        //the reader is right behind the start tag; attribute values may
+        //contain '>' but never '<', so the tag starts at the last '<'
+        int tagEnd = content.lastIndexOf('>', reader.characterOffset()-1);
+        int tokenStart = content.lastIndexOf('<', tagEnd);
+        if (depth == 0) {
+          if (reader.name() != QLatin1String("scenario")) {
+            kDebug() << "This is not a scenario: " << path;
+            return false;
+          }
+          m_rootTag = content.mid(tokenStart, tagEnd+1-tokenStart);
+        } else if (depth == 1) {
+          //skip the section without building anything
+          QString name = reader.name().toString();
+          reader.skipCurrentElement();
+          int tokenEnd = content.lastIndexOf('>', reader.characterOffset()-1) + 1;
+          if (!reader.hasError() && !m_sections.contains(name))
+            m_sections.insert(name, content.mid(tokenStart, tokenEnd-tokenStart));
+          break;
+        }
+        depth++;
+        break;
+      }
+      case QXmlStreamReader::EndElement:
+        depth--;
+        break;
+      default:
+        break;
+    }
+  }
+
+  if (reader.hasError() || m_rootTag.isEmpty()) {
+    kDebug() << "Could not parse scenario " << path << ":" << reader.errorString();
+    m_sections.clear();
+    return false;
+  }
+
+  m_valid = true;
+  return true;
+}
+
+QDomDocument* ScenarioSections::document(const QStringList& sections) const
+{
+  QString xml = m_rootTag;
+  if (xml.endsWith(QLatin1String("/>"))) {
+    //empty scenario
+    xml.chop(2);
+    xml += '>';
+  }
+  foreach (const QString& section, sections)
+    xml += m_sections.value(section);
+  xml += QLatin1String("</scenario>");
+
+  QDomDocument *doc = new QDomDocument("scenario");
+  if (!doc->setContent(xml)) {
+    delete doc;
+    return 0;
+  }
+  return doc;
+}
@@ -0,0 +1,79 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef SIMON_SCENARIOSECTIONS_H_CAD1E51170A0450B9638E7AF24883A8B
+#define SIMON_SCENARIOSECTIONS_H_CAD1E51170A0450B9638E7AF24883A8B
+
+#include "simonmodelmanagement_export.h"
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+
+class QDomDocument;
+
+/**
+ * \class ScenarioSections
+ * \brief Index of the top level sections of a scenario file
+ *
+ * The file is read once with a streaming reader that only records where
+ * every top level element (vocabulary, actions, ...) starts and ends.
+ * Sections are parsed into DOM trees only when they are actually needed.
+ *
+ * Reading does not touch any shared state and can be done in parallel
+ * for multiple scenarios.
+ */
+class MODELMANAGEMENT_EXPORT ScenarioSections
+{
+  public:
+    ScenarioSections();
+
+    bool read(const QString& path);
+    bool isValid() const { return m_valid; }
+    QString path() const { return m_path; }
+
+    bool contains(const QString& section) const { return m_sections.contains(section); }
+
+    /**
+     * \return The unparsed XML of the given top level element
+     */
+    QString section(const QString& section) const { return m_sections.value(section); }
+
+    /**
+     * Creates a document with the scenario root element (and its attributes)
+     * that only contains the given sections.
+     *
+     * The caller has to delete the returned document.
+     */
+    QDomDocument* document(const QStringList& sections) const;
+
+    /**
+     * Drops the given section (e.g. after it was materialized)
+     */
+    void remove(const QString& section) { m_sections.remove(section); }
+
+  private:
+    bool m_valid;
+    QString m_path;
+    QString m_rootTag;
+    QHash<QString, QString> m_sections;
+};
+
+#endif
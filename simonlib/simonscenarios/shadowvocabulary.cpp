@@ -21,6 +21,7 @@
 #include "trainingmanager.h"
 
 #include <QFile>
+#include <ctype.h>
 #include <QDomDocument>
 #include <QDomElement>
 #include <KColorScheme>
@@ -28,6 +29,40 @@
 #include <KDateTime>
 #include <KFilterDev>
 #include <KMimeType>
+#include <KDebug>
+
+static const int lineBufferSize = 1024;
+
+/**
+ * Skips the next line without allocating it
+ */
+static void skipLine(QIODevice *f, char *buffer)
+{
+  qint64 length;
+  do {
+    length = f->readLine(buffer, lineBufferSize);
+  } while ((length == lineBufferSize-1) && (buffer[length-1] != '\n'));
+}
+
+/**
+ * Reads the next line, stripped of surrounding whitespace
+ */
+static QString readValue(QIODevice *f, char *buffer)
+{
+  qint64 length = f->readLine(buffer, lineBufferSize);
+  if (length <= 0)
+    return QString();
+
+  if ((length == lineBufferSize-1) && (buffer[length-1] != '\n'))
+    //very long line
+    return QString::fromUtf8(QByteArray(buffer, length)+f->readLine()).trimmed();
+
+  const char *start = buffer;
+  const char *end = buffer+length;
+  while ((start < end) && isspace((unsigned char) *start)) start++;
+  while ((end > start) && isspace((unsigned char) *(end-1))) end--;
+  return QString::fromUtf8(start, end-start);
+}
 
 /**
  * Empty, private constructor
@@ -43,12 +78,32 @@ ShadowVocabulary::ShadowVocabulary(QObject *parent)
     QIODevice *shadowVocabFile = KFilterDev::deviceForFile(vocabFilename,
       KMimeType::findByFileContent(vocabFilename)->name());
 
-    reset(shadowVocabFile);
+    //the xml file stays authoritative; the binary copy is only used if it is up to date
+    QString binaryFilename = KStandardDirs::locate("appdata", "shadowvocabulary.bin");
+    QDateTime xmlDate = readLastModified(shadowVocabFile);
+    if (!binaryFilename.isEmpty() && xmlDate.isValid() &&
+        (binaryLastModified(binaryFilename) == xmlDate) &&
+        loadBinary(binaryFilename, &lastModifiedDate)) {
+      loadFailed = false;
+    } else if (reset(shadowVocabFile))
+      saveBinary(KStandardDirs::locateLocal("appdata", "shadowvocabulary.bin"), lastModifiedDate);
     shadowVocabFile->deleteLater();
   }
 }
 
 
+QDateTime ShadowVocabulary::readLastModified(QIODevice *f)
+{
+  if (!f->open(QIODevice::ReadOnly))
+    return QDateTime();
+
+  f->readLine();                                  //skip document type
+  QString root = QString::fromUtf8(f->readLine());
+  f->close();
+  return QDateTime::fromString(root.mid(26, 19), Qt::ISODate);
+}
+
+
 bool ShadowVocabulary::reset(QIODevice* f)
 {
   if (!f->open(QIODevice::ReadOnly)) {
@@ -65,6 +120,7 @@ bool ShadowVocabulary::reset(QIODevice* f)
 
   lastModifiedDate = QDateTime::fromString(root, Qt::ISODate);
 
+  char buffer[lineBufferSize];
   while (!f->atEnd()) {
     //<word>
     //	<name>
@@ -77,22 +133,23 @@ bool ShadowVocabulary::reset(QIODevice* f)
     //		NOM
     //	</category>
     //</word>
-    f->readLine();                                //skip word
-    f->readLine();                                //skip name
-    QString name = QString::fromUtf8(f->readLine()).trimmed();
-    f->readLine();                                //skip nameend
+    skipLine(f, buffer);                          //skip word
+    skipLine(f, buffer);                          //skip name
+    QString name = readValue(f, buffer);
+    skipLine(f, buffer);                          //skip nameend
 
-    f->readLine();                                //skip pronunciation
-    QString pronunciation = QString::fromUtf8(f->readLine()).trimmed();
-    f->readLine();                                //skip pronunciationend
+    skipLine(f, buffer);                          //skip pronunciation
+    QString pronunciation = intern(readValue(f, buffer));
+    skipLine(f, buffer);                          //skip pronunciationend
 
-    f->readLine();                                //skip category
-    QString category = QString::fromUtf8(f->readLine()).trimmed();
-    f->readLine();                                //skip categoryend
-    f->readLine();                                //skip wordend
+    skipLine(f, buffer);                          //skip category
+    QString category = intern(readValue(f, buffer));
+    skipLine(f, buffer);                          //skip categoryend
+    skipLine(f, buffer);                          //skip wordend
 
     if (category.isEmpty()) continue;
 
+    //interned: usually only compares pointers
     if (!categories.contains(category)) categories << category;
 
     m_words.append(new Word(name, pronunciation, category));
@@ -167,6 +224,9 @@ bool ShadowVocabulary::save()
   shadowVocabFile->close();
   f.close();
 
+  if (!saveBinary(KStandardDirs::locateLocal("appdata", "shadowvocabulary.bin"), lastModifiedDate))
+    kWarning() << "Failed to store binary shadow vocabulary";
+
   emit changed();
 
   return true;
@@ -35,6 +35,7 @@ class MODELMANAGEMENT_EXPORT ShadowVocabulary : public Vocabulary
   private:
     QDateTime lastModifiedDate;
     void touch();
+    static QDateTime readLastModified(QIODevice *f);
 
   protected:
     bool loadFailed;
@@ -0,0 +1,153 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "../commandindex.h"
+#include "../simoncommand.h"
+
+#include <QTest>
+#include <QDomDocument>
+#include <KIcon>
+
+class DummyCommand : public Command
+{
+  public:
+    DummyCommand(const QString& trigger, int state) : Command(trigger, QString(), QString(), state) {}
+
+    const QString getCategoryText() const { return "Dummy"; }
+    const KIcon getCategoryIcon() const { return KIcon(); }
+
+  protected:
+    bool triggerPrivate(int* state) { Q_UNUSED(state); return true; }
+    const QMap<QString,QVariant> getValueMapPrivate() const { return QMap<QString,QVariant>(); }
+    QDomElement serializePrivate(QDomDocument *doc, QDomElement& commandElem) { Q_UNUSED(doc); return commandElem; }
+    bool deSerializePrivate(const QDomElement& commandElem) { Q_UNUSED(commandElem); return true; }
+};
+
+/**
+ * Checks that the trigger index finds the same command a linear search over
+ * all commands would and compares the cost of both lookups.
+ */
+class testCommandIndex: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testCandidates();
+    void testInvalidation();
+    void benchmarkLinear();
+    void benchmarkIndexed();
+
+  private:
+    CommandList commands;
+    QStringList sentences;
+
+    Command* linear(int state, const QString& sentence);
+    Command* indexed(const CommandIndex& index, int state, const QString& sentence);
+};
+
+void testCommandIndex::initTestCase()
+{
+  for (int i=0; i < 5000; i++) {
+    int state = SimonCommand::DefaultState + (i % 3);
+    commands << new DummyCommand(QString("Open document %1").arg(i), state);
+    if (i % 50 == 0)
+      commands << new DummyCommand("Select "+QString::number(i)+" entry %1", state);
+  }
+  commands << new DummyCommand("Go to %1", SimonCommand::DefaultState);
+  commands << new DummyCommand("%1", SimonCommand::GreedyState);
+
+  sentences << "Open document 3" << "open DOCUMENT 3" << "Open document 4998" << "Select 100 entry foo"
+            << "Select 101 entry foo" << "Go to Vienna" << "Close window" << "" << "Open document";
+}
+
+void testCommandIndex::cleanupTestCase()
+{
+  qDeleteAll(commands);
+}
+
+Command* testCommandIndex::linear(int state, const QString& sentence)
+{
+  foreach (Command *c, commands)
+    if (c->matches(state, sentence))
+      return c;
+  return 0;
+}
+
+Command* testCommandIndex::indexed(const CommandIndex& index, int state, const QString& sentence)
+{
+  foreach (Command *c, index.candidates(state, sentence))
+    if (c->matches(state, sentence))
+      return c;
+  return 0;
+}
+
+void testCommandIndex::testCandidates()
+{
+  CommandIndex index;
+  index.build(commands);
+  QVERIFY(index.isValid(commands));
+
+  QList<int> states;
+  states << SimonCommand::DefaultState << SimonCommand::DefaultState+1 << SimonCommand::DefaultState+2
+         << SimonCommand::GreedyState;
+  foreach (int state, states)
+    foreach (const QString& sentence, sentences)
+      QCOMPARE(indexed(index, state, sentence), linear(state, sentence));
+
+  QCOMPARE(index.candidates(SimonCommand::DefaultState, "Open document 3").count(), 1);
+}
+
+void testCommandIndex::testInvalidation()
+{
+  CommandIndex index;
+  index.build(commands);
+
+  CommandList copy = commands;
+  QVERIFY(index.isValid(copy));
+  copy << new DummyCommand("Close window", SimonCommand::DefaultState);
+  QVERIFY(!index.isValid(copy));
+  delete copy.takeLast();
+
+  index.invalidate();
+  QVERIFY(!index.isValid(commands));
+}
+
+void testCommandIndex::benchmarkLinear()
+{
+  QBENCHMARK {
+    foreach (const QString& sentence, sentences)
+      linear(SimonCommand::DefaultState, sentence);
+  }
+}
+
+void testCommandIndex::benchmarkIndexed()
+{
+  CommandIndex index;
+  index.build(commands);
+  QBENCHMARK {
+    foreach (const QString& sentence, sentences)
+      indexed(index, SimonCommand::DefaultState, sentence);
+  }
+}
+
+QTEST_MAIN(testCommandIndex)
+
+#include "commandindextest.moc"
@@ -0,0 +1,134 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "../promptstable.h"
+
+#include <QTest>
+
+/**
+ * Checks that the word index of the prompts table follows inserts, removals
+ * and merges and compares it with a scan over all prompts.
+ */
+class testPromptsTable: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void testIndex();
+    void testReplace();
+    void testMerge();
+    void benchmarkScan();
+    void benchmarkIndexed();
+
+  private:
+    void fill(PromptsTable& table, int count);
+};
+
+void testPromptsTable::fill(PromptsTable& table, int count)
+{
+  for (int i=0; i < count; i++)
+    table.insert(QString("sample_%1").arg(i), "default",
+                 QString("OPEN DOCUMENT %1 NOW").arg(i % 100));
+}
+
+void testPromptsTable::testIndex()
+{
+  PromptsTable table;
+  table.insert("a", "default", "ONE TWO ONE");
+  table.insert("b", "default", "TWO THREE");
+
+  QCOMPARE(table.wordCount("ONE"), 2);
+  QCOMPARE(table.wordCount("TWO"), 2);
+  QCOMPARE(table.wordCount("ON"), 0);
+  QCOMPARE(table.samplesContaining("TWO"), QSet<QString>() << "a" << "b");
+  QCOMPARE(table.samplesContaining("ONE"), QSet<QString>() << "a");
+  QCOMPARE(table.untrainedWords(QStringList() << "ONE" << "FOUR" << "THREE"), QStringList() << "FOUR");
+
+  table.remove("a");
+  QCOMPARE(table.wordCount("ONE"), 0);
+  QCOMPARE(table.wordCount("TWO"), 1);
+  QCOMPARE(table.samplesContaining("TWO"), QSet<QString>() << "b");
+  QVERIFY(!table.contains("a"));
+
+  table.remove("b");
+  QCOMPARE(table.wordCount("THREE"), 0);
+  QVERIFY(table.samplesContaining("TWO").isEmpty());
+}
+
+void testPromptsTable::testReplace()
+{
+  PromptsTable table;
+  table.insert("a", "default", "ONE TWO");
+  table.insert("a", "default", "THREE");
+
+  QCOMPARE(table.count(), 1);
+  QCOMPARE(table.wordCount("ONE"), 0);
+  QCOMPARE(table.wordCount("THREE"), 1);
+}
+
+void testPromptsTable::testMerge()
+{
+  PromptsTable table;
+  table.insert("a", "default", "ONE TWO");
+  table.insert("b", "default", "TWO");
+
+  PromptsTable other;
+  other.insert("b", "other", "THREE");
+  other.insert("c", "other", "TWO TWO");
+
+  QVERIFY(table.merge(other));
+  QCOMPARE(table.count(), 3);
+  QCOMPARE(table.wordCount("TWO"), 3);
+  QCOMPARE(table.wordCount("THREE"), 1);
+  QCOMPARE(table.samplesContaining("TWO"), QSet<QString>() << "a" << "c");
+  QCOMPARE(table.sampleGroup("b"), QString("other"));
+}
+
+void testPromptsTable::benchmarkScan()
+{
+  PromptsTable table;
+  fill(table, 50000);
+
+  int found = 0;
+  QBENCHMARK_ONCE {
+    for (int i=0; i < 100; i++) {
+      QString word = QString::number(i);
+      foreach (const QString& prompt, table.words())
+        found += prompt.split(' ').count(word);
+    }
+  }
+  QCOMPARE(found, 50000);
+}
+
+void testPromptsTable::benchmarkIndexed()
+{
+  PromptsTable table;
+  fill(table, 50000);
+
+  int found = 0;
+  QBENCHMARK_ONCE {
+    for (int i=0; i < 100; i++)
+      found += table.wordCount(QString::number(i));
+  }
+  QCOMPARE(found, 50000);
+}
+
+QTEST_MAIN(testPromptsTable)
+
+#include "promptstabletest.moc"
@@ -0,0 +1,138 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "../scenariosections.h"
+
+#include <QTest>
+#include <QDir>
+#include <QFile>
+#include <QDomDocument>
+
+/**
+ * Checks that the streaming section index cuts scenario files at the
+ * right places.
+ */
+class testScenarioSections: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void testRead();
+    void testDocument();
+    void testAdjacent();
+    void testInvalid();
+    void cleanup();
+
+  private:
+    QString path() { return QDir::temp().filePath("simonscenariostest-sections.xml"); }
+    void write(const QByteArray& data);
+};
+
+static const char *vocabulary = "<vocabulary><word><name>Stra\xc3\x9f" "e</name><pronunciation>S t r a: s @</pronunciation>"
+                                "<category>NOM &amp; more</category></word></vocabulary>";
+
+void testScenarioSections::write(const QByteArray& data)
+{
+  QFile f(path());
+  QVERIFY(f.open(QIODevice::WriteOnly));
+  f.write(data);
+}
+
+void testScenarioSections::cleanup()
+{
+  QFile::remove(path());
+}
+
+void testScenarioSections::testRead()
+{
+  write(QByteArray("<!DOCTYPE scenario>\n<scenario name=\"Test &gt; 1\" version=\"3\">\n  ")+vocabulary+
+        "\n  <grammar/>\n  <actions>\n    <pluginName>x</pluginName>\n  </actions>\n</scenario>\n");
+
+  ScenarioSections sections;
+  QVERIFY(sections.read(path()));
+  QVERIFY(sections.isValid());
+  QCOMPARE(sections.section("vocabulary"), QString::fromUtf8(vocabulary));
+  QCOMPARE(sections.section("grammar"), QString("<grammar/>"));
+  QCOMPARE(sections.section("actions"), QString("<actions>\n    <pluginName>x</pluginName>\n  </actions>"));
+  QVERIFY(!sections.contains("trainingtexts"));
+
+  sections.remove("grammar");
+  QVERIFY(!sections.contains("grammar"));
+}
+
+void testScenarioSections::testDocument()
+{
+  write(QByteArray("<scenario name=\"Test &gt; 1\" version=\"3\">")+vocabulary+"<grammar/></scenario>");
+
+  ScenarioSections sections;
+  QVERIFY(sections.read(path()));
+  QDomDocument *doc = sections.document(QStringList() << "vocabulary" << "actions");
+  QVERIFY(doc);
+  QDomElement root = doc->documentElement();
+  QCOMPARE(root.attribute("name"), QString("Test > 1"));
+  QCOMPARE(root.attribute("version"), QString("3"));
+  QCOMPARE(root.firstChildElement("vocabulary").firstChildElement().firstChildElement("category").text(),
+           QString("NOM & more"));
+  QVERIFY(root.firstChildElement("grammar").isNull());
+  delete doc;
+
+  write("<scenario name=\"Empty\"/>");
+  QVERIFY(sections.read(path()));
+  doc = sections.document(QStringList() << "vocabulary");
+  QVERIFY(doc);
+  QCOMPARE(doc->documentElement().attribute("name"), QString("Empty"));
+  delete doc;
+}
+
+void testScenarioSections::testAdjacent()
+{
+  //sections directly at the start of their parent, after comments and
+  //after tags with '>' in attribute values
+  write(QByteArray("<scenario name=\"a>b\"><vocabulary/><!-- <grammar/> --><grammar x=\">\"/>"
+                   "<actions><pluginName>x</pluginName></actions></scenario>"));
+
+  ScenarioSections sections;
+  QVERIFY(sections.read(path()));
+  QCOMPARE(sections.section("vocabulary"), QString("<vocabulary/>"));
+  QCOMPARE(sections.section("grammar"), QString("<grammar x=\">\"/>"));
+  QCOMPARE(sections.section("actions"), QString("<actions><pluginName>x</pluginName></actions>"));
+
+  QDomDocument *doc = sections.document(QStringList() << "grammar");
+  QVERIFY(doc);
+  QCOMPARE(doc->documentElement().attribute("name"), QString("a>b"));
+  QCOMPARE(doc->documentElement().firstChildElement("grammar").attribute("x"), QString(">"));
+  delete doc;
+}
+
+void testScenarioSections::testInvalid()
+{
+  ScenarioSections sections;
+  QVERIFY(!sections.read(path()));
+
+  write("<language></language>");
+  QVERIFY(!sections.read(path()));
+
+  write("<scenario><vocabulary></scenario>");
+  QVERIFY(!sections.read(path()));
+  QVERIFY(!sections.isValid());
+}
+
+QTEST_MAIN(testScenarioSections)
+
+#include "scenariosectionstest.moc"
@@ -0,0 +1,230 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "../triggerindex.h"
+#include "../commandindex.h"
+#include "../simoncommand.h"
+#include <simonrecognitionresult/recognitionresult.h>
+
+#include <QTest>
+#include <QDomDocument>
+#include <KIcon>
+
+class DummyCommand : public Command
+{
+  public:
+    DummyCommand(const QString& trigger, int state) : Command(trigger, QString(), QString(), state) {}
+
+    const QString getCategoryText() const { return "Dummy"; }
+    const KIcon getCategoryIcon() const { return KIcon(); }
+
+  protected:
+    bool triggerPrivate(int* state) { Q_UNUSED(state); return true; }
+    const QMap<QString,QVariant> getValueMapPrivate() const { return QMap<QString,QVariant>(); }
+    QDomElement serializePrivate(QDomDocument *doc, QDomElement& commandElem) { Q_UNUSED(doc); return commandElem; }
+    bool deSerializePrivate(const QDomElement& commandElem) { Q_UNUSED(commandElem); return true; }
+};
+
+/**
+ * A synthetic scenario: Plugin triggers (ActionCollection) and the commands
+ * of every plugin (CommandManager).
+ */
+struct SyntheticScenario
+{
+  QStringList triggers;
+  QList<CommandList> commands;
+  TriggerIndex triggerIndex;
+  QList<CommandIndex> commandIndices;
+};
+
+/**
+ * Checks that the plugin trigger index finds the same triggers as matching
+ * every trigger against the sentence and compares the dispatch of a result
+ * through a large synthetic scenario set with and without the indices.
+ */
+class testTriggerIndex: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testCandidates();
+    void testInvalidation();
+    void benchmarkLinear();
+    void benchmarkIndexed();
+
+  private:
+    QStringList triggers;
+    QStringList sentences;
+    QList<SyntheticScenario*> scenarios;
+    QStringList dispatchSentences;
+
+    QList<int> linearMatches(const QString& sentence);
+    QList<int> indexedMatches(const TriggerIndex& index, const QString& sentence);
+    Command* dispatch(const QString& sentence, bool indexed);
+};
+
+//plugin triggers as they are used by the shipped scenarios
+static const char* pluginTriggers[] = { "", "Computer", "Start", "Keyboard", "Open", "Desktop grid",
+                                        "Calculator", "Dictation", "Media", "Window" };
+static const int pluginCount = sizeof(pluginTriggers) / sizeof(pluginTriggers[0]);
+static const int scenarioCount = 200;
+static const int commandsPerPlugin = 20;
+
+void testTriggerIndex::initTestCase()
+{
+  triggers << "Computer" << "" << "Desktop grid" << "Desktop" << "Go (to|into)" << "Computer"
+           << "Win.ow" << "computer" << "Start menu";
+  sentences << "Computer" << "Computer open" << "Computeropen" << "computer open" << "Desktop grid show"
+            << "Desktop gridshow" << "Desktop" << "Go to Vienna" << "Go into the house" << "Window close"
+            << "Start menu" << "Start" << "" << "Nothing at all";
+
+  for (int s=0; s < scenarioCount; s++) {
+    SyntheticScenario *scenario = new SyntheticScenario;
+    for (int p=0; p < pluginCount; p++) {
+      scenario->triggers << QString::fromLatin1(pluginTriggers[p]);
+      CommandList commands;
+      for (int c=0; c < commandsPerPlugin; c++)
+        commands << new DummyCommand(QString("Command %1 %2 %3").arg(s).arg(p).arg(c), SimonCommand::DefaultState);
+      commands << new DummyCommand(QString("Select %1 %2 %3").arg(s).arg(p).arg("%1"), SimonCommand::DefaultState);
+      scenario->commands << commands;
+
+      CommandIndex index;
+      index.build(commands);
+      scenario->commandIndices << index;
+    }
+    scenario->triggerIndex.build(scenario->triggers);
+    scenarios << scenario;
+  }
+
+  dispatchSentences << QString("Computer Command %1 1 7").arg(scenarioCount-1)
+                    << QString("Select %1 0 foo").arg(scenarioCount-1)
+                    << "Desktop grid Command 3 5 19" << "Keyboard nothing" << "Close the window";
+}
+
+void testTriggerIndex::cleanupTestCase()
+{
+  foreach (SyntheticScenario *scenario, scenarios)
+    foreach (const CommandList& commands, scenario->commands)
+      qDeleteAll(commands);
+  qDeleteAll(scenarios);
+}
+
+QList<int> testTriggerIndex::linearMatches(const QString& sentence)
+{
+  QList<int> matches;
+  RecognitionResult result(sentence, QString(), QString(), QList<float>());
+  for (int i=0; i < triggers.count(); i++)
+    if (result.matchesTrigger(triggers[i]))
+      matches << i;
+  return matches;
+}
+
+QList<int> testTriggerIndex::indexedMatches(const TriggerIndex& index, const QString& sentence)
+{
+  QList<int> matches;
+  RecognitionResult result(sentence, QString(), QString(), QList<float>());
+  foreach (int i, index.candidates(sentence))
+    if (result.matchesTrigger(index.trigger(i)))
+      matches << i;
+  return matches;
+}
+
+/**
+ * Finds the command the scenario set would trigger for the sentence, like
+ * ActionCollection::processResult() and CommandManager::trigger() do.
+ */
+Command* testTriggerIndex::dispatch(const QString& sentence, bool indexed)
+{
+  RecognitionResult result(sentence, QString(), QString(), QList<float>());
+  foreach (SyntheticScenario *scenario, scenarios) {
+    QList<int> candidates;
+    if (indexed)
+      candidates = scenario->triggerIndex.candidates(sentence);
+    else
+      for (int i=0; i < scenario->triggers.count(); i++)
+        candidates << i;
+
+    foreach (int i, candidates) {
+      RecognitionResult tempResult = result;
+      if (!tempResult.matchesTrigger(scenario->triggers[i]))
+        continue;
+      tempResult.removeTrigger(scenario->triggers[i]);
+
+      CommandList commands = indexed ?
+            scenario->commandIndices[i].candidates(SimonCommand::DefaultState, tempResult.sentence()) :
+            scenario->commands[i];
+      foreach (Command *c, commands)
+        if (c->matches(SimonCommand::DefaultState, tempResult.sentence()))
+          return c;
+    }
+  }
+  return 0;
+}
+
+void testTriggerIndex::testCandidates()
+{
+  TriggerIndex index;
+  index.build(triggers);
+  QVERIFY(index.isValid(triggers));
+
+  foreach (const QString& sentence, sentences)
+    QCOMPARE(indexedMatches(index, sentence), linearMatches(sentence));
+
+  //only the empty and the pattern triggers are checked for unrelated sentences
+  QCOMPARE(index.candidates("Nothing at all").count(), 3);
+
+  foreach (const QString& sentence, dispatchSentences)
+    QCOMPARE(dispatch(sentence, true), dispatch(sentence, false));
+  QVERIFY(dispatch(dispatchSentences.first(), true));
+}
+
+void testTriggerIndex::testInvalidation()
+{
+  TriggerIndex index;
+  index.build(triggers);
+
+  QStringList changed = triggers;
+  QVERIFY(index.isValid(changed));
+  changed[0] = "Calculator";
+  QVERIFY(!index.isValid(changed));
+
+  index.invalidate();
+  QVERIFY(!index.isValid(triggers));
+}
+
+void testTriggerIndex::benchmarkLinear()
+{
+  QBENCHMARK {
+    foreach (const QString& sentence, dispatchSentences)
+      dispatch(sentence, false);
+  }
+}
+
+void testTriggerIndex::benchmarkIndexed()
+{
+  QBENCHMARK {
+    foreach (const QString& sentence, dispatchSentences)
+      dispatch(sentence, true);
+  }
+}
+
+QTEST_MAIN(testTriggerIndex)
+
+#include "triggerindextest.moc"
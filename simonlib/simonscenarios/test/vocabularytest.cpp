@@ -0,0 +1,182 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "../vocabulary.h"
+#include "../word.h"
+
+#include <QTest>
+#include <QDir>
+#include <QDomDocument>
+
+/**
+ * Checks the sorted insertion and the substring index of the vocabulary
+ * against a plain linear search.
+ */
+class testVocabulary: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testAddWords();
+    void testFindWords();
+    void testFindWords_data();
+    void benchmarkFindWords();
+    void testBinary();
+    void benchmarkLoadXml();
+    void benchmarkLoadBinary();
+
+  private:
+    Vocabulary *vocabulary;
+
+    QString binaryPath() { return QDir::temp().filePath("simonscenariostest-vocabulary.bin"); }
+};
+
+void testVocabulary::initTestCase()
+{
+  vocabulary = new Vocabulary;
+
+  QList<Word*> words;
+  for (int i=0; i < 20000; i++)
+    words << new Word(QString("Word%1").arg(i), QString("w 3: d %1").arg(i % 7), (i % 2) ? "NOM" : "VERB");
+  words << new Word(QString::fromUtf8("Straße"), "S t r a: s @", "NOM");
+  vocabulary->addWords(words);
+}
+
+void testVocabulary::cleanupTestCase()
+{
+  delete vocabulary;
+  QFile::remove(binaryPath());
+}
+
+void testVocabulary::testAddWords()
+{
+  QList<Word*> words = vocabulary->getWords();
+  QCOMPARE(words.count(), 20001);
+  for (int i=1; i < words.count(); i++)
+    QVERIFY(!isWordLessThan(words[i], words[i-1]));
+
+  //duplicates are dropped, new words are inserted in order
+  vocabulary->addWords(QList<Word*>() << new Word("Word5", "w 3: d 5", "NOM") << new Word("Aardvark", "a: r t f a r k", "NOM"));
+  QCOMPARE(vocabulary->wordCount(), 20002);
+  QCOMPARE(vocabulary->getWords().first()->getWord(), QString("Aardvark"));
+  QCOMPARE(vocabulary->getCategories().count(), 2);
+
+  QVERIFY(vocabulary->containsWord("WORD5"));
+  QVERIFY(vocabulary->containsWord("Word5", "w 3: d 5", "NOM"));
+  QVERIFY(!vocabulary->containsWord("Word5", "w 3: d 5", "VERB"));
+
+  vocabulary->removeWord(vocabulary->getWords().first());
+  QCOMPARE(vocabulary->wordCount(), 20001);
+}
+
+void testVocabulary::testFindWords_data()
+{
+  QTest::addColumn<QString>("name");
+  QTest::newRow("prefix") << "word1";
+  QTest::newRow("suffix") << "999";
+  QTest::newRow("upper case") << QString::fromUtf8("STRAßE");
+  QTest::newRow("umlaut") << QString::fromUtf8("aße");
+  QTest::newRow("none") << "xyz";
+}
+
+void testVocabulary::testFindWords()
+{
+  QFETCH(QString, name);
+
+  QList<Word*> expected;
+  foreach (Word *w, vocabulary->getWords())
+    if (w->getWord().contains(name, Qt::CaseInsensitive))
+      expected << w;
+
+  QCOMPARE(vocabulary->findWords(name, Vocabulary::ContainsMatch), expected);
+}
+
+void testVocabulary::benchmarkFindWords()
+{
+  QBENCHMARK {
+    vocabulary->findWords("d123", Vocabulary::ContainsMatch);
+  }
+}
+
+void testVocabulary::testBinary()
+{
+  QDateTime modified = QDateTime::fromString("2014-03-01T12:30:00", Qt::ISODate);
+  QVERIFY(vocabulary->saveBinary(binaryPath(), modified));
+  QCOMPARE(Vocabulary::binaryLastModified(binaryPath()), modified);
+
+  Vocabulary loaded;
+  QDateTime loadedModified;
+  QVERIFY(loaded.loadBinary(binaryPath(), &loadedModified));
+  QCOMPARE(loadedModified, modified);
+  QCOMPARE(loaded.wordCount(), vocabulary->wordCount());
+  QCOMPARE(loaded.getCategories(), vocabulary->getCategories());
+  for (int i=0; i < loaded.wordCount(); i++) {
+    QVERIFY(*loaded.getWords()[i] == *vocabulary->getWords()[i]);
+    QCOMPARE(loaded.getWords()[i]->getLexiconWord(), vocabulary->getWords()[i]->getLexiconWord());
+  }
+  QCOMPARE(loaded.findWords(QString::fromUtf8("straße"), Vocabulary::ExactMatch).count(), 1);
+
+  //loaded words stay valid after modifications
+  Word *w = loaded.findWords("Word0", Vocabulary::ExactMatch).first();
+  w->setWord(w->getWord()+"s");
+  QVERIFY(loaded.reOrder(w));
+  QVERIFY(loaded.containsWord("WORD0S"));
+
+  //a corrupt file leaves the loaded vocabulary alone
+  QString truncatedPath = binaryPath()+".truncated";
+  QFile::remove(truncatedPath);
+  QVERIFY(QFile::copy(binaryPath(), truncatedPath));
+  QFile truncated(truncatedPath);
+  QVERIFY(truncated.resize(100));
+  QVERIFY(!loaded.loadBinary(truncatedPath));
+  QCOMPARE(loaded.wordCount(), vocabulary->wordCount());
+  QFile::remove(truncatedPath);
+}
+
+void testVocabulary::benchmarkLoadXml()
+{
+  QDomDocument doc;
+  doc.appendChild(vocabulary->serialize(&doc));
+  QByteArray xml = doc.toByteArray();
+
+  Vocabulary loaded;
+  QBENCHMARK_ONCE {
+    QDomDocument loadDoc;
+    loadDoc.setContent(xml);
+    QVERIFY(loaded.deSerialize(loadDoc.documentElement()));
+  }
+  QCOMPARE(loaded.wordCount(), vocabulary->wordCount());
+}
+
+void testVocabulary::benchmarkLoadBinary()
+{
+  QVERIFY(vocabulary->saveBinary(binaryPath()));
+
+  Vocabulary loaded;
+  QBENCHMARK_ONCE {
+    QVERIFY(loaded.loadBinary(binaryPath()));
+  }
+  QCOMPARE(loaded.wordCount(), vocabulary->wordCount());
+}
+
+QTEST_MAIN(testVocabulary)
+
+#include "vocabularytest.moc"
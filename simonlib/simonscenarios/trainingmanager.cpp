@@ -165,8 +165,6 @@ bool TrainingManager::savePrompts()
 
   if (m_dirty)
   {
-      m_wordRelevance.clear();                        // drop probability cache
-
       //Update the training date and signal a change in the data
       KConfig config( KStandardDirs::locateLocal("appdata", "model/modelsrcrc"), KConfig::SimpleConfig );
       KConfigGroup cGroup(&config, "");
@@ -283,28 +281,33 @@ int TrainingManager::getProbability ( QString wordname )
 {
   if (!m_promptsTable) init();
 
-  wordname = wordname.toUpper();
-  if (m_wordRelevance.contains(wordname))
-    return m_wordRelevance.value(wordname);
+  return m_promptsTable->wordCount(wordname.toUpper());
+}
 
-  QStringList prompts = m_promptsTable->words();
-  int prob=0;
-  int i=0;
-  int promptscount=prompts.count();
 
-  while ( i<promptscount ) {
-    //work around some strange problem in my qt version...
-    QString prompt = prompts.at(i);
-    prob += prompt.count(' '+wordname+' ');
-    if (prompt == wordname) prob++;
-    else if (prompt.startsWith(wordname+' ')) prob++;
-    else if (prompt.endsWith(' '+wordname)) prob++;
+/**
+ * \brief Returns the samples whose prompt contains the given word
+ */
+QStringList TrainingManager::getSamplesContaining ( const QString& word )
+{
+  if (!m_promptsTable) init();
+
+  return m_promptsTable->samplesContaining(word.toUpper()).toList();
+}
 
-    i++;
-  }
 
-  m_wordRelevance.insert(wordname, prob);
-  return prob;
+/**
+ * \brief Returns the given words that are not used in any prompt
+ */
+QStringList TrainingManager::getUntrainedWords ( const QStringList& words )
+{
+  if (!m_promptsTable) init();
+
+  QStringList untrained;
+  foreach (const QString& word, words)
+    if (!m_promptsTable->wordCount(word.toUpper()))
+      untrained << word;
+  return untrained;
 }
 
 
@@ -317,10 +320,6 @@ bool TrainingManager::addSample (const QString &fileBaseName, const QString &sam
 
   m_promptsTable->insert(fileBaseName, sampleGroup, prompt.toUpper());
 
-  QStringList words = prompt.split(' ');
-  foreach (const QString& word, words)
-    m_wordRelevance.remove(word.toUpper());                   //removed cached recognition rates
-
   m_dirty=true;
   return true;
 }
@@ -331,11 +330,7 @@ bool TrainingManager::mergePrompts(const PromptsTable& table)
 
   m_dirty = true;
 
-  bool succ = m_promptsTable->merge(table);
-
-  foreach (const QString& word, table.words())
-    m_wordRelevance.remove(word);                   //removed cached recognition rates
-  return succ;
+  return m_promptsTable->merge(table);
 }
 
 bool TrainingManager::clear()
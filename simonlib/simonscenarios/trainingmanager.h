@@ -50,8 +50,6 @@ class MODELMANAGEMENT_EXPORT TrainingManager : public QObject
     static TrainingManager *m_instance;
     TrainingList *m_trainingTexts;
 
-    QHash<QString,int> m_wordRelevance;             /// Stores the relevance of words (caching for getProbability)
-
     QMutex m_promptsLock;
     PromptsTable *m_promptsTable;
 
@@ -74,6 +72,8 @@ class MODELMANAGEMENT_EXPORT TrainingManager : public QObject
     bool deletePrompt ( QString key );
 
     int getProbability ( QString name );
+    QStringList getSamplesContaining ( const QString& word );
+    QStringList getUntrainedWords ( const QStringList& words );
     PromptsTable* readPrompts (QString pathToPrompts);
 
     bool deleteWord(const QString& word);
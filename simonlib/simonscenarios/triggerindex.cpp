@@ -0,0 +1,54 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "triggerindex.h"
+
+#include <QRegExp>
+#include <QtAlgorithms>
+
+TriggerIndex::TriggerIndex() : m_valid(false)
+{
+}
+
+void TriggerIndex::build(const QStringList& triggers)
+{
+  m_triggers = triggers;
+  m_literals.clear();
+  m_patterns.clear();
+
+  QRegExp special("[\\\\^$.|?*+()\\[\\]{}]");
+  for (int i=0; i < triggers.count(); i++) {
+    if (triggers[i].isEmpty() || triggers[i].contains(special))
+      m_patterns << i;
+    else
+      m_literals[triggers[i]] << i;
+  }
+  m_valid = true;
+}
+
+QList<int> TriggerIndex::candidates(const QString& sentence) const
+{
+  QList<int> out = m_patterns;
+  //a trigger has to be followed by a space or the end of the sentence
+  for (int boundary = sentence.indexOf(' '); boundary != -1; boundary = sentence.indexOf(' ', boundary+1))
+    out += m_literals.value(sentence.left(boundary));
+  out += m_literals.value(sentence);
+  qSort(out);
+  return out;
+}
@@ -0,0 +1,69 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SIMON_TRIGGERINDEX_H_7A1E5C39D0B44F2E9C86B13F2D5A47E0
+#define SIMON_TRIGGERINDEX_H_7A1E5C39D0B44F2E9C86B13F2D5A47E0
+
+#include "simonmodelmanagement_export.h"
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/**
+ * \class TriggerIndex
+ * \brief Compiled lookup of the plugin triggers that could prefix a recognized sentence
+ *
+ * RecognitionResult::matchesTrigger() treats triggers as regular expressions
+ * that have to be followed by a space or the end of the sentence. Plain
+ * triggers are looked up by the words the sentence starts with; empty and
+ * pattern triggers are candidates for every sentence.
+ *
+ * The returned candidates keep the order of the trigger list and still have
+ * to be confirmed with RecognitionResult::matchesTrigger().
+ */
+class MODELMANAGEMENT_EXPORT TriggerIndex
+{
+  public:
+    TriggerIndex();
+
+    void build(const QStringList& triggers);
+
+    /**
+     * \return True if the index was built from these exact triggers
+     */
+    bool isValid(const QStringList& triggers) const { return m_valid && (m_triggers == triggers); }
+    void invalidate() { m_valid = false; }
+
+    QString trigger(int position) const { return m_triggers[position]; }
+
+    /**
+     * \return Positions of the triggers that could match the sentence, in order
+     */
+    QList<int> candidates(const QString& sentence) const;
+
+  private:
+    bool m_valid;
+    QStringList m_triggers;
+    QHash<QString, QList<int> > m_literals;
+    QList<int> m_patterns;
+};
+
+#endif
@@ -26,6 +26,57 @@
 //sonnet speller
 #include <sonnet/speller.h>
 #include <QFile>
+#include <QStringMatcher>
+#include <QtAlgorithms>
+#include <QHash>
+#include <string.h>
+
+/*
+ * Binary vocabulary format (native byte order):
+ *
+ * BinaryHeader
+ * quint32 stringOffsets[stringCount+1]   in UTF-16 code units
+ * BinaryWord words[wordCount]            indices into the string table
+ * ushort strings[stringOffsets[stringCount]]
+ *
+ * All sections are 4 byte aligned.
+ */
+static const char binaryMagic[8] = { 'S', 'I', 'M', 'O', 'N', 'V', 'O', 'C' };
+static const quint32 binaryVersion = 1;
+static const quint32 binaryByteOrder = 0x01020304;
+
+struct BinaryHeader {
+  char magic[8];
+  quint32 version;
+  quint32 byteOrder;
+  char lastModified[20];                          //yyyy-MM-ddThh:mm:ss, empty if unknown
+  quint32 stringCount;
+  quint32 wordCount;
+  quint32 reserved;
+};
+
+static QDateTime binaryDate(const BinaryHeader& header)
+{
+  return QDateTime::fromString(QString::fromLatin1(header.lastModified,
+                                 qstrnlen(header.lastModified, sizeof(header.lastModified))),
+                               Qt::ISODate);
+}
+
+struct BinaryWord {
+  quint32 word;
+  quint32 lexiconWord;
+  quint32 pronunciation;
+  quint32 category;
+};
+
+static bool readBinaryHeader(const uchar *data, qint64 size, BinaryHeader& header)
+{
+  if (size < (qint64) sizeof(BinaryHeader))
+    return false;
+  memcpy(&header, data, sizeof(BinaryHeader));
+  return (memcmp(header.magic, binaryMagic, sizeof(binaryMagic)) == 0) &&
+         (header.version == binaryVersion) && (header.byteOrder == binaryByteOrder);
+}
 
 /**
  * Empty, private constructor
@@ -44,6 +95,8 @@ bool Vocabulary::deSerialize(const QDomElement& vocabularyElem)
   //clean member
   qDeleteAll(m_words);
   m_words.clear();
+  m_searchWords.clear();
+  m_stringPool.clear();
   categories.clear();
 
   QDomElement wordElem = vocabularyElem.firstChildElement();
@@ -55,7 +108,7 @@ bool Vocabulary::deSerialize(const QDomElement& vocabularyElem)
 
     QString name = nameElem.text();
     QString pronunciation = pronunciationElem.text();
-    QString category = categoryElem.text();
+    QString category = intern(categoryElem.text());
 
     if (!categories.contains(category)) categories << category;
 
@@ -108,6 +161,7 @@ bool Vocabulary::removeWord(Word* w, bool deleteWord)
     if (m_words.at(i) == w) {
       beginRemoveRows(QModelIndex(), i, i);
       m_words.removeAt(i);
+      m_searchWords.clear();
       endRemoveRows();
       if (deleteWord) delete w;
       return true;
@@ -183,6 +237,7 @@ int role) const
 void Vocabulary::sortWords()
 {
   qSort(m_words.begin(), m_words.end(), isWordLessThan);
+  m_searchWords.clear();
 }
 
 
@@ -194,7 +249,9 @@ bool Vocabulary::appendWordRaw(Word* w)
 
 bool Vocabulary::insertWordRaw(int pos, Word* w)
 {
+  intern(w);
   m_words.insert(pos, w);
+  m_searchWords.clear();
   return true;
 }
 
@@ -216,7 +273,6 @@ bool Vocabulary::reOrder(Word* w)
 
 
 /**
- * The list of words has to be sorted
  * The input list will be destroyed!
  */
 bool Vocabulary::addWords(QList<Word*> w)
@@ -226,29 +282,24 @@ bool Vocabulary::addWords(QList<Word*> w)
   }
 
   //insertion
-  for (int i=0; i < m_words.count(); i++) {
-    if (!( *(m_words[i]) < *(w.at(0)) )) {
-      if (*(m_words[i]) != *(w.at(0))) {
-        if (!categories.contains(w.at(0)->getCategory()))
-          categories << w.at(0)->getCategory();
-        m_words.insert(i, w.takeAt(0));
-        if (w.isEmpty()) break;
-      }
-      else {
-        //word already in the list
-        delete w.takeAt(0);
-        if (w.isEmpty()) break;
-      }
-    }
-  }
-
-  if (!w.isEmpty()) {
-    foreach (Word *word, w) {
-      if (!categories.contains(word->getCategory()))
-        categories << word->getCategory();
-      m_words.append(word);
+  QList<Word*>::iterator start = m_words.begin();
+  foreach (Word *word, w) {
+    //input is usually sorted; only fall back to searching the whole list if it isn't
+    if ((start != m_words.begin()) && isWordLessThan(word, *(start-1)))
+      start = m_words.begin();
+    QList<Word*>::iterator i = qLowerBound(start, m_words.end(), word, isWordLessThan);
+    if ((i != m_words.end()) && (**i == *word)) {
+      //word already in the list
+      delete word;
+      start = i;
+      continue;
     }
+    intern(word);
+    if (!categories.contains(word->getCategory()))
+      categories << word->getCategory();
+    start = m_words.insert(i, word) + 1;
   }
+  m_searchWords.clear();
 
   reset();
 
@@ -306,9 +357,10 @@ bool Vocabulary::containsWord(const QString& word)
 bool Vocabulary::containsWord(const QString& word, const QString& category, const QString& pronunciation)
 {
   Word searchWord = Word(word, category, pronunciation);
-  foreach (Word *w, m_words)
-    if ((*w) == searchWord)
-    return true;
+  QList<Word*>::iterator i = qLowerBound(m_words.begin(), m_words.end(), &searchWord, isWordLessThan);
+  for (; (i != m_words.end()) && ((*i)->getLexiconWord() == searchWord.getLexiconWord()); i++)
+    if ((**i) == searchWord)
+      return true;
   return false;
 }
 
@@ -374,12 +426,20 @@ QList<Word*> Vocabulary::findWords(const QString& name, Vocabulary::MatchType ty
     }
   }
   if (type & Vocabulary::ContainsMatch) {
-    foreach (Word *w, m_words) {
-      if (w->getWord().contains(name, Qt::CaseInsensitive)) {
-        kDebug() << "Adding " << w->getWord() << " matching " << name;
-
-        out << w;
-      }
+    updateSearchIndex();
+    QStringMatcher matcher(name.toCaseFolded());
+    int position = matcher.indexIn(m_searchText);
+    while (position != -1) {
+      int wordIndex = (qUpperBound(m_searchOffsets.constBegin(), m_searchOffsets.constEnd(), position) -
+                       m_searchOffsets.constBegin()) - 1;
+      Word *w = m_searchWords[wordIndex];
+      kDebug() << "Adding " << w->getWord() << " matching " << name;
+      out << w;
+
+      //continue with the next word
+      if (wordIndex+1 == m_searchOffsets.count())
+        break;
+      position = matcher.indexIn(m_searchText, m_searchOffsets[wordIndex+1]);
     }
   }
 
@@ -430,6 +490,7 @@ QList<Word*> Vocabulary::findWordsByCategory(const QString& category)
 void Vocabulary::deleteAll()
 {
   qDeleteAll(m_words);
+  m_stringPool.clear();
   clear();
 }
 
@@ -440,9 +501,44 @@ void Vocabulary::deleteAll()
 void Vocabulary::clear()
 {
   m_words.clear();
+  m_searchWords.clear();
   reset();
 }
 
+
+QString Vocabulary::intern(const QString& s)
+{
+  QSet<QString>::const_iterator i = m_stringPool.constFind(s);
+  if (i != m_stringPool.constEnd())
+    return *i;
+  m_stringPool.insert(s);
+  return s;
+}
+
+
+void Vocabulary::intern(Word *w)
+{
+  w->setCategory(intern(w->getCategory()));
+}
+
+
+void Vocabulary::updateSearchIndex()
+{
+  //words edited in place are re-ordered through removeWord() / addWord()
+  if ((m_searchWords == m_words) && (m_searchOffsets.count() == m_words.count()))
+    return;
+
+  m_searchWords = m_words;
+  m_searchOffsets.resize(m_words.count());
+  m_searchText.clear();
+  for (int i=0; i < m_words.count(); i++) {
+    m_searchOffsets[i] = m_searchText.length();
+    m_searchText += m_words[i]->getWord().toCaseFolded();
+    m_searchText += QLatin1Char('\n');
+  }
+  m_searchText.squeeze();
+}
+
 bool Vocabulary::exportToFile(const QString& path, Vocabulary::ExportFormat format)
 {
   QFile f(path);
@@ -467,3 +563,147 @@ Vocabulary::~Vocabulary()
 {
   qDeleteAll(m_words);
 }
+
+
+QDateTime Vocabulary::binaryLastModified(const QString& path)
+{
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly))
+    return QDateTime();
+
+  QByteArray data = f.read(sizeof(BinaryHeader));
+  BinaryHeader header;
+  if (!readBinaryHeader((const uchar*) data.constData(), data.size(), header))
+    return QDateTime();
+  return binaryDate(header);
+}
+
+
+bool Vocabulary::saveBinary(const QString& path, const QDateTime& lastModified)
+{
+  QHash<QString, quint32> stringIndex;
+  QVector<quint32> offsets;
+  QString strings;
+  QVector<BinaryWord> words(m_words.count());
+
+  offsets << 0;
+  for (int i=0; i < m_words.count(); i++) {
+    Word *w = m_words[i];
+    QString fields[4] = { w->getWord(), w->getLexiconWord(), w->getPronunciation(), w->getCategory() };
+    quint32 indices[4];
+    for (int j=0; j < 4; j++) {
+      QHash<QString, quint32>::const_iterator it = stringIndex.constFind(fields[j]);
+      if (it == stringIndex.constEnd()) {
+        it = stringIndex.insert(fields[j], offsets.count()-1);
+        strings += fields[j];
+        offsets << strings.length();
+      }
+      indices[j] = *it;
+    }
+    words[i].word = indices[0];
+    words[i].lexiconWord = indices[1];
+    words[i].pronunciation = indices[2];
+    words[i].category = indices[3];
+  }
+
+  BinaryHeader header;
+  memset(&header, 0, sizeof(BinaryHeader));
+  memcpy(header.magic, binaryMagic, sizeof(binaryMagic));
+  header.version = binaryVersion;
+  header.byteOrder = binaryByteOrder;
+  if (lastModified.isValid())
+    qstrncpy(header.lastModified, lastModified.toString("yyyy-MM-ddThh:mm:ss").toLatin1().constData(),
+             sizeof(header.lastModified));
+  header.stringCount = offsets.count()-1;
+  header.wordCount = words.count();
+
+  //other processes might be reading the old file; never overwrite it in place
+  QString tempPath = path+".new";
+  QFile f(tempPath);
+  if (!f.open(QIODevice::WriteOnly))
+    return false;
+  f.write((const char*) &header, sizeof(BinaryHeader));
+  f.write((const char*) offsets.constData(), offsets.count() * sizeof(quint32));
+  f.write((const char*) words.constData(), words.count() * sizeof(BinaryWord));
+  f.write((const char*) strings.utf16(), strings.length() * sizeof(ushort));
+  f.close();
+  if (f.error() != QFile::NoError) {
+    f.remove();
+    return false;
+  }
+  QFile::remove(path);
+  return QFile::rename(tempPath, path);
+}
+
+
+bool Vocabulary::loadBinary(const QString& path, QDateTime *lastModified)
+{
+  QFile f(path);
+  QByteArray content;
+  if (f.open(QIODevice::ReadOnly))
+    content = f.readAll();
+  const uchar *data = (const uchar*) content.constData();
+  qint64 size = content.size();
+
+  BinaryHeader header;
+  if (!readBinaryHeader(data, size, header)) {
+    kWarning() << "Not a valid binary vocabulary: " << path;
+    return false;
+  }
+
+  const quint32 *offsets = (const quint32*) (data + sizeof(BinaryHeader));
+  const BinaryWord *words = (const BinaryWord*) (offsets + header.stringCount + 1);
+  const ushort *strings = (const ushort*) (words + header.wordCount);
+  qint64 tableSize = sizeof(BinaryHeader) + ((qint64) header.stringCount + 1) * sizeof(quint32) +
+                     ((qint64) header.wordCount) * sizeof(BinaryWord);
+
+  bool valid = (tableSize <= size) && (offsets[0] == 0);
+  for (quint32 i=0; valid && (i < header.stringCount); i++)
+    valid = (offsets[i] <= offsets[i+1]);
+  valid = valid && (tableSize + ((qint64) offsets[header.stringCount]) * sizeof(ushort) <= size);
+  for (quint32 i=0; valid && (i < header.wordCount); i++)
+    valid = (words[i].word < header.stringCount) && (words[i].lexiconWord < header.stringCount) &&
+            (words[i].pronunciation < header.stringCount) && (words[i].category < header.stringCount);
+  if (!valid) {
+    kWarning() << "Corrupt binary vocabulary: " << path;
+    return false;
+  }
+
+  qDeleteAll(m_words);
+  m_words.clear();
+  m_searchWords.clear();
+  m_stringPool.clear();
+  categories.clear();
+
+  //one shared string per table entry
+  QVector<QString> table(header.stringCount);
+  QVector<bool> created(header.stringCount, false);
+  QVector<bool> listed(header.stringCount, false);
+  QString fields[4];
+  for (quint32 i=0; i < header.wordCount; i++) {
+    quint32 indices[4] = { words[i].word, words[i].lexiconWord, words[i].pronunciation, words[i].category };
+    for (int j=0; j < 4; j++) {
+      quint32 index = indices[j];
+      if (!created[index]) {
+        table[index] = QString((const QChar*) (strings + offsets[index]),
+                               offsets[index+1] - offsets[index]);
+        created[index] = true;
+        if (j == 3)
+          m_stringPool.insert(table[index]);
+      }
+      if ((j == 3) && !listed[index]) {
+        categories << table[index];
+        listed[index] = true;
+      }
+      fields[j] = table[index];
+    }
+    m_words << new Word(fields[0], fields[2], fields[3], fields[1]);
+  }
+  kDebug() << "Loaded " << m_words.count() << "words";
+
+  if (lastModified)
+    *lastModified = binaryDate(header);
+
+  reset();
+  return true;
+}
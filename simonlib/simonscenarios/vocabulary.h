@@ -21,7 +21,10 @@
 #define SIMON_VOCABULARY_H_99CD4459A9A24B97A96FA38373D5FEA2
 #include <QString>
 #include <QList>
+#include <QSet>
+#include <QVector>
 #include <QAbstractItemModel>
+#include <QDateTime>
 
 #include "simonmodelmanagement_export.h"
 
@@ -42,10 +45,25 @@ class MODELMANAGEMENT_EXPORT Vocabulary : public QAbstractItemModel
     QModelIndex parent(const QModelIndex &index) const;
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
 
+    QSet<QString> m_stringPool;
+
+    //case folded words, separated by newlines, for substring searches
+    QList<Word*> m_searchWords;
+    QString m_searchText;
+    QVector<int> m_searchOffsets;
+    void updateSearchIndex();
+
   protected:
     QStringList categories;                        //category cache
     QList<Word*> m_words;
 
+    /**
+     * Returns a shared copy of the given string; Only used for categories
+     * as they repeat a lot in large vocabularies
+     */
+    QString intern(const QString& s);
+    void intern(Word *w);
+
     virtual QVariant data(const QModelIndex &index, int role) const;
     virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
 
@@ -101,6 +119,29 @@ class MODELMANAGEMENT_EXPORT Vocabulary : public QAbstractItemModel
 
     bool exportToFile(const QString& path, Vocabulary::ExportFormat format);
 
+    /**
+     * Stores the vocabulary in the binary vocabulary format: A string table
+     * of UTF-16 strings and a list of word records pointing into it.
+     *
+     * \param lastModified Stored in the file; Used to determine if the
+     *        binary file is still up to date
+     */
+    bool saveBinary(const QString& path, const QDateTime& lastModified=QDateTime());
+
+    /**
+     * Replaces the vocabulary with the contents of a binary vocabulary file.
+     *
+     * The file is read in one go and needs no parsing; Every distinct string
+     * of the table is copied once and shared by all words that use it.
+     */
+    bool loadBinary(const QString& path, QDateTime *lastModified=0);
+
+    /**
+     * \return The modification date stored in the given binary vocabulary or
+     *         an invalid date if the file is not a valid binary vocabulary
+     */
+    static QDateTime binaryLastModified(const QString& path);
+
     enum VocabularyType
     {
       ShadowVocabulary = 0,
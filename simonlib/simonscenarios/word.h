@@ -49,6 +49,15 @@ class MODELMANAGEMENT_EXPORT Word
     QString category;                             //!< Category of the word
     QString lexiconWord;
 
+    /**
+     * \return The upper case version of the word; Shares the data of the
+     *         given string if it is already upper case
+     */
+    static QString upper(const QString& word) {
+      QString upperWord = word.toUpper();
+      return (upperWord == word) ? word : upperWord;
+    }
+
   public:
 
     /**
@@ -69,7 +78,21 @@ class MODELMANAGEMENT_EXPORT Word
       : word(word_),
       pronunciation(pronunciation_),
       category(category_),
-    lexiconWord(word_.toUpper()) {
+    lexiconWord(upper(word_)) {
+    }
+
+    /**
+     * @brief Constructor
+     *
+     * Used when the upper case form of the word is already known
+     * (e.g. when loading a binary vocabulary).
+     */
+    Word(const QString& word_, const QString& pronunciation_, const QString& category_,
+         const QString& lexiconWord_)
+      : word(word_),
+      pronunciation(pronunciation_),
+      category(category_),
+    lexiconWord(lexiconWord_) {
     }
 
     /**
@@ -94,7 +117,7 @@ class MODELMANAGEMENT_EXPORT Word
      */
     void setWord(QString word) {
       this->word = word;
-      this->lexiconWord = word.toUpper();
+      this->lexiconWord = upper(word);
     }
 
     /**
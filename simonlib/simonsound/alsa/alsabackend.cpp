@@ -18,7 +18,10 @@
  */
 
 #include "alsabackend.h"
+#include "soundconfig.h"
 #include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
 #include <simonsound/soundbackendclient.h>
 #include <simonlogging/logger.h>
 #include <QThread>
@@ -31,9 +34,14 @@ static int set_hwparams(snd_pcm_t *handle,
                              snd_pcm_hw_params_t *params,
                              snd_pcm_access_t access,
                              int* bufferSize, int* periodSize, unsigned int* chunks,
-                             int channels, unsigned int& samplerate);
+                             int channels, unsigned int& samplerate, bool allowResampling,
+                             unsigned int bufferTime, unsigned int periodTime, bool setPeriods);
 static int xrun_recovery(snd_pcm_t *handle, int err);
 
+//legacy buffer layout
+static const unsigned int defaultBufferTime = 100000;
+static const unsigned int defaultPeriodTime = 20000;
+
 
 class ALSALoop : public QThread {
   protected:
@@ -65,6 +73,90 @@ class ALSACaptureLoop : public ALSALoop
       Logger::log(QString("Starting ALSA recording"));
       Logger::log(QString("EPIPE: %1; ESTRPIPE: %2; EBADFD: %3").arg(EPIPE).arg(ESTRPIPE).arg(EBADFD));
 
+      if (m_parent->m_realtime)
+        setRealtimePriority();
+
+      if (m_parent->m_mmap)
+        runMmap();
+      else
+        runRead();
+
+      Logger::log(QString("Stopped ALSA recording"));
+      m_parent->closeSoundSystem();
+      shouldRun = false;
+    }
+
+  private:
+    void setRealtimePriority()
+    {
+      struct sched_param param;
+      param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+      int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+      if (err)
+        Logger::log(QString("Could not switch to realtime priority: %1").arg(strerror(err)));
+    }
+
+    //restarts the device after an over run (capture needs an explicit start after prepare)
+    int recover(int err)
+    {
+      if (err == -EPIPE)
+        m_parent->m_xruns.ref();
+      err = xrun_recovery(m_parent->m_handle, err);
+      if ((err >= 0) && (snd_pcm_state(m_parent->m_handle) == SND_PCM_STATE_PREPARED))
+        err = snd_pcm_start(m_parent->m_handle);
+      return err;
+    }
+
+    /**
+     * Hands the samples to the client straight from the memory mapped device buffer,
+     * one period at a time.
+     */
+    void runMmap()
+    {
+      snd_pcm_t *handle = m_parent->m_handle;
+      int frameSize = m_parent->m_channels * sizeof(short);
+      snd_pcm_sframes_t periodSize = m_parent->m_periodSize;
+
+      int err = snd_pcm_start(handle);
+      while ((err >= 0) && shouldRun) {
+        snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+        if (avail < 0) {
+          err = recover(avail);
+          continue;
+        }
+        if (avail < periodSize) {
+          //the timeout lets us notice stop() on a stalled device
+          err = snd_pcm_wait(handle, 100);
+          if (err < 0)
+            err = recover(err);
+          continue;
+        }
+
+        const snd_pcm_channel_area_t *areas;
+        snd_pcm_uframes_t offset;
+        snd_pcm_uframes_t frames = avail;
+        err = snd_pcm_mmap_begin(handle, &areas, &offset, &frames);
+        if (err < 0) {
+          err = recover(err);
+          continue;
+        }
+
+        const char *data = (const char*) areas[0].addr + (areas[0].first + offset * areas[0].step) / 8;
+        m_parent->m_client->writeData(data, frames * frameSize);
+
+        snd_pcm_sframes_t committed = snd_pcm_mmap_commit(handle, offset, frames);
+        if ((committed < 0) || ((snd_pcm_uframes_t) committed != frames))
+          err = recover((committed < 0) ? committed : -EPIPE);
+      }
+
+      if (err < 0) {
+        Logger::log(QString("XRUN / SUSPEND recovery failed: %1").arg(snd_strerror(err)));
+        m_parent->errorRecoveryFailed();
+      }
+    }
+
+    void runRead()
+    {
       int err = 0;
       snd_pcm_state_t state;
       short* buffer = (short*) malloc(sizeof(short)*m_parent->m_bufferSize+1);
@@ -73,15 +165,18 @@ class ALSACaptureLoop : public ALSALoop
         err = 0;
         state = snd_pcm_state(m_parent->m_handle);
 
-        if (state == SND_PCM_STATE_XRUN)
+        if (state == SND_PCM_STATE_XRUN) {
+          m_parent->m_xruns.ref();
           err = xrun_recovery(m_parent->m_handle, -EPIPE);
-        else if (state == SND_PCM_STATE_SUSPENDED)
+        } else if (state == SND_PCM_STATE_SUSPENDED)
           err = xrun_recovery(m_parent->m_handle, -ESTRPIPE);
 
         snd_pcm_sframes_t readCount = 0;
         if (err >= 0) {
           readCount = snd_pcm_readi(m_parent->m_handle, buffer, m_parent->m_bufferSize/2);
           if (readCount < 0) {
+            if (readCount == -EPIPE)
+              m_parent->m_xruns.ref();
             xrun_recovery(m_parent->m_handle, readCount);
             Logger::log(QString("Read failed: %1").arg(snd_strerror(readCount)));
             readCount = 0;
@@ -96,10 +191,7 @@ class ALSACaptureLoop : public ALSALoop
       if (err < 0)
         m_parent->errorRecoveryFailed();
 
-      Logger::log(QString("Stopped ALSA recording"));
-      m_parent->closeSoundSystem();
       free(buffer);
-      shouldRun = false;
     }
 };
 
@@ -125,9 +217,10 @@ class ALSAPlaybackLoop : public ALSALoop
         err = 0;
         state = snd_pcm_state(m_parent->m_handle);
 
-        if (state == SND_PCM_STATE_XRUN)
+        if (state == SND_PCM_STATE_XRUN) {
+          m_parent->m_xruns.ref();
           err = xrun_recovery(m_parent->m_handle, -EPIPE);
-        else if (state == SND_PCM_STATE_SUSPENDED)
+        } else if (state == SND_PCM_STATE_SUSPENDED)
           err = xrun_recovery(m_parent->m_handle, -ESTRPIPE);
 
         if (err < 0) {
@@ -162,7 +255,11 @@ class ALSAPlaybackLoop : public ALSALoop
 ALSABackend::ALSABackend() : 
   m_handle(0),
   m_loop(0),
-  m_bufferSize(1024)
+  m_bufferSize(1024),
+  m_channels(1),
+  m_mmap(false),
+  m_realtime(false),
+  m_xruns(0)
 {
 }
 
@@ -171,6 +268,11 @@ int ALSABackend::bufferSize()
   return m_bufferSize;
 }
 
+int ALSABackend::xrunCount()
+{
+  return m_xruns;
+}
+
 QStringList ALSABackend::getAvailableInputDevices()
 {
   return getDevices(SimonSound::Input);
@@ -238,7 +340,8 @@ QStringList ALSABackend::getDevices(SimonSound::SoundDeviceType type)
   return devices;
 }
 
-snd_pcm_t* ALSABackend::openDevice(SimonSound::SoundDeviceType type, const QString& device, int channels, int samplerate)
+snd_pcm_t* ALSABackend::openDevice(SimonSound::SoundDeviceType type, const QString& device, int channels, int samplerate,
+                                   bool allowResampling)
 {
   // remove everything up to (
   QByteArray internalDeviceName = device.mid(device.lastIndexOf("(")+1).toAscii();
@@ -260,12 +363,28 @@ snd_pcm_t* ALSABackend::openDevice(SimonSound::SoundDeviceType type, const QStri
     handle = 0;
   } else {
     unsigned int srate = static_cast<unsigned int>(samplerate);
-    if (handle && (err = set_hwparams(handle, hwparams, SND_PCM_ACCESS_RW_INTERLEAVED,
+    bool lowLatency = (type == SimonSound::Input) && SoundConfiguration::lowLatencyCapture();
+    unsigned int bufferTime = lowLatency ? SoundConfiguration::captureBufferTime() * 1000 : defaultBufferTime;
+    unsigned int periodTime = lowLatency ? SoundConfiguration::capturePeriodTime() * 1000 : defaultPeriodTime;
+
+    m_mmap = lowLatency;
+    err = set_hwparams(handle, hwparams, lowLatency ? SND_PCM_ACCESS_MMAP_INTERLEAVED : SND_PCM_ACCESS_RW_INTERLEAVED,
+            &m_bufferSize, &m_periodSize, &m_chunks,
+            channels, srate, allowResampling, bufferTime, periodTime, !lowLatency);
+    if ((err < 0) && lowLatency) {
+      kWarning() << "Memory mapped capture not available; Falling back to reading";
+      m_mmap = false;
+      err = set_hwparams(handle, hwparams, SND_PCM_ACCESS_RW_INTERLEAVED,
             &m_bufferSize, &m_periodSize, &m_chunks,
-            channels, srate)) < 0) {
+            channels, srate, allowResampling, bufferTime, periodTime, false);
+    }
+    if (err < 0) {
       kWarning() << "Setting of hwparams failed: " << snd_strerror(err);
       snd_pcm_close(handle);
       handle = 0;
+    } else {
+      m_channels = channels;
+      m_realtime = lowLatency && SoundConfiguration::realtimeCapture();
     }
   }
 
@@ -287,6 +406,18 @@ bool ALSABackend::check(SimonSound::SoundDeviceType type, const QString& device,
   return false;
 }
 
+bool ALSABackend::checkNative(SimonSound::SoundDeviceType type, const QString& device, int channels, int samplerate)
+{
+  snd_pcm_t *handle = openDevice(type, device, channels, samplerate, false);
+
+  if (handle) {
+    snd_pcm_close(handle);
+    return true;
+  }
+
+  return false;
+}
+
 QString ALSABackend::defaultDevice(const QStringList& list)
 {
   foreach (const QString& dev, list)
@@ -349,6 +480,7 @@ bool ALSABackend::prepareRecording(const QString& device, int& channels, int& sa
     return false;
   }
 
+  m_xruns = 0;
   m_handle = openDevice(SimonSound::Input, device, channels, samplerate);
   m_loop = (m_loop) ? m_loop : new ALSACaptureLoop(this);
   emit stateChanged(SimonSound::PreparedState);
@@ -385,6 +517,7 @@ bool ALSABackend::preparePlayback(const QString& device, int& channels, int& sam
     return false;
   }
 
+  m_xruns = 0;
   m_handle = openDevice(SimonSound::Output, device, channels, samplerate);
   m_loop = new ALSAPlaybackLoop(this);
   emit stateChanged(SimonSound::PreparedState);
@@ -429,7 +562,8 @@ static int set_hwparams(snd_pcm_t *handle,
                              snd_pcm_hw_params_t *params,
                              snd_pcm_access_t access,
                              int* bufferSize, int* periodSize, unsigned int* chunks,
-                             int channels, unsigned int& samplerate)
+                             int channels, unsigned int& samplerate, bool allowResampling,
+                             unsigned int bufferTime, unsigned int periodTime, bool setPeriods)
 {
   unsigned int rrate;
   snd_pcm_uframes_t size;
@@ -442,7 +576,7 @@ static int set_hwparams(snd_pcm_t *handle,
     return err;
   }
   /* set hardware resampling */
-  err = snd_pcm_hw_params_set_rate_resample(handle, params, true); //TODO: yeah?!
+  err = snd_pcm_hw_params_set_rate_resample(handle, params, allowResampling);
   if (err < 0) {
     kWarning() << "Resampling setup failed for playback:" << snd_strerror(err);
     return err;
@@ -477,7 +611,7 @@ static int set_hwparams(snd_pcm_t *handle,
     return -EINVAL;
   }
   /* set the buffer time */
-  unsigned int buffer_time = 100000;
+  unsigned int buffer_time = bufferTime;
   err = snd_pcm_hw_params_set_buffer_time_near(handle, params, &buffer_time, &dir);
   if (err < 0) {
     kWarning() << "Unable to set buffer time %i for playback:" << buffer_time << snd_strerror(err);
@@ -491,7 +625,7 @@ static int set_hwparams(snd_pcm_t *handle,
   }
   *bufferSize = size;
   
-  unsigned int period_time = 20000;
+  unsigned int period_time = periodTime;
   /* set the period time */
   err = snd_pcm_hw_params_set_period_time_near(handle, params, &period_time, &dir);
   if (err < 0) {
@@ -499,11 +633,15 @@ static int set_hwparams(snd_pcm_t *handle,
     return err;
   }
 
-  unsigned int chunks_ = 8;
-  err = snd_pcm_hw_params_set_periods_near(handle, params, &chunks_, &dir);
-  if ( err < 0 ) {
-    kWarning() << "Unable to set periods: " << snd_strerror(err);
-    return err;
+  //low latency setups keep the requested period instead
+  unsigned int chunks_ = 0;
+  if (setPeriods) {
+    chunks_ = 8;
+    err = snd_pcm_hw_params_set_periods_near(handle, params, &chunks_, &dir);
+    if ( err < 0 ) {
+      kWarning() << "Unable to set periods: " << snd_strerror(err);
+      return err;
+    }
   }
   *chunks = chunks_;
 
@@ -25,6 +25,7 @@
 #include <alsa/asoundlib.h>
 #include <QStringList>
 #include <QMutex>
+#include <QAtomicInt>
 
 class ALSALoop;
 class ALSACaptureLoop;
@@ -44,10 +45,17 @@ class ALSABackend : public SoundBackend
     int m_bufferSize;
     int m_periodSize;
     unsigned int m_chunks;
+    int m_channels;
+
+    //low latency capture: memory mapped access and optionally realtime priority
+    bool m_mmap;
+    bool m_realtime;
+    QAtomicInt m_xruns;
+
     QStringList getDevices(SimonSound::SoundDeviceType type);
 
     snd_pcm_t* openDevice(SimonSound::SoundDeviceType type, 
-        const QString& device, int channels, int samplerate);
+        const QString& device, int channels, int samplerate, bool allowResampling=true);
     QString defaultDevice(const QStringList& list);
 
   protected:
@@ -62,6 +70,7 @@ class ALSABackend : public SoundBackend
     QStringList getAvailableInputDevices();
     QStringList getAvailableOutputDevices();
     bool check(SimonSound::SoundDeviceType type, const QString& device, int channels, int samplerate);
+    bool checkNative(SimonSound::SoundDeviceType type, const QString& device, int channels, int samplerate);
 
     QString getDefaultInputDevice();
     QString getDefaultOutputDevice();
@@ -75,6 +84,7 @@ class ALSABackend : public SoundBackend
     bool stopPlayback();
 
     int bufferSize();
+    int xrunCount();
 };
 
 #endif
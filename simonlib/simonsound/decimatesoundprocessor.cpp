@@ -0,0 +1,87 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "decimatesoundprocessor.h"
+#include <QtGlobal>
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+//taps per unit of the decimation factor
+static const int tapsPerFactor = 24;
+//cutoff relative to the new nyquist frequency; the transition band has to
+//end before it or whatever is just above it aliases
+static const double cutoff = 0.85;
+
+DecimateSoundProcessor::DecimateSoundProcessor(int channels, int factor) :
+  m_channels(channels), m_factor(factor)
+{
+  //low pass below the new nyquist frequency with a hamming window
+  int length = tapsPerFactor * factor + 1;
+  int center = length / 2;
+  float sum = 0;
+  m_taps.resize(length);
+  for (int i=0; i < length; ++i) {
+    double x = cutoff * (i - center) / factor;
+    double sinc = (i == center) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+    double window = 0.54 - 0.46 * cos(2.0 * M_PI * i / (length - 1));
+    m_taps[i] = (float) (sinc * window);
+    sum += m_taps[i];
+  }
+  for (int i=0; i < length; ++i)
+    m_taps[i] /= sum;
+
+  //the first output sample only sees silence before the stream
+  m_buffer.fill(0, (length - 1) * channels);
+}
+
+void DecimateSoundProcessor::process(QByteArray& data, qint64& currentTime)
+{
+  Q_UNUSED(currentTime);
+
+  int inputSamples = data.size() / sizeof(qint16);
+  int oldSize = m_buffer.size();
+  m_buffer.resize(oldSize + inputSamples);
+  memcpy(m_buffer.data() + oldSize, data.constData(), inputSamples * sizeof(qint16));
+
+  int length = m_taps.size();
+  int availableFrames = m_buffer.size() / m_channels;
+  int outputFrames = (availableFrames < length) ? 0 : (availableFrames - length) / m_factor + 1;
+
+  data.resize(outputFrames * m_channels * sizeof(qint16));
+  qint16 *out = reinterpret_cast<qint16*>(data.data());
+  const qint16 *in = m_buffer.constData();
+  const float *taps = m_taps.constData();
+
+  for (int frame=0; frame < outputFrames; ++frame) {
+    const qint16 *window = in + frame * m_factor * m_channels;
+    for (int channel=0; channel < m_channels; ++channel) {
+      float value = 0;
+      for (int i=0; i < length; ++i)
+        value += taps[i] * window[i * m_channels + channel];
+      *out++ = (qint16) qRound(qBound(-32768.0f, value, 32767.0f));
+    }
+  }
+
+  m_buffer.remove(0, outputFrames * m_factor * m_channels);
+}
@@ -0,0 +1,52 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef SIMON_DECIMATESOUNDPROCESSOR_H_2ACA7C343599422CB694906C681950BC
+#define SIMON_DECIMATESOUNDPROCESSOR_H_2ACA7C343599422CB694906C681950BC
+
+#include "soundprocessor.h"
+#include "simonsound_export.h"
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * \class DecimateSoundProcessor
+ * \brief Reduces the sample rate of 16 bit PCM by an integer factor
+ *
+ * A windowed sinc low pass is only evaluated for the samples that are
+ * kept, which is a lot cheaper than a general purpose resampler for
+ * ratios like 48 kHz to 16 kHz.
+ */
+class SIMONSOUND_EXPORT DecimateSoundProcessor : public SoundProcessor
+{
+  private:
+    int m_channels;
+    int m_factor;
+    QVector<float> m_taps;
+
+    //input frames not yet consumed, starting with the filter history
+    QVector<qint16> m_buffer;
+
+  public:
+    DecimateSoundProcessor(int channels, int factor);
+    void process(QByteArray& data, qint64& currentTime);
+};
+
+#endif
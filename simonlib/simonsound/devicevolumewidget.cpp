@@ -21,6 +21,7 @@
 #include "simonsound.h"
 #include "soundconfig.h"
 #include "nullrecorderclient.h"
+#include "soundserver.h"
 #include "ui_devicevolumewidget.h"
 #include <QDateTime>
 #include <KIcon>
@@ -31,12 +32,14 @@ DeviceVolumeWidget::DeviceVolumeWidget( const SimonSound::DeviceConfiguration& d
     ui(new Ui::DeviceVolumeWidgetUi()),
     rec(new NullRecorderClient(device, inputPriority, this)),
     m_deviceName(device.name()),
+    m_xruns(0),
     lastClip(0),
     lastStartedSample(0),
     lastCompletedSample(0)
 {
   ui->setupUi(this);
-  ui->lbDeviceName->setText(i18nc("%1 is the devices name", "Device: %1", m_deviceName.remove(QRegExp("\\(.*\\)"))));
+  m_deviceLabel = i18nc("%1 is the devices name", "Device: %1", QString(m_deviceName).remove(QRegExp("\\(.*\\)")));
+  ui->lbDeviceName->setText(m_deviceLabel);
   connect(rec, SIGNAL(level(qint64,float)), this, SLOT(deviceReportedLevel(qint64,float)));
   connect(rec, SIGNAL(clippingOccured()), this, SLOT(clipping()));
   connect(rec, SIGNAL(sampleStarted()), this, SLOT(started()));
@@ -76,6 +79,21 @@ void DeviceVolumeWidget::deviceReportedLevel(qint64 time, float level)
   }
 
   updateLabel();
+  updateXruns();
+}
+
+void DeviceVolumeWidget::updateXruns()
+{
+  int xruns = SoundServer::getInstance()->getInputXruns(m_deviceName);
+  if (xruns == m_xruns)
+    return;
+
+  m_xruns = xruns;
+  if (m_xruns)
+    ui->lbDeviceName->setText(i18ncp("%2 is the device label (\"Device: <name>\")", "%2 (%1 dropout)", "%2 (%1 dropouts)",
+                                     m_xruns, m_deviceLabel));
+  else
+    ui->lbDeviceName->setText(m_deviceLabel);
 }
 
 void DeviceVolumeWidget::completed()
@@ -153,6 +171,8 @@ void DeviceVolumeWidget::tooLow()
 void DeviceVolumeWidget::start()
 {
   listOfLevels.clear();
+  m_xruns = 0;
+  ui->lbDeviceName->setText(m_deviceLabel);
   if (!rec->start())
     KMessageBox::error(this, i18nc("%1 is device name", "Recording could not be started for device: %1.", m_deviceName));
 }
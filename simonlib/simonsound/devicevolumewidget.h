@@ -61,6 +61,8 @@ class SIMONSOUND_EXPORT DeviceVolumeWidget : public QWidget
     NullRecorderClient *rec;
     
     QString m_deviceName;
+    QString m_deviceLabel;
+    int m_xruns;
     
     qint32 lastClip;
     qint32 lastStartedSample;
@@ -86,6 +88,7 @@ class SIMONSOUND_EXPORT DeviceVolumeWidget : public QWidget
     void tooLow();
     
     void updateLabel();
+    void updateXruns();
 
 };
 #endif
@@ -0,0 +1,430 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "filebackend.h"
+#include <simonsound/soundbackendclient.h>
+#include <simonwav/wav.h>
+#include <simonwav/wavfilewriter.h>
+#include <QThread>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <KLocalizedString>
+#include <KDebug>
+
+//silence appended to the input so that the last utterance is closed properly
+static const int tailLength = 1000;
+//length of one capture period in ms
+static const int periodLength = 20;
+//periods the fast mode hands over before waiting for the client to catch
+//up; the input buffer drops everything beyond 20
+static const int maxPendingPeriods = 4;
+
+//configuration and progress, shared by all backend instances
+static QMutex configurationLock;
+static bool configurationRead = false;
+static bool enabled = false;
+static QStringList inputFiles;
+static FileBackend::Pacing pacing = FileBackend::RealTime;
+static QString outputFile;
+
+static QElapsedTimer captureClock;
+static qint64 deliveredLength = -1;
+static bool deliveredAll = false;
+
+//must be called with the configurationLock held
+static void readConfiguration()
+{
+  if (configurationRead)
+    return;
+  configurationRead = true;
+
+  QString files = QString::fromLocal8Bit(qgetenv("SIMON_SOUND_FILES"));
+  if (files.isEmpty())
+    return;
+  enabled = true;
+  inputFiles = files.split(';', QString::SkipEmptyParts);
+  pacing = qgetenv("SIMON_SOUND_FILES_FAST").isEmpty() ? FileBackend::RealTime : FileBackend::AsFastAsPossible;
+  outputFile = QString::fromLocal8Bit(qgetenv("SIMON_SOUND_OUTPUT"));
+}
+
+
+class FileLoop : public QThread {
+  protected:
+    FileBackend *m_parent;
+    volatile bool shouldRun;
+    bool realTime;
+    double bytesPerMs;
+
+    //sleeps until the given amount of audio (in bytes) is due
+    void pace(const QElapsedTimer& clock, qint64 position)
+    {
+      qint64 wait = qint64(position / bytesPerMs) - clock.elapsed();
+      if (realTime && (wait > 0))
+        msleep(wait);
+    }
+
+  public:
+    FileLoop(FileBackend *parent) : m_parent(parent),
+      shouldRun(true), realTime(true), bytesPerMs(1)
+    {}
+
+    void start() {
+      QMutexLocker l(&configurationLock);
+      shouldRun = true;
+      realTime = (pacing == FileBackend::RealTime);
+      bytesPerMs = m_parent->m_samplerate * m_parent->m_channels * sizeof(short) / 1000.0;
+      QThread::start();
+    }
+    void stop() {
+      shouldRun = false;
+    }
+};
+
+//Capture loop
+class FileCaptureLoop : public FileLoop
+{
+  public:
+    FileCaptureLoop(FileBackend *parent) : FileLoop(parent)
+    {}
+
+    void run()
+    {
+      const QByteArray& input = m_parent->m_input;
+      int chunkSize = m_parent->m_bufferSize;
+      QByteArray silence(chunkSize, '\0');
+      qint64 total = input.size() + qint64(tailLength * bytesPerMs);
+
+      QElapsedTimer clock;
+      {
+        QMutexLocker l(&configurationLock);
+        captureClock.start();
+        clock = captureClock;
+        deliveredLength = 0;
+        deliveredAll = false;
+      }
+
+      //a real device keeps delivering silence; the fast mode stops after the tail
+      qint64 delivered = 0;
+      while (shouldRun && (realTime || (delivered < total))) {
+        const char *data = silence.constData();
+        int length = chunkSize;
+        if (delivered < input.size()) {
+          data = input.constData() + delivered;
+          length = qMin(qint64(chunkSize), input.size() - delivered);
+        }
+
+        //a period is handed over once it has been "recorded" completely
+        pace(clock, delivered + length);
+        while (!realTime && shouldRun &&
+               (m_parent->m_client->pendingLength() >= maxPendingPeriods * chunkSize))
+          msleep(1);
+        m_parent->m_client->writeData(data, length);
+        delivered += length;
+
+        QMutexLocker l(&configurationLock);
+        deliveredLength = qint64(delivered / bytesPerMs);
+        deliveredAll = (delivered >= input.size());
+      }
+
+      while (shouldRun)
+        msleep(periodLength);
+    }
+};
+
+//Playback loop
+class FilePlaybackLoop : public FileLoop
+{
+  public:
+    FilePlaybackLoop(FileBackend *parent) : FileLoop(parent)
+    {}
+
+    void run()
+    {
+      QString path;
+      {
+        QMutexLocker l(&configurationLock);
+        path = outputFile;
+      }
+
+      WavFileWriter *output = 0;
+      if (!path.isEmpty()) {
+        output = new WavFileWriter(path, m_parent->m_channels, m_parent->m_samplerate);
+        if (!output->open()) {
+          kWarning() << "Could not open output file: " << path;
+          delete output;
+          output = 0;
+        }
+      }
+
+      int chunkSize = m_parent->m_bufferSize;
+      char *buffer = (char*) malloc(chunkSize);
+      QElapsedTimer clock;
+      clock.start();
+      qint64 played = 0;
+
+      while (shouldRun) {
+        qint64 read = m_parent->m_client->readData(buffer, chunkSize);
+        if (read == -1)
+          break;
+        if (output)
+          output->write(buffer, read);
+        played += read;
+        pace(clock, played);
+      }
+
+      free(buffer);
+      if (output) {
+        if (!output->finish())
+          kWarning() << "Failed to write output file: " << path;
+        delete output;
+      }
+      emit m_parent->stateChanged(SimonSound::IdleState);
+
+      shouldRun = false;
+    }
+};
+
+
+void FileBackend::enable(const QStringList& files, Pacing filePacing, const QString& output)
+{
+  QMutexLocker l(&configurationLock);
+  configurationRead = true;
+  enabled = true;
+  inputFiles = files;
+  pacing = filePacing;
+  outputFile = output;
+  deliveredLength = -1;
+  deliveredAll = false;
+}
+
+void FileBackend::disable()
+{
+  QMutexLocker l(&configurationLock);
+  configurationRead = true;
+  enabled = false;
+}
+
+bool FileBackend::isEnabled()
+{
+  QMutexLocker l(&configurationLock);
+  readConfiguration();
+  return enabled;
+}
+
+qint64 FileBackend::capturePosition()
+{
+  QMutexLocker l(&configurationLock);
+  return deliveredLength;
+}
+
+qint64 FileBackend::captureElapsed()
+{
+  QMutexLocker l(&configurationLock);
+  if (!captureClock.isValid())
+    return -1;
+  return captureClock.elapsed();
+}
+
+bool FileBackend::inputFinished()
+{
+  QMutexLocker l(&configurationLock);
+  return deliveredAll;
+}
+
+
+FileBackend::FileBackend() :
+  m_loop(0),
+  m_channels(1),
+  m_samplerate(16000),
+  m_bufferSize(640)
+{
+}
+
+int FileBackend::bufferSize()
+{
+  return m_bufferSize;
+}
+
+QStringList FileBackend::getAvailableInputDevices()
+{
+  return QStringList() << getDefaultInputDevice();
+}
+
+QStringList FileBackend::getAvailableOutputDevices()
+{
+  return QStringList() << getDefaultOutputDevice();
+}
+
+QString FileBackend::getDefaultInputDevice()
+{
+  return i18nc("Sound device replaced by audio files", "Audio files (file)");
+}
+
+QString FileBackend::getDefaultOutputDevice()
+{
+  return i18nc("Sound device replaced by an audio file", "Output file (file)");
+}
+
+bool FileBackend::check(SimonSound::SoundDeviceType type, const QString& device, int channels, int samplerate)
+{
+  Q_UNUSED(device);
+  if (type == SimonSound::Output)
+    return true;
+  return loadInput(channels, samplerate);
+}
+
+/**
+ * Reads all input files into memory; Wav files have to match the requested
+ * format, raw files are assumed to.
+ */
+bool FileBackend::loadInput(int channels, int samplerate)
+{
+  QStringList files;
+  {
+    QMutexLocker l(&configurationLock);
+    readConfiguration();
+    files = inputFiles;
+  }
+
+  m_input.clear();
+  foreach (const QString& path, files) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+      kWarning() << "Could not open input file: " << path;
+      return false;
+    }
+    if (path.endsWith(QLatin1String(".wav"), Qt::CaseInsensitive)) {
+      qint16 fileChannels;
+      qint32 fileSamplerate;
+      if (!WAV::parseHeader(&f, fileChannels, fileSamplerate) ||
+          (fileChannels != channels) || (fileSamplerate != samplerate)) {
+        kWarning() << "Input file does not match the requested format: " << path << channels << samplerate;
+        return false;
+      }
+      f.seek(44);
+    }
+    m_input += f.readAll();
+  }
+  //whole frames only
+  m_input.truncate(m_input.size() - m_input.size() % (channels * int(sizeof(short))));
+  return true;
+}
+
+bool FileBackend::stop()
+{
+  kDebug() << "Called stop()";
+  if (state() == SimonSound::IdleState)
+    return true;
+
+  if (m_loop) {
+    m_loop->stop();
+    m_loop->wait();
+    delete m_loop;
+    m_loop = 0;
+  }
+
+  emit stateChanged(SimonSound::IdleState);
+  return true;
+}
+
+///////////////////////////////////////
+// Recording  /////////////////////////
+///////////////////////////////////////
+
+bool FileBackend::prepareRecording(const QString& device, int& channels, int& samplerate)
+{
+  Q_UNUSED(device);
+  if (m_loop && m_loop->isRunning()) {
+    emit errorOccured(SimonSound::BackendBusy);
+    return false;
+  }
+
+  if (!loadInput(channels, samplerate)) {
+    emit errorOccured(SimonSound::OpenError);
+    return false;
+  }
+
+  m_channels = channels;
+  m_samplerate = samplerate;
+  m_bufferSize = samplerate * channels * sizeof(short) * periodLength / 1000;
+  delete m_loop;
+  m_loop = new FileCaptureLoop(this);
+  emit stateChanged(SimonSound::PreparedState);
+  return true;
+}
+
+bool FileBackend::startRecording(SoundBackendClient *client)
+{
+  m_client = client;
+  if (!m_loop) return false;
+
+  m_loop->start();
+  emit stateChanged(SimonSound::ActiveState);
+  return true;
+}
+
+bool FileBackend::stopRecording()
+{
+  return stop();
+}
+
+///////////////////////////////////////
+// Playback  //////////////////////////
+///////////////////////////////////////
+
+bool FileBackend::preparePlayback(const QString& device, int& channels, int& samplerate)
+{
+  Q_UNUSED(device);
+  if (m_loop && m_loop->isRunning()) {
+    emit errorOccured(SimonSound::BackendBusy);
+    return false;
+  }
+
+  m_channels = channels;
+  m_samplerate = samplerate;
+  m_bufferSize = samplerate * channels * sizeof(short) * periodLength / 1000;
+  delete m_loop;
+  m_loop = new FilePlaybackLoop(this);
+  emit stateChanged(SimonSound::PreparedState);
+  return true;
+}
+
+bool FileBackend::startPlayback(SoundBackendClient *client)
+{
+  m_client = client;
+  if (!m_loop) return false;
+
+  m_loop->start();
+  emit stateChanged(SimonSound::ActiveState);
+  return true;
+}
+
+bool FileBackend::stopPlayback()
+{
+  return stop();
+}
+
+FileBackend::~FileBackend()
+{
+  if (state() != SimonSound::IdleState)
+    stop();
+  delete m_loop;
+}
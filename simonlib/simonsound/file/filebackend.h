@@ -0,0 +1,112 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SIMON_FILEBACKEND_H_D763ABBB8C274172BE5CBA8A88AD603F
+#define SIMON_FILEBACKEND_H_D763ABBB8C274172BE5CBA8A88AD603F
+
+#include <simonsound/simonsound.h>
+#include <simonsound/soundbackend.h>
+#include <simonsound/simonsound_export.h>
+#include <QStringList>
+#include <QByteArray>
+
+class FileLoop;
+class FileCaptureLoop;
+class FilePlaybackLoop;
+
+/**
+ * \class FileBackend
+ * \brief Deterministic sound backend reading audio files instead of a device
+ *
+ * Recording plays the configured input files (16 bit wav or raw PCM in the
+ * requested format) into the capture path, either paced like a real device
+ * or as fast as the consumers can take it, followed by silence. Playback is
+ * written to the configured output file (or discarded).
+ *
+ * Replaces the platform backend for every sound device once enabled through
+ * enable() or the environment (SIMON_SOUND_FILES, a ';' separated list of
+ * input files; SIMON_SOUND_FILES_FAST; SIMON_SOUND_OUTPUT).
+ */
+class SIMONSOUND_EXPORT FileBackend : public SoundBackend
+{
+  friend class FileLoop;
+  friend class FileCaptureLoop;
+  friend class FilePlaybackLoop;
+
+  public:
+    enum Pacing {
+      RealTime,
+      AsFastAsPossible
+    };
+
+    static void enable(const QStringList& inputFiles, Pacing pacing=RealTime,
+                       const QString& outputFile=QString());
+    static void disable();
+    static bool isEnabled();
+
+    /**
+     * \return Milliseconds of input delivered to the capture path since the
+     *         last recording was started; -1 if none was started yet
+     */
+    static qint64 capturePosition();
+
+    /**
+     * \return Milliseconds of wall clock time since the last recording was
+     *         started; -1 if none was started yet
+     */
+    static qint64 captureElapsed();
+
+    /**
+     * \return True once all input files have been delivered to the capture path
+     */
+    static bool inputFinished();
+
+  private:
+    FileLoop *m_loop;
+    QByteArray m_input;
+    int m_channels;
+    int m_samplerate;
+    int m_bufferSize;
+
+    bool loadInput(int channels, int samplerate);
+    bool stop();
+
+  public:
+    FileBackend();
+    ~FileBackend();
+
+    QStringList getAvailableInputDevices();
+    QStringList getAvailableOutputDevices();
+    bool check(SimonSound::SoundDeviceType type, const QString& device, int channels, int samplerate);
+
+    QString getDefaultInputDevice();
+    QString getDefaultOutputDevice();
+
+    bool prepareRecording(const QString& device, int& channels, int& samplerate);
+    bool startRecording(SoundBackendClient *client);
+    bool stopRecording();
+
+    bool preparePlayback(const QString& device, int& channels, int& samplerate);
+    bool startPlayback(SoundBackendClient *client);
+    bool stopPlayback();
+
+    int bufferSize();
+};
+
+#endif
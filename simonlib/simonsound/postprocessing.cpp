@@ -18,15 +18,41 @@
  */
 
 #include "postprocessing.h"
-#include <QProcess>
+#include "postprocessingchain.h"
 #include <QFile>
 #include <KProgressDialog>
 #include <QCoreApplication>
 #include <QObject>
+#include <QtConcurrentMap>
 #include <KLocalizedString>
+#include <KDebug>
 #include "soundconfig.h"
 
-PostProcessing::PostProcessing(QObject *parent) : QObject(parent)
+struct PostProcessingJob
+{
+  QString in;
+  QString out;
+  bool success;
+  QString error;
+};
+
+class PostProcessingJobRunner
+{
+  public:
+    PostProcessingJobRunner(PostProcessing *owner, PostProcessingChain *chain, bool deleteIn) :
+      m_owner(owner), m_chain(chain), m_deleteIn(deleteIn) {}
+
+    void operator()(PostProcessingJob& job) { m_owner->runJob(m_chain, job, m_deleteIn); }
+
+  private:
+    PostProcessing *m_owner;
+    PostProcessingChain *m_chain;
+    bool m_deleteIn;
+};
+
+PostProcessing::PostProcessing(QObject *parent) : QObject(parent),
+  m_canceled(0),
+  m_done(0)
 {
 }
 
@@ -49,37 +75,22 @@ bool PostProcessing::process(const QString& in, const QString& out, bool deleteI
     return false;
   }
 
-  QStringList filters = SoundConfiguration::processingFilters();
-  QString filter;
+  PostProcessingChain chain;
+  if (!chain.parse(SoundConfiguration::processingFilters())) {
+    emit error(chain.lastError());
+    return false;
+  }
   if (!silent) {
-    progDialog->progressBar()->setMaximum(filter.count()+1);
+    progDialog->progressBar()->setMaximum(1);
     QCoreApplication::processEvents();
   }
-  for (int j=0; j < filters.count(); j++) {
-    QString execStr = filters.at(j);
-    execStr.replace("%1", in);
-    execStr.replace("%2", out);
-    // 		execStr.replace("\%3", QString::number(CoreConfiguration::modelSampleRate()));
-    // 		execStr.replace("\%4", QString::number(CoreConfiguration::modelChannels()));
-    int ret = QProcess::execute(execStr);
-    if (ret) {
-      //something went wrong
-      emit error(i18nc("%1 is input file name, %2 is output file name, %3 is the return value and %4 is the executed command string",
-                       "Could not process \"%1\" to \"%2\". Please check the command:\n\"%4\". (Return value: %3)", in, out, ret, execStr));
-      return 0;
-    }
-    if (!silent) {
-      progDialog->progressBar()->setValue(j+1);
-      QCoreApplication::processEvents();
-    }
-  }
 
-  if (!QFile::exists(out)) {                      //if there are no filters or they do not copy it to the output
-    if (!QFile::copy(in, out)) {
-      emit error(i18n("Could not copy %1 to %2. Please check if you have all the needed permissions.", in, out));
-      return false;
-    }
+  QString errorMessage;
+  if (!chain.apply(in, out, errorMessage)) {
+    emit error(errorMessage);
+    return false;
   }
+  kDebug() << "Post-processing timing:\n" << chain.timingReport();
 
   if (deleteIn) {
     if (!QFile::remove(in)) {
@@ -98,6 +109,61 @@ bool PostProcessing::process(const QString& in, const QString& out, bool deleteI
 }
 
 
+void PostProcessing::runJob(PostProcessingChain *chain, PostProcessingJob& job, bool deleteIn)
+{
+  if (m_canceled) {
+    job.success = false;
+    return;
+  }
+
+  job.success = chain->apply(job.in, job.out, job.error);
+  if (job.success && deleteIn && !QFile::remove(job.in))
+    kWarning() << "Could not remove " << job.in;
+
+  emit batchProgress(m_done.fetchAndAddOrdered(1) + 1);
+}
+
+bool PostProcessing::processBatch(const QStringList& in, const QStringList& out, bool deleteIn)
+{
+  Q_ASSERT(in.count() == out.count());
+
+  PostProcessingChain chain;
+  if (!chain.parse(SoundConfiguration::processingFilters())) {
+    emit error(chain.lastError());
+    return false;
+  }
+
+  QList<PostProcessingJob> jobs;
+  for (int i=0; i < in.count(); i++) {
+    PostProcessingJob job;
+    job.in = in[i];
+    job.out = out[i];
+    job.success = false;
+    jobs << job;
+  }
+
+  m_canceled = 0;
+  m_done = 0;
+  QtConcurrent::map(jobs, PostProcessingJobRunner(this, &chain, deleteIn)).waitForFinished();
+  kDebug() << "Post-processed" << (int) m_done << "files:\n" << chain.timingReport();
+
+  if (m_canceled)
+    return false;
+
+  foreach (const PostProcessingJob& job, jobs) {
+    if (!job.success) {
+      emit error(job.error);
+      return false;
+    }
+  }
+  return true;
+}
+
+void PostProcessing::cancel()
+{
+  m_canceled = 1;
+}
+
 PostProcessing::~PostProcessing()
 {
 }
@@ -22,8 +22,12 @@
 
 #include "simonsound_export.h"
 #include <QObject>
+#include <QStringList>
+#include <QAtomicInt>
 
-class QString;
+class PostProcessingChain;
+class PostProcessingJobRunner;
+struct PostProcessingJob;
 
 /**
  \class PostProcessing
@@ -31,6 +35,9 @@ class QString;
  \version 0.1
  \date 19.2.2008
  \brief Applies the specified postprocessing stack to the given filenames
+
+ The stack is read from SoundConfiguration::processingFilters(); See
+ PostProcessingChain for the supported filters.
 */
 class SIMONSOUND_EXPORT PostProcessing : public QObject
 {
@@ -38,11 +45,31 @@ class SIMONSOUND_EXPORT PostProcessing : public QObject
     signals:
   void error(const QString& error);
 
+  /**
+   * \brief Emitted from the worker threads whenever a file of the batch is done
+   */
+  void batchProgress(int done);
+
+  private:
+    friend class PostProcessingJobRunner;
+    QAtomicInt m_canceled;
+    QAtomicInt m_done;
+
+    void runJob(PostProcessingChain *chain, PostProcessingJob& job, bool deleteIn);
+
   public:
     PostProcessing(QObject *parent=0);
 
     bool process(const QString& in, const QString& out, bool deleteIn=false, bool silent=false);
 
+    /**
+     * \brief Processes in[i] to out[i] for all given files on the global thread pool
+     *
+     * Blocks until all files are done or the batch was canceled.
+     */
+    bool processBatch(const QStringList& in, const QStringList& out, bool deleteIn=false);
+    void cancel();
+
     ~PostProcessing();
 
 };
@@ -0,0 +1,468 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "postprocessingchain.h"
+#include "decimatesoundprocessor.h"
+#include <simonwav/wavfilewriter.h>
+
+#include <QFile>
+#include <QProcess>
+#include <QElapsedTimer>
+#include <QtEndian>
+#include <QMutexLocker>
+#include <KLocalizedString>
+#include <math.h>
+
+#ifdef HAVE_LIBSAMPLERATE_H
+extern "C"
+{
+#include <samplerate.h>
+}
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static const QLatin1String builtinPrefix("simon:");
+
+struct PostProcessingAudio
+{
+  QVector<float> samples;                         //interleaved, -1 to 1
+  int channels;
+  int sampleRate;
+
+  int frames() const { return samples.count() / channels; }
+};
+
+class PostProcessingStage
+{
+  public:
+    explicit PostProcessingStage(const QString& description) : m_description(description) {}
+    virtual ~PostProcessingStage() {}
+
+    QString description() const { return m_description; }
+    virtual bool isExternal() const { return false; }
+    virtual bool process(PostProcessingAudio& audio, QString& error) const = 0;
+
+  private:
+    QString m_description;
+};
+
+class ExternalStage : public PostProcessingStage
+{
+  public:
+    explicit ExternalStage(const QString& command) : PostProcessingStage(command) {}
+
+    bool isExternal() const { return true; }
+    bool process(PostProcessingAudio& audio, QString& error) const {
+      Q_UNUSED(audio);
+      Q_UNUSED(error);
+      return false;
+    }
+
+    bool run(const QString& in, const QString& out, QString& error) const {
+      QString execStr = description();
+      execStr.replace("%1", in);
+      execStr.replace("%2", out);
+      int ret = QProcess::execute(execStr);
+      if (ret) {
+        error = i18nc("%1 is input file name, %2 is output file name, %3 is the return value and %4 is the executed command string",
+                      "Could not process \"%1\" to \"%2\". Please check the command:\n\"%4\". (Return value: %3)", in, out, ret, execStr);
+        return false;
+      }
+      return true;
+    }
+};
+
+class NormalizeStage : public PostProcessingStage
+{
+  public:
+    NormalizeStage(const QString& description, double peak) : PostProcessingStage(description),
+      m_peak(pow(10.0, peak / 20.0)) {}
+
+    bool process(PostProcessingAudio& audio, QString& error) const {
+      Q_UNUSED(error);
+      float peak = 0;
+      foreach (float sample, audio.samples)
+        peak = qMax(peak, qAbs(sample));
+      if (peak == 0)
+        return true;
+
+      float gain = m_peak / peak;
+      float *samples = audio.samples.data();
+      for (int i=0; i < audio.samples.count(); ++i)
+        samples[i] *= gain;
+      return true;
+    }
+
+  private:
+    float m_peak;
+};
+
+class DcRemoveStage : public PostProcessingStage
+{
+  public:
+    explicit DcRemoveStage(const QString& description) : PostProcessingStage(description) {}
+
+    bool process(PostProcessingAudio& audio, QString& error) const {
+      Q_UNUSED(error);
+      int frames = audio.frames();
+      if (!frames)
+        return true;
+
+      float *samples = audio.samples.data();
+      for (int channel=0; channel < audio.channels; ++channel) {
+        double sum = 0;
+        for (int i=channel; i < audio.samples.count(); i += audio.channels)
+          sum += samples[i];
+        float mean = sum / frames;
+        for (int i=channel; i < audio.samples.count(); i += audio.channels)
+          samples[i] -= mean;
+      }
+      return true;
+    }
+};
+
+/**
+ * Second order butterworth high pass (bilinear transform)
+ */
+class HighPassStage : public PostProcessingStage
+{
+  public:
+    HighPassStage(const QString& description, double cutoff) : PostProcessingStage(description),
+      m_cutoff(cutoff) {}
+
+    bool process(PostProcessingAudio& audio, QString& error) const {
+      if (m_cutoff >= audio.sampleRate / 2.0) {
+        error = i18n("The high pass cutoff of %1 Hz is above the nyquist frequency of the sample.", m_cutoff);
+        return false;
+      }
+
+      double w = 2.0 * M_PI * m_cutoff / audio.sampleRate;
+      double alpha = sin(w) / sqrt(2.0);              //q = 1/sqrt(2)
+      double a0 = 1.0 + alpha;
+      double b0 = (1.0 + cos(w)) / 2.0 / a0;
+      double b1 = -(1.0 + cos(w)) / a0;
+      double b2 = b0;
+      double a1 = -2.0 * cos(w) / a0;
+      double a2 = (1.0 - alpha) / a0;
+
+      float *samples = audio.samples.data();
+      for (int channel=0; channel < audio.channels; ++channel) {
+        double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+        for (int i=channel; i < audio.samples.count(); i += audio.channels) {
+          double x = samples[i];
+          double y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+          x2 = x1;
+          x1 = x;
+          y2 = y1;
+          y1 = y;
+          samples[i] = (float) y;
+        }
+      }
+      return true;
+    }
+
+  private:
+    double m_cutoff;
+};
+
+/**
+ * Silences every 10 ms frame whose level (over all channels) is below the
+ * threshold
+ */
+class GateStage : public PostProcessingStage
+{
+  public:
+    GateStage(const QString& description, double threshold) : PostProcessingStage(description),
+      m_threshold(pow(10.0, threshold / 20.0)) {}
+
+    bool process(PostProcessingAudio& audio, QString& error) const {
+      Q_UNUSED(error);
+      int frameLength = qMax(1, audio.sampleRate / 100) * audio.channels;
+      float *samples = audio.samples.data();
+      for (int start=0; start < audio.samples.count(); start += frameLength) {
+        int end = qMin(start + frameLength, audio.samples.count());
+        double sum = 0;
+        for (int i=start; i < end; ++i)
+          sum += samples[i] * samples[i];
+        if (sqrt(sum / (end - start)) < m_threshold)
+          for (int i=start; i < end; ++i)
+            samples[i] = 0;
+      }
+      return true;
+    }
+
+  private:
+    double m_threshold;
+};
+
+class ResampleStage : public PostProcessingStage
+{
+  public:
+    ResampleStage(const QString& description, int sampleRate) : PostProcessingStage(description),
+      m_sampleRate(sampleRate) {}
+
+    bool process(PostProcessingAudio& audio, QString& error) const {
+      if (audio.sampleRate == m_sampleRate)
+        return true;
+
+#ifdef HAVE_LIBSAMPLERATE_H
+      double ratio = (double) m_sampleRate / audio.sampleRate;
+      QVector<float> resampled(((int) ceil(audio.frames() * ratio) + 1) * audio.channels);
+
+      SRC_DATA data;
+      data.data_in = audio.samples.constData();
+      data.data_out = resampled.data();
+      data.input_frames = audio.frames();
+      data.output_frames = resampled.count() / audio.channels;
+      data.src_ratio = ratio;
+      int ret = src_simple(&data, SRC_SINC_MEDIUM_QUALITY, audio.channels);
+      if (ret) {
+        error = i18n("Could not resample: %1", QString::fromLocal8Bit(src_strerror(ret)));
+        return false;
+      }
+      resampled.resize(data.output_frames_gen * audio.channels);
+      audio.samples = resampled;
+#else
+      if ((m_sampleRate > audio.sampleRate) || (audio.sampleRate % m_sampleRate)) {
+        error = i18n("Resampling from %1 Hz to %2 Hz needs libsamplerate.", audio.sampleRate, m_sampleRate);
+        return false;
+      }
+
+      QByteArray data(audio.samples.count() * sizeof(qint16), 0);
+      qint16 *pcm = reinterpret_cast<qint16*>(data.data());
+      for (int i=0; i < audio.samples.count(); ++i)
+        pcm[i] = (qint16) qRound(qBound(-1.0f, audio.samples[i], 1.0f) * 32767.0f);
+
+      DecimateSoundProcessor decimator(audio.channels, audio.sampleRate / m_sampleRate);
+      qint64 time = 0;
+      decimator.process(data, time);
+
+      pcm = reinterpret_cast<qint16*>(data.data());
+      audio.samples.resize(data.size() / sizeof(qint16));
+      for (int i=0; i < audio.samples.count(); ++i)
+        audio.samples[i] = pcm[i] / 32768.0f;
+#endif
+      audio.sampleRate = m_sampleRate;
+      return true;
+    }
+
+  private:
+    int m_sampleRate;
+};
+
+
+static bool readWav(const QString& path, PostProcessingAudio& audio, QString& error)
+{
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly)) {
+    error = i18n("Could not open %1.", path);
+    return false;
+  }
+  QByteArray wav = f.readAll();
+  const uchar *data = reinterpret_cast<const uchar*>(wav.constData());
+
+  if ((wav.size() < 12) || !wav.startsWith("RIFF") || (wav.mid(8, 4) != "WAVE")) {
+    error = i18n("%1 is not a WAV file. Add a command converting it before the built in filters.", path);
+    return false;
+  }
+
+  bool format = false;
+  int offset = 12;
+  while (offset + 8 <= wav.size()) {
+    QByteArray id = wav.mid(offset, 4);
+    int length = (int) qMin<quint32>(qFromLittleEndian<quint32>(data + offset + 4), wav.size() - offset - 8);
+    const uchar *chunk = data + offset + 8;
+
+    if ((id == "fmt ") && (length >= 16)) {
+      quint16 tag = qFromLittleEndian<quint16>(chunk);
+      audio.channels = qFromLittleEndian<quint16>(chunk + 2);
+      audio.sampleRate = (int) qFromLittleEndian<quint32>(chunk + 4);
+      quint16 bits = qFromLittleEndian<quint16>(chunk + 14);
+      if ((tag != 1) || (bits != 16) || !audio.channels || !audio.sampleRate) {
+        error = i18n("%1 is not a 16 bit PCM WAV file.", path);
+        return false;
+      }
+      format = true;
+    } else if ((id == "data") && format) {
+      int count = length / sizeof(qint16);
+      audio.samples.resize(count - count % audio.channels);
+      for (int i=0; i < audio.samples.count(); ++i)
+        audio.samples[i] = ((qint16) qFromLittleEndian<quint16>(chunk + i * 2)) / 32768.0f;
+      return true;
+    }
+    offset += 8 + length + (length % 2);
+  }
+
+  error = i18n("%1 does not contain any samples.", path);
+  return false;
+}
+
+static bool writeWav(const QString& path, const PostProcessingAudio& audio, QString& error)
+{
+  QByteArray data(audio.samples.count() * sizeof(qint16), 0);
+  qint16 *pcm = reinterpret_cast<qint16*>(data.data());
+  for (int i=0; i < audio.samples.count(); ++i)
+    pcm[i] = (qint16) qRound(qBound(-1.0f, audio.samples[i], 1.0f) * 32767.0f);
+
+  WavFileWriter writer(path, audio.channels, audio.sampleRate);
+  if (!writer.open() || (writer.write(data) != data.size()) || !writer.finish()) {
+    error = i18n("Could not write %1.", path);
+    return false;
+  }
+  return true;
+}
+
+
+PostProcessingChain::PostProcessingChain() : m_runs(0)
+{
+}
+
+void PostProcessingChain::clear()
+{
+  qDeleteAll(m_stages);
+  m_stages.clear();
+  m_nsecs.clear();
+  m_runs = 0;
+}
+
+bool PostProcessingChain::parse(const QStringList& filters)
+{
+  clear();
+
+  foreach (const QString& filter, filters) {
+    QString description = filter.trimmed();
+    if (description.isEmpty())
+      continue;
+
+    if (!description.startsWith(builtinPrefix)) {
+      m_stages << new ExternalStage(description);
+      continue;
+    }
+
+    QStringList arguments = description.mid(QString(builtinPrefix).length()).split(' ', QString::SkipEmptyParts);
+    QString name = arguments.isEmpty() ? QString() : arguments.takeFirst();
+    bool ok = true;
+    double value = 0;
+    if (!arguments.isEmpty())
+      value = arguments.first().toDouble(&ok);
+
+    PostProcessingStage *stage = 0;
+    if (ok && (arguments.count() <= 1)) {
+      if (name == "normalize")
+        stage = new NormalizeStage(description, arguments.isEmpty() ? -1.0 : value);
+      else if ((name == "dcremove") && arguments.isEmpty())
+        stage = new DcRemoveStage(description);
+      else if ((name == "highpass") && (arguments.isEmpty() || (value > 0)))
+        stage = new HighPassStage(description, arguments.isEmpty() ? 80.0 : value);
+      else if (name == "gate")
+        stage = new GateStage(description, arguments.isEmpty() ? -50.0 : value);
+      else if ((name == "resample") && (value > 0))
+        stage = new ResampleStage(description, qRound(value));
+    }
+
+    if (!stage) {
+      m_lastError = i18n("Invalid post-processing filter: \"%1\"", description);
+      clear();
+      return false;
+    }
+    m_stages << stage;
+  }
+
+  m_nsecs.fill(0, m_stages.count());
+  return true;
+}
+
+bool PostProcessingChain::apply(const QString& in, const QString& out, QString& error)
+{
+  PostProcessingAudio audio;
+  bool decoded = false;
+  QString current = in;
+  QStringList temporaryFiles;
+  QVector<qint64> nsecs(m_stages.count(), 0);
+
+  bool success = true;
+  for (int i=0; success && (i < m_stages.count()); ++i) {
+    QElapsedTimer timer;
+    timer.start();
+
+    PostProcessingStage *stage = m_stages[i];
+    if (stage->isExternal()) {
+      if (decoded) {
+        current = out+'.'+QString::number(i)+".in.wav";
+        temporaryFiles << current;
+        success = writeWav(current, audio, error);
+        decoded = false;
+      }
+      QString target = out+'.'+QString::number(i)+".wav";
+      temporaryFiles << target;
+      success = success && static_cast<ExternalStage*>(stage)->run(current, target, error);
+      //commands that do not write an output file leave the samples untouched
+      if (QFile::exists(target))
+        current = target;
+    } else {
+      if (!decoded)
+        success = decoded = readWav(current, audio, error);
+      success = success && stage->process(audio, error);
+    }
+
+    nsecs[i] = timer.nsecsElapsed();
+  }
+
+  if (success) {
+    if (QFile::exists(out) && !QFile::remove(out)) {
+      error = i18n("Could not overwrite %1.\n\nPlease check if you have the needed permissons.", out);
+      success = false;
+    } else if (decoded) {
+      success = writeWav(out, audio, error);
+    } else if ((current == in) ? !QFile::copy(in, out) : !QFile::rename(current, out)) {
+      error = i18n("Could not copy %1 to %2. Please check if you have all the needed permissions.", current, out);
+      success = false;
+    }
+  }
+
+  foreach (const QString& temporary, temporaryFiles)
+    QFile::remove(temporary);
+
+  QMutexLocker lock(&m_timingLock);
+  for (int i=0; i < nsecs.count(); ++i)
+    m_nsecs[i] += nsecs[i];
+  ++m_runs;
+
+  return success;
+}
+
+QString PostProcessingChain::timingReport() const
+{
+  QMutexLocker lock(&m_timingLock);
+  QStringList report;
+  for (int i=0; i < m_stages.count(); ++i)
+    report << QString("%1: %2 ms (%3 ms per file)").arg(m_stages[i]->description())
+                .arg(m_nsecs[i] / 1000000.0, 0, 'f', 1)
+                .arg(m_runs ? m_nsecs[i] / 1000000.0 / m_runs : 0.0, 0, 'f', 2);
+  return report.join("\n");
+}
+
+PostProcessingChain::~PostProcessingChain()
+{
+  clear();
+}
@@ -0,0 +1,84 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef SIMON_POSTPROCESSINGCHAIN_H_6BE67CD9A9CB478DA7F4BA00FDEB56F0
+#define SIMON_POSTPROCESSINGCHAIN_H_6BE67CD9A9CB478DA7F4BA00FDEB56F0
+
+#include "simonsound_export.h"
+#include <QList>
+#include <QVector>
+#include <QStringList>
+#include <QMutex>
+
+class PostProcessingStage;
+
+/**
+ * \class PostProcessingChain
+ * \brief The configured post-processing filters, ready to be applied to files
+ *
+ * Every entry of the filter list is either an external command (with %1
+ * and %2 standing for the input and output file) or one of the built in
+ * filters:
+ *
+ *  - simon:normalize [peak in dBFS, default -1]
+ *  - simon:dcremove
+ *  - simon:highpass [cutoff in Hz, default 80]
+ *  - simon:gate [threshold in dBFS, default -50]
+ *  - simon:resample <sample rate>
+ *
+ * Built in filters work on the samples in memory (16 bit PCM WAV files
+ * only); files are only written before external commands and at the end
+ * of the chain. External commands read the output of the previous stage.
+ *
+ * The chain does not change after parse(), so apply() may be called from
+ * several threads at once.
+ */
+class SIMONSOUND_EXPORT PostProcessingChain
+{
+  public:
+    PostProcessingChain();
+    ~PostProcessingChain();
+
+    bool parse(const QStringList& filters);
+    bool isEmpty() const { return m_stages.isEmpty(); }
+
+    bool apply(const QString& in, const QString& out, QString& error);
+
+    /**
+     * Time spent in every stage since the last parse().
+     */
+    QString timingReport() const;
+
+    QString lastError() const { return m_lastError; }
+
+  private:
+    Q_DISABLE_COPY(PostProcessingChain)
+
+    QList<PostProcessingStage*> m_stages;
+    QString m_lastError;
+
+    mutable QMutex m_timingLock;
+    QVector<qint64> m_nsecs;
+    int m_runs;
+
+    void clear();
+};
+
+#endif
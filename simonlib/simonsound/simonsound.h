@@ -92,6 +92,8 @@ namespace SimonSound
       int sampleRate() const { return m_sampleRate; }
       bool resample() const { return m_resample; }
       int resampleSampleRate() const { return m_resampleRate; }
+      //rate of the audio handed to the clients
+      int targetSampleRate() const { return m_resample ? m_resampleRate : m_sampleRate; }
       QString conditions() const { return m_conditions; }
 
       void setChannels(int channels) { m_channels = channels; }
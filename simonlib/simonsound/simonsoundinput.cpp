@@ -39,12 +39,22 @@ int SimonSoundInput::bufferSize()
   return m_input->bufferSize();
 }
 
+int SimonSoundInput::xrunCount()
+{
+  return m_input->xrunCount();
+}
+
 qint64 SimonSoundInput::writeData(const char *toWrite, qint64 len)
 {
   m_buffer->write(toWrite, len);
   return len;
 }
 
+qint64 SimonSoundInput::pendingLength()
+{
+  return m_buffer ? m_buffer->length() : 0;
+}
+
 void SimonSoundInput::processData(const QByteArray& data)
 {
   QMutexLocker l(&m_lock);
@@ -54,6 +54,7 @@ class SimonSoundInput : public QObject, public SoundBackendClient
 
   protected:
     qint64 writeData(const char *toWrite, qint64 len);
+    qint64 pendingLength();
 
   private slots:
     void slotInputStateChanged(SimonSound::State state);
@@ -75,6 +76,7 @@ class SimonSoundInput : public QObject, public SoundBackendClient
     bool isActive() { return (m_activeInputClients.count() > 0); }
 
     int bufferSize();
+    int xrunCount();
     void processData(const QByteArray& data);
 
     void suspend(SoundInputClient*);
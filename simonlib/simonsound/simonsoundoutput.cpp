@@ -32,8 +32,8 @@
 #include <QFile>
 
 SimonSoundOutput::SimonSoundOutput(QObject *parent) : QObject(parent),
-popWhenBufferEmpty(false),
 m_output(SoundBackend::createObject()),
+m_clientLock(QMutex::Recursive),
 m_activeOutputClient(0),
 m_buffer(new SoundOutputBuffer(this))
 {
@@ -48,10 +48,13 @@ qint64 SimonSoundOutput::readData(char *toRead, qint64 maxLen)
 {
   qint64 read = m_buffer->read(toRead, maxLen);
 
-  if (m_activeOutputClient)
-    m_activeOutputClient->advanceStreamTimeByBytes(read);
+  QMutexLocker l(&m_clientLock);
+  SoundOutputClient *playing = m_drainingClients.isEmpty() ? m_activeOutputClient : m_drainingClients.first().first;
+  if (playing)
+    playing->advanceStreamTimeByBytes(read);
   else  {
-    if (m_suspendedOutputClients.isEmpty()) {
+    if (!haveSomethingToPlay()) {
+      l.unlock();
       stopPlayback();
       return -1;
     }
@@ -63,30 +66,69 @@ qint64 SimonSoundOutput::readData(char *toRead, qint64 maxLen)
 /**
  * Read data from output client to buffer
  */
-QByteArray SimonSoundOutput::requestData(qint64 maxLen)
+QByteArray SimonSoundOutput::requestData(qint64 maxLen, qint64 position)
 {
+  QMutexLocker l(&m_clientLock);
   if (!m_activeOutputClient) {
     kDebug() << "No current output client\n";
     return QByteArray();
   }
 
+  QByteArray output;
   char* toRead = (char*) malloc(maxLen+1);
-  qint64 read = m_activeOutputClient->read(toRead, maxLen);
-  if (read <= 0) {
-    popWhenBufferEmpty = true;
-  } else popWhenBufferEmpty = false;
+  while (m_activeOutputClient && (output.size() < maxLen)) {
+    qint64 read = m_activeOutputClient->read(toRead, maxLen - output.size());
+    if (read > 0) {
+      //a streaming client can deliver again before it was played out
+      removeDraining(m_activeOutputClient);
+      output.append(toRead, read);
+      continue;
+    }
 
-  QByteArray output = QByteArray().append(toRead, read);
+    if (!isDraining(m_activeOutputClient))
+      m_drainingClients << qMakePair(m_activeOutputClient, position + output.size());
+    //no gap between two clients: fill up the rest with the next one
+    if (m_suspendedOutputClients.isEmpty())
+      break;
+    m_activeOutputClient = m_suspendedOutputClients.takeFirst();
+  }
   free(toRead);
   return output;
 }
 
+/**
+ * Finishes the clients whose data was played completely
+ */
 void SimonSoundOutput::popClient()
 {
-  if (!popWhenBufferEmpty || !m_activeOutputClient) return;
+  qint64 played = m_buffer->playedLength();
+  QList<SoundOutputClient*> finished;
+  {
+    QMutexLocker l(&m_clientLock);
+    for (int i = 0; i < m_drainingClients.count(); ++i)
+      if (m_drainingClients[i].second <= played)
+        finished << m_drainingClients[i].first;
+  }
+
+  foreach (SoundOutputClient *client, finished)
+    SoundServer::getInstance()->deRegisterOutputClient(client);
+}
+
+bool SimonSoundOutput::isDraining(SoundOutputClient* client)
+{
+  QMutexLocker l(&m_clientLock);
+  for (int i = 0; i < m_drainingClients.count(); ++i)
+    if (m_drainingClients[i].first == client)
+      return true;
+  return false;
+}
 
-  popWhenBufferEmpty = false;
-  SoundServer::getInstance()->deRegisterOutputClient(m_activeOutputClient);
+void SimonSoundOutput::removeDraining(SoundOutputClient* client)
+{
+  QMutexLocker l(&m_clientLock);
+  for (int i = 0; i < m_drainingClients.count(); ++i)
+    if (m_drainingClients[i].first == client)
+      m_drainingClients.removeAt(i--);
 }
 
 int SimonSoundOutput::bufferSize()
@@ -99,6 +141,21 @@ qint64 SimonSoundOutput::bufferTime()
   return SoundServer::getInstance()->byteSizeToLength(bufferSize(), m_device);
 }
 
+qint64 SimonSoundOutput::playedLength()
+{
+  return m_buffer->playedLength();
+}
+
+int SimonSoundOutput::underruns()
+{
+  return m_buffer->underruns();
+}
+
+qint64 SimonSoundOutput::underrunLength()
+{
+  return m_buffer->underrunLength();
+}
+
 qint64 SimonSoundOutput::writeData(const char *toWrite, qint64 len)
 {
   Q_UNUSED(toWrite);
@@ -113,13 +170,18 @@ bool SimonSoundOutput::registerOutputClient(SoundOutputClient* client)
 
   bool newOut = false;
 
-  if (m_activeOutputClient != 0)
-    m_suspendedOutputClients.insert(0,m_activeOutputClient);
-  else
+  QMutexLocker l(&m_clientLock);
+  if (m_activeOutputClient != 0) {
+    //a client that already ran out just finishes playing what's buffered
+    if (!isDraining(m_activeOutputClient))
+      m_suspendedOutputClients.insert(0,m_activeOutputClient);
+  } else if (m_drainingClients.isEmpty())
     //can only happen if this is a new output
     newOut = true;
 
   m_activeOutputClient = client;
+  l.unlock();
+  m_buffer->clientsChanged();
 
   if (newOut) //start playback
     return m_output->startPlayback(this);
@@ -132,12 +194,16 @@ bool SimonSoundOutput::deRegisterOutputClient(SoundOutputClient* client)
 {
   kWarning() << "Deregister output client";
 
+  QMutexLocker l(&m_clientLock);
+  removeDraining(client);
   if (client != m_activeOutputClient)
     //wasn't active anyways
     m_suspendedOutputClients.removeAll(client);
   else {
     m_activeOutputClient = 0;
   }
+  l.unlock();
+
   if (!haveSomethingToPlay())
     stopPlayback();
 
@@ -171,6 +237,7 @@ SoundClient::SoundClientPriority SimonSoundOutput::getHighestPriority()
 {
   SoundClient::SoundClientPriority priority = SoundClient::Background;
 
+  QMutexLocker l(&m_clientLock);
   if (m_activeOutputClient)
     priority = m_activeOutputClient->priority();
 
@@ -184,6 +251,7 @@ bool SimonSoundOutput::activate(SoundClient::SoundClientPriority priority)
 {
   kDebug() << "Activating priority: " << priority;
 
+  QMutexLocker l(&m_clientLock);
   if (m_activeOutputClient &&
     (m_activeOutputClient->priority() == priority))
     return true;
@@ -193,6 +261,8 @@ bool SimonSoundOutput::activate(SoundClient::SoundClientPriority priority)
     if (priority == client->priority()) {
       m_activeOutputClient = client;
       m_suspendedOutputClients.removeAll(client);
+      l.unlock();
+      m_buffer->clientsChanged();
       return true;
     }
   }
@@ -237,7 +307,9 @@ void SimonSoundOutput::slotOutputStateChanged(SimonSound::State state)
 
 bool SimonSoundOutput::haveSomethingToPlay()
 {
-  return ((m_activeOutputClient != 0) || !m_suspendedOutputClients.isEmpty());
+  QMutexLocker l(&m_clientLock);
+  return ((m_activeOutputClient != 0) || !m_suspendedOutputClients.isEmpty() ||
+          !m_drainingClients.isEmpty());
 }
 
 bool SimonSoundOutput::stopPlayback()
@@ -23,16 +23,18 @@
 #include <simonsound/simonsound.h>
 #include <simonsound/soundclient.h>
 #include <simonsound/soundbackendclient.h>
+#include "simonsound_export.h"
 #include <QList>
 #include <QObject>
 #include <QMutex>
+#include <QPair>
 #include <qvarlengtharray.h>
 
 class SoundOutputClient;
 class SoundOutputBuffer;
 class SoundBackend;
 
-class SimonSoundOutput : public QObject, public SoundBackendClient
+class SIMONSOUND_EXPORT SimonSoundOutput : public QObject, public SoundBackendClient
 {
   Q_OBJECT
 
@@ -42,15 +44,21 @@ class SimonSoundOutput : public QObject, public SoundBackendClient
     void outputStateChanged(SimonSound::State state);
 
   private:
-    bool popWhenBufferEmpty;
     SoundBackend *m_output;
+
+    QMutex m_clientLock;
     SoundOutputClient* m_activeOutputClient;
     QList<SoundOutputClient*> m_suspendedOutputClients;
+    //clients that delivered all their data, with the position (in bytes
+    //written to the buffer) where it ends; they finish once that is played
+    QList< QPair<SoundOutputClient*, qint64> > m_drainingClients;
 
     SimonSound::DeviceConfiguration m_device;
     SoundOutputBuffer *m_buffer;
 
     bool haveSomethingToPlay();
+    bool isDraining(SoundOutputClient* client);
+    void removeDraining(SoundOutputClient* client);
 
   protected:
     qint64 readData(char *toRead, qint64 maxLen);
@@ -75,7 +83,27 @@ class SimonSoundOutput : public QObject, public SoundBackendClient
 
     int bufferSize();
     qint64 bufferTime();
-    QByteArray requestData(qint64 maxSize);
+
+    /**
+     * \return Bytes of client data handed to the backend so far
+     */
+    qint64 playedLength();
+    /**
+     * \return Backend reads that had to be filled up with silence while
+     *         the clients still had data; Silence between two clients that
+     *         ran out is not counted
+     */
+    int underruns();
+    /**
+     * \return Bytes of silence played because of underruns()
+     */
+    qint64 underrunLength();
+    /**
+     * Reads the next data for the buffer; Continues with the next client as
+     * soon as the active one runs out.
+     * \param position Bytes written to the buffer so far
+     */
+    QByteArray requestData(qint64 maxSize, qint64 position);
 
     void startClientUpdate();
     void completeClientUpdate();
@@ -18,6 +18,7 @@
  */
 
 #include "soundbackend.h"
+#include "file/filebackend.h"
 
 #ifdef Q_OS_LINUX
 #include "alsa/alsabackend.h"
@@ -37,6 +38,9 @@ SoundBackend::SoundBackend() : m_client(0), m_error(SimonSound::NoError), m_stat
 
 SoundBackend* SoundBackend::createObject()
 {
+  if (FileBackend::isEnabled())
+    return new FileBackend();
+
 #ifdef Q_OS_LINUX
   return new ALSABackend();
 #endif
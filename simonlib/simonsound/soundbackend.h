@@ -58,12 +58,17 @@ class SoundBackend : public QObject
     virtual QStringList getAvailableInputDevices()=0;
     virtual QStringList getAvailableOutputDevices()=0;
     virtual bool check(SimonSound::SoundDeviceType type, const QString& device, int channels, int samplerate)=0;
+    //true if the device runs at the given rate without any conversion
+    virtual bool checkNative(SimonSound::SoundDeviceType type, const QString& device, int channels, int samplerate)
+      { return check(type, device, channels, samplerate); }
 
     virtual QString getDefaultInputDevice()=0;
     virtual QString getDefaultOutputDevice()=0;
 
     //general information
     virtual int bufferSize()=0;
+    //over- / underruns since the device was prepared
+    virtual int xrunCount() { return 0; }
 
     SimonSound::Error error();
     SimonSound::State state();
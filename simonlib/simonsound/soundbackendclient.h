@@ -27,6 +27,8 @@ class SoundBackendClient
   public:
     virtual qint64 readData(char *, qint64) { return -1; }
     virtual qint64 writeData(const char *, qint64) { return -1; }
+    //written input that wasn't processed yet (in bytes)
+    virtual qint64 pendingLength() { return 0; }
     virtual ~SoundBackendClient() {};
 };
 
@@ -41,6 +41,12 @@ void SoundInputBuffer::write(const char *toWrite, qint64 len)
   m_bufferAllocLock.unlock();
 }
 
+qint64 SoundInputBuffer::length()
+{
+  QMutexLocker l(&m_bufferAllocLock);
+  return m_bufferLength;
+}
+
 void SoundInputBuffer::run()
 {
   while (m_shouldBeRunning)
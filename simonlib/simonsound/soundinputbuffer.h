@@ -34,6 +34,7 @@ public:
   SoundInputBuffer(SimonSoundInput* input);
   ~SoundInputBuffer();
   void write(const char *toWrite, qint64 len);
+  qint64 length();
   void stop();
   virtual void run();
 };
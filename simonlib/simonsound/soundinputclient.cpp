@@ -19,25 +19,56 @@
 
 #include "soundinputclient.h"
 #include "soundprocessor.h"
+#include "decimatesoundprocessor.h"
 
 #ifdef HAVE_LIBSAMPLERATE_H
 #include "resamplesoundprocessor.h"
 #endif
 
 #include <QByteArray>
+#include <KDebug>
 
 /**
  * \brief Constructor
  */
 SoundInputClient::SoundInputClient(const SimonSound::DeviceConfiguration& deviceConfiguration, SoundClient::SoundClientPriority priority) :
-SoundClient(deviceConfiguration, priority)
+SoundClient(deviceConfiguration, priority),
+m_converter(0)
 {
+}
+
+
+void SoundInputClient::setupConversion()
+{
+  delete m_converter;
+  m_converter = 0;
+
+  int channels = m_deviceConfiguration.channels();
+  int captureRate = m_deviceConfiguration.sampleRate();
+  int targetRate = m_deviceConfiguration.targetSampleRate();
+
+  if (captureRate == targetRate) {
+    kDebug() << "Input pipeline for" << m_deviceConfiguration.name() << ":" << captureRate << "Hz, no conversion";
+    return;
+  }
+
+  if (captureRate % targetRate == 0) {
+    m_converter = new DecimateSoundProcessor(channels, captureRate / targetRate);
+    kDebug() << "Input pipeline for" << m_deviceConfiguration.name() << ":" << captureRate << "Hz, decimated by"
+             << (captureRate / targetRate) << "to" << targetRate << "Hz";
+    return;
+  }
+
 #ifdef HAVE_LIBSAMPLERATE_H
-  if (deviceConfiguration.resample())
-      registerSoundProcessor(new ResampleSoundProcessor(
-                deviceConfiguration.channels(),
-                deviceConfiguration.sampleRate(),
-                deviceConfiguration.resampleSampleRate()));
+  m_converter = new ResampleSoundProcessor(channels, captureRate, targetRate);
+  kDebug() << "Input pipeline for" << m_deviceConfiguration.name() << ":" << captureRate << "Hz, resampled to"
+           << targetRate << "Hz";
+#else
+  kWarning() << "Input pipeline for" << m_deviceConfiguration.name() << ":" << captureRate
+             << "Hz, can't convert to" << targetRate << "Hz without libsamplerate";
+  m_deviceConfiguration = SimonSound::DeviceConfiguration(m_deviceConfiguration.name(), channels, captureRate,
+                                                          false, captureRate, m_deviceConfiguration.conditions(),
+                                                          m_deviceConfiguration.defaultSampleGroup());
 #endif
 }
 
@@ -45,6 +76,10 @@ SoundClient(deviceConfiguration, priority)
 void SoundInputClient::process(const QByteArray& data, qint64 currentTime)
 {
   QByteArray processedData = data;
+  if (m_converter) {
+    m_converter->process(processedData, currentTime);
+    if (processedData.isEmpty()) return;
+  }
   foreach (SoundProcessor* p, processors) {
     p->process(processedData, currentTime);
     if (processedData.isEmpty()) return;
@@ -59,5 +94,6 @@ void SoundInputClient::process(const QByteArray& data, qint64 currentTime)
  */
 SoundInputClient::~SoundInputClient()
 {
+  delete m_converter;
   qDeleteAll(processors);
 }
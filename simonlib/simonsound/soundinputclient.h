@@ -26,11 +26,20 @@
 
 class SIMONSOUND_EXPORT SoundInputClient : public SoundClient
 {
+  private:
+    SoundProcessor *m_converter;
 
   public:
     explicit SoundInputClient(const SimonSound::DeviceConfiguration& deviceConfiguration, SoundClientPriority options=Normal);
     virtual ~SoundInputClient();
 
+    /**
+     * Converts from the rate the device records at (sampleRate()) to the
+     * rate of the clients processors (targetSampleRate()); Called by the
+     * SoundServer once the capture parameters are known.
+     */
+    void setupConversion();
+
     void process(const QByteArray& data, qint64 currentTime);
     virtual void processPrivate(const QByteArray& data, qint64 currentTime)=0;
 };
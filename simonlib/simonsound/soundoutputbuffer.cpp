@@ -20,75 +20,157 @@
 #include "simonsoundoutput.h"
 #include <QMutexLocker>
 #include <KDebug>
-#include <QTimer>
+
+//how many periods the ring has to hold before the backend gets the first one
+static const int prefillPeriods = 2;
+//longest time the first read waits for the ring to be primed (ms)
+static const int prefillTimeout = 500;
 
 SoundOutputBuffer::SoundOutputBuffer(SimonSoundOutput* output): SoundBuffer(output),
-  m_output(output)
+  m_output(output),
+  m_ring((char*) malloc(BUFFER_MAX_LENGTH)),
+  m_capacity(BUFFER_MAX_LENGTH),
+  m_readPos(0),
+  m_fill(0),
+  m_readTotal(0),
+  m_writtenTotal(0),
+  m_prefilled(false),
+  m_starved(false),
+  m_underruns(0),
+  m_underrunLength(0)
 {
 }
 
 qint64 SoundOutputBuffer::read(char* data, qint64 maxLen)
 {
   QMutexLocker l(&bufferLock);
-  if (m_buffer.isEmpty()) {
-#ifndef Q_OS_WIN32
-    m_output->popClient();
-#else
-    QTimer::singleShot(2000, m_output, SLOT("popClient"));
-#endif
+  if (!m_prefilled) {
+    int prefill = qMin(prefillPeriods * m_output->bufferSize(), m_capacity);
+    while (m_shouldBeRunning && !m_starved && (m_fill < prefill))
+      if (!m_readerCondition.wait(&bufferLock, prefillTimeout))
+        break;
+    m_prefilled = true;
+  }
+
+  int length = qMin((qint64) m_fill, maxLen);
+  int firstPart = qMin(length, m_capacity - m_readPos);
+  memcpy(data, m_ring + m_readPos, firstPart);
+  memcpy(data + firstPart, m_ring, length - firstPart);
+  m_readPos = (m_readPos + length) % m_capacity;
+  m_fill -= length;
+  m_readTotal += length;
+
+  if (length < maxLen) {
     //return zeros to keep stream going while we sort out the next client or
     //stop the stream
-    memset(data, 0, maxLen);
-    return maxLen;
+    memset(data + length, 0, maxLen - length);
+    if (!m_starved) {
+      ++m_underruns;
+      m_underrunLength += maxLen - length;
+    }
   }
+  m_feederCondition.wakeOne();
+  l.unlock();
+
+#ifndef Q_OS_WIN32
+  m_output->popClient();
+#else
+  QMetaObject::invokeMethod(m_output, "popClient", Qt::QueuedConnection);
+#endif
+  return maxLen;
+}
 
-  int realCpy = qMin((int) maxLen, m_buffer.size());
-  memcpy(data, m_buffer.constData(), realCpy);
-  m_buffer.remove(0,realCpy);
-  
-  return realCpy;
+/**
+ * Appends the data to the ring; The caller made sure that it fits.
+ * Has to be called with the bufferLock held.
+ */
+void SoundOutputBuffer::write(const QByteArray& data)
+{
+  int writePos = (m_readPos + m_fill) % m_capacity;
+  int firstPart = qMin(data.size(), m_capacity - writePos);
+  memcpy(m_ring + writePos, data.constData(), firstPart);
+  memcpy(m_ring, data.constData() + firstPart, data.size() - firstPart);
+  m_fill += data.size();
+  m_writtenTotal += data.size();
 }
 
 void SoundOutputBuffer::run()
 {
-  bufferLock.lock();
-  m_buffer.fill(0, qMin(2*8192, BUFFER_MAX_LENGTH));
-  bufferLock.unlock();
+  QMutexLocker l(&bufferLock);
   while (m_shouldBeRunning)
   {
-    int bufferSize = m_output->bufferSize();
-    int bufferLength = m_output->bufferTime();
-    if (m_buffer.size() < BUFFER_MAX_LENGTH) {
-      //kDebug() << "Buffer not full";
-      //fill buffer
-      QByteArray currentData = m_output->requestData(bufferSize);
-      //kDebug() << "Got " << currentData.size() << " bytes of data from clients";
-
-      //if currentData is empty, just keep going as read() will pop the
-      //output client as soon as the buffer is empty to make sure that
-      //the current active output is really the current active output
-      bufferLock.lock();
-      m_buffer += currentData;
-      bufferLock.unlock();
+    int bufferSize = qMin(m_output->bufferSize(), m_capacity);
+
+    //sleep until the backend made room for another period
+    if (m_capacity - m_fill < bufferSize) {
+      m_feederCondition.wait(&bufferLock);
+      continue;
+    }
+
+    //written data only moves from here; so the position is stable while unlocked
+    qint64 position = m_writtenTotal;
+    l.unlock();
+    QByteArray currentData = m_output->requestData(bufferSize, position);
+    l.relock();
+
+    m_starved = currentData.isEmpty();
+    if (m_starved) {
+      //don't hold up the first read for data that isn't coming; Either
+      //the backend reads again or a new client wakes us up
+      m_readerCondition.wakeAll();
+      m_feederCondition.wait(&bufferLock);
+      continue;
     }
 
-    //either half of the buffered time or 50 milliseconds, whichever is shorter
-    int sleepDuration = qMin((bufferLength*100)/2, 50000);
-    //kDebug() << "Sleeping: " << sleepDuration << " microseconds; Buffersize: " << bufferSize << bufferLength;
-    usleep(sleepDuration);
+    write(currentData);
+    m_readerCondition.wakeAll();
   }
-  kWarning() << "Left run loop";
-  
+  kWarning() << "Left run loop; Underruns: " << m_underruns << "(" << m_underrunLength << "bytes)";
+  l.unlock();
+
   deleteLater();
 }
 
+void SoundOutputBuffer::clientsChanged()
+{
+  QMutexLocker l(&bufferLock);
+  if (m_starved) {
+    //prime the ring again before playing the new client
+    m_starved = false;
+    m_prefilled = false;
+  }
+  m_feederCondition.wakeAll();
+}
+
+qint64 SoundOutputBuffer::playedLength()
+{
+  QMutexLocker l(&bufferLock);
+  return m_readTotal;
+}
+
+int SoundOutputBuffer::underruns()
+{
+  QMutexLocker l(&bufferLock);
+  return m_underruns;
+}
+
+qint64 SoundOutputBuffer::underrunLength()
+{
+  QMutexLocker l(&bufferLock);
+  return m_underrunLength;
+}
+
 void SoundOutputBuffer::stop()
 {
   kWarning() << "Setting should be running to false...";
 
+  QMutexLocker l(&bufferLock);
   m_shouldBeRunning = false;
+  m_feederCondition.wakeAll();
+  m_readerCondition.wakeAll();
 }
 
 SoundOutputBuffer::~SoundOutputBuffer()
 {
+  free(m_ring);
 }
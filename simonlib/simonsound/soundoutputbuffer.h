@@ -20,19 +20,62 @@
 #define SOUNDOUTPUTBUFFER_H
 #include "soundbuffer.h"
 #include <QMutex>
+#include <QWaitCondition>
 
 class SimonSoundOutput;
+
+/**
+ * Ring buffer between the output clients and the sound backend.
+ *
+ * The buffer thread refills the ring whenever the backend consumed a
+ * period; When there is nothing to play it sleeps until a client is
+ * registered.
+ */
 class SoundOutputBuffer : public SoundBuffer
 {
 private:
   SimonSoundOutput *m_output;
-  QByteArray m_buffer;
+  char *m_ring;
+  int m_capacity;
+  int m_readPos;
+  int m_fill;
+  qint64 m_readTotal;
+  qint64 m_writtenTotal;
+
+  //the first read waits for the ring to be primed
+  bool m_prefilled;
+  //the clients had nothing to give on the last refill
+  bool m_starved;
+
+  //backend reads that could not be satisfied although data was on the way
+  int m_underruns;
+  qint64 m_underrunLength;
+
   QMutex bufferLock;
-  
+  QWaitCondition m_feederCondition;
+  QWaitCondition m_readerCondition;
+
+  void write(const QByteArray& data);
+
 public:
   SoundOutputBuffer(SimonSoundOutput* output);
   ~SoundOutputBuffer();
   qint64 read(char* data, qint64 maxLen);
+
+  /**
+   * Wakes the buffer thread to refill from the (new) active client.
+   */
+  void clientsChanged();
+
+  /**
+   * \return Bytes of client data handed to the backend since the output
+   *         was started (without the silence filling underruns)
+   */
+  qint64 playedLength();
+
+  int underruns();
+  qint64 underrunLength();
+
   void stop();
   virtual void run();
 };
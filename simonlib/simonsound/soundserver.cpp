@@ -86,9 +86,9 @@ bool SoundServer::registerInputClient(SoundInputClient* client)
   bool succ = true;
   bool isNew = false;
 
-  SimonSound::DeviceConfiguration clientRequestedSoundConfiguration = client->deviceConfiguration();
+  SimonSound::DeviceConfiguration clientRequestedSoundConfiguration = negotiateInput(client->deviceConfiguration());
                                                   //recording not currently running
-  if (!inputs.contains(client->deviceConfiguration())) {
+  if (!inputs.contains(clientRequestedSoundConfiguration)) {
     SimonSoundInput *soundInput = new SimonSoundInput(0);
     connect(soundInput, SIGNAL(error(QString)), this, SIGNAL(error(QString)));
     //then start recording
@@ -103,14 +103,15 @@ bool SoundServer::registerInputClient(SoundInputClient* client)
         inputs.insert(clientRequestedSoundConfiguration, soundInput);
         isNew = true;
       }
-
-      if (! (client->deviceConfiguration() == clientRequestedSoundConfiguration) )
-                                                  // found something supported that is very close
-        client->setDeviceConfiguration(clientRequestedSoundConfiguration);
     }
   }
 
   if (succ) {
+    if (! (client->deviceConfiguration() == clientRequestedSoundConfiguration) )
+                                                  // found something supported that is very close
+      client->setDeviceConfiguration(clientRequestedSoundConfiguration);
+    client->setupConversion();
+
     SimonSoundInput *input = inputs.value(clientRequestedSoundConfiguration);
     input->registerInputClient(client);
     if (isNew)
@@ -122,6 +123,32 @@ bool SoundServer::registerInputClient(SoundInputClient* client)
 }
 
 
+/**
+ * \brief Picks the capture parameters that need the least conversion
+ *
+ * If the device can record at the rate the client wants (or already does
+ * so for another client), no conversion is needed at all; Otherwise the
+ * configured capture rate is used and converted by the client.
+ */
+SimonSound::DeviceConfiguration SoundServer::negotiateInput(const SimonSound::DeviceConfiguration& device)
+{
+  int targetSampleRate = device.targetSampleRate();
+  if (targetSampleRate == device.sampleRate())
+    return device;
+
+  SimonSound::DeviceConfiguration native(device.name(), device.channels(), targetSampleRate,
+                                         device.resample(), targetSampleRate, device.conditions(),
+                                         device.defaultSampleGroup());
+  if (inputs.contains(native))
+    return native;
+  if (inputs.contains(device))
+    return device;
+  if (backend->checkNative(SimonSound::Input, device.name(), device.channels(), targetSampleRate))
+    return native;
+  return device;
+}
+
+
 void SoundServer::closeOutput(SimonSoundOutput* output)
 {
   QMutexLocker l(&outputRegistrationLock);
@@ -310,6 +337,23 @@ int SoundServer::getInputDeviceCount()
 }
 
 
+/**
+ * \brief Returns the number of dropouts of all running recordings on the given device
+ */
+int SoundServer::getInputXruns(const QString& device)
+{
+  QMutexLocker l(&inputRegistrationLock);
+  int xruns = 0;
+  QHashIterator<SimonSound::DeviceConfiguration, SimonSoundInput*> i(inputs);
+  while (i.hasNext()) {
+    i.next();
+    if (i.key().name() == device)
+      xruns += i.value()->xrunCount();
+  }
+  return xruns;
+}
+
+
 int SoundServer::getOutputDeviceCount()
 {
   return SoundConfiguration::soundOutputDevices().count();
@@ -54,6 +54,7 @@ class SIMONSOUND_EXPORT SoundServer : public QObject
     static QList<SimonSound::DeviceConfiguration> getInputDevices(SimonSound::SoundDeviceUses uses);
     static QList<SimonSound::DeviceConfiguration> getOutputDevices(SimonSound::SoundDeviceUses uses);
 
+    SimonSound::DeviceConfiguration negotiateInput(const SimonSound::DeviceConfiguration& device);
     void applyInputPriorities();
     void applyOutputPriorities();
 
@@ -80,6 +81,7 @@ class SIMONSOUND_EXPORT SoundServer : public QObject
     bool reinitializeDevices();
 
     int getInputDeviceCount();
+    int getInputXruns(const QString& device);
     int getOutputDeviceCount();
 
     bool check(SimonSound::SoundDeviceType type, const QString& device, int channels, int samplerate);
@@ -0,0 +1,107 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "decimatetest.h"
+#include "../decimatesoundprocessor.h"
+
+#include <QByteArray>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static QByteArray sine(int frequency, int sampleRate, int frames)
+{
+  QByteArray data(frames * sizeof(qint16), 0);
+  qint16 *samples = reinterpret_cast<qint16*>(data.data());
+  for (int i=0; i < frames; ++i)
+    samples[i] = (qint16) qRound(10000.0 * sin(2.0 * M_PI * frequency * i / sampleRate));
+  return data;
+}
+
+static double rms(const QByteArray& data, int skip)
+{
+  const qint16 *samples = reinterpret_cast<const qint16*>(data.constData());
+  int count = data.size() / sizeof(qint16);
+  double sum = 0;
+  for (int i=skip; i < count; ++i)
+    sum += (double) samples[i] * samples[i];
+  return sqrt(sum / (count - skip));
+}
+
+void DecimateTest::testLength()
+{
+  DecimateSoundProcessor decimator(1, 3);
+  QByteArray data = sine(1000, 48000, 4800);
+  qint64 time = 0;
+  decimator.process(data, time);
+  QCOMPARE(data.size(), 1600 * (int) sizeof(qint16));
+}
+
+void DecimateTest::testPassBand()
+{
+  DecimateSoundProcessor decimator(1, 3);
+  QByteArray data = sine(1000, 48000, 4800);
+  qint64 time = 0;
+  decimator.process(data, time);
+  //amplitude 10000 -> rms 7071
+  QVERIFY(qAbs(rms(data, 50) - 7071) < 350);
+}
+
+void DecimateTest::testStopBand()
+{
+  QFETCH(int, frequency);
+  DecimateSoundProcessor decimator(1, 3);
+  QByteArray data = sine(frequency, 48000, 4800);
+  qint64 time = 0;
+  decimator.process(data, time);
+  QVERIFY(rms(data, 50) < 100);
+}
+
+void DecimateTest::testStopBand_data()
+{
+  QTest::addColumn<int>("frequency");
+  //would alias to 4 kHz without the low pass
+  QTest::newRow("12 kHz") << 12000;
+  //just above the new nyquist frequency; would alias to 7.6 kHz
+  QTest::newRow("8.4 kHz") << 8400;
+}
+
+void DecimateTest::testChunked()
+{
+  QByteArray input = sine(440, 44100, 44100 / 10);
+  qint64 time = 0;
+
+  DecimateSoundProcessor whole(1, 2);
+  QByteArray expected = input;
+  whole.process(expected, time);
+
+  DecimateSoundProcessor chunked(1, 2);
+  QByteArray result;
+  for (int offset = 0; offset < input.size(); offset += 202) {
+    QByteArray chunk = input.mid(offset, 202);
+    chunked.process(chunk, time);
+    result += chunk;
+  }
+  QCOMPARE(result, expected);
+}
+
+QTEST_MAIN(DecimateTest)
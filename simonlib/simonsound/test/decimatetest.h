@@ -0,0 +1,39 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef SIMON_DECIMATETEST_H_C0C6EDD12C6C4D488AE73C69F086E191
+#define SIMON_DECIMATETEST_H_C0C6EDD12C6C4D488AE73C69F086E191
+
+#include <QTest>
+
+class DecimateTest: public QObject
+{
+  Q_OBJECT
+  public:
+    virtual ~DecimateTest() {}
+  private slots:
+    void testLength();
+    void testPassBand();
+    void testStopBand();
+    void testStopBand_data();
+    void testChunked();
+};
+
+#endif
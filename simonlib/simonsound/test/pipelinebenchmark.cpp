@@ -0,0 +1,162 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "pipelinebenchmark.h"
+#include "../vadsoundprocessor.h"
+#include "../soundserver.h"
+#include "../simonsound.h"
+
+#include <QFileInfo>
+#include <QDebug>
+#include <ctime>
+
+/**
+ * Measures the capture pipeline (backend, sound server, voice activity
+ * detection) with reproducible input from the FileBackend.
+ *
+ * Reports the delay between the end of an utterance and its detection
+ * (percentiles over all utterances) and the CPU time spent per second of
+ * audio.
+ *
+ * Set SIMON_BENCHMARK_PIPELINE to run it; The input defaults to the 16 kHz
+ * recording of the VAD test and can be replaced by setting
+ * SIMON_BENCHMARK_PIPELINE to a ';' separated list of files.
+ */
+
+static const QString dataFolder = KDESRCDIR "data/";
+static const int sampleRate = 16000;
+
+LatencyClient::LatencyClient(const SimonSound::DeviceConfiguration& deviceConfiguration) :
+  SoundInputClient(deviceConfiguration),
+  vad(new VADSoundProcessor(deviceConfiguration, true))
+{
+  registerSoundProcessor(vad);
+  //the sound processing thread emits this; don't wait for the event loop
+  connect(vad, SIGNAL(complete(qint64, qint64)), this, SLOT(complete(qint64, qint64)), Qt::DirectConnection);
+}
+
+void LatencyClient::processPrivate(const QByteArray& data, qint64 currentTime)
+{
+  Q_UNUSED(data);
+  Q_UNUSED(currentTime);
+}
+
+void LatencyClient::complete(qint64 start, qint64 end)
+{
+  Q_UNUSED(start);
+  QMutexLocker l(&latencyLock);
+  m_latencies << FileBackend::captureElapsed() - end;
+}
+
+QList<qint64> LatencyClient::latencies()
+{
+  QMutexLocker l(&latencyLock);
+  return m_latencies;
+}
+
+LatencyClient::~LatencyClient()
+{
+  SoundServer::getInstance()->deRegisterInputClient(this);
+}
+
+
+static qint64 percentile(const QList<qint64>& sorted, double p)
+{
+  return sorted[qMin(sorted.count() - 1, int(p * sorted.count()))];
+}
+
+static void report(const char* mode, QList<qint64> latencies, qint64 inputLength, qint64 wallTime, qint64 cpuTime)
+{
+  qSort(latencies);
+  qDebug() << mode << ":" << latencies.count() << "utterances in" << inputLength << "ms of audio,"
+           << wallTime << "ms wall time";
+  qDebug() << "  latency p50:" << percentile(latencies, 0.5) << "ms, p90:" << percentile(latencies, 0.9)
+           << "ms, p99:" << percentile(latencies, 0.99) << "ms, max:" << latencies.last() << "ms";
+  qDebug() << "  CPU:" << (double(cpuTime) / (inputLength / 1000.0)) << "ms per audio second";
+}
+
+void PipelineBenchmark::initTestCase()
+{
+  QString files = QString::fromLocal8Bit(qgetenv("SIMON_BENCHMARK_PIPELINE"));
+  if (files.isEmpty())
+    QSKIP("SIMON_BENCHMARK_PIPELINE not set", SkipAll);
+
+  input = files.split(';', QString::SkipEmptyParts);
+  if (input.count() == 1 && !QFileInfo(input.first()).exists())
+    input = QStringList() << dataFolder + "commands.raw";
+
+  inputLength = 0;
+  realTimeUtterances = -1;
+  foreach (const QString& file, input) {
+    QFileInfo info(file);
+    QVERIFY(info.exists());
+    //wav headers are negligible here
+    inputLength += info.size() * 1000 / (sampleRate * sizeof(short));
+  }
+}
+
+QList<qint64> PipelineBenchmark::run(FileBackend::Pacing pacing, qint64& wallTime, qint64& cpuTime)
+{
+  FileBackend::enable(input, pacing);
+  SimonSound::DeviceConfiguration device(FileBackend().getDefaultInputDevice(), 1, sampleRate, false, sampleRate);
+  LatencyClient client(device);
+
+  clock_t cpuStart = clock();
+  if (!SoundServer::getInstance()->registerInputClient(&client))
+    return QList<qint64>();
+
+  while ((FileBackend::capturePosition() == -1) || !FileBackend::inputFinished())
+    QTest::qWait(50);
+  wallTime = FileBackend::captureElapsed();
+  //give the last utterance time to be detected
+  QTest::qWait(1500);
+
+  SoundServer::getInstance()->deRegisterInputClient(&client);
+  cpuTime = (clock() - cpuStart) * 1000 / CLOCKS_PER_SEC;
+  return client.latencies();
+}
+
+void PipelineBenchmark::benchmarkRealTime()
+{
+  qint64 wallTime = 0, cpuTime = 0;
+  QList<qint64> latencies;
+  QBENCHMARK_ONCE {
+    latencies = run(FileBackend::RealTime, wallTime, cpuTime);
+  }
+  QVERIFY(!latencies.isEmpty());
+  realTimeUtterances = latencies.count();
+  report("real time", latencies, inputLength, wallTime, cpuTime);
+}
+
+void PipelineBenchmark::benchmarkFast()
+{
+  qint64 wallTime = 0, cpuTime = 0;
+  QList<qint64> latencies;
+  QBENCHMARK_ONCE {
+    latencies = run(FileBackend::AsFastAsPossible, wallTime, cpuTime);
+  }
+  QVERIFY(!latencies.isEmpty());
+  //the fast mode must not drop any input
+  if (realTimeUtterances != -1)
+    QCOMPARE(latencies.count(), realTimeUtterances);
+  //latencies are meaningless when the input isn't paced; this is about throughput
+  report("as fast as possible", latencies, inputLength, wallTime, cpuTime);
+}
+
+QTEST_MAIN(PipelineBenchmark)
@@ -0,0 +1,72 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SIMON_PIPELINEBENCHMARK_H_BA861C2511FE409E9897F7882E77E41B
+#define SIMON_PIPELINEBENCHMARK_H_BA861C2511FE409E9897F7882E77E41B
+
+#include "../soundinputclient.h"
+#include "../file/filebackend.h"
+#include <QTest>
+#include <QMutex>
+#include <QList>
+
+class VADSoundProcessor;
+
+/**
+ * Records through the sound server and notes how long after the end of
+ * every utterance the voice activity detection reported it.
+ */
+class LatencyClient : public QObject, public SoundInputClient
+{
+  Q_OBJECT
+  public:
+    explicit LatencyClient(const SimonSound::DeviceConfiguration& deviceConfiguration);
+    ~LatencyClient();
+
+    void processPrivate(const QByteArray& data, qint64 currentTime);
+    QList<qint64> latencies();
+
+  private slots:
+    void complete(qint64 start, qint64 end);
+
+  private:
+    VADSoundProcessor *vad;
+    QMutex latencyLock;
+    QList<qint64> m_latencies;
+};
+
+class PipelineBenchmark: public QObject
+{
+  Q_OBJECT
+  public:
+    virtual ~PipelineBenchmark() {}
+  private slots:
+    void initTestCase();
+    void benchmarkRealTime();
+    void benchmarkFast();
+
+  private:
+    QStringList input;
+    qint64 inputLength;
+    int realTimeUtterances;
+
+    QList<qint64> run(FileBackend::Pacing pacing, qint64& wallTime, qint64& cpuTime);
+};
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "postprocessingtest.h"
+#include "../postprocessingchain.h"
+#include <simonwav/wavfilewriter.h>
+
+#include <QFile>
+#include <QDir>
+#include <QCoreApplication>
+#include <QtEndian>
+#include <QDebug>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static QVector<float> sine(double frequency, double amplitude, int sampleRate, int frames)
+{
+  QVector<float> samples(frames);
+  for (int i=0; i < frames; ++i)
+    samples[i] = (float) (amplitude * sin(2.0 * M_PI * frequency * i / sampleRate));
+  return samples;
+}
+
+static double rms(const QVector<float>& samples, int from, int to)
+{
+  double sum = 0;
+  for (int i=from; i < to; ++i)
+    sum += samples[i] * samples[i];
+  return sqrt(sum / (to - from));
+}
+
+void PostProcessingTest::init()
+{
+  QString prefix = QDir::tempPath()+"/simonpostprocessingtest_"+QString::number(QCoreApplication::applicationPid());
+  input = prefix+"_in.wav";
+  output = prefix+"_out.wav";
+}
+
+void PostProcessingTest::cleanup()
+{
+  QFile::remove(input);
+  QFile::remove(output);
+}
+
+void PostProcessingTest::writeInput(const QVector<float>& samples, int sampleRate)
+{
+  QByteArray data(samples.count() * sizeof(qint16), 0);
+  qint16 *pcm = reinterpret_cast<qint16*>(data.data());
+  for (int i=0; i < samples.count(); ++i)
+    pcm[i] = (qint16) qRound(samples[i] * 32767.0f);
+
+  WavFileWriter writer(input, 1, sampleRate);
+  QVERIFY(writer.open());
+  writer.write(data);
+  QVERIFY(writer.finish());
+}
+
+QVector<float> PostProcessingTest::readOutput(int& sampleRate)
+{
+  QFile f(output);
+  if (!f.open(QIODevice::ReadOnly))
+    return QVector<float>();
+  QByteArray wav = f.readAll();
+  const uchar *data = reinterpret_cast<const uchar*>(wav.constData());
+  sampleRate = (int) qFromLittleEndian<quint32>(data + 24);
+
+  QVector<float> samples((wav.size() - 44) / sizeof(qint16));
+  for (int i=0; i < samples.count(); ++i)
+    samples[i] = ((qint16) qFromLittleEndian<quint16>(data + 44 + i * 2)) / 32768.0f;
+  return samples;
+}
+
+QVector<float> PostProcessingTest::apply(const QStringList& filters, const QVector<float>& samples, int& sampleRate)
+{
+  writeInput(samples, sampleRate);
+
+  PostProcessingChain chain;
+  QString error;
+  if (!chain.parse(filters) || !chain.apply(input, output, error)) {
+    qWarning() << chain.lastError() << error;
+    return QVector<float>();
+  }
+  return readOutput(sampleRate);
+}
+
+void PostProcessingTest::testParse()
+{
+  PostProcessingChain chain;
+  QVERIFY(chain.parse(QStringList()));
+  QVERIFY(chain.isEmpty());
+  QVERIFY(chain.parse(QStringList() << "simon:normalize" << "simon:highpass 100" << "sox %1 %2 gain -3"));
+  QVERIFY(!chain.isEmpty());
+
+  QVERIFY(!chain.parse(QStringList() << "simon:bogus"));
+  QVERIFY(!chain.parse(QStringList() << "simon:highpass -5"));
+  QVERIFY(!chain.parse(QStringList() << "simon:resample"));
+  QVERIFY(!chain.parse(QStringList() << "simon:dcremove 3"));
+  QVERIFY(!chain.lastError().isEmpty());
+  QVERIFY(chain.isEmpty());
+}
+
+void PostProcessingTest::testCopy()
+{
+  writeInput(sine(440, 0.5, 16000, 1600), 16000);
+
+  PostProcessingChain chain;
+  QString error;
+  QVERIFY(chain.parse(QStringList()));
+  QVERIFY(chain.apply(input, output, error));
+
+  QFile in(input), out(output);
+  QVERIFY(in.open(QIODevice::ReadOnly) && out.open(QIODevice::ReadOnly));
+  QCOMPARE(out.readAll(), in.readAll());
+}
+
+void PostProcessingTest::testNormalize()
+{
+  int sampleRate = 16000;
+  QVector<float> samples = apply(QStringList() << "simon:normalize -6", sine(440, 0.1, sampleRate, 16000), sampleRate);
+  QCOMPARE(samples.count(), 16000);
+
+  float peak = 0;
+  foreach (float sample, samples)
+    peak = qMax(peak, qAbs(sample));
+  QVERIFY(qAbs(peak - 0.501f) < 0.01f);
+}
+
+void PostProcessingTest::testDcRemove()
+{
+  int sampleRate = 16000;
+  QVector<float> input = sine(440, 0.3, sampleRate, 16000);
+  for (int i=0; i < input.count(); ++i)
+    input[i] += 0.2f;
+  QVector<float> samples = apply(QStringList() << "simon:dcremove", input, sampleRate);
+  QCOMPARE(samples.count(), 16000);
+
+  double sum = 0;
+  foreach (float sample, samples)
+    sum += sample;
+  QVERIFY(qAbs(sum / samples.count()) < 0.001);
+}
+
+void PostProcessingTest::testHighPass()
+{
+  int sampleRate = 16000;
+  QVector<float> low = apply(QStringList() << "simon:highpass 300", sine(30, 0.5, sampleRate, 16000), sampleRate);
+  QVector<float> high = apply(QStringList() << "simon:highpass 300", sine(3000, 0.5, sampleRate, 16000), sampleRate);
+  QCOMPARE(low.count(), 16000);
+  QCOMPARE(high.count(), 16000);
+
+  //skip the settling of the filter; amplitude 0.5 -> rms 0.354
+  QVERIFY(rms(low, 1600, 16000) < 0.01);
+  QVERIFY(qAbs(rms(high, 1600, 16000) - 0.354) < 0.01);
+}
+
+void PostProcessingTest::testGate()
+{
+  int sampleRate = 16000;
+  QVector<float> input = sine(440, 0.001, sampleRate, 8000) + sine(440, 0.5, sampleRate, 8000);
+  QVector<float> samples = apply(QStringList() << "simon:gate -40", input, sampleRate);
+  QCOMPARE(samples.count(), 16000);
+
+  QCOMPARE(rms(samples, 0, 8000), 0.0);
+  QVERIFY(qAbs(rms(samples, 8000, 16000) - 0.354) < 0.01);
+}
+
+void PostProcessingTest::testResample()
+{
+  int sampleRate = 48000;
+  QVector<float> samples = apply(QStringList() << "simon:resample 16000", sine(1000, 0.5, sampleRate, 48000), sampleRate);
+  QCOMPARE(sampleRate, 16000);
+  QVERIFY(qAbs(samples.count() - 16000) < 50);
+  QVERIFY(qAbs(rms(samples, 200, samples.count() - 200) - 0.354) < 0.02);
+}
+
+QTEST_MAIN(PostProcessingTest)
@@ -0,0 +1,49 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef SIMON_POSTPROCESSINGTEST_H_A06295286D534A95B0BF9D535D688CC9
+#define SIMON_POSTPROCESSINGTEST_H_A06295286D534A95B0BF9D535D688CC9
+
+#include <QTest>
+#include <QVector>
+
+class PostProcessingTest: public QObject
+{
+  Q_OBJECT
+  public:
+    virtual ~PostProcessingTest() {}
+  private:
+    QString input, output;
+    void writeInput(const QVector<float>& samples, int sampleRate);
+    QVector<float> readOutput(int& sampleRate);
+    QVector<float> apply(const QStringList& filters, const QVector<float>& samples, int& sampleRate);
+  private slots:
+    void init();
+    void cleanup();
+    void testParse();
+    void testCopy();
+    void testNormalize();
+    void testDcRemove();
+    void testHighPass();
+    void testGate();
+    void testResample();
+};
+
+#endif
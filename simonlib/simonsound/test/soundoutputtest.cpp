@@ -0,0 +1,140 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "soundoutputtest.h"
+#include "../simonsoundoutput.h"
+#include "../soundserver.h"
+#include "../file/filebackend.h"
+
+#include <QDir>
+#include <QFile>
+#include <QElapsedTimer>
+
+/**
+ * Plays clients through SimonSoundOutput into the FileBackend and checks
+ * the ring buffer: Clients follow each other without silence in between
+ * and the underrun accounting only counts actual underruns.
+ */
+
+static const int sampleRate = 16000;
+//one period of the FileBackend is 640 bytes; switch clients in the middle of one
+static const int firstLength = 15000;
+static const int secondLength = 10000;
+
+BufferClient::BufferClient(const SimonSound::DeviceConfiguration& deviceConfiguration, const QByteArray& data) :
+  SoundOutputClient(deviceConfiguration)
+{
+  m_data.setData(data);
+  m_data.open(QIODevice::ReadOnly);
+}
+
+void SoundOutputTest::initTestCase()
+{
+  path = QDir::temp().filePath("simonsoundoutputtest.wav");
+  FileBackend::enable(QStringList(), FileBackend::RealTime, path);
+  device = SimonSound::DeviceConfiguration(FileBackend().getDefaultOutputDevice(), 1, sampleRate, false, sampleRate);
+  //the backend thread reaches the sound server through popClient(); create it here
+  SoundServer::getInstance();
+}
+
+void SoundOutputTest::cleanupTestCase()
+{
+  FileBackend::disable();
+  QFile::remove(path);
+}
+
+bool SoundOutputTest::waitForPlayed(SimonSoundOutput *output, qint64 length)
+{
+  QElapsedTimer timeout;
+  timeout.start();
+  while ((output->playedLength() < length) && (timeout.elapsed() < 5000))
+    QTest::qWait(20);
+  return output->playedLength() == length;
+}
+
+/**
+ * \return The samples written to the output file, starting with the first
+ *         non-silent one
+ */
+QByteArray SoundOutputTest::played()
+{
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly))
+    return QByteArray();
+  QByteArray samples = f.readAll().mid(44);
+  int start = 0;
+  while ((start < samples.size()) && (samples[start] == 0))
+    ++start;
+  return samples.mid(start);
+}
+
+void SoundOutputTest::testGapless()
+{
+  QByteArray first(firstLength, 1);
+  QByteArray second(secondLength, 2);
+  BufferClient firstClient(device, first);
+  BufferClient secondClient(device, second);
+
+  SimonSoundOutput *output = new SimonSoundOutput();
+  QVERIFY(output->preparePlayback(device));
+  QVERIFY(output->registerOutputClient(&firstClient));
+  QVERIFY(output->registerOutputClient(&secondClient));
+
+  QVERIFY(waitForPlayed(output, firstLength + secondLength));
+  QCOMPARE(output->underruns(), 0);
+  QCOMPARE(output->underrunLength(), (qint64) 0);
+  //stops the backend, which finishes the file
+  delete output;
+
+  //the second client interrupts the first one, which resumes afterwards;
+  //Any silence before all samples were played would be a gap
+  QByteArray samples = played().left(firstLength + secondLength);
+  QCOMPARE(samples.count((char) 1), firstLength);
+  QCOMPARE(samples.count((char) 2), secondLength);
+}
+
+void SoundOutputTest::testStarved()
+{
+  QByteArray first(firstLength, 1);
+  QByteArray second(secondLength, 2);
+  BufferClient firstClient(device, first);
+  BufferClient secondClient(device, second);
+
+  SimonSoundOutput *output = new SimonSoundOutput();
+  QVERIFY(output->preparePlayback(device));
+  QVERIFY(output->registerOutputClient(&firstClient));
+  QVERIFY(waitForPlayed(output, firstLength));
+
+  //nothing to play in between: silence, but no underruns
+  QTest::qWait(200);
+  QVERIFY(output->registerOutputClient(&secondClient));
+  QVERIFY(waitForPlayed(output, firstLength + secondLength));
+  QCOMPARE(output->underruns(), 0);
+  QCOMPARE(output->underrunLength(), (qint64) 0);
+  delete output;
+
+  QByteArray samples = played();
+  QCOMPARE(samples.left(firstLength), first);
+  int secondStart = samples.indexOf((char) 2);
+  QVERIFY(secondStart > firstLength);
+  QCOMPARE(samples.mid(secondStart, secondLength), second);
+}
+
+QTEST_MAIN(SoundOutputTest)
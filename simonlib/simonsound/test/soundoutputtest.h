@@ -0,0 +1,64 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SIMON_SOUNDOUTPUTTEST_H_5E0C2B7A41D94F6B8E3A9C1D7F26B804
+#define SIMON_SOUNDOUTPUTTEST_H_5E0C2B7A41D94F6B8E3A9C1D7F26B804
+
+#include "../soundoutputclient.h"
+#include <QTest>
+#include <QBuffer>
+
+class SimonSoundOutput;
+
+/**
+ * Plays a fixed block of samples.
+ */
+class BufferClient : public SoundOutputClient
+{
+  public:
+    BufferClient(const SimonSound::DeviceConfiguration& deviceConfiguration, const QByteArray& data);
+    void finish() {}
+
+  protected:
+    QIODevice* getDataProvider() { return &m_data; }
+
+  private:
+    QBuffer m_data;
+};
+
+class SoundOutputTest: public QObject
+{
+  Q_OBJECT
+  public:
+    virtual ~SoundOutputTest() {}
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testGapless();
+    void testStarved();
+
+  private:
+    QString path;
+    SimonSound::DeviceConfiguration device;
+
+    bool waitForPlayed(SimonSoundOutput *output, qint64 length);
+    QByteArray played();
+};
+
+#endif
@@ -18,7 +18,7 @@
  */
 
 #include "wavrecorderclient.h"
-#include <simonwav/wav.h>
+#include <simonwav/wavfilewriter.h>
 #include <soundconfig.h>
 
 #include "soundserver.h"
@@ -56,10 +56,13 @@ bool WavRecorderClient::record(QString filename)
     wavData = 0;
   }
 
-  wavData = new WAV(filename, m_deviceConfiguration.channels(),
-    m_deviceConfiguration.resample() ? m_deviceConfiguration.resampleSampleRate() :
-                                       m_deviceConfiguration.sampleRate());
-  wavData->beginAddSequence();
+  wavData = new WavFileWriter(filename, m_deviceConfiguration.channels(),
+                              m_deviceConfiguration.targetSampleRate());
+  if (!wavData->open()) {
+    wavData->deleteLater();
+    wavData = 0;
+    return false;
+  }
 
   bool succ =  SoundServer::getInstance()->registerInputClient(this);
 
@@ -105,8 +108,7 @@ bool WavRecorderClient::finish()
   if (ratio < SoundConfiguration::minimumSNR())
     emit signalToNoiseRatioLow();
 
-  wavData->endAddSequence();
-  if (!wavData->writeFile())
+  if (!wavData->finish())
     succ = false;
   wavData->deleteLater();
   wavData = 0;
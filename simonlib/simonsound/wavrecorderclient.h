@@ -24,7 +24,7 @@
 #include <QTimer>
 #include "soundinputclient.h"
 
-class WAV;
+class WavFileWriter;
 class VADSoundProcessor;
 
 class WavRecorderClient :public QObject, public SoundInputClient
@@ -32,7 +32,7 @@ class WavRecorderClient :public QObject, public SoundInputClient
   Q_OBJECT
 
   private:
-    WAV *wavData;
+    WavFileWriter *wavData;
     VADSoundProcessor *vad;
 
   signals:
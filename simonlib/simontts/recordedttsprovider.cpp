@@ -19,13 +19,19 @@
 
 #include "recordedttsprovider.h"
 #include "recordingsetcollection.h"
+#include "ttsplaybackstream.h"
 #include <simonsound/wavplayerclient.h>
 #include <simonsound/soundserver.h>
+#include <simonwav/wav.h>
 #include <QStringList>
+#include <QFileInfo>
 #include <KDebug>
 #include <KStandardDirs>
 
 RecordedTTSProvider::RecordedTTSProvider() : QObject(), sets(0),
+  recordings(16*1024 /*KiB*/),
+  streamChannels(0),
+  streamSamplerate(0),
   player(0)
 {
   initializeOutput();
@@ -100,27 +106,84 @@ bool RecordedTTSProvider::say(const QString& text)
   if (/*!interrupt() ||*/ (!sets && !initialize()))
     return false;
 
-  //play wav file
   QString path = sets->getPath(text);
-  kDebug() << "Playing: " << path;
+  Recording recording;
+  if (!load(path, recording))
+    return false;
+
+  //continue the running stream if possible
+  if (filesToPlay.isEmpty() && stream && (streamChannels == recording.channels) &&
+      (streamSamplerate == recording.samplerate) && stream->append(recording.pcm)) {
+    kDebug() << "Appended to playback: " << path;
+    return true;
+  }
+
   if (!player->isPlaying())
-    player->play(path);
+    play(recording);
   else {
     kDebug() << "Adding to playback queue: " << path;
-    filesToPlay << path;
+    filesToPlay << recording;
   }
 
   return true;
 }
 
+/**
+ * \brief Reads the samples of the given wav file (or takes them from the cache)
+ */
+bool RecordedTTSProvider::load(const QString& path, Recording& recording)
+{
+  QDateTime modified = QFileInfo(path).lastModified();
+  Recording *cached = recordings.object(path);
+  if (cached && (cached->modified == modified)) {
+    recording = *cached;
+    return true;
+  }
+
+  WAV wav(path);
+  if (!wav.beginReadSequence()) {
+    kWarning() << "Couldn't read recording: " << path;
+    return false;
+  }
+  recording.pcm = wav.readAll();
+  wav.endReadSequence();
+  recording.channels = wav.getChannels();
+  recording.samplerate = wav.getSampleRate();
+  recording.modified = modified;
+  if (recording.pcm.isEmpty())
+    return false;
+
+  recordings.insert(path, new Recording(recording), qMax(1, recording.pcm.size() / 1024));
+  return true;
+}
+
+void RecordedTTSProvider::play(const Recording& recording)
+{
+  stream = QSharedPointer<TTSPlaybackStream>(new TTSPlaybackStream);
+  streamChannels = recording.channels;
+  streamSamplerate = recording.samplerate;
+  stream->append(recording.pcm);
+
+  //phrases with the same format that are already waiting join this stream
+  while (!filesToPlay.isEmpty() && (filesToPlay.first().channels == streamChannels) &&
+         (filesToPlay.first().samplerate == streamSamplerate))
+    stream->append(filesToPlay.takeFirst().pcm);
+
+  if (!player->play(stream, streamChannels, streamSamplerate))
+    kWarning() << "Failed to start playback";
+}
+
 
 /**
  * \brief Plays the next file in the playing queue
  */
 void RecordedTTSProvider::playNext()
 {
+  if (stream)
+    stream->clear();
+  stream.clear();
   if (filesToPlay.isEmpty()) return;
-  player->play(filesToPlay.takeAt(0));
+  play(filesToPlay.takeFirst());
 }
 
 /**
@@ -132,6 +195,8 @@ bool RecordedTTSProvider::interrupt()
   if (!initialize()) return true;
 
   filesToPlay.clear();
+  if (stream)
+    stream->clear();
   player->stop();
   return true;
 }
@@ -23,25 +23,47 @@
 #include "simonttsprovider.h"
 #include <QStringList>
 #include <QObject>
+#include <QCache>
+#include <QDateTime>
+#include <QSharedPointer>
 
 class QString;
 class RecordingSetCollection;
 class WavPlayerClient;
+class TTSPlaybackStream;
 
 /**
  * \class RecordedTTSProvider
  * \author Peter Grasch
  * \since 0.4
  * \brief Interface to pre recorded sound snippets
+ *
+ * Decoded recordings are cached in memory. Recordings said while another
+ * one is still playing are appended to the running stream so queued
+ * phrases play without gaps.
  */
 class RecordedTTSProvider : public QObject, public SimonTTSProvider
 {
   Q_OBJECT
   private:
+    struct Recording {
+      QByteArray pcm;
+      int channels;
+      int samplerate;
+      QDateTime modified;
+    };
+
     RecordingSetCollection *sets;
-    QStringList filesToPlay;
+    QCache<QString /*path*/, Recording> recordings;
+    QList<Recording> filesToPlay;
+    QSharedPointer<TTSPlaybackStream> stream;
+    int streamChannels;
+    int streamSamplerate;
     WavPlayerClient *player;
 
+    bool load(const QString& path, Recording& recording);
+    void play(const Recording& recording);
+
   private slots:
     void playNext();
     void initializeOutput();
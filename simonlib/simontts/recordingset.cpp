@@ -190,6 +190,16 @@ QString RecordingSet::getPath(const QString& text, bool forceTemp) const
   return getBaseDirectory()+file;
 }
 
+QStringList RecordingSet::getTexts() const
+{
+  QStringList texts;
+  QHash<RecordingSetText, QString>::const_iterator i = m_recordings.constBegin();
+  QHash<RecordingSetText, QString>::const_iterator end = m_recordings.constEnd();
+  for (; i != end; ++i)
+    texts << i.key();
+  return texts;
+}
+
 bool RecordingSet::rename(const QString& newName)
 {
   m_name = newName;
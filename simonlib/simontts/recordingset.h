@@ -24,6 +24,7 @@
 #include <QDomElement>
 #include <QString>
 #include <QHash>
+#include <QStringList>
 #include <QAbstractItemModel>
 
 class QDomDocument;
@@ -167,6 +168,12 @@ class SIMONTTS_EXPORT RecordingSet : public QAbstractItemModel
      */
     QString getPath(const QString& text, bool forceTemp=false) const;
 
+    /**
+     * \brief Returns the texts of all recordings in this set
+     * \return List of texts (as entered)
+     */
+    QStringList getTexts() const;
+
     /*
      * Getter method for @sa m_isNull
      * \return m_isNull
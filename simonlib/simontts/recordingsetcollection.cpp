@@ -24,13 +24,17 @@
 #include <QDir>
 #include <QDomDocument>
 #include <KTar>
+#include <KDebug>
 
-RecordingSetCollection::RecordingSetCollection()
+RecordingSetCollection::RecordingSetCollection() : m_indexValid(false),
+  m_indexActiveSet(-1),
+  m_indexAcrossSets(false)
 {
 }
 
 void RecordingSetCollection::deleteAll()
 {
+  m_indexValid = false;
   qDeleteAll(m_sets);
   m_sets.clear();
   qDeleteAll(m_setsScheduledForDeletion);
@@ -70,6 +74,8 @@ bool RecordingSetCollection::save(const QString& path)
 
   bool succ = true;
   succ = purgeSelectedSets();
+  //committed recordings move out of the temporary folder
+  m_indexValid = false;
   
   QDomDocument doc;
   QDomElement rootElem = doc.createElement("ttssets");
@@ -190,6 +196,7 @@ bool RecordingSetCollection::importSet(const QString& path)
   }
 
   m_sets << set;
+  m_indexValid = false;
   QDir d;
   return d.rmdir(setDataDir) && d.rmdir(importDirectory);
 }
@@ -201,16 +208,42 @@ bool RecordingSetCollection::canSay(const QString& text)
 
 QString RecordingSetCollection::getPath(const QString& text)
 {
+  updateIndex();
+  return m_index.value(normalize(text));
+}
+
+QString RecordingSetCollection::normalize(const QString& text)
+{
+  return text.simplified().toLower();
+}
+
+void RecordingSetCollection::updateIndex()
+{
+  int activeSet = TTSConfiguration::activeSet();
+  bool acrossSets = TTSConfiguration::useRecordingsAcrossSets();
+  if (m_indexValid && (m_indexActiveSet == activeSet) && (m_indexAcrossSets == acrossSets))
+    return;
+
+  m_index.clear();
+  //sets are in order of priority: only add texts not provided by an earlier one
   QList<RecordingSet*> activeSets = getActiveSets();
-  QString path;
   foreach (RecordingSet *s, activeSets)
   {
-    path = s->getPath(text);
-    if (!path.isNull())
-      return path;
+    foreach (const QString& text, s->getTexts())
+    {
+      QString key = normalize(text);
+      if (m_index.contains(key))
+        continue;
+      QString path = s->getPath(text);
+      if (!path.isNull())
+        m_index.insert(key, path);
+    }
   }
-  
-  return QString();
+  kDebug() << "Indexed " << m_index.count() << " recordings";
+
+  m_indexValid = true;
+  m_indexActiveSet = activeSet;
+  m_indexAcrossSets = acrossSets;
 }
 
 RecordingSet* RecordingSetCollection::getSet(int id) const
@@ -261,6 +294,7 @@ int RecordingSetCollection::getFreeId()
 bool RecordingSetCollection::addSet(const QString& name)
 {
   m_sets << new RecordingSet(getFreeId(), name);
+  m_indexValid = false;
   return true;
 }
 
@@ -278,6 +312,7 @@ bool RecordingSetCollection::removeSet(int id)
   if (!set || !set->clear()) return false;
   m_sets.removeAll(set);
   m_setsScheduledForDeletion << set;
+  m_indexValid = false;
   kDebug() << "Scheduling set for deletion";
   return true;
 }
@@ -299,6 +334,7 @@ bool RecordingSetCollection::addRecording(int id, const QString& text, const QSt
 {
   RecordingSet *set = getSet(id);
   if (!set) return false;
+  m_indexValid = false;
   return set->addRecording(text, path);
 }
 
@@ -306,6 +342,7 @@ bool RecordingSetCollection::editRecording(int id, const QString& text, const QS
 {
   RecordingSet *set = getSet(id);
   if (!set) return false;
+  m_indexValid = false;
   return set->editRecording(text, path);
 }
 
@@ -313,6 +350,7 @@ bool RecordingSetCollection::removeRecording(int id, const QString& text)
 {
   RecordingSet *set = getSet(id);
   if (!set) return false;
+  m_indexValid = false;
   return set->removeRecording(text);
 }
 
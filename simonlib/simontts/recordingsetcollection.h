@@ -23,6 +23,7 @@
 #include "simontts_export.h"
 #include <QString>
 #include <QList>
+#include <QHash>
 
 class RecordingSet;
 
@@ -41,6 +42,24 @@ class SIMONTTS_EXPORT RecordingSetCollection
     /// Sets that should be removed the next time we save
     QList<RecordingSet*> m_setsScheduledForDeletion;
 
+    /// Paths of all recordings of the active sets by normalized text; built on demand
+    QHash<QString, QString> m_index;
+
+    /// Configuration the index was built for
+    bool m_indexValid;
+    int m_indexActiveSet;
+    bool m_indexAcrossSets;
+
+    /**
+     * \brief Rebuilds the index if it is missing or the active sets changed
+     */
+    void updateIndex();
+
+    /**
+     * \brief Key of the given text in @sa m_index
+     */
+    static QString normalize(const QString& text);
+
     /**
      * \brief Clears the @sa m_sets and @sa m_setsScheduledForDeletion lists
      */
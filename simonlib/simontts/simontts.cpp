@@ -74,6 +74,21 @@ bool SimonTTS::say(const QString& text, SimonTTS::TTSFlags flags)
 }
 
 
+/**
+ * \brief Prepares the given texts to be said soon
+ *
+ * Providers that synthesize remotely fetch the audio ahead of time so
+ * later calls to \sa say() start playback right away.
+ *
+ * \param texts The texts that are likely to be said
+ * \return True if successful
+ */
+bool SimonTTS::prefetch(const QStringList& texts, SimonTTS::TTSFlags flags)
+{
+  return getInstance()->prefetch(texts, flags);
+}
+
+
 /**
  * \brief Interrupts the current spoken text
  * \return true if successfully sent interrupt request or if service seems unavailable
@@ -51,6 +51,7 @@ class SIMONTTS_EXPORT SimonTTS
     static bool initialize();
     static bool uninitialize();
     static bool say(const QString& text, SimonTTS::TTSFlags flags=SimonTTS::StripHTML);
+    static bool prefetch(const QStringList& texts, SimonTTS::TTSFlags flags=SimonTTS::StripHTML);
     static bool interrupt();
     static QStringList recentlyUsed();
 };
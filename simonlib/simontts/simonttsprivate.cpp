@@ -149,6 +149,33 @@ bool SimonTTSPrivate::say(const QString& text, SimonTTS::TTSFlags flags)
 }
 
 
+/**
+ * \brief Prepares the given texts to be said soon
+ *
+ * \param texts The texts that are likely to be said
+ * \param flags The flags to apply
+ * \return True if successful
+ */
+bool SimonTTSPrivate::prefetch(const QStringList& texts, SimonTTS::TTSFlags flags)
+{
+  if (forceReinitialization && !initialize()) return false;
+  bool succ = true;
+  foreach (const QString& text, texts)
+  {
+    QString spokenText = processString(text, flags);
+    if (spokenText.isEmpty()) continue;
+
+    foreach (SimonTTSProvider *p, providers)
+      if (p->canSay(spokenText))
+      {
+        succ = p->prefetch(spokenText) && succ;
+        break;
+      }
+  }
+  return succ;
+}
+
+
 /**
  * \brief Interrupts the current spoken text
  * \return true if successfully sent interrupt request or if service seems unavailable
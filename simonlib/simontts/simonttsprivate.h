@@ -49,6 +49,7 @@ class SimonTTSPrivate : public QObject
     SimonTTSPrivate();
    ~SimonTTSPrivate();
     QStringList recentlyUsed();
+    bool prefetch(const QStringList& texts, SimonTTS::TTSFlags flags);
 
   public slots:
     bool initialize();
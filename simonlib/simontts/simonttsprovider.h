@@ -35,6 +35,10 @@ class SimonTTSProvider
     virtual bool uninitialize()=0;
     virtual bool canSay(const QString& text)=0;
     virtual bool say(const QString& text)=0;
+    /**
+     * \brief Prepares the given text to be said soon (e.g. by synthesizing it ahead of time)
+     */
+    virtual bool prefetch(const QString& /*text*/) { return true; }
     virtual bool interrupt()=0;
     virtual ~SimonTTSProvider() {}
 
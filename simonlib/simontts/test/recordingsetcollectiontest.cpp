@@ -0,0 +1,128 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "../recordingsetcollection.h"
+#include "../recordingset.h"
+#include "../ttsplaybackstream.h"
+#include "ttsconfiguration.h"
+
+#include <QTest>
+#include <QDir>
+#include <QFile>
+#include <qtest_kde.h>
+
+class testRecordingSetCollection: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testLookup();
+    void testPriority();
+    void testPlaybackStream();
+
+  private:
+    RecordingSetCollection sets;
+    QString sample;
+};
+
+void testRecordingSetCollection::initTestCase()
+{
+  sample = QDir::temp().filePath("simonttsrecordingtest.wav");
+  QFile f(sample);
+  QVERIFY(f.open(QIODevice::WriteOnly));
+  f.write(QByteArray(64, 'x'));
+  f.close();
+
+  QVERIFY(sets.addSet("first"));
+  QVERIFY(sets.addSet("second"));
+  QCOMPARE(sets.getSets().count(), 2);
+
+  QVERIFY(sets.addRecording(0, "Hello world", sample));
+  QVERIFY(sets.addRecording(0, "Only first", sample));
+  QVERIFY(sets.addRecording(1, "Hello world", sample));
+  QVERIFY(sets.addRecording(1, "Only second", sample));
+}
+
+void testRecordingSetCollection::cleanupTestCase()
+{
+  foreach (int id, sets.getSets())
+    sets.removeSet(id);
+  QFile::remove(sample);
+}
+
+void testRecordingSetCollection::testLookup()
+{
+  TTSConfiguration::setActiveSet(0);
+  TTSConfiguration::setUseRecordingsAcrossSets(true);
+
+  QString path = sets.getPath("Hello world");
+  QVERIFY(!path.isNull());
+  QVERIFY(QFile::exists(path));
+  QCOMPARE(sets.getPath("hello WORLD"), path);
+  QCOMPARE(sets.getPath("  Hello \t world "), path);
+  QVERIFY(sets.canSay("only second"));
+  QVERIFY(!sets.canSay("Hello"));
+
+  QVERIFY(sets.removeRecording(1, "Only second"));
+  QVERIFY(!sets.canSay("Only second"));
+}
+
+void testRecordingSetCollection::testPriority()
+{
+  TTSConfiguration::setActiveSet(0);
+  TTSConfiguration::setUseRecordingsAcrossSets(true);
+  QString first = sets.getPath("Hello world");
+  QVERIFY(first.contains(sets.getSet(0)->getTempDirectory()));
+
+  TTSConfiguration::setActiveSet(1);
+  QString second = sets.getPath("Hello world");
+  QVERIFY(second.contains(sets.getSet(1)->getTempDirectory()));
+  QVERIFY(sets.canSay("Only first"));
+
+  TTSConfiguration::setUseRecordingsAcrossSets(false);
+  QCOMPARE(sets.getPath("Hello world"), second);
+  QVERIFY(!sets.canSay("Only first"));
+}
+
+void testRecordingSetCollection::testPlaybackStream()
+{
+  TTSPlaybackStream stream;
+  QVERIFY(stream.open(QIODevice::ReadOnly));
+  QVERIFY(stream.append("abcd"));
+  QVERIFY(stream.append("ef"));
+  QCOMPARE(stream.bytesAvailable(), qint64(6));
+
+  char buffer[4];
+  QCOMPARE(stream.read(buffer, 4), qint64(4));
+  QCOMPARE(QByteArray(buffer, 4), QByteArray("abcd"));
+  QVERIFY(stream.append("gh"));
+  QCOMPARE(stream.read(buffer, 4), qint64(4));
+  QCOMPARE(QByteArray(buffer, 4), QByteArray("efgh"));
+
+  //ran dry: the player finishes and new data has to go to a new stream
+  QCOMPARE(stream.read(buffer, 4), qint64(0));
+  QVERIFY(!stream.append("ij"));
+  QCOMPARE(stream.bytesAvailable(), qint64(0));
+}
+
+QTEST_KDEMAIN(testRecordingSetCollection, GUI)
+
+#include "recordingsetcollectiontest.moc"
@@ -0,0 +1,298 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "../webservicettsprovider.h"
+#include "../ttsaudiocache.h"
+#include "ttsconfiguration.h"
+
+#include <QTest>
+#include <QDir>
+#include <QFile>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QHash>
+#include <QDataStream>
+#include <qtest_kde.h>
+
+/**
+ * Minimal http server answering every request with a short wav file after
+ * a delay
+ */
+class WebserviceStub : public QObject
+{
+  Q_OBJECT
+  public:
+    WebserviceStub() : requests(0), active(0), maxActive(0) {
+      connect(&server, SIGNAL(newConnection()), this, SLOT(accept()));
+    }
+    bool listen() { return server.listen(QHostAddress::LocalHost); }
+    quint16 port() const { return server.serverPort(); }
+
+    int requests;
+    int active;
+    int maxActive;
+
+  private slots:
+    void accept();
+    void readRequest();
+    void respond();
+
+  private:
+    QTcpServer server;
+    QHash<QTcpSocket*, QByteArray> pending;
+    QList<QTcpSocket*> waiting;
+};
+
+void WebserviceStub::accept()
+{
+  while (QTcpSocket *socket = server.nextPendingConnection())
+    connect(socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+}
+
+void WebserviceStub::readRequest()
+{
+  QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+  QByteArray& request = pending[socket];
+  request += socket->readAll();
+  if (!request.contains("\r\n\r\n"))
+    return;
+
+  ++requests;
+  maxActive = qMax(maxActive, ++active);
+  waiting << socket;
+  QTimer::singleShot(50, this, SLOT(respond()));
+}
+
+void WebserviceStub::respond()
+{
+  QTcpSocket *socket = waiting.takeFirst();
+  pending.remove(socket);
+
+  const qint32 dataSize = 16000;
+  QByteArray wav;
+  QDataStream s(&wav, QIODevice::WriteOnly);
+  s.setByteOrder(QDataStream::LittleEndian);
+  s.writeRawData("RIFF", 4);
+  s << (qint32) (36 + dataSize);
+  s.writeRawData("WAVEfmt ", 8);
+  s << (qint32) 16 << (qint16) 1 << (qint16) 1 << (qint32) 16000 << (qint32) 32000 << (qint16) 2 << (qint16) 16;
+  s.writeRawData("data", 4);
+  s << dataSize;
+  wav += QByteArray(dataSize, '\0');
+
+  socket->write("HTTP/1.0 200 OK\r\nContent-Type: audio/x-wav\r\nContent-Length: " +
+                QByteArray::number(wav.size()) + "\r\n\r\n" + wav);
+  socket->disconnectFromHost();
+  socket->deleteLater();
+  --active;
+}
+
+/**
+ * Records what would be played instead of using the sound server
+ */
+class RecordingProvider : public WebserviceTTSProvider
+{
+  public:
+    explicit RecordingProvider(const QString& cachePath) : WebserviceTTSProvider(cachePath),
+      channels(0), sampleRate(0) {}
+
+    QSharedPointer<QIODevice> audio;
+    int channels;
+    int sampleRate;
+
+    void finishPlayback() {
+      audio.clear();
+      playNext();
+    }
+
+  protected:
+    bool startPlayback(QSharedPointer<QIODevice> audio, int channels, int sampleRate) {
+      this->audio = audio;
+      this->channels = channels;
+      this->sampleRate = sampleRate;
+      return true;
+    }
+};
+
+class testWebserviceTTSProvider: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void testCache();
+    void testPrefetch();
+    void testSay();
+
+  private:
+    WebserviceStub stub;
+    QString cachePath;
+
+    void clearCache();
+    bool waitForCache(WebserviceTTSProvider& provider, const QStringList& texts);
+};
+
+void testWebserviceTTSProvider::initTestCase()
+{
+  QVERIFY(stub.listen());
+  TTSConfiguration::setWebserviceURL(QString("http://127.0.0.1:%1/process?INPUT_TEXT=%2").arg(stub.port()).arg("%1"));
+  TTSConfiguration::setWebserviceParallelRequests(2);
+}
+
+void testWebserviceTTSProvider::clearCache()
+{
+  foreach (const QString& file, QDir(cachePath).entryList(QDir::Files))
+    QFile::remove(QDir(cachePath).filePath(file));
+}
+
+void testWebserviceTTSProvider::init()
+{
+  QDir::temp().mkdir("simonttsprovidertest");
+  cachePath = QDir::temp().filePath("simonttsprovidertest") + '/';
+  clearCache();
+  stub.requests = 0;
+  stub.maxActive = 0;
+}
+
+void testWebserviceTTSProvider::cleanup()
+{
+  clearCache();
+  QDir::temp().rmdir("simonttsprovidertest");
+}
+
+/**
+ * \return True once all of the given texts are cached
+ */
+bool testWebserviceTTSProvider::waitForCache(WebserviceTTSProvider& provider, const QStringList& texts)
+{
+  for (int i = 0; i < 100; i++) {
+    int cached = 0;
+    foreach (const QString& text, texts)
+      cached += provider.isCached(text) ? 1 : 0;
+    if (cached == texts.count())
+      return true;
+    QTest::qWait(50);
+  }
+  return false;
+}
+
+void testWebserviceTTSProvider::testCache()
+{
+  QDir directory = QDir::temp();
+  directory.mkdir("simonttscachetest");
+  QString cachePath = directory.filePath("simonttscachetest");
+  foreach (const QString& file, QDir(cachePath).entryList(QDir::Files))
+    QFile::remove(QDir(cachePath).filePath(file));
+
+  const QByteArray file(10*1024, 'x');
+  {
+    TTSAudioCache cache(cachePath, 15*1024, 30*1024);
+    QString key = TTSAudioCache::key("voice", "  Some\ttext ");
+    QCOMPARE(key, TTSAudioCache::key("voice", "Some text"));
+    QVERIFY(key != TTSAudioCache::key("other voice", "Some text"));
+    QVERIFY(!cache.contains(key));
+    cache.insert(key, file);
+    QVERIFY(cache.contains(key));
+    QCOMPARE(cache.find(key), file);
+
+    //only one file fits in memory; the others are read back from disk
+    cache.insert(TTSAudioCache::key("voice", "second"), file);
+    QCOMPARE(cache.find(key), file);
+
+    cache.insert(TTSAudioCache::key("voice", "third"), file);
+    cache.insert(TTSAudioCache::key("voice", "fourth"), file);
+    QCOMPARE(QDir(cachePath).entryList(QStringList() << "*.wav", QDir::Files).count(), 3);
+  }
+
+  TTSAudioCache cache(cachePath, 15*1024, 30*1024);
+  int found = 0;
+  foreach (const QString& text, QStringList() << "Some text" << "second" << "third" << "fourth")
+    if (cache.find(TTSAudioCache::key("voice", text)) == file)
+      ++found;
+  QCOMPARE(found, 3);
+
+  foreach (const QString& file, QDir(cachePath).entryList(QDir::Files))
+    QFile::remove(QDir(cachePath).filePath(file));
+  directory.rmdir("simonttscachetest");
+}
+
+void testWebserviceTTSProvider::testPrefetch()
+{
+  QStringList texts;
+  for (int i = 0; i < 5; i++)
+    texts << QString("Text %1").arg(i);
+
+  WebserviceTTSProvider provider(cachePath);
+  foreach (const QString& text, texts) {
+    QVERIFY(!provider.isCached(text));
+    QVERIFY(provider.prefetch(text));
+  }
+  QVERIFY(waitForCache(provider, texts));
+
+  QCOMPARE(stub.requests, texts.count());
+  QCOMPARE(stub.maxActive, 2);
+
+  //known texts are not requested again
+  foreach (const QString& text, texts)
+    QVERIFY(provider.prefetch(text));
+  QTest::qWait(200);
+  QCOMPARE(stub.requests, texts.count());
+
+  WebserviceTTSProvider restarted(cachePath);
+  QVERIFY(restarted.isCached(texts.first()));
+}
+
+void testWebserviceTTSProvider::testSay()
+{
+  RecordingProvider provider(cachePath);
+  QVERIFY(provider.prefetch("Prefetched"));
+  QVERIFY(waitForCache(provider, QStringList() << "Prefetched"));
+  QCOMPARE(stub.requests, 1);
+
+  //prefetched texts are played right away without asking the webservice again
+  QVERIFY(provider.say("Prefetched"));
+  QVERIFY(provider.audio);
+  QCOMPARE(provider.channels, 1);
+  QCOMPARE(provider.sampleRate, 16000);
+  QCOMPARE(provider.audio->readAll(), QByteArray(16000, '\0'));
+  QCOMPARE(stub.requests, 1);
+
+  //unknown texts are queued and played once they arrive
+  QVERIFY(provider.say("Unknown"));
+  QCOMPARE(stub.requests, 1);
+  provider.finishPlayback();
+  QVERIFY(waitForCache(provider, QStringList() << "Unknown"));
+  QCOMPARE(stub.requests, 2);
+  QVERIFY(provider.audio);
+  QByteArray played = provider.audio->readAll();
+  for (int i = 0; (i < 100) && (played.size() < 16000); i++) {
+    QTest::qWait(50);
+    played += provider.audio->readAll();
+  }
+  QCOMPARE(played, QByteArray(16000, '\0'));
+  provider.finishPlayback();
+  QVERIFY(!provider.audio);
+}
+
+QTEST_KDEMAIN(testWebserviceTTSProvider, GUI)
+
+#include "webservicettsprovidertest.moc"
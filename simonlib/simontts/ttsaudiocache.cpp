@@ -0,0 +1,115 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "ttsaudiocache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QCryptographicHash>
+#include <KDebug>
+
+#ifdef Q_OS_WIN
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+
+TTSAudioCache::TTSAudioCache(const QString& directory, int memoryLimit, qint64 diskLimit) :
+  m_memory(qMax(1, memoryLimit / 1024)),
+  m_directory(directory),
+  m_diskLimit(diskLimit),
+  m_diskUsage(0)
+{
+  QDir().mkpath(m_directory);
+  foreach (const QFileInfo& info, QDir(m_directory).entryInfoList(QStringList() << "*.wav", QDir::Files))
+    m_diskUsage += info.size();
+  trimDisk();
+}
+
+QString TTSAudioCache::key(const QString& voice, const QString& text)
+{
+  return voice + '\n' + text.simplified();
+}
+
+QString TTSAudioCache::path(const QString& key) const
+{
+  return m_directory + QDir::separator() +
+      QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5).toHex()) + ".wav";
+}
+
+bool TTSAudioCache::contains(const QString& key) const
+{
+  return m_memory.contains(key) || QFile::exists(path(key));
+}
+
+QByteArray TTSAudioCache::find(const QString& key)
+{
+  QByteArray *data = m_memory.object(key);
+  if (data)
+    return *data;
+
+  QString filePath = path(key);
+  QFile f(filePath);
+  if (!f.open(QIODevice::ReadOnly))
+    return QByteArray();
+  QByteArray fileData = f.readAll();
+  f.close();
+
+  //the modification time orders the files for trimDisk()
+  QByteArray encodedPath = QFile::encodeName(filePath);
+  utime(encodedPath.constData(), 0);
+
+  m_memory.insert(key, new QByteArray(fileData), qMax(1, fileData.size() / 1024));
+  return fileData;
+}
+
+void TTSAudioCache::insert(const QString& key, const QByteArray& data)
+{
+  if (data.isEmpty())
+    return;
+  m_memory.insert(key, new QByteArray(data), qMax(1, data.size() / 1024));
+
+  QString filePath = path(key);
+  QFile f(filePath);
+  m_diskUsage -= f.size();
+  if (!f.open(QIODevice::WriteOnly) || (f.write(data) != data.size())) {
+    kWarning() << "Couldn't store synthesized audio at " << filePath;
+    f.remove();
+    return;
+  }
+  m_diskUsage += data.size();
+  f.close();
+  trimDisk();
+}
+
+void TTSAudioCache::trimDisk()
+{
+  if (m_diskUsage <= m_diskLimit)
+    return;
+
+  //newest first
+  QFileInfoList files = QDir(m_directory).entryInfoList(QStringList() << "*.wav", QDir::Files, QDir::Time);
+  while ((m_diskUsage > m_diskLimit) && !files.isEmpty()) {
+    QFileInfo oldest = files.takeLast();
+    if (QFile::remove(oldest.absoluteFilePath()))
+      m_diskUsage -= oldest.size();
+  }
+}
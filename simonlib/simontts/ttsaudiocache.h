@@ -0,0 +1,67 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef SIMON_TTSAUDIOCACHE_H_462913DE7CC64B8AA8B0BAC6592BB3ED
+#define SIMON_TTSAUDIOCACHE_H_462913DE7CC64B8AA8B0BAC6592BB3ED
+
+#include <QString>
+#include <QByteArray>
+#include <QCache>
+
+/**
+ * \class TTSAudioCache
+ * \author Peter Grasch
+ * \since 0.4
+ * \brief Least recently used cache of synthesized audio
+ *
+ * Recently used files are kept in memory; Every file is also stored in the
+ * given folder (named after the hash of its key) so it survives restarts.
+ * When the folder grows over its limit, the files that were not used the
+ * longest are removed.
+ */
+class TTSAudioCache
+{
+  public:
+    /**
+     * \param memoryLimit Size of the memory cache in bytes
+     * \param diskLimit Size of the folder in bytes
+     */
+    TTSAudioCache(const QString& directory, int memoryLimit, qint64 diskLimit);
+
+    /**
+     * \return Key of the given text spoken with the given voice
+     */
+    static QString key(const QString& voice, const QString& text);
+
+    bool contains(const QString& key) const;
+    QByteArray find(const QString& key);
+    void insert(const QString& key, const QByteArray& data);
+
+  private:
+    QCache<QString, QByteArray> m_memory;
+    QString m_directory;
+    qint64 m_diskLimit;
+    qint64 m_diskUsage;
+
+    QString path(const QString& key) const;
+    void trimDisk();
+};
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "ttsplaybackstream.h"
+#include <QMutexLocker>
+#include <string.h>
+
+TTSPlaybackStream::TTSPlaybackStream(QObject *parent) : QIODevice(parent),
+  m_drained(false)
+{
+}
+
+bool TTSPlaybackStream::open(OpenMode mode)
+{
+  return QIODevice::open(mode|QIODevice::Unbuffered);
+}
+
+bool TTSPlaybackStream::append(const QByteArray& data)
+{
+  QMutexLocker l(&m_lock);
+  if (m_drained)
+    return false;
+  m_data += data;
+  return true;
+}
+
+void TTSPlaybackStream::clear()
+{
+  QMutexLocker l(&m_lock);
+  m_data.clear();
+  m_drained = true;
+}
+
+qint64 TTSPlaybackStream::bytesAvailable() const
+{
+  QMutexLocker l(&m_lock);
+  return m_data.size();
+}
+
+qint64 TTSPlaybackStream::readData(char *data, qint64 maxSize)
+{
+  QMutexLocker l(&m_lock);
+  if (m_data.isEmpty()) {
+    m_drained = true;
+    return 0;
+  }
+
+  int read = (int) qMin(maxSize, (qint64) m_data.size());
+  memcpy(data, m_data.constData(), read);
+  m_data.remove(0, read);
+  return read;
+}
+
+qint64 TTSPlaybackStream::writeData(const char *data, qint64 maxSize)
+{
+  Q_UNUSED(data);
+  Q_UNUSED(maxSize);
+  return -1;
+}
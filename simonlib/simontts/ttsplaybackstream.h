@@ -0,0 +1,73 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef SIMON_TTSPLAYBACKSTREAM_H_9ABF3EC3D23B41B3A07C01D3D91CE30A
+#define SIMON_TTSPLAYBACKSTREAM_H_9ABF3EC3D23B41B3A07C01D3D91CE30A
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QMutex>
+
+/**
+ * \class TTSPlaybackStream
+ * \author Peter Grasch
+ * \since 0.4
+ * \brief Queue of raw audio read by the sound server
+ *
+ * Audio appended while the stream is played continues without a gap.
+ * Once the sound server read everything, the stream is done and refuses
+ * further data (the player is about to finish).
+ *
+ * Appending and reading may happen in different threads.
+ */
+class TTSPlaybackStream : public QIODevice
+{
+  public:
+    TTSPlaybackStream(QObject *parent=0);
+
+    /**
+     * \return False if the stream already ran dry; The data has to be
+     *         played in a new stream
+     */
+    bool append(const QByteArray& data);
+
+    /**
+     * \brief Drops all queued data and ends the stream
+     */
+    void clear();
+
+    /**
+     * \brief Always opens the device unbuffered; Read ahead would drain the stream early
+     */
+    bool open(OpenMode mode);
+    bool isSequential() const { return true; }
+    qint64 bytesAvailable() const;
+
+  protected:
+    qint64 readData(char *data, qint64 maxSize);
+    qint64 writeData(const char *data, qint64 maxSize);
+
+  private:
+    mutable QMutex m_lock;
+    QByteArray m_data;
+    bool m_drained;
+};
+
+#endif
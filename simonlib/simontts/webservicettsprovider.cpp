@@ -18,6 +18,7 @@
  */
 
 #include "webservicettsprovider.h"
+#include "ttsaudiocache.h"
 #include "ttsconfiguration.h"
 #include <limits.h>
 #include <simonsound/wavplayerclient.h>
@@ -27,18 +28,17 @@
 #include <QFile>
 #include <QNetworkRequest>
 #include <QNetworkReply>
-#include <QMutexLocker>
 #include <QNetworkAccessManager>
 #include <KDebug>
 #include <KStandardDirs>
 #include <QBuffer>
 #include <QTextDocument>
 
-WebserviceTTSProvider::WebserviceTTSProvider() : QObject(),
-  downloadMutex(QMutex::Recursive),
-  downloadOffset(0),
-  currentConnection(0),
+WebserviceTTSProvider::WebserviceTTSProvider(const QString& cachePath) : QObject(),
+  maxDownloads(1),
   net(0),
+  cachePath(cachePath.isNull() ? KStandardDirs::locateLocal("cache", "simontts/") : cachePath),
+  cache(0),
   player(0)
 {
   initializeOutput();
@@ -54,31 +54,86 @@ WebserviceTTSProvider::WebserviceTTSProvider() : QObject(),
 bool WebserviceTTSProvider::initialize()
 {
   if (!net)
+  {
     net = new QNetworkAccessManager(this);
+    maxDownloads = qMax(1, TTSConfiguration::webserviceParallelRequests());
+    cache = new TTSAudioCache(cachePath, 4*1024*1024,
+                              ((qint64) TTSConfiguration::webserviceCacheSize()) * 1024 * 1024);
+  }
 
   return true;
 }
 
+WebserviceTTSProvider::Segment* WebserviceTTSProvider::createSegment(const QString& text)
+{
+  QTextDocument d;
+  d.setHtml(text);
+
+  QString encoded = d.toPlainText();
+  kDebug() << "Encoded: " << encoded;
+  QString voice = TTSConfiguration::webserviceURL();
+
+  Segment *segment = new Segment;
+  segment->key = TTSAudioCache::key(voice, encoded);
+  segment->url = voice.replace("%1", QUrl::toPercentEncoding(encoded));
+  segment->buffer = QSharedPointer<QBuffer>(new QBuffer());
+  segment->buffer->open(QIODevice::ReadWrite);
+  segment->reply = 0;
+  segment->finished = false;
+  segment->failed = false;
+  segment->playing = false;
+  return segment;
+}
+
+/**
+ * \return The prefetched (or prefetching) segment with the given key or 0
+ */
+WebserviceTTSProvider::Segment* WebserviceTTSProvider::takePrefetch(const QString& key)
+{
+  for (int i = 0; i < filesToPrefetch.count(); i++)
+  {
+    Segment *segment = filesToPrefetch[i];
+    if (segment->key != key)
+      continue;
+
+    filesToPrefetch.removeAt(i);
+    //the header might already have been stripped off for playback
+    segment->buffer = QSharedPointer<QBuffer>(new QBuffer());
+    segment->buffer->open(QIODevice::ReadWrite);
+    segment->buffer->buffer() = segment->data;
+    return segment;
+  }
+  return 0;
+}
+
 void WebserviceTTSProvider::replyReceived()
 {
-  QNetworkReply* reply = dynamic_cast<QNetworkReply*>(sender());
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
   if (!reply) return;
+  reply->deleteLater();
+
+  Segment *segment = downloads.take(reply);
+  if (!segment) return;
+  segment->reply = 0;
   
   if (reply->error() != QNetworkReply::NoError)
   {
     kWarning() << "Webservice reported error: " << reply->errorString();
-    return;
+    segment->failed = true;
+  } else {
+    QByteArray buf = reply->readAll();
+    segment->data += buf;
+    segment->buffer->buffer() += buf;
+    segment->finished = true;
+    cache->insert(segment->key, segment->data);
   }
-  
-  downloadMutex.lock();
-  ++downloadOffset;
-  kDebug() << "Done download, increasing offset to: " << downloadOffset;
-  kDebug() << "Files still left to download: " << filesToDownload.count();
-  if (!filesToDownload.isEmpty())
-    fetch(filesToDownload.dequeue());
-  else
-    currentConnection = 0;
-  downloadMutex.unlock();
+
+  kDebug() << "Done download; Files still left to download: " << filesToPlay.count() + filesToPrefetch.count();
+  if (filesToPrefetch.removeAll(segment))
+    delete segment;
+
+  startDownloads();
+  enquePlayback();
 }
 
 void WebserviceTTSProvider::initializeOutput()
@@ -116,79 +171,174 @@ bool WebserviceTTSProvider::say(const QString& text)
   if (!initialize())
     return false;
 
-  QTextDocument d;
-  d.setHtml(text);
+  Segment *segment = createSegment(text);
+  kDebug() << "Getting: " << segment->url;
 
-  QString encoded = d.toPlainText();
-  kDebug() << "Encoded: " << encoded;
-  QString url = TTSConfiguration::webserviceURL().replace("%1", QUrl::toPercentEncoding(encoded));
- 
-  downloadMutex.lock();
-  kDebug() << "Getting: " << url;
-  QSharedPointer<QBuffer> b(new QBuffer());
-  b->open(QIODevice::ReadWrite);
-  filesToPlay.enqueue(b);
-
-  if (currentConnection) {
-    kDebug() << "We already have a connection. Queueing url...";
-    filesToDownload.enqueue(url);
+  Segment *prefetched = takePrefetch(segment->key);
+  if (prefetched) {
+    delete segment;
+    segment = prefetched;
   } else {
-    fetch(url);
+    QByteArray cached = cache->find(segment->key);
+    if (!cached.isEmpty()) {
+      kDebug() << "Playing cached file";
+      segment->data = cached;
+      segment->buffer->buffer() = cached;
+      segment->finished = true;
+    }
+  }
+  filesToPlay << segment;
+
+  startDownloads();
+  enquePlayback();
+  return true;
+}
+
+/**
+ * \brief Downloads the given text into the cache without playing it
+ *
+ * Prefetching only uses connections not needed for playback.
+ */
+bool WebserviceTTSProvider::prefetch(const QString& text)
+{
+  if (!initialize())
+    return false;
+
+  Segment *segment = createSegment(text);
+  bool known = cache->contains(segment->key);
+  foreach (Segment *s, filesToPlay + filesToPrefetch)
+    known = known || (s->key == segment->key);
+  if (known) {
+    delete segment;
+    return true;
   }
-  downloadMutex.unlock();
+
+  filesToPrefetch << segment;
+  startDownloads();
   return true;
 }
 
-void WebserviceTTSProvider::fetch(const QString& url)
+/**
+ * \return True if the given text will be played without contacting the webservice
+ */
+bool WebserviceTTSProvider::isCached(const QString& text)
 {
-  currentConnection = net->get(QNetworkRequest(KUrl(url)));
-  connect(currentConnection, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(downloadProgress(qint64,qint64)));
-  connect(currentConnection, SIGNAL(finished()), this, SLOT(replyReceived()));
+  if (!initialize())
+    return false;
+
+  Segment *segment = createSegment(text);
+  bool cached = cache->contains(segment->key);
+  delete segment;
+  return cached;
+}
+
+/**
+ * \brief Starts downloads until the configured maximum is reached
+ *
+ * Files to play take precedence over prefetched ones.
+ */
+void WebserviceTTSProvider::startDownloads()
+{
+  foreach (Segment *segment, filesToPlay + filesToPrefetch)
+  {
+    if (downloads.count() >= maxDownloads)
+      break;
+    if (!segment->reply && !segment->finished && !segment->failed)
+      fetch(segment);
+  }
+}
+
+void WebserviceTTSProvider::fetch(Segment *segment)
+{
+  QNetworkReply *reply = net->get(QNetworkRequest(KUrl(segment->url)));
+  connect(reply, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(downloadProgress(qint64,qint64)));
+  connect(reply, SIGNAL(finished()), this, SLOT(replyReceived()));
+  segment->reply = reply;
+  downloads.insert(reply, segment);
+}
+
+void WebserviceTTSProvider::abort(Segment *segment)
+{
+  if (!segment->reply)
+    return;
+
+  downloads.remove(segment->reply);
+  segment->reply->disconnect(this);
+  segment->reply->abort();
+  segment->reply->deleteLater();
+  segment->reply = 0;
 }
 
 void WebserviceTTSProvider::downloadProgress(qint64 now, qint64 max)
 {
-  QMutexLocker l(&downloadMutex);
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+  Segment *segment = downloads.value(reply);
+  if (!segment) return;
+
   kDebug() << "Download progress: " << now << max;
-  QByteArray buf = currentConnection->readAll();
-  kDebug() << "Writing to offset: " << downloadOffset << filesToPlay.count();
-  filesToPlay.at(downloadOffset)->buffer() += buf;
-  enquePlayback();
+  QByteArray buf = reply->readAll();
+  segment->data += buf;
+  segment->buffer->buffer() += buf;
+  if (!filesToPlay.isEmpty() && (filesToPlay.first() == segment))
+    enquePlayback();
 }
 
-/// downloadMutex is already locked as we enter this method
 void WebserviceTTSProvider::enquePlayback()
 {
-  kDebug() << "Bytes available: " << filesToPlay.first()->bytesAvailable() << player->isPlaying();
-  if (filesToPlay.first()->bytesAvailable() > 44 && !player->isPlaying()) {
-    kDebug() << "Received header so starting playback";
-    qint16 channels;
-    qint32 samplerate;
-    WAV::parseHeader(filesToPlay.first().data(), channels, samplerate);
-    kDebug() << "header: " << channels << samplerate;
-    QSharedPointer<QBuffer> handle = filesToPlay.first();
-    handle->buffer().remove(0, 44);
-    player->play(handle, channels, samplerate);
+  while (!filesToPlay.isEmpty())
+  {
+    Segment *segment = filesToPlay.first();
+    if (segment->playing)
+      return;
+
+    if (segment->failed || (segment->finished && (segment->buffer->bytesAvailable() <= 44)))
+    {
+      kDebug() << "Skipping file without audio";
+      delete filesToPlay.takeFirst();
+      continue;
+    }
+
+    kDebug() << "Bytes available: " << segment->buffer->bytesAvailable() << player->isPlaying();
+    if (segment->buffer->bytesAvailable() > 44 && !player->isPlaying()) {
+      kDebug() << "Received header so starting playback";
+      qint16 channels;
+      qint32 samplerate;
+      WAV::parseHeader(segment->buffer.data(), channels, samplerate);
+      kDebug() << "header: " << channels << samplerate;
+      segment->buffer->buffer().remove(0, 44);
+      segment->buffer->seek(0);
+      segment->playing = true;
+      if (!startPlayback(segment->buffer, channels, samplerate)) {
+        kWarning() << "Failed to start playback";
+        playNext();
+      }
+    }
+    return;
   }
 }
 
+bool WebserviceTTSProvider::startPlayback(QSharedPointer<QIODevice> audio, int channels, int sampleRate)
+{
+  return player->play(audio, channels, sampleRate);
+}
+
 
 /**
  * \brief Plays the next file in the playing queue
  */
 void WebserviceTTSProvider::playNext()
 {
-  QMutexLocker l(&downloadMutex);
-  downloadOffset = qMax(0, downloadOffset-1);
-  
-  if (filesToPlay.isEmpty()) return;
+  if (filesToPlay.isEmpty() || !filesToPlay.first()->playing) return;
   
   kDebug() << "Finished playback";
-  filesToPlay.dequeue();
+  Segment *segment = filesToPlay.takeFirst();
+  if (segment->reply) {
+    //still downloading; finish it for the cache
+    segment->playing = false;
+    filesToPrefetch.prepend(segment);
+  } else
+    delete segment;
   
-  kDebug() << "Done playing, decreasing offset to: " << downloadOffset;
-  
-  if (filesToPlay.isEmpty()) return;
   enquePlayback();
 }
 
@@ -200,16 +350,16 @@ bool WebserviceTTSProvider::interrupt()
 {
   if (!initialize()) return true;
 
-  downloadMutex.lock();
-  if (currentConnection) {
-    currentConnection->abort();
-    currentConnection->deleteLater();
-    currentConnection = 0;
-  }
-  downloadOffset = 0;
+  QList<Segment*> segments = filesToPlay;
   filesToPlay.clear();
   player->stop();
-  downloadMutex.unlock();
+  foreach (Segment *segment, segments)
+  {
+    abort(segment);
+    delete segment;
+  }
+  //prefetching continues in the freed connections
+  startDownloads();
   
   return true;
 }
@@ -229,6 +379,11 @@ bool WebserviceTTSProvider::uninitialize()
 
 WebserviceTTSProvider::~WebserviceTTSProvider()
 {
+  foreach (Segment *segment, filesToPlay + filesToPrefetch)
+  {
+    abort(segment);
+    delete segment;
+  }
   delete player;
+  delete cache;
 }
-
@@ -25,49 +25,83 @@
 #include <QObject>
 #include <QBuffer>
 #include <QSharedPointer>
-#include <QQueue>
-#include <QFile>
-#include <QMutex>
+#include <QList>
+#include <QHash>
 
 class QString;
 class WavPlayerClient;
 class QBuffer;
+class QIODevice;
 class QNetworkReply;
 class QNetworkAccessManager;
+class TTSAudioCache;
 
 /**
  * \class WebserviceTTSProvider
  * \author Peter Grasch
  * \since 0.4
- * \brief Interface to pre recorded sound snippets
+ * \brief Synthesizes text through a webservice (e.g. MARY)
+ *
+ * Texts are downloaded in parallel (up to the configured number of
+ * requests); Playback of the first text starts as soon as its header is
+ * received. Every downloaded file is cached.
  */
 class WebserviceTTSProvider : public QObject, public SimonTTSProvider
 {
   Q_OBJECT
   private:
-    QMutex downloadMutex;
-    QQueue<QString> filesToDownload;
-    QQueue< QSharedPointer<QBuffer> > filesToPlay;
-    int downloadOffset; /// we are always playing the file at position 0 of filesToPlay; we are downloading file [0+downloadOffset]
-    QNetworkReply *currentConnection;
+    struct Segment {
+      QString key;
+      QString url;
+      QSharedPointer<QBuffer> buffer; ///< played data
+      QByteArray data; ///< the complete file for the cache
+      QNetworkReply *reply;
+      bool finished;
+      bool failed;
+      bool playing;
+    };
+
+    QList<Segment*> filesToPlay; ///< we are always playing the file at position 0
+    QList<Segment*> filesToPrefetch;
+    QHash<QNetworkReply*, Segment*> downloads;
+    int maxDownloads;
     
     QNetworkAccessManager *net;
+    QString cachePath;
+    TTSAudioCache *cache;
     WavPlayerClient *player;
+    Segment* createSegment(const QString& text);
+    Segment* takePrefetch(const QString& key);
     void enquePlayback();
-    void fetch(const QString& url);
+    void startDownloads();
+    void fetch(Segment *segment);
+    void abort(Segment *segment);
 
   private slots:
     void downloadProgress(qint64,qint64);
     void replyReceived();
-    void playNext();
     void initializeOutput();
 
+  protected slots:
+    void playNext();
+
+  protected:
+    /**
+     * Starts playing the given audio; playNext() is called once it finished
+     */
+    virtual bool startPlayback(QSharedPointer<QIODevice> audio, int channels, int sampleRate);
+
   public:
-    WebserviceTTSProvider();
+    /**
+     * \param cachePath Folder of the disk cache; Defaults to the user's cache
+     */
+    explicit WebserviceTTSProvider(const QString& cachePath=QString());
     bool initialize();
     bool uninitialize();
     bool canSay(const QString& text);
     bool say(const QString& text);
+    bool prefetch(const QString& text);
+    bool isCached(const QString& text);
     bool interrupt();
     ~WebserviceTTSProvider();
 };
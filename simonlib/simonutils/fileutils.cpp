@@ -19,7 +19,8 @@
 
 #include "fileutils.h"
 
-#include <KTar>
+#include "modelcontainer.h"
+
 #include <KDebug>
 #include <QDir>
 #include <QFile>
@@ -91,14 +92,15 @@ bool FileUtils::copyDirRecursive(const QString &sourceDirName, const QString &de
 bool FileUtils::pack(const QString &targetArchive, const QHash<QString, QByteArray> &fromMemory,
                      const QHash<QString, QString> &existingFiles)
 {
-  KTar archive(targetArchive, "application/x-gzip");
+  ModelContainer archive(targetArchive);
   if (!archive.open(QIODevice::WriteOnly)) return false;
 
   QHash<QString, QByteArray>::const_iterator data = fromMemory.begin(), end = fromMemory.end();
 
   while(data != end)
   {
-    archive.writeFile(data.key(), "nobody", "nobody", data.value().constData(), data.value().length());
+    if (!archive.writeFile(data.key(), data.value()))
+      return false;
     data++;
   }
 
@@ -121,22 +123,18 @@ bool FileUtils::unpack(const QString &archive, const QString &targetDir, const Q
 
   if (!QFile::exists(archive)) return false;
 
-  KTar tar(archive, "application/x-gzip");
-  if (!tar.open(QIODevice::ReadOnly)) return false;
-
-  const KArchiveDirectory *d = tar.directory();
-  if (!d) return false;
+  ModelContainer container(archive);
+  if (!container.open(QIODevice::ReadOnly)) return false;
 
-  const QStringList &iFiles = files.isEmpty()?d->entries():files;
+  const QStringList &iFiles = files.isEmpty()?container.entries():files;
 
   foreach (const QString& file, iFiles)
   {
-    const KArchiveFile *entry = dynamic_cast<const KArchiveFile*>(d->entry(file));
-    if (!entry) return false;
+    if (!container.contains(file)) return false;
 
     QFile f(targetDir+file);
     if (!f.open(QIODevice::WriteOnly)) return false;
-    f.write(entry->data());
+    if (!container.copyTo(file, &f)) return false;
     f.close();
   }
   return true;
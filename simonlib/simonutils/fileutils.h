@@ -41,7 +41,7 @@ public:
   static bool copyDirRecursive(const QString &sourceDirName, const QString &destinationDirName);
 
   /*!
-     * \brief   Pack data from "fromMemory" and files from disk to tar.gzip archive with name targetArchive
+     * \brief   Pack data from "fromMemory" and files from disk to a model container (see ModelContainer) with name targetArchive
      *
      *  \author Vladislav Sitalo
      *  \param targetArchive Archive name
@@ -55,7 +55,7 @@ public:
 
 
   /*!
-     *  \brief Unpack selected files from gzip archive to target directory. If file list is empty: unpacks all
+     *  \brief Unpack selected files from a model container (or a legacy gzipped tar archive) to target directory. If file list is empty: unpacks all
      *  \author Vladislav Sitalo
      *  \param archive Archive name
      *  \param targetDir Target dir
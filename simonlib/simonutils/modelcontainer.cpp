@@ -0,0 +1,315 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "modelcontainer.h"
+
+#include <QFile>
+#include <QBuffer>
+#include <QDataStream>
+#include <KTar>
+#include <KFilterDev>
+#include <KDebug>
+
+static const char containerMagic[] = "SBMC";
+static const char indexMagic[] = "SBMI";
+static const quint32 containerVersion = 1;
+static const int trailerSize = sizeof(qint64) + 4;
+
+const int ModelContainer::chunkSize;
+
+ModelContainer::ModelContainer(const QString& path) :
+  m_path(path), m_device(0), m_ownDevice(true), m_mode(QIODevice::NotOpen),
+  m_offset(0), m_writeFailed(false), m_legacy(0), m_legacyBuffer(0)
+{
+}
+
+ModelContainer::ModelContainer(QIODevice *device) :
+  m_device(device), m_ownDevice(false), m_mode(QIODevice::NotOpen),
+  m_offset(0), m_writeFailed(false), m_legacy(0), m_legacyBuffer(0)
+{
+}
+
+ModelContainer::~ModelContainer()
+{
+  if (isOpen())
+    close();
+}
+
+bool ModelContainer::isContainer(QIODevice *device)
+{
+  return device->peek(4) == QByteArray(containerMagic, 4);
+}
+
+bool ModelContainer::open(QIODevice::OpenMode mode)
+{
+  if (isOpen() || ((mode != QIODevice::ReadOnly) && (mode != QIODevice::WriteOnly)))
+    return false;
+
+  if (m_ownDevice) {
+    m_device = new QFile(m_path);
+    if (!m_device->open(mode)) {
+      kDebug() << "Couldn't open " << m_path;
+      delete m_device;
+      m_device = 0;
+      return false;
+    }
+  } else if (!m_device->isOpen() && !m_device->open(mode))
+    return false;
+
+  m_mode = mode;
+  m_names.clear();
+  m_entries.clear();
+
+  bool ok;
+  if (mode == QIODevice::WriteOnly) {
+    m_offset = 0;
+    m_writeFailed = false;
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream.writeRawData(containerMagic, 4);
+    stream << containerVersion;
+    ok = write(header);
+  } else
+    ok = isContainer(m_device) ? readIndex() : openLegacy();
+
+  if (!ok)
+    close();
+  return ok;
+}
+
+bool ModelContainer::openLegacy()
+{
+  if (m_ownDevice) {
+    //let KTar handle the decompression itself
+    m_device->close();
+    m_legacy = new KTar(m_path, "application/x-gzip");
+  } else {
+    //seeking doesn't work properly in kfilterdevs, which trips up KTar. Instead, decompress
+    //completely before passing it on to KTar
+    QIODevice *uncompressed = KFilterDev::device(m_device, "application/x-gzip", false);
+    if (!uncompressed)
+      return false;
+    m_legacyBuffer = new QBuffer;
+    if (uncompressed->open(QIODevice::ReadOnly))
+      m_legacyBuffer->setData(uncompressed->readAll());
+    delete uncompressed;
+    m_legacy = new KTar(m_legacyBuffer);
+  }
+
+  if (!m_legacy->open(QIODevice::ReadOnly) || !m_legacy->directory()) {
+    kDebug() << "Neither a model container nor a tar archive";
+    return false;
+  }
+  return true;
+}
+
+bool ModelContainer::readIndex()
+{
+  qint64 size = m_device->size();
+  if (size < (qint64) (8 + trailerSize) || !m_device->seek(size - trailerSize))
+    return false;
+
+  QDataStream stream(m_device);
+  stream.setVersion(QDataStream::Qt_4_6);
+  qint64 indexOffset;
+  char magic[4];
+  stream >> indexOffset;
+  if ((stream.readRawData(magic, 4) != 4) || (QByteArray(magic, 4) != QByteArray(indexMagic, 4)) ||
+      (indexOffset < 8) || (indexOffset > size - trailerSize) || !m_device->seek(indexOffset)) {
+    kDebug() << "Container index missing";
+    return false;
+  }
+
+  quint32 entryCount;
+  stream >> entryCount;
+  for (quint32 i = 0; (i < entryCount) && (stream.status() == QDataStream::Ok); ++i) {
+    QString name;
+    Entry entry;
+    quint32 chunkCount;
+    stream >> name >> entry.size >> chunkCount;
+    for (quint32 j = 0; (j < chunkCount) && (stream.status() == QDataStream::Ok); ++j) {
+      Chunk chunk;
+      stream >> chunk.offset >> chunk.length;
+      entry.chunks << chunk;
+    }
+    if (!m_entries.contains(name))
+      m_names << name;
+    m_entries.insert(name, entry);
+  }
+  return stream.status() == QDataStream::Ok;
+}
+
+bool ModelContainer::write(const QByteArray& data)
+{
+  if (m_writeFailed || (m_device->write(data) != data.size())) {
+    m_writeFailed = true;
+    return false;
+  }
+  m_offset += data.size();
+  return true;
+}
+
+bool ModelContainer::writeIndex()
+{
+  QByteArray index;
+  QDataStream stream(&index, QIODevice::WriteOnly);
+  stream.setVersion(QDataStream::Qt_4_6);
+  stream << (quint32) m_names.count();
+  foreach (const QString& name, m_names) {
+    const Entry& entry = m_entries[name];
+    stream << name << entry.size << (quint32) entry.chunks.count();
+    foreach (const Chunk& chunk, entry.chunks)
+      stream << chunk.offset << chunk.length;
+  }
+  stream << m_offset;
+  stream.writeRawData(indexMagic, 4);
+  return write(index);
+}
+
+bool ModelContainer::close()
+{
+  if (!isOpen())
+    return false;
+
+  bool success = true;
+  if (m_mode == QIODevice::WriteOnly)
+    success = writeIndex();
+
+  delete m_legacy;
+  m_legacy = 0;
+  delete m_legacyBuffer;
+  m_legacyBuffer = 0;
+  if (m_ownDevice) {
+    delete m_device;
+    m_device = 0;
+  }
+  m_mode = QIODevice::NotOpen;
+  return success;
+}
+
+bool ModelContainer::writeFile(const QString& name, const QByteArray& data)
+{
+  QBuffer buffer(const_cast<QByteArray*>(&data));
+  if (!buffer.open(QIODevice::ReadOnly))
+    return false;
+  return writeFile(name, &buffer);
+}
+
+bool ModelContainer::writeFile(const QString& name, QIODevice *source)
+{
+  if (m_mode != QIODevice::WriteOnly)
+    return false;
+
+  Entry entry;
+  entry.size = 0;
+  QByteArray data;
+  while (!(data = source->read(chunkSize)).isEmpty()) {
+    QByteArray compressed = qCompress(data);
+    Chunk chunk;
+    chunk.offset = m_offset;
+    chunk.length = compressed.size();
+    if (!write(compressed))
+      return false;
+    entry.chunks << chunk;
+    entry.size += data.size();
+  }
+
+  if (!m_entries.contains(name))
+    m_names << name;
+  m_entries.insert(name, entry);
+  return true;
+}
+
+bool ModelContainer::addLocalFile(const QString& path, const QString& name)
+{
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly)) {
+    kDebug() << "Couldn't read " << path;
+    return false;
+  }
+  return writeFile(name, &f);
+}
+
+QStringList ModelContainer::entries() const
+{
+  if (m_legacy)
+    return m_legacy->directory()->entries();
+  return m_names;
+}
+
+bool ModelContainer::contains(const QString& name) const
+{
+  if (m_legacy)
+    return dynamic_cast<const KArchiveFile*>(m_legacy->directory()->entry(name)) != 0;
+  return m_entries.contains(name);
+}
+
+QByteArray ModelContainer::readChunk(const Chunk& chunk)
+{
+  if (!m_device->seek(chunk.offset))
+    return QByteArray();
+  return qUncompress(m_device->read(chunk.length));
+}
+
+QByteArray ModelContainer::data(const QString& name)
+{
+  if (m_mode != QIODevice::ReadOnly)
+    return QByteArray();
+
+  if (m_legacy) {
+    const KArchiveFile *entry = dynamic_cast<const KArchiveFile*>(m_legacy->directory()->entry(name));
+    return entry ? entry->data() : QByteArray();
+  }
+
+  QHash<QString, Entry>::const_iterator entry = m_entries.constFind(name);
+  if (entry == m_entries.constEnd())
+    return QByteArray();
+
+  QByteArray data;
+  data.reserve(entry->size);
+  foreach (const Chunk& chunk, entry->chunks)
+    data += readChunk(chunk);
+  if (data.size() != entry->size) {
+    kWarning() << "Entry corrupt: " << name;
+    return QByteArray();
+  }
+  return data;
+}
+
+bool ModelContainer::copyTo(const QString& name, QIODevice *target)
+{
+  if ((m_mode != QIODevice::ReadOnly) || !contains(name))
+    return false;
+
+  if (m_legacy) {
+    QByteArray d = data(name);
+    return target->write(d) == d.size();
+  }
+
+  const Entry& entry = m_entries[name];
+  qint64 written = 0;
+  foreach (const Chunk& chunk, entry.chunks) {
+    QByteArray data = readChunk(chunk);
+    if (data.isEmpty() || (target->write(data) != data.size()))
+      return false;
+    written += data.size();
+  }
+  return written == entry.size;
+}
@@ -0,0 +1,131 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef SIMON_MODELCONTAINER_H_C51022A90C3747DDB0B29C6B1D9969C2
+#define SIMON_MODELCONTAINER_H_C51022A90C3747DDB0B29C6B1D9969C2
+
+#include "simonutils_export.h"
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include <QIODevice>
+
+class KTar;
+class QBuffer;
+
+/**
+ * \class ModelContainer
+ * \brief Chunk compressed, indexed archive for speech models (*.sbm)
+ *
+ * Every file is split into chunks that are compressed on their own. The
+ * index of all entries is written after the last chunk, so a container is
+ * written front to back in one pass (even to sequential devices) and a
+ * single entry can be read without inflating the rest of the archive.
+ *
+ * Layout: "SBMC", quint32 version, the chunks, the index and finally
+ * qint64 index offset, "SBMI".
+ *
+ * Containers in the gzipped tar format used by earlier versions are still
+ * read (but never written).
+ */
+class SIMONUTILS_EXPORT ModelContainer
+{
+public:
+  /**
+   * Uncompressed size of a chunk
+   */
+  static const int chunkSize = 1024*1024;
+
+  explicit ModelContainer(const QString& path);
+
+  /**
+   * The device has to stay valid while the container is open; It is not
+   * deleted. Reading needs a random access device.
+   */
+  explicit ModelContainer(QIODevice *device);
+  ~ModelContainer();
+
+  /**
+   * Opens the container either QIODevice::ReadOnly or QIODevice::WriteOnly
+   */
+  bool open(QIODevice::OpenMode mode);
+
+  /**
+   * When writing, this writes the index; Check the return value.
+   */
+  bool close();
+  bool isOpen() const { return m_mode != QIODevice::NotOpen; }
+
+  /**
+   * \return True if the container was read from a tar archive
+   */
+  bool isLegacy() const { return m_legacy != 0; }
+
+  bool writeFile(const QString& name, const QByteArray& data);
+  bool writeFile(const QString& name, QIODevice *source);
+  bool addLocalFile(const QString& path, const QString& name);
+
+  QStringList entries() const;
+  bool contains(const QString& name) const;
+  QByteArray data(const QString& name);
+
+  /**
+   * Decompresses the given entry into target one chunk at a time
+   */
+  bool copyTo(const QString& name, QIODevice *target);
+
+  /**
+   * \return True if the device is positioned at the start of a container in
+   *         this format (and not, for example, a tar archive)
+   */
+  static bool isContainer(QIODevice *device);
+
+private:
+  struct Chunk {
+    qint64 offset;
+    quint32 length;
+  };
+  struct Entry {
+    qint64 size;
+    QList<Chunk> chunks;
+  };
+
+  QString m_path;
+  QIODevice *m_device;
+  bool m_ownDevice;
+  QIODevice::OpenMode m_mode;
+  qint64 m_offset;
+  bool m_writeFailed;
+
+  QStringList m_names;
+  QHash<QString, Entry> m_entries;
+
+  KTar *m_legacy;
+  QBuffer *m_legacyBuffer;
+
+  bool readIndex();
+  bool writeIndex();
+  bool openLegacy();
+  bool write(const QByteArray& data);
+  QByteArray readChunk(const Chunk& chunk);
+};
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "partialmodel.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <KConfig>
+#include <KConfigGroup>
+#include <KDebug>
+
+const int PartialModel::chunkSize;
+
+PartialModel::PartialModel(const QString& targetPath) : m_targetPath(targetPath)
+{
+}
+
+QString PartialModel::path() const
+{
+  return m_targetPath+".part";
+}
+
+QString PartialModel::infoPath() const
+{
+  return m_targetPath+".partrc";
+}
+
+qint64 PartialModel::resumeOffset(const QDateTime& changedTime) const
+{
+  if (!QFile::exists(infoPath()))
+    return 0;
+  KConfig config(infoPath(), KConfig::SimpleConfig);
+  KConfigGroup cGroup(&config, "");
+  if (cGroup.readEntry("Date", QDateTime()) != changedTime)
+    return 0;
+  return QFileInfo(path()).size();
+}
+
+PartialModel::Status PartialModel::write(const QDateTime& changedTime, qint64 totalSize, qint64 offset,
+                                         const QByteArray& data)
+{
+  KConfig config(infoPath(), KConfig::SimpleConfig);
+  KConfigGroup cGroup(&config, "");
+  bool sameModel = (cGroup.readEntry("Date", QDateTime()) == changedTime) &&
+                   (cGroup.readEntry("Size", qint64(-1)) == totalSize);
+
+  QFile part(path());
+  if (offset == 0 || !sameModel) {
+    if (offset != 0) {
+      kDebug() << "Ignoring chunk of unknown transfer at " << offset;
+      return Incomplete;
+    }
+    cGroup.writeEntry("Date", changedTime);
+    cGroup.writeEntry("Size", totalSize);
+    config.sync();
+    if (!part.open(QIODevice::WriteOnly|QIODevice::Truncate))
+      return Failed;
+  } else {
+    if (!part.open(QIODevice::ReadWrite))
+      return Failed;
+    if (offset > part.size()) {
+      kDebug() << "Ignoring chunk at " << offset << ", have " << part.size();
+      return Incomplete;
+    }
+  }
+
+  if ((offset + data.size() > totalSize) || !part.seek(offset) || (part.write(data) != data.size()))
+    return Failed;
+
+  return (part.size() == totalSize) ? Complete : Incomplete;
+}
+
+void PartialModel::discard()
+{
+  QFile::remove(path());
+  QFile::remove(infoPath());
+}
+
+QByteArray PartialModel::readChunk(const QString& path, qint64 offset)
+{
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly))
+    return QByteArray();
+  return readChunk(&f, offset);
+}
+
+QByteArray PartialModel::readChunk(QIODevice *container, qint64 offset)
+{
+  if (!container->seek(offset))
+    return QByteArray();
+  return container->read(chunkSize);
+}
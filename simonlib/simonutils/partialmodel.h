@@ -0,0 +1,96 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef SIMON_PARTIALMODEL_H_66FBB406EF82422499430E14089C8453
+#define SIMON_PARTIALMODEL_H_66FBB406EF82422499430E14089C8453
+
+#include "simonutils_export.h"
+#include <QString>
+#include <QDateTime>
+#include <QByteArray>
+
+class QIODevice;
+
+/**
+ * \class PartialModel
+ * \brief Reassembles a model container that is transferred in chunks
+ *
+ * The received data is written to a ".part" file next to the target path.
+ * The modification date and size of the model being transferred are stored
+ * alongside, so that an interrupted transfer of the same model can be
+ * resumed instead of started over.
+ */
+class SIMONUTILS_EXPORT PartialModel
+{
+public:
+  enum Status {
+    Failed=0,
+    Incomplete=1,
+    Complete=2
+  };
+
+  /**
+   * Maximum size of a transferred chunk
+   */
+  static const int chunkSize = 1024*1024;
+
+  explicit PartialModel(const QString& targetPath);
+
+  /**
+   * Path of the (partially) received container
+   */
+  QString path() const;
+
+  /**
+   * \return The number of bytes already received of the model with the
+   *         given modification date
+   */
+  qint64 resumeOffset(const QDateTime& changedTime) const;
+
+  /**
+   * Stores the given chunk. Chunks starting at 0 always start a new transfer;
+   * Chunks past the end of what was received so far are ignored.
+   *
+   * Once Complete is returned, path() holds the whole container. Move it to
+   * the target and call discard().
+   */
+  Status write(const QDateTime& changedTime, qint64 totalSize, qint64 offset, const QByteArray& data);
+
+  /**
+   * Removes all traces of the transfer
+   */
+  void discard();
+
+  /**
+   * Reads the chunk of the given container file starting at offset
+   */
+  static QByteArray readChunk(const QString& path, qint64 offset);
+
+  /**
+   * Reads the chunk of the given, already opened container starting at offset
+   */
+  static QByteArray readChunk(QIODevice *container, qint64 offset);
+
+private:
+  QString m_targetPath;
+  QString infoPath() const;
+};
+
+#endif
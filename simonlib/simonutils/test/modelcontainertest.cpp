@@ -0,0 +1,238 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "../modelcontainer.h"
+#include "../partialmodel.h"
+#include "../fileutils.h"
+
+#include <QTest>
+#include <QFile>
+#include <QDir>
+#include <QBuffer>
+#include <KTar>
+#include <qtest_kde.h>
+
+class testModelContainer: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testRoundTrip();
+    void testRandomAccess();
+    void testSequentialWrite();
+    void testLegacy();
+    void testPartialModel();
+
+  private:
+    QString containerPath;
+    QString tarPath;
+    QString unpackPath;
+    QByteArray metadata;
+    QByteArray hmmdefs;
+
+    QString unpacked(const QString& name);
+};
+
+void testModelContainer::initTestCase()
+{
+  containerPath = QDir::temp().filePath("simon_modelcontainertest.sbm");
+  tarPath = QDir::temp().filePath("simon_modelcontainertest_legacy.sbm");
+  unpackPath = QDir::temp().filePath("simon_modelcontainertest/");
+  QDir::temp().mkdir("simon_modelcontainertest");
+
+  metadata = "<baseModel><name>Test</name></baseModel>";
+  //spans several chunks; the last one is not full
+  hmmdefs.reserve(ModelContainer::chunkSize * 3);
+  for (int i = 0; hmmdefs.size() < ModelContainer::chunkSize * 2 + 17; ++i)
+    hmmdefs += "~h \"" + QByteArray::number(i) + "\"\n<BEGINHMM> <ENDHMM>\n";
+}
+
+void testModelContainer::cleanupTestCase()
+{
+  QFile::remove(containerPath);
+  QFile::remove(tarPath);
+  QFile::remove(unpacked("metadata.xml"));
+  QFile::remove(unpacked("hmmdefs"));
+  QDir::temp().rmdir("simon_modelcontainertest");
+}
+
+QString testModelContainer::unpacked(const QString& name)
+{
+  return unpackPath + name;
+}
+
+void testModelContainer::testRoundTrip()
+{
+  QHash<QString, QByteArray> fromMemory;
+  fromMemory.insert("metadata.xml", metadata);
+  fromMemory.insert("hmmdefs", hmmdefs);
+  fromMemory.insert("empty", QByteArray());
+  QVERIFY(FileUtils::pack(containerPath, fromMemory, QHash<QString, QString>()));
+
+  //compressed chunks of repetitive data
+  QVERIFY(QFile(containerPath).size() < hmmdefs.size() / 2);
+
+  ModelContainer container(containerPath);
+  QVERIFY(container.open(QIODevice::ReadOnly));
+  QVERIFY(!container.isLegacy());
+  QCOMPARE(container.entries().count(), 3);
+  QVERIFY(container.contains("empty"));
+  QVERIFY(!container.contains("tiedlist"));
+  QCOMPARE(container.data("hmmdefs"), hmmdefs);
+  QCOMPARE(container.data("empty"), QByteArray());
+  QVERIFY(container.close());
+
+  QVERIFY(FileUtils::unpack(containerPath, unpackPath, QStringList() << "hmmdefs"));
+  QFile f(unpacked("hmmdefs"));
+  QVERIFY(f.open(QIODevice::ReadOnly));
+  QCOMPARE(f.readAll(), hmmdefs);
+  QVERIFY(!FileUtils::unpack(containerPath, unpackPath, QStringList() << "tiedlist"));
+}
+
+void testModelContainer::testRandomAccess()
+{
+  ModelContainer container(containerPath);
+  QVERIFY(container.open(QIODevice::ReadOnly));
+  QCOMPARE(container.data("metadata.xml"), metadata);
+
+  QBuffer target;
+  QVERIFY(target.open(QIODevice::WriteOnly));
+  QVERIFY(container.copyTo("hmmdefs", &target));
+  QCOMPARE(target.data(), hmmdefs);
+  QVERIFY(!container.copyTo("tiedlist", &target));
+}
+
+void testModelContainer::testSequentialWrite()
+{
+  QBuffer buffer;
+  QVERIFY(buffer.open(QIODevice::WriteOnly));
+  ModelContainer out(&buffer);
+  QVERIFY(out.open(QIODevice::WriteOnly));
+  QVERIFY(out.writeFile("metadata.xml", metadata));
+  QVERIFY(out.writeFile("metadata.xml", metadata + "<!-- updated -->"));
+  QVERIFY(out.close());
+  buffer.close();
+
+  QVERIFY(buffer.open(QIODevice::ReadOnly));
+  QVERIFY(ModelContainer::isContainer(&buffer));
+  ModelContainer in(&buffer);
+  QVERIFY(in.open(QIODevice::ReadOnly));
+  QCOMPARE(in.entries(), QStringList() << "metadata.xml");
+  QCOMPARE(in.data("metadata.xml"), QByteArray(metadata + "<!-- updated -->"));
+
+  //truncated containers are rejected
+  QByteArray truncated = buffer.data().left(buffer.data().size() - 3);
+  QBuffer truncatedBuffer(&truncated);
+  QVERIFY(truncatedBuffer.open(QIODevice::ReadOnly));
+  ModelContainer broken(&truncatedBuffer);
+  QVERIFY(!broken.open(QIODevice::ReadOnly));
+}
+
+void testModelContainer::testLegacy()
+{
+  KTar tar(tarPath, "application/x-gzip");
+  QVERIFY(tar.open(QIODevice::WriteOnly));
+  QVERIFY(tar.writeFile("metadata.xml", "nobody", "nobody", metadata.constData(), metadata.length()));
+  QVERIFY(tar.writeFile("hmmdefs", "nobody", "nobody", hmmdefs.constData(), hmmdefs.length()));
+  QVERIFY(tar.close());
+
+  ModelContainer container(tarPath);
+  QVERIFY(container.open(QIODevice::ReadOnly));
+  QVERIFY(container.isLegacy());
+  QVERIFY(container.contains("hmmdefs"));
+  QCOMPARE(container.data("metadata.xml"), metadata);
+  container.close();
+
+  QFile f(tarPath);
+  QVERIFY(f.open(QIODevice::ReadOnly));
+  ModelContainer fromDevice(&f);
+  QVERIFY(fromDevice.open(QIODevice::ReadOnly));
+  QVERIFY(fromDevice.isLegacy());
+  QCOMPARE(fromDevice.data("hmmdefs"), hmmdefs);
+
+  QVERIFY(FileUtils::unpackAll(tarPath, unpackPath));
+  QFile unpackedMetadata(unpacked("metadata.xml"));
+  QVERIFY(unpackedMetadata.open(QIODevice::ReadOnly));
+  QCOMPARE(unpackedMetadata.readAll(), metadata);
+}
+
+void testModelContainer::testPartialModel()
+{
+  QString target = unpacked("received.sbm");
+  QDateTime changed = QDateTime::currentDateTime();
+  QFile source(containerPath);
+  QVERIFY(source.open(QIODevice::ReadOnly));
+  QByteArray container = source.readAll();
+  qint64 total = container.size();
+
+  PartialModel part(target);
+  part.discard();
+  QCOMPARE(part.resumeOffset(changed), qint64(0));
+
+  QByteArray first = PartialModel::readChunk(containerPath, 0);
+  QCOMPARE(first, container.left(PartialModel::chunkSize));
+  QCOMPARE(part.write(changed, total, 0, first.left(100)), PartialModel::Incomplete);
+
+  //interrupted transfer: resumed by the next receiver
+  PartialModel resumed(target);
+  QCOMPARE(resumed.resumeOffset(changed), qint64(100));
+  QCOMPARE(resumed.resumeOffset(changed.addSecs(1)), qint64(0));
+
+  //chunks past what was received are ignored
+  QCOMPARE(resumed.write(changed, total, 200, container.mid(200, 10)), PartialModel::Incomplete);
+  QCOMPARE(resumed.resumeOffset(changed), qint64(100));
+  //as are chunks of a different model
+  QCOMPARE(resumed.write(changed.addSecs(1), total, 100, container.mid(100)), PartialModel::Incomplete);
+  QCOMPARE(resumed.resumeOffset(changed), qint64(100));
+
+  QCOMPARE(resumed.write(changed, total, 100, container.mid(100)), PartialModel::Complete);
+  ModelContainer received(resumed.path());
+  QVERIFY(received.open(QIODevice::ReadOnly));
+  QCOMPARE(received.data("hmmdefs"), hmmdefs);
+  received.close();
+
+  //more than announced
+  QCOMPARE(resumed.write(changed, 10, 0, container.left(11)), PartialModel::Failed);
+
+  resumed.discard();
+  QVERIFY(!QFile::exists(resumed.path()));
+  QCOMPARE(resumed.resumeOffset(changed), qint64(0));
+
+  //an open container keeps serving the model it was opened with even if
+  //the file is replaced in the meantime
+  QString replacedPath = unpacked("replaced.sbm");
+  QVERIFY(QFile::copy(containerPath, replacedPath));
+  QFile replaced(replacedPath);
+  QVERIFY(replaced.open(QIODevice::ReadOnly));
+  QCOMPARE(PartialModel::readChunk(&replaced, 100), container.mid(100, PartialModel::chunkSize));
+  QVERIFY(QFile::remove(replacedPath));
+  QFile newer(replacedPath);
+  QVERIFY(newer.open(QIODevice::WriteOnly));
+  newer.write("newer model");
+  newer.close();
+  QCOMPARE(PartialModel::readChunk(&replaced, 0), container.left(PartialModel::chunkSize));
+  replaced.close();
+  QFile::remove(replacedPath);
+}
+
+QTEST_KDEMAIN(testModelContainer, NoGUI)
+
+#include "modelcontainertest.moc"
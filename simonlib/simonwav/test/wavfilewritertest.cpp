@@ -0,0 +1,163 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+
+#include "../wavfilewriter.h"
+#include "../wav.h"
+
+#include <QTest>
+#include <QDir>
+#include <QFile>
+#include <QtEndian>
+
+/**
+ * Checks the header of streamed wav files while they are written, once
+ * they are finished and when they are cut off after a block.
+ */
+class testWavFileWriter: public QObject
+{
+  Q_OBJECT
+  private slots:
+    void init();
+    void cleanup();
+    void testBlocks();
+    void testFinish();
+    void testTruncated();
+    void testAbort();
+
+  private:
+    QString path;
+    QString copyPath;
+
+    QByteArray samples(int length);
+    static QByteArray readFile(const QString& path);
+    void verifyHeader(const QByteArray& file, quint32 dataLength);
+};
+
+void testWavFileWriter::init()
+{
+  path = QDir::temp().filePath("simonwavfilewritertest.wav");
+  copyPath = QDir::temp().filePath("simonwavfilewritertest-copy.wav");
+}
+
+void testWavFileWriter::cleanup()
+{
+  QFile::remove(path);
+  QFile::remove(copyPath);
+}
+
+QByteArray testWavFileWriter::samples(int length)
+{
+  QByteArray data(length, 0);
+  for (int i=0; i < length; i++)
+    data[i] = (char) (i % 251);
+  return data;
+}
+
+QByteArray testWavFileWriter::readFile(const QString& path)
+{
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly))
+    return QByteArray();
+  return f.readAll();
+}
+
+void testWavFileWriter::verifyHeader(const QByteArray& file, quint32 dataLength)
+{
+  QVERIFY(file.size() >= 44);
+  const uchar *data = reinterpret_cast<const uchar*>(file.constData());
+  QCOMPARE(file.left(4), QByteArray("RIFF"));
+  QCOMPARE(qFromLittleEndian<quint32>(data + 4), dataLength + 36);
+  QCOMPARE(file.mid(8, 4), QByteArray("WAVE"));
+  QCOMPARE(qFromLittleEndian<quint16>(data + 22), (quint16) 1);
+  QCOMPARE(qFromLittleEndian<quint32>(data + 24), (quint32) 16000);
+  QCOMPARE(file.mid(36, 4), QByteArray("data"));
+  QCOMPARE(qFromLittleEndian<quint32>(data + 40), dataLength);
+}
+
+void testWavFileWriter::testBlocks()
+{
+  WavFileWriter writer(path, 1, 16000);
+  QVERIFY(writer.open());
+  verifyHeader(readFile(path), 0);
+
+  //the header follows every flushed block; partial blocks stay in memory
+  for (int i=1; i <= 3; i++) {
+    writer.write(samples(WavFileWriter::flushBlockSize));
+    QByteArray file = readFile(path);
+    verifyHeader(file, i * WavFileWriter::flushBlockSize);
+    QCOMPARE(file.size(), 44 + i * WavFileWriter::flushBlockSize);
+  }
+
+  writer.write(samples(100));
+  verifyHeader(readFile(path), 3 * WavFileWriter::flushBlockSize);
+  QVERIFY(writer.finish());
+}
+
+void testWavFileWriter::testFinish()
+{
+  QByteArray data = samples(WavFileWriter::flushBlockSize + 1000);
+  WavFileWriter writer(path, 1, 16000);
+  QVERIFY(writer.open());
+  writer.write(data);
+  QVERIFY(writer.finish());
+
+  QVERIFY(!writer.isOpen());
+  QCOMPARE(writer.getLength(), (qint64) data.size());
+  QByteArray file = readFile(path);
+  verifyHeader(file, data.size());
+  QCOMPARE(file.mid(44), data);
+
+  //finishing twice is harmless
+  QVERIFY(writer.finish());
+  QCOMPARE(readFile(path), file);
+}
+
+void testWavFileWriter::testTruncated()
+{
+  QByteArray data = samples(WavFileWriter::flushBlockSize + 1000);
+  WavFileWriter writer(path, 1, 16000);
+  QVERIFY(writer.open());
+  writer.write(data);
+
+  //what is on disk if the application died now
+  QVERIFY(QFile::copy(path, copyPath));
+  writer.abort();
+
+  WAV wav(copyPath);
+  QCOMPARE(wav.getSampleRate(), 16000);
+  QCOMPARE(wav.getChannels(), 1);
+  QCOMPARE(wav.getLength(), (int) WavFileWriter::flushBlockSize);
+  QCOMPARE(readFile(copyPath).mid(44), data.left(WavFileWriter::flushBlockSize));
+}
+
+void testWavFileWriter::testAbort()
+{
+  WavFileWriter writer(path, 1, 16000);
+  QVERIFY(writer.open());
+  writer.write(samples(WavFileWriter::flushBlockSize * 2));
+  writer.abort();
+  QVERIFY(!writer.isOpen());
+  QVERIFY(!QFile::exists(path));
+}
+
+QTEST_MAIN(testWavFileWriter)
+
+#include "wavfilewritertest.moc"
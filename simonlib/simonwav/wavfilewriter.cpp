@@ -0,0 +1,172 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "wavfilewriter.h"
+#include <QDataStream>
+#include <KDebug>
+#include <string.h>
+
+WavFileWriter::WavFileWriter(const QString& filename, int channels, int samplerate, QObject *parent) :
+  QIODevice(parent),
+  m_file(filename),
+  m_channels(channels),
+  m_samplerate(samplerate),
+  m_length(0),
+  m_block(flushBlockSize, 0),
+  m_pending(0),
+  m_failed(false)
+{
+}
+
+bool WavFileWriter::open(OpenMode mode)
+{
+  if (isOpen())
+    close();
+
+  if (mode & QIODevice::ReadOnly) {
+    setErrorString("WavFileWriter can not be opened for reading");
+    return false;
+  }
+
+  m_length = 0;
+  m_failed = false;
+  m_pending = 0;
+
+  if (!m_file.open(QIODevice::WriteOnly|QIODevice::Truncate) || !writeHeader()) {
+    kWarning() << "Failed to create " << m_file.fileName() << m_file.errorString();
+    setErrorString(m_file.errorString());
+    m_file.close();
+    return false;
+  }
+  return QIODevice::open(mode|QIODevice::Unbuffered);
+}
+
+/**
+ * Writes the 44 byte header for the current length and leaves the file
+ * positioned at its end.
+ * See WAV::writeHeader(), WAV::writeFormat() and WAV::writeDataChunk().
+ */
+bool WavFileWriter::writeHeader()
+{
+  if (!m_file.seek(0))
+    return false;
+
+  QDataStream dstream(&m_file);
+  dstream.setByteOrder(QDataStream::LittleEndian);
+
+  dstream.writeRawData("RIFF", 4);
+  dstream << (quint32) (m_length + 36);
+  dstream.writeRawData("WAVE", 4);
+
+  dstream.writeRawData("fmt ", 4);
+  dstream << (quint32) 0x10;
+  dstream << (quint16) 0x01;
+  dstream << (quint16) m_channels;
+  dstream << (quint32) m_samplerate;
+  dstream << (quint32) (m_channels * m_samplerate * (int) sizeof(short));
+  dstream << (quint16) (m_channels * (int) sizeof(short));
+  dstream << (quint16) 16;
+
+  dstream.writeRawData("data", 4);
+  dstream << (quint32) m_length;
+
+  return (dstream.status() == QDataStream::Ok) && m_file.seek(m_file.size());
+}
+
+/**
+ * Appends the pending block and patches the header.
+ *
+ * This runs on the thread that calls write(), which for recordings is the
+ * audio capture thread (WavRecorderClient::processPrivate()). It costs a
+ * write, a flush (no fsync) and two seeks per block, i.e. about every two
+ * seconds of 16 kHz mono audio; all of this normally ends in the page cache.
+ */
+bool WavFileWriter::flushPending()
+{
+  if (!m_pending)
+    return true;
+
+  qint64 written = m_file.write(m_block.constData(), m_pending);
+  if (written != m_pending) {
+    kWarning() << "Failed to write to " << m_file.fileName() << m_file.errorString();
+    m_failed = true;
+  }
+  if (written > 0)
+    m_length += written;
+  m_pending = 0;
+
+  if (!m_file.flush() || !writeHeader())
+    m_failed = true;
+  return !m_failed;
+}
+
+qint64 WavFileWriter::writeData(const char *data, qint64 maxSize)
+{
+  qint64 remaining = maxSize;
+  while (remaining > 0) {
+    int chunk = qMin<qint64>(remaining, flushBlockSize - m_pending);
+    memcpy(m_block.data() + m_pending, data, chunk);
+    m_pending += chunk;
+    data += chunk;
+    remaining -= chunk;
+    if (m_pending == flushBlockSize)
+      flushPending();
+  }
+  return maxSize;
+}
+
+qint64 WavFileWriter::readData(char *data, qint64 maxSize)
+{
+  Q_UNUSED(data);
+  Q_UNUSED(maxSize);
+  return -1;
+}
+
+bool WavFileWriter::finish()
+{
+  if (!m_file.isOpen())
+    return !m_failed;
+
+  flushPending();
+  m_file.close();
+  QIODevice::close();
+  return !m_failed;
+}
+
+void WavFileWriter::abort()
+{
+  if (!m_file.isOpen())
+    return;
+
+  m_pending = 0;
+  m_file.close();
+  QIODevice::close();
+  m_file.remove();
+}
+
+void WavFileWriter::close()
+{
+  finish();
+}
+
+WavFileWriter::~WavFileWriter()
+{
+  finish();
+}
@@ -0,0 +1,97 @@
+/*
+ *   Copyright (C) 2014 Peter Grasch <peter.grasch@bedahr.org>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2,
+ *   or (at your option) any later version, as published by the Free
+ *   Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef SIMON_WAVFILEWRITER_H_FEA2796866CA43BCA0A7EC901F3F5314
+#define SIMON_WAVFILEWRITER_H_FEA2796866CA43BCA0A7EC901F3F5314
+
+#include <QIODevice>
+#include <QFile>
+#include <QByteArray>
+
+#include "simonwav_export.h"
+
+/**
+ * \class WavFileWriter
+ * \brief Streams 16 bit PCM data into a WAV file
+ *
+ * Unlike WAV, which keeps the whole recording in memory until writeFile(),
+ * this writes the header when opened and appends the samples in blocks of
+ * flushBlockSize bytes.
+ *
+ * The sizes in the header are updated after every block, so a file that
+ * was never finished (e.g. because the application crashed) is still valid
+ * up to the last written block.
+ *
+ * The blocks are written synchronously by write(); see flushPending() for
+ * what this costs the calling (e.g. capture) thread.
+ *
+ * Use WAV for short clips that need to be read back from memory.
+ */
+class SIMONWAV_EXPORT WavFileWriter : public QIODevice
+{
+  public:
+    static const int flushBlockSize = 64 * 1024;
+
+    WavFileWriter(const QString& filename, int channels, int samplerate, QObject *parent=0);
+
+    /**
+     * Creates (or truncates) the file and writes the header.
+     * Only write only modes are supported.
+     */
+    bool open(OpenMode mode = QIODevice::WriteOnly);
+    void close();
+
+    /**
+     * Writes any pending samples, patches the header and closes the file.
+     * \return False if any write to the file failed
+     */
+    bool finish();
+
+    /**
+     * Discards the recording: Closes the file without writing pending
+     * samples and removes it.
+     */
+    void abort();
+
+    bool isSequential() const { return true; }
+
+    QString getFilename() const { return m_file.fileName(); }
+    qint64 getLength() const { return m_length; }
+
+    ~WavFileWriter();
+
+  protected:
+    qint64 readData(char *data, qint64 maxSize);
+    qint64 writeData(const char *data, qint64 maxSize);
+
+  private:
+    QFile m_file;
+    qint16 m_channels;
+    qint32 m_samplerate;
+    qint64 m_length;
+    QByteArray m_block;
+    int m_pending;
+    bool m_failed;
+
+    bool writeHeader();
+    bool flushPending();
+};
+
+#endif